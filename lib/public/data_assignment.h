@@ -0,0 +1,123 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_assignment.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** Fluorophore to detector assignment
+**
+** :class: Data::AssignmentSolver
+** Assigns every fluorophore to (at most) one detector of an instrument, and
+** every detector to (at most) one fluorophore, at minimal total cost. The
+** cost of a pairing rewards the signal (excitation efficiency times filter
+** throughput) and penalizes the fraction of the emission spilling into the
+** other detectors. Solved with the Hungarian algorithm (shortest augmenting
+** paths with potentials). Adding a fluorophore runs a single augmenting
+** phase, removing a fluorophore re-solves the (small) problem.
+**
+***************************************************************************/
+
+#ifndef DATA_ASSIGNMENT_H
+#define DATA_ASSIGNMENT_H
+
+#include <QString>
+#include <QStringList>
+#include <limits>
+#include <vector>
+
+#include "data_global.h"
+#include "data_instruments.h"
+#include "data_spectrum.h"
+#include "data_spillover.h"
+
+namespace Data {
+
+class DATALIB_EXPORT AssignmentSolver {
+ public:
+  AssignmentSolver();
+  AssignmentSolver(const AssignmentSolver&) = default;
+  AssignmentSolver& operator=(const AssignmentSolver&) = default;
+  AssignmentSolver(AssignmentSolver&&) = default;
+  AssignmentSolver& operator=(AssignmentSolver&&) = default;
+  ~AssignmentSolver() = default;
+
+  static const std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  struct Options {
+    Options() : spillover_weight(1.0), signal_minimum(0.01) {}
+
+    double spillover_weight;  // weight of the spillover fraction relative to the signal
+    double signal_minimum;    // minimum signal of a fluorophore in its detector
+  };
+
+ private:
+  Data::SpilloverMatrix solver_detectors;
+  AssignmentSolver::Options solver_options;
+
+  QStringList row_ids;
+  std::vector<Data::Spectrum> row_spectra;
+  std::vector<double> row_cost;  // [fluorophore][detector], the cost of unassigned (dummy column) is 0.0
+
+  std::size_t column_capacity;           // amount of dummy columns, atleast the amount of rows
+  std::vector<double> potential_row;     // size: rows
+  std::vector<double> potential_column;  // size: columns + 1 (sentinel)
+  std::vector<std::size_t> column_row;   // size: columns + 1, the row assigned to the column, or none
+  std::vector<std::size_t> row_column;   // size: rows, the column assigned to the row
+
+  // Scratch buffers of the augmenting phase
+  std::vector<double> phase_minimum;
+  std::vector<std::size_t> phase_way;
+  std::vector<char> phase_used;
+
+ public:
+  void setInstrument(const Data::Instrument& instrument);
+  void setOptions(const AssignmentSolver::Options& options);
+
+  void sync(const std::vector<const Data::Spectrum*>& spectra);
+  void add(const Data::Spectrum& spectrum);
+  void remove(const QString& id);
+  void clear();
+
+  std::size_t fluorophoreCount() const;
+  std::size_t detectorCount() const;
+  const QString& fluorophore(std::size_t fluorophore) const;
+  const Data::SpilloverMatrix::Detector& detector(std::size_t detector) const;
+
+  std::size_t assignment(std::size_t fluorophore) const;
+  std::size_t assignment(const QString& id) const;
+  double cost(std::size_t fluorophore, std::size_t detector) const;
+  double totalCost() const;
+
+ private:
+  std::size_t columnCount() const;
+  double columnCost(std::size_t row, std::size_t column) const;
+  void buildCost(const Data::Spectrum& spectrum, double* cost) const;
+  void rebuild();
+  void eraseRow(std::size_t row);
+  void solve();
+  void solveRow(std::size_t row);
+};
+
+}  // namespace Data
+
+#endif  // DATA_ASSIGNMENT_H
@@ -0,0 +1,121 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_catalogue.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** Persistent catalogue of FCS acquisitions
+**
+** :class: Data::FCSCatalogue
+** Indexes all .fcs files below a set of folders. Only the HEADER and TEXT
+** segments are read: the cytometer ($CYT), detectors ($PnN), stains ($PnS),
+** and laser wavelengths ($PnL and LASERn keywords). Every file is matched
+** to the instrument with the most similar detectors, lasers, and name.
+** The folders are walked level by level with all directories of a level
+** listed in parallel, the headers are parsed in parallel. The catalogue is
+** stored as json; a rescan only parses new and changed (size or time) files.
+** Long running, so it is cancelled through its token and reports its
+** progress.
+**
+***************************************************************************/
+
+#ifndef DATA_CATALOGUE_H
+#define DATA_CATALOGUE_H
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "data_global.h"
+#include "data_instruments.h"
+#include "data_jobs.h"
+
+namespace Data {
+
+class DATALIB_EXPORT FCSCatalogue {
+ public:
+  FCSCatalogue();
+  FCSCatalogue(const FCSCatalogue&) = delete;
+  FCSCatalogue& operator=(const FCSCatalogue&) = delete;
+  FCSCatalogue(FCSCatalogue&&) = delete;
+  FCSCatalogue& operator=(FCSCatalogue&&) = delete;
+  ~FCSCatalogue() = default;
+
+  static const std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  struct Entry {
+    QString path;
+    qint64 size;
+    qint64 modified;  // in ms since epoch
+    bool valid;       // whether the header could be read
+    QString cytometer;
+    std::size_t event_count;
+    QStringList detectors;       // $PnN
+    QStringList labels;          // $PnS
+    std::vector<double> lasers;  // the excitation wavelengths, sorted
+    QString instrument;          // the id of the best matching instrument, empty if none matches
+    double score;                // the match score (0.0-1.0)
+  };
+
+ private:
+  struct Profile {
+    QString id;
+    QString name;                // simplified name
+    QStringList detectors;       // simplified filter names, sorted
+    std::vector<double> lasers;  // sorted
+  };
+
+  std::vector<FCSCatalogue::Profile> profiles;
+  QStringList catalogue_folders;
+  std::vector<FCSCatalogue::Entry> catalogue_entries;  // sorted by path
+  std::size_t scanned_count;
+
+  bool cancelled;  // whether the last scan was cancelled
+  Data::JobProgress scan_progress;
+
+  static void readEntry(FCSCatalogue::Entry& entry);
+  void matchInstrument(FCSCatalogue::Entry& entry) const;
+
+ public:
+  void setInstruments(const Data::InstrumentReader& reader);
+  void setFolders(const QStringList& folders);
+  const QStringList& folders() const;
+
+  bool load(const QString& path);
+  bool save(const QString& path) const;
+
+  bool scan(const Data::JobToken& token = Data::JobToken(), std::function<void(double)> report = nullptr);
+  bool isCancelled() const;
+  double progress() const;
+
+  std::size_t entryCount() const;
+  const FCSCatalogue::Entry& entry(std::size_t index) const;
+  std::size_t find(const QString& path) const;
+  std::size_t scannedCount() const;
+};
+
+}  // namespace Data
+
+#endif  // DATA_CATALOGUE_H
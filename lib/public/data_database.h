@@ -0,0 +1,231 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_database.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** The compiled (binary) fluorophore spectrum database
+**
+** :class: Data::SpectrumDatabase
+** Memory maps a compiled spectrum database file and returns the fluorophore
+** ids, names and spectra directly from the mapped pages. The file is compiled
+** from fluorophores.json and is considered stale if the source file changed.
+** Alternatively decodes fluorophores.json in parallel into an in-memory image
+** of the same layout, which is a single contiguous structure-of-arrays arena.
+** The returned Data::Polygon's are views on the mapped pages / arena.
+**
+** File layout (native byte order, every section aligned to 16 bytes):
+**   Header        - magic, version, source file size/modification time, offsets
+**   Records       - one fixed size Record per enabled fluorophore, ordered by id
+**   Strings       - UTF-8 encoded ids and '\0' separated names
+**   Floats        - per curve the intensities on its uniform wavelength grid,
+**                   the grid start and step are stored in the Record. The
+**                   emission curve is followed by its cumulative integral
+**
+** :class: Data::SpectrumIndex
+** Byte-offset index of fluorophores.json. A single streaming scan records the
+** byte range of each (enabled) fluorophore object and its names, the spectra
+** arrays are skipped. A fluorophore object is only parsed upon request, the
+** spectrum decoded from it can be cached in the index for later requests.
+**
+***************************************************************************/
+
+#ifndef DATA_DATABASE_H
+#define DATA_DATABASE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "data_global.h"
+#include "data_spectrum.h"
+
+namespace Data {
+
+class SpectrumIndex;
+
+class DATALIB_EXPORT SpectrumDatabase : public std::enable_shared_from_this<SpectrumDatabase> {
+ public:
+  SpectrumDatabase();
+  SpectrumDatabase(const SpectrumDatabase&) = delete;
+  SpectrumDatabase& operator=(const SpectrumDatabase&) = delete;
+  SpectrumDatabase(SpectrumDatabase&&) = delete;
+  SpectrumDatabase& operator=(SpectrumDatabase&&) = delete;
+  ~SpectrumDatabase();
+
+  static const quint32 version = 3;
+
+  struct Header {
+    char magic[8];
+    quint32 version;
+    quint32 record_count;
+    qint64 source_size;
+    qint64 source_modified;
+    quint64 offset_records;
+    quint64 offset_strings;
+    quint64 offset_floats;
+    quint64 file_size;
+  };
+
+  struct Record {
+    quint32 id_offset;  // in bytes, relative to offset_strings
+    quint32 id_size;
+    quint32 names_offset;  // in bytes, relative to offset_strings
+    quint32 names_size;
+    quint32 excitation_offset;  // in floats, relative to offset_floats
+    quint32 excitation_size;
+    quint32 emission_offset;  // in floats, relative to offset_floats
+    quint32 emission_size;
+    double excitation_start;  // in nm, uniform grid start
+    double excitation_step;   // in nm, uniform grid step
+    double emission_start;
+    double emission_step;
+    double excitation_max;
+    double emission_max;
+    quint32 flags;
+    quint32 emission_cumulative_offset;  // in floats, relative to offset_floats, emission_size values
+  };
+
+  enum RecordFlag : quint32 { Absorption = 0x01 };
+
+  // A single decoded fluorophore, the input for building a database image
+  struct Decoded {
+    QString id;
+    QStringList names;
+    std::vector<float> excitation;  // intensities on the uniform grid
+    std::vector<float> emission;    // intensities on the uniform grid
+    std::vector<float> emission_cumulative;  // cumulative integral of the emission on the uniform grid
+    double excitation_start;
+    double excitation_step;
+    double emission_start;
+    double emission_step;
+    double excitation_max;
+    double emission_max;
+    quint32 flags;
+  };
+
+ private:
+  QFile file;
+  std::vector<uchar> file_image;  // the in-memory image if the database is not mapped
+  const uchar* file_data;
+  quint64 file_size;
+  const Header* header;
+  const Record* records;
+  const char* strings;
+  const float* floats;
+  std::unordered_map<QString, std::size_t> record_index;
+
+ public:
+  bool open(const QString& path_compiled, const QString& path_source);
+  bool decode(const QString& path_source);
+  void close();
+  bool isValid() const;
+  bool isMapped() const;
+  bool write(const QString& path_compiled) const;
+
+  std::size_t size() const;
+  std::size_t find(const QString& id) const;
+
+  QString id(std::size_t record) const;
+  QStringList names(std::size_t record) const;
+  bool absorptionFlag(std::size_t record) const;
+  Data::Meta meta(std::size_t record) const;
+  Data::Polygon excitation(std::size_t record) const;
+  Data::Polygon emission(std::size_t record) const;
+
+  static bool compile(const QJsonDocument& document, const QString& path_source, const QString& path_compiled);
+  static bool compile(const Data::SpectrumIndex& index, const QString& path_compiled);
+  static void decodeObject(const QJsonObject& object, SpectrumDatabase::Decoded& decoded);
+
+ private:
+  bool attach(const uchar* data, quint64 size);
+  bool verify() const;
+  Data::Polygon toPolygon(quint32 offset, quint32 size, double start, double step, const float* cumulative) const;
+
+  static void decodeEntries(const Data::SpectrumIndex& index, const char* data, std::vector<SpectrumDatabase::Decoded>& decoded);
+  static std::vector<uchar> build(const std::vector<SpectrumDatabase::Decoded>& decoded, qint64 source_size, qint64 source_modified);
+  static bool write(const uchar* data, quint64 size, const QString& path_compiled);
+  static quint64 align(quint64 value);
+};
+
+class DATALIB_EXPORT SpectrumIndex {
+ public:
+  SpectrumIndex();
+  SpectrumIndex(const SpectrumIndex&) = delete;
+  SpectrumIndex& operator=(const SpectrumIndex&) = delete;
+  SpectrumIndex(SpectrumIndex&&) = delete;
+  SpectrumIndex& operator=(SpectrumIndex&&) = delete;
+  ~SpectrumIndex() = default;
+
+  struct Entry {
+    QString id;
+    QStringList names;
+    qint64 begin;  // in bytes, position of the opening '{'
+    qint64 end;    // in bytes, one past the closing '}'
+  };
+
+ private:
+  QString path_source;
+  qint64 source_size;
+  qint64 source_modified;
+  std::vector<SpectrumIndex::Entry> entries;  // ordered by id
+  std::unordered_map<QString, std::size_t> entry_index;
+  mutable std::mutex cache_mutex;
+  mutable std::unordered_map<std::size_t, std::pair<Data::Spectrum, Data::Meta>> cache_spectra;  // decoded spectra, by entry
+
+ public:
+  bool open(const QString& path_source);
+  void close();
+  bool isValid() const;
+
+  const QString& path() const;
+  qint64 sourceSize() const;
+  qint64 sourceModified() const;
+
+  std::size_t size() const;
+  std::size_t find(const QString& id) const;
+
+  const QString& id(std::size_t entry) const;
+  const QStringList& names(std::size_t entry) const;
+  const SpectrumIndex::Entry& entry(std::size_t index) const;
+  QJsonObject object(std::size_t entry) const;
+  bool cached(std::size_t entry, Data::Spectrum& spectrum, Data::Meta& meta) const;
+  void cache(std::size_t entry, const Data::Spectrum& spectrum, const Data::Meta& meta) const;
+
+  bool scan(const char* data, qint64 size);
+
+ private:
+  bool scanObject(const char* data, qint64 size);
+};
+
+}  // namespace Data
+
+#endif  // DATA_DATABASE_H
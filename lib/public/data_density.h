@@ -0,0 +1,106 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_density.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** Density (histogram) binning of large event sets
+**
+** :class: Data::DensityGrid
+** Bins events of one (histogram) or two (density) parameters into a grid of
+** equal sized bins. The bins are calculated with the vectorized
+** Kernel::binIndices and counted in per-thread grids. On setEvents() all
+** events are binned once into a fine base grid covering the event extent.
+** A new range/size is resampled from the base grid while its bins are
+** smaller than the requested bins; the events are only binned again when
+** zoomed in further than the base resolution. Copies share the events and
+** the base grid, so a grid can cheaply be copied into a job for rebinning.
+**
+***************************************************************************/
+
+#ifndef DATA_DENSITY_H
+#define DATA_DENSITY_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "data_global.h"
+
+namespace Data {
+
+class DATALIB_EXPORT DensityGrid {
+ public:
+  DensityGrid();
+  DensityGrid(const DensityGrid&) = default;
+  DensityGrid& operator=(const DensityGrid&) = default;
+  DensityGrid(DensityGrid&&) = default;
+  DensityGrid& operator=(DensityGrid&&) = default;
+  ~DensityGrid() = default;
+
+ private:
+  std::shared_ptr<const std::vector<float>> events_x;
+  std::shared_ptr<const std::vector<float>> events_y;  // nullptr for a histogram
+
+  double extent_x_min;
+  double extent_x_max;
+  double extent_y_min;
+  double extent_y_max;
+  std::size_t base_columns;
+  std::size_t base_rows;
+  std::shared_ptr<const std::vector<std::uint32_t>> base_counts;  // row-major [row][column], shared by copies
+
+  double grid_x_min;
+  double grid_x_max;
+  double grid_y_min;
+  double grid_y_max;
+  std::size_t grid_columns;
+  std::size_t grid_rows;
+  std::vector<float> grid_counts;  // row-major [row][column], row 0 is the lowest y
+  float grid_maximum;
+  bool grid_resampled;
+
+  void binEvents(double x_min, double x_max, std::size_t columns, double y_min, double y_max, std::size_t rows,
+                 std::vector<std::uint32_t>& counts) const;
+  void resample();
+
+ public:
+  void setEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y = nullptr);
+  void clear();
+
+  bool isEmpty() const;
+  bool isHistogram() const;
+  std::size_t eventCount() const;
+  void extent(double& x_min, double& x_max, double& y_min, double& y_max) const;
+
+  bool bin(double x_min, double x_max, std::size_t columns, double y_min, double y_max, std::size_t rows);
+  std::size_t columns() const;
+  std::size_t rows() const;
+  const float* counts() const;
+  float maximum() const;
+  bool isResampled() const;
+};
+
+}  // namespace Data
+
+#endif  // DATA_DENSITY_H
@@ -0,0 +1,132 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_estimator.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** Estimation of the measured spillover matrix from single stain controls
+**
+** :class: Data::SpilloverEstimator
+** Estimates the spillover of every single stain control FCS file in a
+** folder, and compares it to the spillover predicted from the spectra for
+** the same instrument. The FCS parameters are matched to the instrument's
+** detectors by name. In every control the primary detector gates a
+** negative and a positive population, the spillover into a detector is the
+** difference of the population medians normalized to the primary detector.
+** The medians are found with a parallel radix selection over the streamed
+** events: a few counting passes over the (memory mapped) file instead of a
+** sort. Long running, so it is cancelled through its token and reports its
+** progress.
+**
+***************************************************************************/
+
+#ifndef DATA_ESTIMATOR_H
+#define DATA_ESTIMATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "data_global.h"
+#include "data_instruments.h"
+#include "data_jobs.h"
+#include "data_spectrum.h"
+#include "data_spillover.h"
+
+namespace Data {
+
+class DATALIB_EXPORT SpilloverEstimator {
+ public:
+  SpilloverEstimator();
+  SpilloverEstimator(const SpilloverEstimator&) = delete;
+  SpilloverEstimator& operator=(const SpilloverEstimator&) = delete;
+  SpilloverEstimator(SpilloverEstimator&&) = delete;
+  SpilloverEstimator& operator=(SpilloverEstimator&&) = delete;
+  ~SpilloverEstimator() = default;
+
+  static const std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  enum Mode { Measured, Predicted, Difference };
+
+  struct Options {
+    Options() : positive_quantile(0.98), negative_quantile(0.5), chunk_events(65536) {}
+
+    double positive_quantile;  // events above this quantile of the primary detector are positive
+    double negative_quantile;  // events below this quantile of the primary detector are negative
+    std::size_t chunk_events;  // events per streamed chunk
+  };
+
+  struct Control {
+    QString path;
+    QString name;                // the stain: the label ($PnS) of the primary detector, or the file name
+    std::size_t primary;         // the primary detector, none if the control could not be estimated
+    std::size_t negative_count;  // events in the negative population
+    std::size_t positive_count;  // events in the positive population
+  };
+
+ private:
+  Data::Instrument estimator_instrument;
+  std::vector<Data::Spectrum> library;
+  QStringList library_names;
+  QStringList control_paths;
+  SpilloverEstimator::Options estimator_options;
+
+  std::vector<SpilloverEstimator::Control> estimator_controls;
+  std::vector<double> estimator_measured;  // control x detector, NaN if not measured
+  Data::SpilloverMatrix estimator_predicted;
+  std::vector<std::size_t> predicted_rows;  // per control the row in estimator_predicted, or none
+
+  bool cancelled;  // whether the last run was cancelled
+  Data::JobProgress run_progress;
+
+  bool estimateControl(std::size_t index, SpilloverEstimator::Control& control, double* row, const Data::JobToken& token);
+  std::size_t matchLibrary(const QString& name) const;
+  void predict();
+
+ public:
+  void setInstrument(const Data::Instrument& instrument);
+  void setLibrary(std::vector<Data::Spectrum> spectra, QStringList names);
+  std::size_t setFolder(const QString& folder);
+  void setOptions(const SpilloverEstimator::Options& options);
+
+  bool run(const Data::JobToken& token = Data::JobToken(), std::function<void(double)> report = nullptr);
+  bool isCancelled() const;
+  double progress() const;
+
+  std::size_t controlCount() const;
+  const SpilloverEstimator::Control& control(std::size_t index) const;
+  std::size_t detectorCount() const;
+  const Data::SpilloverMatrix::Detector& detector(std::size_t index) const;
+  bool isPredicted(std::size_t control) const;
+  double measured(std::size_t control, std::size_t detector) const;
+  double predicted(std::size_t control, std::size_t detector) const;
+  double value(SpilloverEstimator::Mode mode, std::size_t control, std::size_t detector) const;
+
+  QString toCSV(SpilloverEstimator::Mode mode) const;
+};
+
+}  // namespace Data
+
+#endif  // DATA_ESTIMATOR_H
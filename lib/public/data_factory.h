@@ -75,6 +75,7 @@ class DATALIB_EXPORT Factory {
   QString getPathStyles() const;
   QString getPathInstruments() const;
   QString getPathFluorophores() const;
+  QString getPathFluorophoresCompiled() const;
   std::unique_ptr<QSettings> get(const Factory::type type) const;
   QJsonDocument get_json(const Factory::type type) const;
 
@@ -90,6 +91,7 @@ class DATALIB_EXPORT Factory {
   QString path_instruments;
   QString path_fluorophores;
   QString path_styles;
+  QString path_fluorophores_compiled;
 
   bool valid_settings;
   bool valid_defaults;
@@ -101,6 +103,7 @@ class DATALIB_EXPORT Factory {
   bool error_warning;
 
   static bool exists(const QString& path_file);
+  static QString compiledPath(const QString& path_file);
 };
 
 class DATALIB_EXPORT Error : public QMessageBox {
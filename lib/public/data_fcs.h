@@ -0,0 +1,125 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_fcs.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** Reader of flow cytometry standard (FCS 3.0 and 3.1) files
+**
+** :class: Data::FCSReader
+** Parses the HEADER and TEXT segments (keywords, parameters, spillover) of
+** the first dataset of a list mode FCS file. The DATA segment is memory
+** mapped, never read into memory as a whole: float and double data in the
+** native byte order are exposed without a copy, integer (and foreign byte
+** order) data is converted in chunks of events. The header can also be read
+** on its own, without mapping the data.
+**
+***************************************************************************/
+
+#ifndef DATA_FCS_H
+#define DATA_FCS_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "data_global.h"
+
+namespace Data {
+
+class DATALIB_EXPORT FCSReader {
+ public:
+  FCSReader();
+  FCSReader(const FCSReader&) = delete;
+  FCSReader& operator=(const FCSReader&) = delete;
+  FCSReader(FCSReader&&) = delete;
+  FCSReader& operator=(FCSReader&&) = delete;
+  ~FCSReader();
+
+  static const std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  enum DataType { Integer, Float, Double };
+
+  struct Parameter {
+    QString name;      // $PnN, the detector name
+    QString label;     // $PnS, the stain name, can be empty
+    std::size_t bits;  // $PnB
+    double range;      // $PnR
+    double decades;    // $PnE, logarithmic amplification decades, 0.0 for linear data
+    double offset;     // $PnE, logarithmic amplification offset
+    double gain;       // $PnG, linear amplification gain
+  };
+
+ private:
+  QFile file;
+  QString fcs_version;
+  std::unordered_map<QString, QString> fcs_keywords;  // upper case keyword to value
+  std::vector<FCSReader::Parameter> fcs_parameters;
+  FCSReader::DataType data_type;
+  bool data_little_endian;
+  std::size_t event_count;
+  std::size_t event_size;                  // bytes per event
+  std::vector<std::size_t> event_offsets;  // per parameter the byte offset within an event
+  std::vector<std::uint64_t> event_masks;  // per parameter the bit mask of integer data
+  qint64 data_begin;
+  qint64 data_size;
+  uchar* data;
+
+  bool parse(const QString& path);
+  bool parseText(const QByteArray& text);
+  bool parseLayout();
+  void convert(std::size_t parameter, std::size_t begin, std::size_t count, float* values, std::size_t stride) const;
+
+ public:
+  bool readHeader(const QString& path);
+  bool open(const QString& path);
+  void close();
+
+  bool isValid() const;
+  bool isOpen() const;
+  QString path() const;
+  const QString& version() const;
+  QString keyword(const QString& key) const;
+  const std::unordered_map<QString, QString>& keywords() const;
+  QString cytometer() const;
+  bool spillover(QStringList& names, std::vector<double>& values) const;
+
+  std::size_t eventCount() const;
+  std::size_t parameterCount() const;
+  const FCSReader::Parameter& parameter(std::size_t index) const;
+  std::size_t parameterIndex(const QString& name) const;
+  FCSReader::DataType dataType() const;
+
+  const float* floatData() const;
+  const double* doubleData() const;
+  std::size_t readColumn(std::size_t parameter, std::size_t begin, std::size_t count, float* values) const;
+  std::size_t readEvents(std::size_t begin, std::size_t count, float* values) const;
+};
+
+}  // namespace Data
+
+#endif  // DATA_FCS_H
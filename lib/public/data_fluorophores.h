@@ -30,9 +30,13 @@
 ** A struct holding the basic informantion of a Fluorophore entree.
 ** This struct is purely used for communication with(in) the GUI.
 **
-** :class: Data::Fluorophore
-** Object that loads fluorophore data from a QSettings. Builds maps/sets,
-** and can return spectrum (DataSpectrum) data upon request.
+** :class: Data::FluorophoreReader
+** Object that loads fluorophore data from the compiled spectrum database, or
+** if that is stale, from fluorophores.json. Builds maps/sets, and can return
+** spectrum (DataSpectrum) data upon request. In Lazy mode fluorophores.json
+** is only indexed, spectra are parsed upon their first request and cached.
+** In Eager mode all spectra are decoded in parallel into a contiguous arena
+** upon loading.
 **
 ***************************************************************************/
 
@@ -41,14 +45,17 @@
 
 #include <QDebug>
 #include <QJsonDocument>
+#include <QJsonObject>
 #include <QString>
 #include <QStringList>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "data_database.h"
 #include "data_factory.h"
 #include "data_global.h"
+#include "data_jobs.h"
 #include "data_spectrum.h"
 
 namespace Data {
@@ -83,16 +90,24 @@ class DATALIB_EXPORT FluorophoreReader {
   FluorophoreReader& operator=(FluorophoreReader&&) = default;
   ~FluorophoreReader() = default;
 
+  enum LoadMode { Document, Lazy, Eager };
+
  private:
+  FluorophoreReader::LoadMode load_mode;
   QJsonDocument fluor_data;
+  std::shared_ptr<const Data::SpectrumDatabase> fluor_database;
+  std::shared_ptr<const Data::SpectrumIndex> fluor_index;
   std::vector<QString> fluor_name;  // ordered vector of fluorophore names (for input list)
   std::unordered_map<QString, QString> fluor_id;  // unordered map, each fluorophore's name corresponding fluorophore ID (for ID/spectrum lookup)
   std::unordered_map<QString, QStringList> fluor_names;  // unordered map, each fluorophore's name corresponding to all name variants (for lineedit item en/disabling)
 
  public:
+  void setLoadMode(FluorophoreReader::LoadMode mode);
   void load(Data::Factory& factory);
   void unload();
   bool isValid() const;
+  bool isCompiled() const;
+  bool compile(const Data::Factory& factory) const;
 
   const std::vector<QString>& getFluorName() const;
   const std::unordered_map<QString, QString>& getFluorID() const;
@@ -100,10 +115,23 @@ class DATALIB_EXPORT FluorophoreReader {
 
   Data::Spectrum getSpectrum(const QString& id) const;
   Data::CacheSpectrum getCacheSpectrum(const QString& id, unsigned int index) const;
+  void getLibrary(std::vector<Data::Spectrum>& spectra, QStringList& names, const Data::JobToken& token = Data::JobToken()) const;
 
  private:
-  static Data::Polygon toPolygon(const QStringList& list_x, const QStringList& list_y);
-  static Data::Polygon toPolygon(const QJsonArray& list_x, const QJsonArray& list_y);
+  void loadDocument();
+  void loadDatabase();
+  bool loadIndex(const Data::Factory& factory);
+  void reserve(std::size_t size);
+  void addNames(const QString& id, const QStringList& names);
+
+  Data::Spectrum getIndexSpectrum(const QString& id, Data::Meta& meta) const;
+  Data::Spectrum getDatabaseSpectrum(const QString& id) const;
+  Data::Meta getDatabaseMeta(const QString& id) const;
+
+  static Data::Spectrum toSpectrum(const QString& id, const QJsonObject& data, Data::Meta& meta);
+
+  static Data::Polygon toPolygon(const QStringList& list_x, const QStringList& list_y, bool cumulative = false);
+  static Data::Polygon toPolygon(const QJsonArray& list_x, const QJsonArray& list_y, bool cumulative = false);
 
   static void qDebugMap(const std::unordered_map<QString, QString>& map);
   static void qDebugMap(const std::unordered_map<QString, QStringList>& map);
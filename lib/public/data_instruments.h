@@ -46,6 +46,8 @@
 **
 ** :class: Data::InstrumentReader
 ** A Reader object that loads the instruments.ini and can return a instruments laser/filter properties
+** Spectral instruments can declare their contiguous detector channels as a
+** range per laserline ("channels") instead of as individual filters
 **
 ***************************************************************************/
 
@@ -53,6 +55,7 @@
 #define DATA_INSTRUMENTS_H
 
 #include <QDebug>
+#include <QJsonObject>
 #include <QString>
 #include <unordered_map>
 #include <vector>
@@ -249,6 +252,9 @@ class DATALIB_EXPORT InstrumentReader {
 
   Instrument getInstrument(const QString& id) const;
   const std::vector<InstrumentID>& getInstruments() const;
+
+ private:
+  static void addChannels(LaserLine& laserline, const QJsonObject& data_channels);
 };
 
 }  // namespace Data
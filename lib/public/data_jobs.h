@@ -0,0 +1,217 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_jobs.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** Shared job system for all heavy computation
+**
+** :class: Data::JobToken
+** Cancellation token of a job. A token is cancelled explicitly, or when the
+** generation it was handed out by has moved on. Copies share the state.
+**
+** :class: Data::JobGeneration
+** Hands out tokens for a stream of superseding jobs (a search per keystroke,
+** a rebin per resize step). Every new token cancels all previous tokens.
+**
+** :class: Data::JobSystem
+** Work-stealing scheduler with a worker per core. Every worker owns a queue
+** per priority; workers take their own newest job first and steal the oldest
+** job of another worker if they run dry, higher priorities first. Jobs of
+** a cancelled token are dropped before they start, running jobs have to poll
+** their token. Data::parallelFor runs its chunks on these workers.
+**
+** :class: Data::JobReceiver
+** Posts the result of a job to the GUI thread. The result is dropped if the
+** receiving QObject is deleted or the token is cancelled in the meantime.
+**
+** :class: Data::JobGroup
+** Submits jobs to the JobSystem and keeps count of them, so their owner can
+** wait for (join) its jobs before it is destroyed. The destructor waits.
+**
+** :class: Data::JobProgress
+** Progress of a long running job in permille. Can be read from any thread,
+** every increase is reported to an (optional) callback on the thread that
+** made the change, usually the callback posts through a JobReceiver.
+**
+***************************************************************************/
+
+#ifndef DATA_JOBS_H
+#define DATA_JOBS_H
+
+#include <QObject>
+#include <QPointer>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "data_global.h"
+
+namespace Data {
+
+class DATALIB_EXPORT JobToken {
+ public:
+  JobToken();
+  JobToken(const JobToken&) = default;
+  JobToken& operator=(const JobToken&) = default;
+  JobToken(JobToken&&) = default;
+  JobToken& operator=(JobToken&&) = default;
+  ~JobToken() = default;
+
+ private:
+  std::shared_ptr<std::atomic<bool>> token_cancelled;
+  std::shared_ptr<const std::atomic<std::uint64_t>> token_current;  // the generation counter, or nullptr
+  std::uint64_t token_generation;
+
+  friend class JobGeneration;
+
+ public:
+  void cancel();
+  bool isCancelled() const;
+  std::uint64_t generation() const;
+};
+
+class DATALIB_EXPORT JobGeneration {
+ public:
+  JobGeneration();
+  JobGeneration(const JobGeneration&) = delete;
+  JobGeneration& operator=(const JobGeneration&) = delete;
+  JobGeneration(JobGeneration&&) = delete;
+  JobGeneration& operator=(JobGeneration&&) = delete;
+  ~JobGeneration();
+
+ private:
+  std::shared_ptr<std::atomic<std::uint64_t>> generation_current;
+
+ public:
+  JobToken next();
+  void cancel();
+  std::uint64_t current() const;
+};
+
+class DATALIB_EXPORT JobSystem {
+ public:
+  enum Priority { High, Normal, Low };
+
+ private:
+  explicit JobSystem(std::size_t threads);
+
+ public:
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+  JobSystem(JobSystem&&) = delete;
+  JobSystem& operator=(JobSystem&&) = delete;
+  ~JobSystem();
+
+  static JobSystem& instance();
+
+ private:
+  struct Job {
+    std::function<void()> function;
+    JobToken token;
+  };
+  struct Queue;
+
+  std::vector<std::unique_ptr<JobSystem::Queue>> queues;  // a queue per worker
+  std::vector<std::thread> workers;
+  std::atomic<std::size_t> submit_next;  // round robin queue for submissions of non-workers
+
+  std::mutex sleep_mutex;
+  std::condition_variable sleep_condition;
+  std::atomic<std::ptrdiff_t> pending;  // amount of queued jobs, only incremented while sleep_mutex is locked
+  bool stopping;
+
+  void work(std::size_t index);
+  bool take(std::size_t index, JobSystem::Job& job);
+
+ public:
+  void submit(std::function<void()> function, JobSystem::Priority priority = JobSystem::Normal, const JobToken& token = JobToken());
+  std::size_t threadCount() const;
+};
+
+class DATALIB_EXPORT JobReceiver {
+ public:
+  explicit JobReceiver(QObject* receiver);
+  JobReceiver(const JobReceiver&) = default;
+  JobReceiver& operator=(const JobReceiver&) = default;
+  JobReceiver(JobReceiver&&) = default;
+  JobReceiver& operator=(JobReceiver&&) = default;
+  ~JobReceiver() = default;
+
+ private:
+  QPointer<QObject> receiver;
+
+ public:
+  void post(std::function<void()> function, const JobToken& token = JobToken()) const;
+};
+
+class DATALIB_EXPORT JobGroup {
+ public:
+  JobGroup();
+  JobGroup(const JobGroup&) = delete;
+  JobGroup& operator=(const JobGroup&) = delete;
+  JobGroup(JobGroup&&) = delete;
+  JobGroup& operator=(JobGroup&&) = delete;
+  ~JobGroup();
+
+ private:
+  std::mutex group_mutex;
+  std::condition_variable group_condition;
+  std::size_t group_running;
+
+  void finish();
+
+ public:
+  void submit(std::function<void()> function, JobSystem::Priority priority = JobSystem::Normal, const JobToken& token = JobToken());
+  void wait();
+};
+
+class DATALIB_EXPORT JobProgress {
+ public:
+  JobProgress();
+  JobProgress(const JobProgress&) = delete;
+  JobProgress& operator=(const JobProgress&) = delete;
+  JobProgress(JobProgress&&) = delete;
+  JobProgress& operator=(JobProgress&&) = delete;
+  ~JobProgress() = default;
+
+ private:
+  std::atomic<int> progress_permille;
+  std::function<void(double)> progress_report;
+
+ public:
+  void reset(std::function<void(double)> report = nullptr);
+  void set(int permille);
+  int permille() const;
+  double value() const;
+};
+
+}  // namespace Data
+
+#endif  // DATA_JOBS_H
@@ -0,0 +1,99 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_kernels.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** Vectorized numerical kernels with runtime instruction set dispatch
+**
+** :function: Data::Kernel::sampleGrid
+** Evaluates a uniform grid curve at many wavelengths, with linear
+** interpolation. Equal to repeated Data::Polygon::intensityAt calls.
+**
+** :function: Data::Kernel::dotRows
+** Calculates the dot product of a vector with every row of a row-major
+** float matrix
+**
+** :function: Data::Kernel::binIndices
+** Calculates the bin of every event in a 1D or 2D grid of equal sized bins,
+** the first step of a (density) histogram
+**
+** :function: Data::Kernel::affineCurve
+** Transforms a uniform grid curve into clamped, interleaved (x, y) points,
+** the scaling of a Data::Polygon into a plotting region
+**
+** :function: Data::Kernel::lowerBound
+** Branchless binary search of many values in an ascending table, the
+** inversion sampling of a discrete (Poisson) distribution
+**
+** :class: Data::Kernel::RandomState
+** The state of eight interleaved xoshiro128+ random generators (lanes)
+**
+** :function: Data::Kernel::seedRandom
+** Seeds the random generators of a RandomState
+**
+** :function: Data::Kernel::uniformFill
+** Fills a buffer with uniform random values in (0, 1]
+**
+** :function: Data::Kernel::normalFill
+** Fills a buffer with standard normal random values (Box-Muller). Every
+** instruction set produces bitwise identical values for the same state.
+**
+** :function: Data::Kernel::instructionSet
+** The instruction set the kernels dispatch to on this cpu. The
+** FLUOR_KERNELS environment variable ("SSE2" or "Scalar") caps it.
+**
+***************************************************************************/
+
+#ifndef DATA_KERNELS_H
+#define DATA_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "data_global.h"
+
+namespace Data {
+namespace Kernel {
+
+struct RandomState {
+  std::uint32_t words[4][8];  // [xoshiro state word][lane]
+};
+
+DATALIB_EXPORT void sampleGrid(const float* y, int size, double start, double step, const double* wavelengths, double* intensities,
+                               std::size_t count, double cutoff);
+DATALIB_EXPORT void dotRows(const float* matrix, std::size_t rows, std::size_t stride, const float* vector, std::size_t count, float* results);
+DATALIB_EXPORT void binIndices(const float* x, const float* y, std::size_t count, double x_min, double x_max, std::size_t columns,
+                               double y_min, double y_max, std::size_t rows, std::uint32_t* indices);
+DATALIB_EXPORT void affineCurve(const float* y, std::size_t count, double x_origin, double x_step, double x_left, double x_right,
+                                double y_slope, double y_intercept, double y_top, double y_bottom, double* points);
+DATALIB_EXPORT void lowerBound(const float* table, std::size_t size, const float* values, std::size_t count, std::uint32_t* indices);
+DATALIB_EXPORT void seedRandom(RandomState& state, std::uint64_t seed);
+DATALIB_EXPORT void uniformFill(RandomState& state, float* values, std::size_t count);
+DATALIB_EXPORT void normalFill(RandomState& state, float* values, std::size_t count);
+DATALIB_EXPORT const char* instructionSet();
+
+}  // namespace Kernel
+}  // namespace Data
+
+#endif  // DATA_KERNELS_H
@@ -0,0 +1,62 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_linalg.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** Small dense linear algebra routines, for matrices of panel size
+**
+** :function: Data::LinearAlgebra::choleskyAppend
+** Extends the upper triangular Cholesky factor R of a Gram matrix (R^T R = G)
+** with a vector: O(size^2) instead of a refactorization. Fails if the vector
+** (nearly) depends on the vectors of the factor.
+**
+** :function: Data::LinearAlgebra::choleskyErase
+** Removes a vector from a Cholesky factor, and restores the triangular form
+** with Givens rotations: O(size^2) instead of a refactorization
+**
+** :function: Data::LinearAlgebra::singularValues
+** Calculates the singular values of a square matrix with the one-sided
+** (Hestenes) Jacobi method. Accurate for the small singular values, which
+** dominate the condition number.
+**
+***************************************************************************/
+
+#ifndef DATA_LINALG_H
+#define DATA_LINALG_H
+
+#include <cstddef>
+
+#include "data_global.h"
+
+namespace Data {
+namespace LinearAlgebra {
+
+DATALIB_EXPORT bool choleskyAppend(const double* r, std::size_t size, const double* column, double* result);
+DATALIB_EXPORT void choleskyErase(const double* r, std::size_t size, std::size_t index, double* result);
+DATALIB_EXPORT void singularValues(const double* matrix, std::size_t size, double* values);
+
+}  // namespace LinearAlgebra
+}  // namespace Data
+
+#endif  // DATA_LINALG_H
@@ -0,0 +1,114 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_panel.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** Panel design
+**
+** :class: Data::PanelOptimizer
+** Picks (at most) one fluorophore per detector of an instrument out of a list
+** of candidates. Maximizes the summed signal minus the weighted (total or
+** worst-case) spillover between the chosen fluorophores. The search is a
+** beam search over the detectors, each beam expansion is run in parallel.
+** run() blocks, it is cancelled through its token and can be monitored from
+** another thread.
+**
+***************************************************************************/
+
+#ifndef DATA_PANEL_H
+#define DATA_PANEL_H
+
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "data_global.h"
+#include "data_instruments.h"
+#include "data_jobs.h"
+#include "data_spectrum.h"
+#include "data_spillover.h"
+
+namespace Data {
+
+class DATALIB_EXPORT PanelOptimizer {
+ public:
+  PanelOptimizer();
+  PanelOptimizer(const PanelOptimizer&) = delete;
+  PanelOptimizer& operator=(const PanelOptimizer&) = delete;
+  PanelOptimizer(PanelOptimizer&&) = delete;
+  PanelOptimizer& operator=(PanelOptimizer&&) = delete;
+  ~PanelOptimizer() = default;
+
+  static const std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  enum Objective { TotalSpillover, WorstSpillover };
+
+  struct Options {
+    Options() : objective(PanelOptimizer::TotalSpillover), spillover_weight(1.0), signal_minimum(0.05), beam_width(64) {}
+
+    PanelOptimizer::Objective objective;
+    double spillover_weight;  // weight of the spillover penalty relative to the signal
+    double signal_minimum;    // minimum signal of a fluorophore in its detector
+    std::size_t beam_width;
+  };
+
+  struct Result {
+    std::vector<std::size_t> assignment;  // per detector the candidate index, or none
+    double score;
+    double signal;
+    double spillover_total;
+    double spillover_worst;
+  };
+
+ private:
+  std::vector<Data::Spectrum> candidates;
+  QStringList candidate_names;
+  Data::SpilloverMatrix optimizer_matrix;
+  PanelOptimizer::Options optimizer_options;
+  PanelOptimizer::Result optimizer_result;
+
+  bool cancelled;  // whether the last run was cancelled
+  Data::JobProgress run_progress;
+
+ public:
+  void setInstrument(const Data::Instrument& instrument);
+  void setCandidates(std::vector<Data::Spectrum> spectra, QStringList names);
+  void setOptions(const PanelOptimizer::Options& options);
+
+  bool run(const Data::JobToken& token = Data::JobToken(), std::function<void(double)> report = nullptr);
+  bool isCancelled() const;
+  double progress() const;
+
+  const PanelOptimizer::Result& result() const;
+  const Data::SpilloverMatrix& matrix() const;
+  std::size_t candidateCount() const;
+  const Data::Spectrum& candidate(std::size_t index) const;
+  const QString& candidateName(std::size_t index) const;
+};
+
+}  // namespace Data
+
+#endif  // DATA_PANEL_H
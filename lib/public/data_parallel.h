@@ -0,0 +1,54 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_parallel.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** Data parallel helpers
+**
+** :function: Data::parallelFor
+** Splits an index range into chunks and runs the chunks on the workers of the
+** Data::JobSystem. The calling thread participates, so the function can safely
+** be called from within a job. Returns after all chunks are finished.
+**
+** :function: Data::parallelThreads
+** The amount of threads parallelFor distributes the work over
+**
+***************************************************************************/
+
+#ifndef DATA_PARALLEL_H
+#define DATA_PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+#include "data_global.h"
+
+namespace Data {
+
+DATALIB_EXPORT void parallelFor(std::size_t count, const std::function<void(std::size_t, std::size_t)>& function, std::size_t grain = 1);
+DATALIB_EXPORT std::size_t parallelThreads();
+
+}  // namespace Data
+
+#endif  // DATA_PARALLEL_H
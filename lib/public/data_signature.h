@@ -0,0 +1,115 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_signature.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** The spectral signature matrix of a panel
+**
+** :class: Data::SignatureMatrix
+** The signature of a fluorophore is its signal in all detectors (channels)
+** normalized to the brightest channel, as used for spectral unmixing. From
+** the signatures the pairwise (cosine) similarity matrix and the complexity
+** index are calculated. The complexity index is the condition number of the
+** signature matrix, the ratio of its largest to its smallest singular value;
+** it grows as the panel gets harder to unmix. Fluorophores without signal in
+** any channel cannot be unmixed and are left out of the complexity index.
+** The Gram matrix of the signals and its Cholesky factor are maintained
+** incrementally: adding or removing a fluorophore is a row/column update,
+** changing the lasers of a laserline only updates that laserline's channels.
+** The singular values of the signatures follow from a one-sided Jacobi SVD
+** of the (small) factor.
+**
+***************************************************************************/
+
+#ifndef DATA_SIGNATURE_H
+#define DATA_SIGNATURE_H
+
+#include <QString>
+#include <QStringList>
+#include <limits>
+#include <vector>
+
+#include "data_global.h"
+#include "data_spillover.h"
+
+namespace Data {
+
+class DATALIB_EXPORT SignatureMatrix {
+ public:
+  SignatureMatrix();
+  SignatureMatrix(const SignatureMatrix&) = default;
+  SignatureMatrix& operator=(const SignatureMatrix&) = default;
+  SignatureMatrix(SignatureMatrix&&) = default;
+  SignatureMatrix& operator=(SignatureMatrix&&) = default;
+  ~SignatureMatrix() = default;
+
+  static const std::size_t none = std::numeric_limits<std::size_t>::max();
+
+ private:
+  std::size_t signature_channels;
+  QStringList signature_fluorophores;        // in row order
+  std::vector<std::size_t> signature_order;  // per row its slot
+
+  // The fluorophores are stored in slots, in order of addition
+  QStringList slot_ids;
+  std::vector<double> slot_signal;       // [slot][channel]
+  std::vector<double> slot_peak;         // [slot], the signal in the brightest channel
+  std::vector<double> slot_gram;         // [slot][slot], the inner products of the signals
+  std::vector<std::size_t> slot_factor;  // [slot], the slot's index in the factor, or none
+
+  std::vector<std::size_t> factor_slots;  // per factor index its slot
+  std::vector<double> factor;             // Cholesky factor of the Gram matrix of the factor_slots
+
+  double signature_complexity;
+
+ public:
+  void calculate(const Data::SpilloverMatrix& matrix);
+  void sync(const Data::SpilloverMatrix& matrix);
+  void updateChannels(const Data::SpilloverMatrix& matrix, std::size_t begin, std::size_t end);
+  void clear();
+
+  bool isEmpty() const;
+  std::size_t fluorophoreCount() const;
+  std::size_t channelCount() const;
+
+  const QString& fluorophore(std::size_t fluorophore) const;
+  double signature(std::size_t fluorophore, std::size_t channel) const;
+  double similarity(std::size_t fluorophore_a, std::size_t fluorophore_b) const;
+  double complexity() const;
+
+  QString toCSV() const;
+
+ private:
+  std::size_t slotCount() const;
+  void appendSlot(const Data::SpilloverMatrix& matrix, std::size_t fluorophore);
+  void eraseSlot(std::size_t slot);
+  bool appendFactor(std::size_t slot);
+  void rebuildFactor();
+  bool isDependent() const;
+  void calculateComplexity();
+};
+
+}  // namespace Data
+
+#endif  // DATA_SIGNATURE_H
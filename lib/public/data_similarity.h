@@ -0,0 +1,110 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_similarity.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** Spectral similarity search
+**
+** :class: Data::SimilarityIndex
+** Stores a normalized signature of every fluorophore of a library, and
+** ranks the library by cosine similarity to a query. A signature is either
+** the excitation and emission spectrum sampled on a fixed wavelength grid,
+** or the signal in the detectors of an instrument. The signatures are stored
+** as one contiguous row-major float matrix, so a query is a single pass of
+** (vectorized) dot products. The rows are split over the thread pool, every
+** chunk keeps a bounded top-k heap that is merged afterwards.
+**
+***************************************************************************/
+
+#ifndef DATA_SIMILARITY_H
+#define DATA_SIMILARITY_H
+
+#include <QString>
+#include <QStringList>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "data_global.h"
+#include "data_instruments.h"
+#include "data_spectrum.h"
+#include "data_spillover.h"
+
+namespace Data {
+
+class DATALIB_EXPORT SimilarityIndex {
+ public:
+  SimilarityIndex();
+  SimilarityIndex(const SimilarityIndex&) = default;
+  SimilarityIndex& operator=(const SimilarityIndex&) = default;
+  SimilarityIndex(SimilarityIndex&&) = default;
+  SimilarityIndex& operator=(SimilarityIndex&&) = default;
+  ~SimilarityIndex() = default;
+
+  static const std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  enum Mode { Spectral, Detector };
+
+  struct Match {
+    std::size_t index;  // row in the index
+    double similarity;  // cosine similarity (0.0-1.0)
+  };
+
+ private:
+  SimilarityIndex::Mode index_mode;
+  Data::SpilloverMatrix index_detectors;
+
+  QStringList index_ids;
+  QStringList index_names;
+  std::unordered_map<QString, std::size_t> index_rows;
+
+  std::size_t index_dimension;  // amount of values in a signature
+  std::size_t index_stride;     // the dimension padded to a multiple of 8 floats
+  std::vector<float> index_signatures;
+
+ public:
+  void setInstrument(const Data::Instrument& instrument);
+  void build(SimilarityIndex::Mode mode, const std::vector<Data::Spectrum>& spectra, const QStringList& names);
+  void clear();
+
+  bool isEmpty() const;
+  SimilarityIndex::Mode mode() const;
+  std::size_t size() const;
+  std::size_t dimension() const;
+  std::size_t find(const QString& id) const;
+  const QString& id(std::size_t index) const;
+  const QString& name(std::size_t index) const;
+
+  std::vector<SimilarityIndex::Match> query(std::size_t index, std::size_t count) const;
+  std::vector<SimilarityIndex::Match> query(const Data::Spectrum& spectrum, std::size_t count) const;
+
+ private:
+  std::size_t signatureDimension(SimilarityIndex::Mode mode) const;
+  bool signature(const Data::Spectrum& spectrum, float* values) const;
+  std::vector<SimilarityIndex::Match> search(const float* values, std::size_t count, std::size_t exclude) const;
+};
+
+}  // namespace Data
+
+#endif  // DATA_SIMILARITY_H
@@ -0,0 +1,105 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_simulation.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** Monte Carlo simulation of the spillover spreading of a panel
+**
+** :class: Data::SpreadingSimulation
+** Simulates single stained and unstained control events of the fluorophores
+** of a spillover matrix: Poisson distributed photon counts in every detector
+** plus normal distributed detector noise. The events are unmixed (ordinary
+** least squares) and the spillover spreading matrix is calculated from the
+** spread of the unmixed controls. The events are simulated in fixed blocks
+** that each have their own random stream, so the result only depends on the
+** seed, not on the amount of threads. Long running, so it is cancelled
+** through its token and reports its progress.
+**
+***************************************************************************/
+
+#ifndef DATA_SIMULATION_H
+#define DATA_SIMULATION_H
+
+#include <QString>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "data_global.h"
+#include "data_jobs.h"
+#include "data_spillover.h"
+
+namespace Data {
+
+class DATALIB_EXPORT SpreadingSimulation {
+ public:
+  SpreadingSimulation();
+  SpreadingSimulation(const SpreadingSimulation&) = delete;
+  SpreadingSimulation& operator=(const SpreadingSimulation&) = delete;
+  SpreadingSimulation(SpreadingSimulation&&) = delete;
+  SpreadingSimulation& operator=(SpreadingSimulation&&) = delete;
+  ~SpreadingSimulation() = default;
+
+  struct Options {
+    Options() : events(100000), brightness(10000.0), background(100.0), noise(10.0), seed(1) {}
+
+    std::size_t events;  // events per control
+    double brightness;   // mean photons of a stained event in its primary detector
+    double background;   // mean (autofluorescence) photons of every event in every detector
+    double noise;        // standard deviation of the detector noise in photons
+    std::uint64_t seed;
+  };
+
+ private:
+  Data::SpilloverMatrix simulation_matrix;
+  SpreadingSimulation::Options simulation_options;
+  std::vector<float> unmixing;           // fluorophore x detector
+  std::vector<double> spreading_matrix;  // stained fluorophore x fluorophore
+  std::size_t event_count;
+
+  bool cancelled;  // whether the last run was cancelled
+  Data::JobProgress run_progress;
+
+  bool buildUnmixing();
+
+ public:
+  void setMatrix(const Data::SpilloverMatrix& matrix);
+  void setOptions(const SpreadingSimulation::Options& options);
+
+  bool run(const Data::JobToken& token = Data::JobToken(), std::function<void(double)> report = nullptr);
+  bool isCancelled() const;
+  double progress() const;
+
+  bool isEmpty() const;
+  std::size_t fluorophoreCount() const;
+  std::size_t eventCount() const;
+  const QString& fluorophore(std::size_t fluorophore) const;
+  double spreading(std::size_t stained, std::size_t fluorophore) const;
+
+  QString toCSV() const;
+};
+
+}  // namespace Data
+
+#endif  // DATA_SIMULATION_H
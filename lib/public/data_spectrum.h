@@ -30,7 +30,9 @@
 ** Struct for Spectrum meta data
 **
 ** :class: Data::Polygon
-** QPolygonF curve container
+** A view on a uniform grid curve in the (shared) spectrum storage, plus a
+** QPolygonF container for the scaled (plotting) curve. A curve can carry a
+** cumulative integral table, which makes integral() O(1)
 **
 ** :class: Data::Spectrum
 ** Container for excitation and emission curves (Data::Polygon) and ID
@@ -50,7 +52,9 @@
 #include <QRectF>
 #include <QString>
 #include <QStringList>
-#include <functional>
+#include <QTransform>
+#include <memory>
+#include <vector>
 
 #include "data_global.h"
 
@@ -67,7 +71,7 @@ class DATALIB_EXPORT Meta {
 class DATALIB_EXPORT Polygon {
  public:
   Polygon();
-  Polygon(double x_min, double x_max, double y_min, double y_max, QPolygonF curve);
+  Polygon(std::shared_ptr<const void> owner, double start, double step, const float* y, int size, const float* cumulative = nullptr);
   Polygon(const Polygon& other);             // Non default - forces deepcopy of QPolygonF
   Polygon& operator=(const Polygon& other);  // Non default - forces deepcopy of QPolygonF
   Polygon(Polygon&& other) = default;
@@ -75,33 +79,35 @@ class DATALIB_EXPORT Polygon {
   ~Polygon() = default;
 
   friend QDebug operator<<(QDebug stream, const Polygon& object) {
-    return stream << "Data::Polygon{" << object.x_min << "-" << object.x_max << ":" << object.curve[0] << "-"
-                  << object.curve[object.curve.size() - 1] << "}";
+    return stream << "Data::Polygon{" << object.x_min << "-" << object.x_max << ":" << object.source_size << "}";
   };
 
   bool empty() const;
+  int size() const;
   double intensityAt(double wavelength, double cutoff = 0.0) const;
+  void intensityAt(const double* wavelengths, double* intensities, std::size_t count, double cutoff = 0.0) const;
   double intensityAtIter(double wavelength, double cutoff = 0.0) const;
   double intensityMax() const;
+  double integral(double wavelength_min, double wavelength_max) const;
 
   const QColor& color() const;
   void setColor();
   void setColor(double wavelength);
   void setColor(QColor color);
   static QColor visibleSpectrum(const double wavelength);
+  static void resample(const float* x, const float* y, int size, std::vector<float>& grid, double& start, double& step);
+  static void cumulate(const float* y, int size, double step, float* cumulative);
 
   QPolygonF& polygon();
+  const QPolygonF& polygon() const;
 
   bool contains(const QPointF& point, double line_width) const;
-  bool contains(const QPointF& point, double line_width, std::function<double(double)> scale_x) const;
 
   // Polygon scaling/moving - note: the cache is supposed to keep unmodified originals
-  void scale(const Polygon& base, const QRectF& size, const double xg_start, const double xg_end, const double yg_start,
-             const double yg_end, const double intensity = 1.0);
-  void scale(const Polygon& base, const QRectF& size, std::function<double(double)> scale_x, std::function<double(double, double)> scale_y,
-             const double intensity = 1.0);
+  void scale(const Polygon& base, const QRectF& size, const QTransform& transform, const double intensity = 1.0);
   void copyCurve(const Polygon& base);
   void closeCurve(const QRectF& size);
+  void decimate(double origin, double width);
 
  private:
   double x_min;  // in wavelength (nm)
@@ -109,6 +115,19 @@ class DATALIB_EXPORT Polygon {
   double y_min;  // in intensity (%)
   double y_max;  // in intensity (%)
   QColor curve_color;
+
+  // Source curve, a view on the (shared) spectrum storage. The curve is on a uniform grid: x[i] = start + i * step
+  std::shared_ptr<const void> source_owner;  // keeps the storage (arena/mapped file) alive
+  double source_start;                       // in wavelength (nm)
+  double source_step;                        // in wavelength (nm)
+  double source_step_inverse;
+  const float* source_y;           // in intensity (%)
+  const float* source_cumulative;  // (optional) cumulative integral of y, in intensity (%) * wavelength (nm)
+  int source_size;
+
+  double cumulativeAt(double wavelength) const;
+
+  // Scaled curve, only build for plotting
   QPolygonF curve;
 };
 
@@ -141,6 +160,12 @@ class DATALIB_EXPORT Spectrum {
 
   qreal excitationAt(double wavelength, double cutoff = 0.0) const;
   qreal emissionAt(double wavelength, double cutoff = 0.0) const;
+  void excitationAt(const double* wavelengths, double* intensities, std::size_t count, double cutoff = 0.0) const;
+  void emissionAt(const double* wavelengths, double* intensities, std::size_t count, double cutoff = 0.0) const;
+  static void excitationMatrix(const std::vector<const Data::Spectrum*>& spectra, const double* wavelengths, std::size_t count,
+                               double* intensities, double cutoff = 0.0);
+  static void emissionMatrix(const std::vector<const Data::Spectrum*>& spectra, const double* wavelengths, std::size_t count,
+                             double* intensities, double cutoff = 0.0);
   double excitationMax() const;
   double emissionMax() const;
 
@@ -223,6 +248,12 @@ class DATALIB_EXPORT CacheSpectrum {
 
   double excitationAt(double wavelength) const;
   double emissionAt(double wavelength) const;
+  void excitationAt(const double* wavelengths, double* intensities, std::size_t count) const;
+  void emissionAt(const double* wavelengths, double* intensities, std::size_t count) const;
+  static void excitationMatrix(const std::vector<const Data::CacheSpectrum*>& spectra, const double* wavelengths, std::size_t count,
+                               double* intensities);
+  static void emissionMatrix(const std::vector<const Data::CacheSpectrum*>& spectra, const double* wavelengths, std::size_t count,
+                             double* intensities);
 };
 
 }  // namespace Data
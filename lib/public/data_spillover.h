@@ -0,0 +1,122 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_spillover.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** The spillover (detector brightness) matrix of an instrument
+**
+** :class: Data::SpilloverMatrix
+** Builds a detector for every filter of every laserline of an instrument.
+** The signal of a fluorophore in a detector is the summed excitation
+** efficiency of the laserline's lasers multiplied by the fraction of the
+** emission that passes the detector's filter. The spillover matrix is the
+** signal normalized to the brightest (primary) detector of a fluorophore.
+** Both matrices are stored row-major as [fluorophore][detector].
+** The matrices can be kept up-to-date incrementally: sync() only calculates
+** the rows of new fluorophores, and setLasers() only the detectors of the
+** laserline whose lasers changed.
+**
+***************************************************************************/
+
+#ifndef DATA_SPILLOVER_H
+#define DATA_SPILLOVER_H
+
+#include <QString>
+#include <QStringList>
+#include <utility>
+#include <vector>
+
+#include "data_global.h"
+#include "data_instruments.h"
+#include "data_spectrum.h"
+
+namespace Data {
+
+class DATALIB_EXPORT SpilloverMatrix {
+ public:
+  SpilloverMatrix();
+  SpilloverMatrix(const SpilloverMatrix&) = default;
+  SpilloverMatrix& operator=(const SpilloverMatrix&) = default;
+  SpilloverMatrix(SpilloverMatrix&&) = default;
+  SpilloverMatrix& operator=(SpilloverMatrix&&) = default;
+  ~SpilloverMatrix() = default;
+
+  enum Mode { Signal, Spillover };
+
+  struct Detector {
+    QString name;
+    std::size_t laserline;     // index of the laserline in the instrument's optics
+    std::size_t filter;        // index of the filter in the laserline's filters
+    std::size_t laser_offset;  // index of the first laser in laser_wavelengths
+    std::size_t laser_count;
+    double wavelength_min;  // in nm, of the filter window
+    double wavelength_max;  // in nm, of the filter window
+  };
+
+ private:
+  std::vector<SpilloverMatrix::Detector> matrix_detectors;
+  std::vector<std::vector<double>> laserline_wavelengths;  // the lasers of every laserline of the instrument
+  std::vector<double> laser_wavelengths;                   // the lasers of all detectors, in detector order
+
+  QStringList matrix_ids;
+  QStringList matrix_fluorophores;
+  std::vector<double> matrix_signal;
+  std::vector<double> matrix_spillover;
+  std::vector<std::size_t> matrix_primary;
+
+ public:
+  void setInstrument(const Data::Instrument& instrument);
+  void calculate(const std::vector<const Data::Spectrum*>& spectra, const QStringList& names);
+  void calculate(const std::vector<const Data::CacheSpectrum*>& spectra, const QStringList& names);
+  void calculateSignal(const Data::Spectrum& spectrum, double* signal) const;
+  void sync(const std::vector<const Data::Spectrum*>& spectra, const QStringList& names);
+  bool setLasers(std::size_t laserline, const std::vector<double>& wavelengths, const std::vector<const Data::Spectrum*>& spectra);
+  void clear();
+
+  bool isEmpty() const;
+  std::size_t fluorophoreCount() const;
+  std::size_t detectorCount() const;
+
+  const QString& id(std::size_t fluorophore) const;
+  const QString& fluorophore(std::size_t fluorophore) const;
+  const SpilloverMatrix::Detector& detector(std::size_t detector) const;
+  std::pair<std::size_t, std::size_t> detectorRange(std::size_t laserline) const;
+  double signal(std::size_t fluorophore, std::size_t detector) const;
+  double spillover(std::size_t fluorophore, std::size_t detector) const;
+  double value(SpilloverMatrix::Mode mode, std::size_t fluorophore, std::size_t detector) const;
+  std::size_t primaryDetector(std::size_t fluorophore) const;
+
+  QString toCSV(SpilloverMatrix::Mode mode) const;
+
+ private:
+  void buildLasers();
+  void setNames(const std::vector<const Data::Spectrum*>& spectra, const QStringList& names);
+  void normalizeRow(std::size_t fluorophore);
+  void calculateSignal(const Data::Spectrum& spectrum, double* excitation, double* signal, std::size_t begin, std::size_t end) const;
+  static QString detectorName(const Data::LaserLine& laserline, const Data::Filter& filter);
+};
+
+}  // namespace Data
+
+#endif  // DATA_SPILLOVER_H
@@ -71,6 +71,7 @@ class DATALIB_EXPORT StyleBuilder {
   std::vector<StyleID> getStyleIDs(const Data::Factory& data) const;
 
   void loadStyle(const Data::Factory& data, const QString& style_id);
+  bool readStyle(const Data::Factory& data, const QString& style_id);
   void buildStyleSheet();
   void buildStyleSheet(const QFontMetrics& metrics);
 
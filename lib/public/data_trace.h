@@ -0,0 +1,94 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** data_trace.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** Scoped tracing, exported as Chrome/Perfetto trace events
+**
+** :macro: DATA_TRACE_SCOPE(name)
+** Records the duration of the enclosing scope. name has to be a string
+** literal, only the pointer is stored.
+**
+** :macro: DATA_TRACE_COUNTER(name, value)
+** Records the value of a counter at this moment.
+**
+** :macro: DATA_TRACE_THREAD(name)
+** Names the calling thread in the trace.
+**
+** The macros only record if the build defines DATA_TRACE (cmake option
+** FLUOR_TRACE), otherwise they compile to nothing. Every thread records
+** into its own ring buffer of the last 65536 events, a single writer per
+** buffer so recording takes no locks.
+**
+** :function: Data::Trace::save
+** Writes the recorded events of all threads as Chrome trace event json,
+** viewable in chrome://tracing or ui.perfetto.dev.
+**
+***************************************************************************/
+
+#ifndef DATA_TRACE_H
+#define DATA_TRACE_H
+
+#include <QString>
+#include <cstdint>
+
+#include "data_global.h"
+
+namespace Data {
+namespace Trace {
+
+class DATALIB_EXPORT Scope {
+ public:
+  explicit Scope(const char* name);
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+  Scope(Scope&&) = delete;
+  Scope& operator=(Scope&&) = delete;
+  ~Scope();
+
+ private:
+  const char* scope_name;
+  std::int64_t scope_begin;  // in ns since the start of the trace
+};
+
+DATALIB_EXPORT void counter(const char* name, double value);
+DATALIB_EXPORT void setThreadName(const QString& name);
+DATALIB_EXPORT bool save(const QString& path);
+
+}  // namespace Trace
+}  // namespace Data
+
+#ifdef DATA_TRACE
+#define DATA_TRACE_JOIN_(a, b) a##b
+#define DATA_TRACE_JOIN(a, b) DATA_TRACE_JOIN_(a, b)
+#define DATA_TRACE_SCOPE(name) const Data::Trace::Scope DATA_TRACE_JOIN(data_trace_scope_, __LINE__)(name)
+#define DATA_TRACE_COUNTER(name, value) Data::Trace::counter(name, static_cast<double>(value))
+#define DATA_TRACE_THREAD(name) Data::Trace::setThreadName(name)
+#else
+#define DATA_TRACE_SCOPE(name) static_cast<void>(0)
+#define DATA_TRACE_COUNTER(name, value) static_cast<void>(0)
+#define DATA_TRACE_THREAD(name) static_cast<void>(0)
+#endif
+
+#endif  // DATA_TRACE_H
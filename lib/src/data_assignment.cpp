@@ -0,0 +1,357 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_assignment.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+
+namespace Data {
+
+const std::size_t AssignmentSolver::none;
+
+/*
+Constructor: constructs a solver without fluorophores and detectors
+*/
+AssignmentSolver::AssignmentSolver()
+    : solver_detectors(),
+      solver_options(),
+      row_ids(),
+      row_spectra(),
+      row_cost(),
+      column_capacity(0),
+      potential_row(),
+      potential_column(1, 0.0),
+      column_row(1, AssignmentSolver::none),
+      row_column(),
+      phase_minimum(),
+      phase_way(),
+      phase_used() {}
+
+/*
+Sets the instrument, the detectors to assign to. Rebuilds the costs and re-solves the assignment.
+  :param instrument: the instrument
+*/
+void AssignmentSolver::setInstrument(const Data::Instrument& instrument) {
+  this->solver_detectors.setInstrument(instrument);
+  this->rebuild();
+}
+
+/*
+Sets the cost options. Rebuilds the costs and re-solves the assignment.
+  :param options: the options
+*/
+void AssignmentSolver::setOptions(const AssignmentSolver::Options& options) {
+  this->solver_options = options;
+  this->rebuild();
+}
+
+/*
+Synchronizes the fluorophores to the spectra. Removed fluorophores cause a single re-solve, added fluorophores are
+solved incrementally.
+  :param spectra: the spectra to assign
+*/
+void AssignmentSolver::sync(const std::vector<const Data::Spectrum*>& spectra) {
+  std::unordered_set<QString> ids;
+  for (const Data::Spectrum* spectrum : spectra) {
+    ids.insert(spectrum->id());
+  }
+
+  // Remove all stale rows before solving once
+  bool removed = false;
+  for (std::size_t row = this->row_ids.size(); row > 0; --row) {
+    if (ids.find(this->row_ids[static_cast<int>(row - 1)]) == ids.end()) {
+      this->eraseRow(row - 1);
+      removed = true;
+    }
+  }
+  if (removed) {
+    this->solve();
+  }
+
+  for (const Data::Spectrum* spectrum : spectra) {
+    this->add(*spectrum);
+  }
+}
+
+/*
+Adds a fluorophore, runs a single augmenting phase of the Hungarian algorithm: O(rows * columns).
+If the fluorophore is already added, nothing happens.
+  :param spectrum: the fluorophore's spectrum
+*/
+void AssignmentSolver::add(const Data::Spectrum& spectrum) {
+  if (this->row_ids.contains(spectrum.id())) {
+    return;
+  }
+
+  std::size_t detector_count = this->detectorCount();
+  std::size_t row = this->row_spectra.size();
+
+  this->row_ids.append(spectrum.id());
+  this->row_spectra.push_back(spectrum);
+  this->row_cost.resize(this->row_cost.size() + detector_count);
+  this->buildCost(spectrum, this->row_cost.data() + row * detector_count);
+  this->potential_row.push_back(0.0);
+  this->row_column.push_back(AssignmentSolver::none);
+
+  // Every row needs a dummy column to be able to stay unassigned, growing the columns invalidates the potentials
+  if (this->row_spectra.size() > this->column_capacity) {
+    this->column_capacity = std::max<std::size_t>(16, this->column_capacity * 2);
+    this->solve();
+    return;
+  }
+
+  this->solveRow(row);
+}
+
+/*
+Removes a fluorophore and re-solves the assignment: O(rows^2 * columns).
+  :param id: the fluorophore's spectrum id
+*/
+void AssignmentSolver::remove(const QString& id) {
+  int index = this->row_ids.indexOf(id);
+  if (index < 0) {
+    return;
+  }
+
+  this->eraseRow(static_cast<std::size_t>(index));
+  this->solve();
+}
+
+/*
+Removes all fluorophores, keeps the detectors
+*/
+void AssignmentSolver::clear() {
+  this->row_ids.clear();
+  this->row_spectra.clear();
+  this->row_cost.clear();
+  this->potential_row.clear();
+  this->row_column.clear();
+  this->column_capacity = 0;
+  this->solve();
+}
+
+/*
+Getter for the amount of fluorophores
+*/
+std::size_t AssignmentSolver::fluorophoreCount() const { return this->row_spectra.size(); }
+
+/*
+Getter for the amount of detectors
+*/
+std::size_t AssignmentSolver::detectorCount() const { return this->solver_detectors.detectorCount(); }
+
+/*
+Getter for a fluorophore's spectrum id
+  :param fluorophore: the fluorophore index
+*/
+const QString& AssignmentSolver::fluorophore(std::size_t fluorophore) const { return this->row_ids.at(static_cast<int>(fluorophore)); }
+
+/*
+Getter for a detector
+  :param detector: the detector index
+*/
+const Data::SpilloverMatrix::Detector& AssignmentSolver::detector(std::size_t detector) const {
+  return this->solver_detectors.detector(detector);
+}
+
+/*
+Getter for the detector a fluorophore is assigned to
+  :param fluorophore: the fluorophore index
+  :returns: the detector index, or none if unassigned
+*/
+std::size_t AssignmentSolver::assignment(std::size_t fluorophore) const {
+  std::size_t column = this->row_column[fluorophore];
+  return column < this->detectorCount() ? column : AssignmentSolver::none;
+}
+
+/*
+Getter for the detector a fluorophore is assigned to
+  :param id: the fluorophore's spectrum id
+  :returns: the detector index, or none if unassigned or unknown
+*/
+std::size_t AssignmentSolver::assignment(const QString& id) const {
+  int index = this->row_ids.indexOf(id);
+  if (index < 0) {
+    return AssignmentSolver::none;
+  }
+  return this->assignment(static_cast<std::size_t>(index));
+}
+
+/*
+Getter for the cost of assigning a fluorophore to a detector
+  :param fluorophore: the fluorophore index
+  :param detector: the detector index
+  :returns: the cost, negative for a usable pairing
+*/
+double AssignmentSolver::cost(std::size_t fluorophore, std::size_t detector) const {
+  return this->row_cost[fluorophore * this->detectorCount() + detector];
+}
+
+/*
+Getter for the total cost of the assignment
+*/
+double AssignmentSolver::totalCost() const {
+  double total = 0.0;
+  for (std::size_t row = 0; row < this->row_column.size(); ++row) {
+    total += this->columnCost(row, this->row_column[row]);
+  }
+  return total;
+}
+
+/*
+Getter for the amount of columns, the detectors followed by the dummy (unassigned) columns
+*/
+std::size_t AssignmentSolver::columnCount() const { return this->detectorCount() + this->column_capacity; }
+
+/*
+Getter for the cost of a row/column pairing, dummy columns cost 0.0
+*/
+double AssignmentSolver::columnCost(std::size_t row, std::size_t column) const {
+  std::size_t detector_count = this->detectorCount();
+  if (column >= detector_count) {
+    return 0.0;
+  }
+  return this->row_cost[row * detector_count + column];
+}
+
+/*
+Builds the detector costs of a spectrum. The cost is the negative signal, weakened by the fraction of the
+signal that spills into the other detectors. Pairings that are not better than leaving the fluorophore
+unassigned get a positive cost, so a dummy column is always preferred.
+  :param spectrum: the spectrum
+  :param cost: (return) buffer of atleast detectorCount() values
+*/
+void AssignmentSolver::buildCost(const Data::Spectrum& spectrum, double* cost) const {
+  std::size_t detector_count = this->detectorCount();
+  std::vector<double> signal(detector_count);
+  this->solver_detectors.calculateSignal(spectrum, signal.data());
+
+  double signal_total = 0.0;
+  for (double value : signal) {
+    signal_total += value;
+  }
+
+  for (std::size_t j = 0; j < detector_count; ++j) {
+    cost[j] = 1.0;
+    if (signal_total <= 0.0 || signal[j] < this->solver_options.signal_minimum) {
+      continue;
+    }
+
+    double spillover = 1.0 - signal[j] / signal_total;
+    double value = -signal[j] * (1.0 - this->solver_options.spillover_weight * spillover);
+    if (value < 0.0) {
+      cost[j] = value;
+    }
+  }
+}
+
+/*
+Rebuilds all costs for the current detectors/options and re-solves the assignment
+*/
+void AssignmentSolver::rebuild() {
+  std::size_t detector_count = this->detectorCount();
+  this->row_cost.assign(this->row_spectra.size() * detector_count, 0.0);
+  for (std::size_t row = 0; row < this->row_spectra.size(); ++row) {
+    this->buildCost(this->row_spectra[row], this->row_cost.data() + row * detector_count);
+  }
+  this->solve();
+}
+
+/*
+Removes a row without re-solving, the assignment is invalid until solve() is called
+  :param row: the row index
+*/
+void AssignmentSolver::eraseRow(std::size_t row) {
+  std::size_t detector_count = this->detectorCount();
+  auto cost_begin = this->row_cost.begin() + static_cast<std::ptrdiff_t>(row * detector_count);
+
+  this->row_ids.removeAt(static_cast<int>(row));
+  this->row_spectra.erase(this->row_spectra.begin() + static_cast<std::ptrdiff_t>(row));
+  this->row_cost.erase(cost_begin, cost_begin + static_cast<std::ptrdiff_t>(detector_count));
+  this->potential_row.erase(this->potential_row.begin() + static_cast<std::ptrdiff_t>(row));
+  this->row_column.erase(this->row_column.begin() + static_cast<std::ptrdiff_t>(row));
+}
+
+/*
+Solves the assignment from scratch, one augmenting phase per row: O(rows^2 * columns).
+A 50x50 problem (with 64 dummy columns) takes well below a millisecond.
+*/
+void AssignmentSolver::solve() {
+  std::size_t columns = this->columnCount();
+  this->potential_row.assign(this->row_spectra.size(), 0.0);
+  this->potential_column.assign(columns + 1, 0.0);
+  this->column_row.assign(columns + 1, AssignmentSolver::none);
+  this->row_column.assign(this->row_spectra.size(), AssignmentSolver::none);
+
+  for (std::size_t row = 0; row < this->row_spectra.size(); ++row) {
+    this->solveRow(row);
+  }
+}
+
+/*
+A single augmenting phase of the Hungarian algorithm. Assigns the row by finding the shortest augmenting path in the
+reduced costs, and updates the potentials so the reduced costs of all assigned pairs stay zero.
+Requires all previous rows to be assigned, and a free column to exist.
+  :param row: the (unassigned) row to add to the assignment
+*/
+void AssignmentSolver::solveRow(std::size_t row) {
+  const std::size_t columns = this->columnCount();
+  const std::size_t sentinel = columns;
+
+  this->phase_minimum.assign(columns + 1, std::numeric_limits<double>::max());
+  this->phase_way.assign(columns + 1, sentinel);
+  this->phase_used.assign(columns + 1, 0);
+
+  // The sentinel column holds the new row at the root of the augmenting path
+  this->column_row[sentinel] = row;
+  std::size_t column = sentinel;
+  do {
+    this->phase_used[column] = 1;
+    std::size_t row_current = this->column_row[column];
+    double delta = std::numeric_limits<double>::max();
+    std::size_t column_next = sentinel;
+
+    for (std::size_t j = 0; j < columns; ++j) {
+      if (this->phase_used[j]) {
+        continue;
+      }
+      double reduced = this->columnCost(row_current, j) - this->potential_row[row_current] - this->potential_column[j];
+      if (reduced < this->phase_minimum[j]) {
+        this->phase_minimum[j] = reduced;
+        this->phase_way[j] = column;
+      }
+      if (this->phase_minimum[j] < delta) {
+        delta = this->phase_minimum[j];
+        column_next = j;
+      }
+    }
+
+    for (std::size_t j = 0; j <= columns; ++j) {
+      if (this->phase_used[j]) {
+        this->potential_row[this->column_row[j]] += delta;
+        this->potential_column[j] -= delta;
+      } else {
+        this->phase_minimum[j] -= delta;
+      }
+    }
+    column = column_next;
+  } while (this->column_row[column] != AssignmentSolver::none);
+
+  // Augment along the path
+  do {
+    std::size_t column_previous = this->phase_way[column];
+    this->column_row[column] = this->column_row[column_previous];
+    this->row_column[this->column_row[column]] = column;
+    column = column_previous;
+  } while (column != sentinel);
+  this->column_row[sentinel] = AssignmentSolver::none;
+}
+
+}  // namespace Data
@@ -0,0 +1,540 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+
+#include "data_catalogue.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <unordered_set>
+#include <utility>
+
+#include "data_fcs.h"
+#include "data_parallel.h"
+
+namespace Data {
+
+const std::size_t FCSCatalogue::none;
+
+namespace {
+
+/*
+Lower case letters and digits of a name, to compare names independent of punctuation and case
+*/
+QString simplifyName(const QString& name) {
+  QString simple;
+  for (const QChar& character : name) {
+    if (character.isLetterOrNumber()) {
+      simple.append(character.toLower());
+    }
+  }
+  return simple;
+}
+
+/*
+Simplified detector name without the area/height/width suffix, "BV421-A" -> "bv421"
+*/
+QString simplifyDetector(const QString& name) {
+  QString detector = name.trimmed();
+  if (detector.size() > 2 && detector.at(detector.size() - 2) == QChar('-')) {
+    QChar suffix = detector.at(detector.size() - 1).toUpper();
+    if (suffix == QChar('A') || suffix == QChar('H') || suffix == QChar('W')) {
+      detector.chop(2);
+    }
+  }
+  return simplifyName(detector);
+}
+
+/*
+Appends all (comma separated) positive wavelengths of a keyword value
+*/
+void appendWavelengths(const QString& value, std::vector<double>& wavelengths) {
+  for (const QString& part : value.split(',')) {
+    bool ok = false;
+    double wavelength = part.trimmed().toDouble(&ok);
+    if (ok && wavelength > 0.0) {
+      wavelengths.push_back(wavelength);
+    }
+  }
+}
+
+/*
+Sorts the wavelengths and removes (near) duplicates
+*/
+void uniqueWavelengths(std::vector<double>& wavelengths) {
+  std::sort(wavelengths.begin(), wavelengths.end());
+  wavelengths.erase(
+      std::unique(wavelengths.begin(), wavelengths.end(), [](double left, double right) { return std::abs(left - right) < 1.0; }),
+      wavelengths.end());
+}
+
+/*
+F1 like overlap of two sorted sets: 2 * matches / (size_a + size_b)
+*/
+double overlap(std::size_t matches, std::size_t size_a, std::size_t size_b) {
+  if (matches == 0) {
+    return 0.0;
+  }
+  return (2.0 * static_cast<double>(matches)) / static_cast<double>(size_a + size_b);
+}
+
+/*
+The content of a single directory
+*/
+struct Listing {
+  std::vector<FCSCatalogue::Entry> files;
+  QStringList directories;
+};
+
+}  // namespace
+
+/*
+Constructor: constructs an empty catalogue without instruments and folders
+*/
+FCSCatalogue::FCSCatalogue()
+    : profiles(), catalogue_folders(), catalogue_entries(), scanned_count(0), cancelled(false), scan_progress() {}
+
+/*
+Sets the instruments to match the files to, does not rematch the catalogue until the next scan
+  :param reader: the instrument reader, all its instruments are loaded
+*/
+void FCSCatalogue::setInstruments(const Data::InstrumentReader& reader) {
+  this->profiles.clear();
+
+  for (const Data::InstrumentID& instrument_id : reader.getInstruments()) {
+    Data::Instrument instrument = reader.getInstrument(instrument_id.id);
+    if (!instrument.isValid()) {
+      continue;
+    }
+
+    FCSCatalogue::Profile profile;
+    profile.id = instrument.id();
+    profile.name = simplifyName(instrument.name());
+    for (const Data::LaserLine& laserline : instrument.optics()) {
+      for (const Data::Laser& laser : laserline.lasers()) {
+        profile.lasers.push_back(laser.wavelength());
+      }
+      for (const Data::Filter& filter : laserline.filters()) {
+        QString name = simplifyDetector(filter.name());
+        if (!name.isEmpty()) {
+          profile.detectors.append(name);
+        }
+      }
+    }
+    profile.detectors.sort();
+    profile.detectors.removeDuplicates();
+    uniqueWavelengths(profile.lasers);
+
+    this->profiles.push_back(std::move(profile));
+  }
+}
+
+/*
+Sets the root folders to index, all subfolders are included
+  :param folders: the folders
+*/
+void FCSCatalogue::setFolders(const QStringList& folders) {
+  this->catalogue_folders.clear();
+  for (const QString& folder : folders) {
+    QString path = QDir::cleanPath(QDir(folder).absolutePath());
+    if (!this->catalogue_folders.contains(path)) {
+      this->catalogue_folders.append(path);
+    }
+  }
+}
+
+/*
+Getter for the root folders
+*/
+const QStringList& FCSCatalogue::folders() const { return this->catalogue_folders; }
+
+/*
+Loads a catalogue from json, replaces the folders and entries
+  :param path: the file path
+  :returns: whether the catalogue could be loaded
+*/
+bool FCSCatalogue::load(const QString& path) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  QJsonParseError error;
+  QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+  if (error.error != QJsonParseError::NoError || !document.isObject()) {
+    qWarning() << "FCSCatalogue::load: cannot parse" << path << ":" << error.errorString();
+    return false;
+  }
+
+  QJsonObject root = document.object();
+  if (root.value("version").toInt() != 1) {
+    qWarning() << "FCSCatalogue::load: unsupported version in" << path;
+    return false;
+  }
+
+  QStringList folders;
+  for (const QJsonValue& folder : root.value("folders").toArray()) {
+    folders.append(folder.toString());
+  }
+  this->setFolders(folders);
+
+  this->catalogue_entries.clear();
+  for (const QJsonValue& value : root.value("files").toArray()) {
+    QJsonObject object = value.toObject();
+
+    FCSCatalogue::Entry entry;
+    entry.path = object.value("path").toString();
+    entry.size = static_cast<qint64>(object.value("size").toDouble());
+    entry.modified = static_cast<qint64>(object.value("modified").toDouble());
+    entry.valid = object.value("valid").toBool();
+    entry.cytometer = object.value("cytometer").toString();
+    entry.event_count = static_cast<std::size_t>(object.value("events").toDouble());
+    for (const QJsonValue& detector : object.value("detectors").toArray()) {
+      entry.detectors.append(detector.toString());
+    }
+    for (const QJsonValue& label : object.value("labels").toArray()) {
+      entry.labels.append(label.toString());
+    }
+    for (const QJsonValue& laser : object.value("lasers").toArray()) {
+      entry.lasers.push_back(laser.toDouble());
+    }
+    entry.instrument = object.value("instrument").toString();
+    entry.score = object.value("score").toDouble();
+
+    if (!entry.path.isEmpty()) {
+      this->catalogue_entries.push_back(std::move(entry));
+    }
+  }
+
+  std::sort(this->catalogue_entries.begin(), this->catalogue_entries.end(),
+            [](const FCSCatalogue::Entry& left, const FCSCatalogue::Entry& right) { return left.path < right.path; });
+  this->scanned_count = 0;
+  return true;
+}
+
+/*
+Saves the catalogue as json
+  :param path: the file path
+  :returns: whether the catalogue could be written
+*/
+bool FCSCatalogue::save(const QString& path) const {
+  QJsonArray folders;
+  for (const QString& folder : this->catalogue_folders) {
+    folders.append(folder);
+  }
+
+  QJsonArray files;
+  for (const FCSCatalogue::Entry& entry : this->catalogue_entries) {
+    QJsonArray lasers;
+    for (double laser : entry.lasers) {
+      lasers.append(laser);
+    }
+
+    QJsonObject object;
+    object.insert("path", entry.path);
+    object.insert("size", static_cast<double>(entry.size));
+    object.insert("modified", static_cast<double>(entry.modified));
+    object.insert("valid", entry.valid);
+    object.insert("cytometer", entry.cytometer);
+    object.insert("events", static_cast<double>(entry.event_count));
+    object.insert("detectors", QJsonArray::fromStringList(entry.detectors));
+    object.insert("labels", QJsonArray::fromStringList(entry.labels));
+    object.insert("lasers", lasers);
+    object.insert("instrument", entry.instrument);
+    object.insert("score", entry.score);
+    files.append(object);
+  }
+
+  QJsonObject root;
+  root.insert("version", 1);
+  root.insert("folders", folders);
+  root.insert("files", files);
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qWarning() << "FCSCatalogue::save: cannot open" << path;
+    return false;
+  }
+  file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+  if (!file.commit()) {
+    qWarning() << "FCSCatalogue::save: cannot write" << path;
+    return false;
+  }
+  return true;
+}
+
+/*
+Reads the header of the entry's file and fills in the acquisition properties
+  :param entry: the entry, the path has to be set
+*/
+void FCSCatalogue::readEntry(FCSCatalogue::Entry& entry) {
+  const QRegularExpression laser_keyword("^LASER\\s*\\d+\\s*_?WAVELENGTH$");
+
+  entry.valid = false;
+  entry.cytometer.clear();
+  entry.event_count = 0;
+  entry.detectors.clear();
+  entry.labels.clear();
+  entry.lasers.clear();
+
+  Data::FCSReader reader;
+  if (!reader.readHeader(entry.path)) {
+    return;
+  }
+
+  entry.valid = true;
+  entry.cytometer = reader.cytometer();
+  entry.event_count = reader.eventCount();
+  for (std::size_t i = 0; i < reader.parameterCount(); ++i) {
+    const Data::FCSReader::Parameter& parameter = reader.parameter(i);
+    entry.detectors.append(parameter.name);
+    entry.labels.append(parameter.label);
+
+    appendWavelengths(reader.keyword(QString("$P%1L").arg(i + 1)), entry.lasers);
+  }
+
+  // Some vendors store the lasers as separate keywords
+  for (const std::pair<const QString, QString>& keyword : reader.keywords()) {
+    if (laser_keyword.match(keyword.first).hasMatch()) {
+      appendWavelengths(keyword.second, entry.lasers);
+    }
+  }
+  uniqueWavelengths(entry.lasers);
+}
+
+/*
+Matches the entry to the most similar instrument. The score is a weighted sum of the detector overlap (0.7),
+the laser overlap (0.2, within 3 nm), and whether the cytometer and instrument names contain each other (0.1)
+  :param entry: the entry, the instrument and score are set
+*/
+void FCSCatalogue::matchInstrument(FCSCatalogue::Entry& entry) const {
+  entry.instrument.clear();
+  entry.score = 0.0;
+  if (!entry.valid) {
+    return;
+  }
+
+  QStringList detectors;
+  for (const QString& detector : entry.detectors) {
+    QString name = simplifyDetector(detector);
+    if (!name.isEmpty()) {
+      detectors.append(name);
+    }
+  }
+  detectors.sort();
+  detectors.removeDuplicates();
+
+  const QString cytometer = simplifyName(entry.cytometer);
+
+  for (const FCSCatalogue::Profile& profile : this->profiles) {
+    std::size_t detector_matches = 0;
+    for (const QString& detector : detectors) {
+      if (std::binary_search(profile.detectors.cbegin(), profile.detectors.cend(), detector)) {
+        ++detector_matches;
+      }
+    }
+
+    std::size_t laser_matches = 0;
+    for (double laser : entry.lasers) {
+      auto near = [laser](double other) { return std::abs(laser - other) <= 3.0; };
+      if (std::find_if(profile.lasers.cbegin(), profile.lasers.cend(), near) != profile.lasers.cend()) {
+        ++laser_matches;
+      }
+    }
+
+    bool name_match = !cytometer.isEmpty() && !profile.name.isEmpty() &&
+                      (cytometer.contains(profile.name) || profile.name.contains(cytometer));
+
+    std::size_t detector_count = static_cast<std::size_t>(detectors.size());
+    double score = 0.7 * overlap(detector_matches, detector_count, static_cast<std::size_t>(profile.detectors.size()));
+    score += 0.2 * overlap(laser_matches, entry.lasers.size(), profile.lasers.size());
+    score += name_match ? 0.1 : 0.0;
+
+    if (score > entry.score) {
+      entry.score = score;
+      entry.instrument = profile.id;
+    }
+  }
+}
+
+/*
+(Re)scans the folders, blocks until finished or cancelled. The folders are walked level by level, every level is listed
+in parallel. Files with an unchanged size and modification time are taken from the current catalogue, the headers of
+the other files are read in parallel. Afterwards all files are (re)matched to the instruments.
+  :param token: the cancellation token, polled between the directories and files
+  :param report: (optional) called upon every progress change with the progress (0.0-1.0), from the worker threads
+  :returns: whether the scan finished, false if cancelled; a cancelled scan keeps the previous catalogue
+*/
+bool FCSCatalogue::scan(const Data::JobToken& token, std::function<void(double)> report) {
+  this->cancelled = false;
+  this->scan_progress.reset(std::move(report));
+
+  // Walk the folders, the first 10% of progress
+  std::vector<FCSCatalogue::Entry> entries;
+  std::unordered_set<QString> visited;
+  QStringList level;
+  for (const QString& folder : this->catalogue_folders) {
+    if (QFileInfo(folder).isDir()) {
+      level.append(folder);
+    }
+  }
+
+  while (!level.isEmpty()) {
+    std::vector<Listing> listings(static_cast<std::size_t>(level.size()));
+
+    Data::parallelFor(listings.size(), [&](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i) {
+        if (token.isCancelled()) {
+          return;
+        }
+        QDir directory(level.at(static_cast<int>(i)));
+
+        for (const QFileInfo& info : directory.entryInfoList({"*.fcs", "*.FCS"}, QDir::Files)) {
+          FCSCatalogue::Entry entry;
+          entry.path = info.absoluteFilePath();
+          entry.size = info.size();
+          entry.modified = info.lastModified().toMSecsSinceEpoch();
+          entry.valid = false;
+          entry.event_count = 0;
+          entry.score = 0.0;
+          listings[i].files.push_back(std::move(entry));
+        }
+        for (const QFileInfo& info : directory.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks)) {
+          listings[i].directories.append(info.absoluteFilePath());
+        }
+      }
+    });
+
+    if (token.isCancelled()) {
+      this->cancelled = true;
+      return false;
+    }
+
+    for (const QString& directory : level) {
+      visited.insert(directory);
+    }
+    level.clear();
+    for (Listing& listing : listings) {
+      std::move(listing.files.begin(), listing.files.end(), std::back_inserter(entries));
+      for (const QString& directory : listing.directories) {
+        if (visited.insert(directory).second) {
+          level.append(directory);
+        }
+      }
+    }
+
+    // The depth is unknown, so the walk progress approaches but never reaches 10%
+    this->scan_progress.set(100 - (100 - this->scan_progress.permille()) / 2);
+  }
+
+  // Case insensitive filesystems can list a file twice
+  auto path_less = [](const FCSCatalogue::Entry& left, const FCSCatalogue::Entry& right) { return left.path < right.path; };
+  std::sort(entries.begin(), entries.end(), path_less);
+  entries.erase(std::unique(entries.begin(), entries.end(),
+                            [](const FCSCatalogue::Entry& left, const FCSCatalogue::Entry& right) { return left.path == right.path; }),
+                entries.end());
+
+  // Reuse the unchanged entries
+  std::vector<std::size_t> changed;
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    std::size_t previous = this->find(entries[i].path);
+    if (previous != FCSCatalogue::none && this->catalogue_entries[previous].size == entries[i].size &&
+        this->catalogue_entries[previous].modified == entries[i].modified) {
+      entries[i] = this->catalogue_entries[previous];
+    } else {
+      changed.push_back(i);
+    }
+  }
+
+  // Read the headers of the new and changed files, the remaining 90% of progress
+  std::atomic<std::size_t> read_count(0);
+  Data::parallelFor(
+      changed.size(),
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          if (token.isCancelled()) {
+            return;
+          }
+          FCSCatalogue::readEntry(entries[changed[i]]);
+
+          std::size_t count = ++read_count;
+          this->scan_progress.set(static_cast<int>(100 + (count * 900) / changed.size()));
+        }
+      },
+      16);
+
+  if (token.isCancelled()) {
+    this->cancelled = true;
+    return false;
+  }
+
+  // Rematch all entries, the instruments could have changed since the last scan
+  Data::parallelFor(entries.size(), [&](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      this->matchInstrument(entries[i]);
+    }
+  });
+
+  this->catalogue_entries = std::move(entries);
+  this->scanned_count = changed.size();
+  this->scan_progress.set(1000);
+  return true;
+}
+
+/*
+Whether the last scan was cancelled
+*/
+bool FCSCatalogue::isCancelled() const { return this->cancelled; }
+
+/*
+Getter for the progress of a running scan, can be called from any thread
+  :returns: progress (0.0-1.0)
+*/
+double FCSCatalogue::progress() const { return this->scan_progress.value(); }
+
+/*
+Getter for the amount of cataloged files
+*/
+std::size_t FCSCatalogue::entryCount() const { return this->catalogue_entries.size(); }
+
+/*
+Getter for a cataloged file, the entries are sorted by path
+  :param index: entry index
+*/
+const FCSCatalogue::Entry& FCSCatalogue::entry(std::size_t index) const { return this->catalogue_entries[index]; }
+
+/*
+Finds a file in the catalogue
+  :param path: the absolute file path
+  :returns: the entry index, or FCSCatalogue::none if not cataloged
+*/
+std::size_t FCSCatalogue::find(const QString& path) const {
+  auto match = std::lower_bound(this->catalogue_entries.cbegin(), this->catalogue_entries.cend(), path,
+                                [](const FCSCatalogue::Entry& entry, const QString& value) { return entry.path < value; });
+  if (match == this->catalogue_entries.cend() || match->path != path) {
+    return FCSCatalogue::none;
+  }
+  return static_cast<std::size_t>(match - this->catalogue_entries.cbegin());
+}
+
+/*
+Getter for the amount of files whose header was read by the last scan
+*/
+std::size_t FCSCatalogue::scannedCount() const { return this->scanned_count; }
+
+}  // namespace Data
@@ -0,0 +1,1032 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_database.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "data_parallel.h"
+
+namespace Data {
+
+namespace {
+const char database_magic[8] = {'F', 'L', 'U', 'O', 'R', 'S', 'D', 'B'};
+
+/*
+JSON scanning helpers used by SpectrumIndex. Each helper returns the position directly after the scanned token,
+or -1 if the data is malformed.
+*/
+bool isWhitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+qint64 skipWhitespace(const char* data, qint64 size, qint64 pos) {
+  while (pos < size && isWhitespace(data[pos])) {
+    ++pos;
+  }
+  return pos;
+}
+
+// pos has to point to the opening quote
+qint64 skipString(const char* data, qint64 size, qint64 pos) {
+  ++pos;
+  while (pos < size) {
+    if (data[pos] == '\\') {
+      pos += 2;
+    } else if (data[pos] == '"') {
+      return pos + 1;
+    } else {
+      ++pos;
+    }
+  }
+  return -1;
+}
+
+qint64 skipValue(const char* data, qint64 size, qint64 pos) {
+  if (pos >= size) {
+    return -1;
+  }
+
+  if (data[pos] == '"') {
+    return skipString(data, size, pos);
+  }
+
+  if (data[pos] == '{' || data[pos] == '[') {
+    int depth = 0;
+    while (pos < size) {
+      char c = data[pos];
+      if (c == '"') {
+        pos = skipString(data, size, pos);
+        if (pos < 0) {
+          return -1;
+        }
+        continue;
+      }
+      if (c == '{' || c == '[') {
+        ++depth;
+      } else if (c == '}' || c == ']') {
+        --depth;
+        if (depth == 0) {
+          return pos + 1;
+        }
+      }
+      ++pos;
+    }
+    return -1;
+  }
+
+  // Number or literal
+  while (pos < size && !isWhitespace(data[pos]) && data[pos] != ',' && data[pos] != '}' && data[pos] != ']') {
+    ++pos;
+  }
+  return pos;
+}
+
+// Decodes a JSON string token (including quotes), escapes are rare so are handed to the Qt parser
+QString readString(const char* data, qint64 begin, qint64 end) {
+  const char* token = data + begin;
+  int length = static_cast<int>(end - begin);
+  if (std::memchr(token, '\\', static_cast<std::size_t>(length)) == nullptr) {
+    return QString::fromUtf8(token + 1, length - 2);
+  }
+  QByteArray array = "[" + QByteArray(token, length) + "]";
+  return QJsonDocument::fromJson(array).array().at(0).toString();
+}
+}  // namespace
+
+/*
+Constructor: Construct an (invalid) unmapped database
+*/
+SpectrumDatabase::SpectrumDatabase()
+    : file(),
+      file_image(),
+      file_data(nullptr),
+      file_size(0),
+      header(nullptr),
+      records(nullptr),
+      strings(nullptr),
+      floats(nullptr),
+      record_index() {}
+
+/*
+Destructor: unmaps the database file
+*/
+SpectrumDatabase::~SpectrumDatabase() { this->close(); }
+
+/*
+Memory maps the compiled database. The database is only opened if it was compiled from the current source file.
+  :param path_compiled: path to the compiled database file
+  :param path_source: path to the fluorophores.json file the database should be compiled from
+  :returns: whether the database could be opened, if false the database is stale or corrupt and should be recompiled
+*/
+bool SpectrumDatabase::open(const QString& path_compiled, const QString& path_source) {
+  this->close();
+
+  QFileInfo info_compiled(path_compiled);
+  QFileInfo info_source(path_source);
+  if (!info_compiled.exists() || !info_source.exists()) {
+    return false;
+  }
+
+  if (static_cast<std::size_t>(info_compiled.size()) < sizeof(SpectrumDatabase::Header)) {
+    qWarning() << "Data::SpectrumDatabase::open: compiled database is truncated";
+    return false;
+  }
+
+  this->file.setFileName(path_compiled);
+  if (!this->file.open(QIODevice::ReadOnly)) {
+    qWarning() << "Data::SpectrumDatabase::open: cannot open" << path_compiled;
+    return false;
+  }
+
+  uchar* data = this->file.map(0, this->file.size());
+  if (data == nullptr) {
+    qWarning() << "Data::SpectrumDatabase::open: cannot map" << path_compiled << ":" << this->file.errorString();
+    this->close();
+    return false;
+  }
+
+  if (!this->attach(data, static_cast<quint64>(this->file.size()))) {
+    qWarning() << "Data::SpectrumDatabase::open: compiled database is invalid, falling back to the source file";
+    this->close();
+    return false;
+  }
+
+  // Stale check, the compiled database is only valid for the exact source file it was compiled from
+  if (this->header->source_size != info_source.size() || this->header->source_modified != info_source.lastModified().toMSecsSinceEpoch()) {
+    this->close();
+    return false;
+  }
+
+  return true;
+}
+
+/*
+Decodes all enabled fluorophores of fluorophores.json (in parallel) into an in-memory database image.
+The image has the layout of the compiled database file, so all curves end up in one contiguous float block.
+  :param path_source: path to fluorophores.json
+  :returns: whether decoding succeeded, if false the file should be parsed as a QJsonDocument for error reporting
+*/
+bool SpectrumDatabase::decode(const QString& path_source) {
+  this->close();
+
+  QFile source(path_source);
+  if (!source.open(QIODevice::ReadOnly)) {
+    qWarning() << "Data::SpectrumDatabase::decode: cannot open" << path_source;
+    return false;
+  }
+  QFileInfo info_source(source);
+  QByteArray data = source.readAll();
+  source.close();
+
+  // Find the fluorophore objects
+  Data::SpectrumIndex index;
+  if (!index.scan(data.constData(), data.size())) {
+    qWarning() << "Data::SpectrumDatabase::decode: cannot index" << path_source;
+    return false;
+  }
+
+  std::vector<SpectrumDatabase::Decoded> decoded;
+  SpectrumDatabase::decodeEntries(index, data.constData(), decoded);
+
+  this->file_image = SpectrumDatabase::build(decoded, info_source.size(), info_source.lastModified().toMSecsSinceEpoch());
+  if (!this->attach(this->file_image.data(), this->file_image.size())) {
+    qWarning() << "Data::SpectrumDatabase::decode: invalid database image";
+    this->close();
+    return false;
+  }
+
+  return true;
+}
+
+/*
+Unmaps and closes the database file or releases the in-memory image
+*/
+void SpectrumDatabase::close() {
+  if (this->file.isOpen()) {
+    if (this->file_data != nullptr) {
+      this->file.unmap(const_cast<uchar*>(this->file_data));
+    }
+    this->file.close();
+  }
+  std::vector<uchar>().swap(this->file_image);
+  this->file_data = nullptr;
+  this->file_size = 0;
+  this->header = nullptr;
+  this->records = nullptr;
+  this->strings = nullptr;
+  this->floats = nullptr;
+  std::unordered_map<QString, std::size_t>().swap(this->record_index);
+}
+
+/*
+Returns whether the database is mapped or decoded and usable
+  :returns: validity
+*/
+bool SpectrumDatabase::isValid() const { return this->header != nullptr; }
+
+/*
+Returns whether the database is a mapped compiled file (and not an in-memory image)
+  :returns: whether the database is mapped
+*/
+bool SpectrumDatabase::isMapped() const { return this->header != nullptr && this->file.isOpen(); }
+
+/*
+Writes the database to a file. Only useful for an in-memory (decoded) database, a mapped database is written already.
+  :param path_compiled: path to write the compiled database to
+  :returns: whether writing succeeded
+*/
+bool SpectrumDatabase::write(const QString& path_compiled) const {
+  if (this->header == nullptr) {
+    return false;
+  }
+  return SpectrumDatabase::write(this->file_data, this->file_size, path_compiled);
+}
+
+/*
+Returns the amount of records (enabled fluorophores) in the database
+  :returns: record count
+*/
+std::size_t SpectrumDatabase::size() const {
+  if (this->header == nullptr) {
+    return 0;
+  }
+  return this->header->record_count;
+}
+
+/*
+Looks up the record index of a fluorophore
+  :param id: fluorophore id
+  :returns: the record index, or size() if the id is not in the database
+*/
+std::size_t SpectrumDatabase::find(const QString& id) const {
+  auto record = this->record_index.find(id);
+  if (record == this->record_index.end()) {
+    return this->size();
+  }
+  return record->second;
+}
+
+/*
+Getter for the fluorophore id of a record
+  :param record: record index
+  :returns: fluorophore id
+*/
+QString SpectrumDatabase::id(std::size_t record) const {
+  const SpectrumDatabase::Record& data = this->records[record];
+  return QString::fromUtf8(this->strings + data.id_offset, static_cast<int>(data.id_size));
+}
+
+/*
+Getter for the fluorophore names of a record
+  :param record: record index
+  :returns: the names
+*/
+QStringList SpectrumDatabase::names(std::size_t record) const {
+  const SpectrumDatabase::Record& data = this->records[record];
+  if (data.names_size == 0) {
+    return QStringList();
+  }
+  return QString::fromUtf8(this->strings + data.names_offset, static_cast<int>(data.names_size)).split(QChar('\0'));
+}
+
+/*
+Getter for the absorption flag of a record
+  :param record: record index
+  :returns: whether the excitation curve is an absorption curve
+*/
+bool SpectrumDatabase::absorptionFlag(std::size_t record) const {
+  return (this->records[record].flags & SpectrumDatabase::Absorption) != 0;
+}
+
+/*
+Getter for the meta data of a record
+  :param record: record index
+  :returns: meta data
+*/
+Data::Meta SpectrumDatabase::meta(std::size_t record) const {
+  const SpectrumDatabase::Record& data = this->records[record];
+  return Data::Meta(data.excitation_max, data.emission_max);
+}
+
+/*
+Builds the excitation curve of a record
+  :param record: record index
+  :returns: excitation curve
+*/
+Data::Polygon SpectrumDatabase::excitation(std::size_t record) const {
+  const SpectrumDatabase::Record& data = this->records[record];
+  return this->toPolygon(data.excitation_offset, data.excitation_size, data.excitation_start, data.excitation_step, nullptr);
+}
+
+/*
+Builds the emission curve of a record
+  :param record: record index
+  :returns: emission curve
+*/
+Data::Polygon SpectrumDatabase::emission(std::size_t record) const {
+  const SpectrumDatabase::Record& data = this->records[record];
+  return this->toPolygon(data.emission_offset, data.emission_size, data.emission_start, data.emission_step,
+                         this->floats + data.emission_cumulative_offset);
+}
+
+/*
+Builds a Data::Polygon view on a float block. The polygon keeps the database alive, so the database has
+to be owned by a std::shared_ptr.
+  :param offset: offset (in floats) of the intensity block
+  :param size: amount of points
+  :param start: wavelength of the first grid point
+  :param step: wavelength step of the grid
+  :param cumulative: (optional) the cumulative integral block of the curve
+  :returns: the curve
+*/
+Data::Polygon SpectrumDatabase::toPolygon(quint32 offset, quint32 size, double start, double step, const float* cumulative) const {
+  if (size == 0) {
+    qWarning() << "Data::SpectrumDatabase::toPolygon: curve is empty. Default Data::Polygon is returned";
+    return Data::Polygon();
+  }
+
+  return Data::Polygon(this->shared_from_this(), start, step, this->floats + offset, static_cast<int>(size), cumulative);
+}
+
+/*
+Attaches the database to a (mapped or in-memory) image and verifies it
+  :param data: the image
+  :param size: size of the image in bytes
+  :returns: whether the image is a valid database
+*/
+bool SpectrumDatabase::attach(const uchar* data, quint64 size) {
+  if (size < sizeof(SpectrumDatabase::Header)) {
+    return false;
+  }
+
+  this->file_data = data;
+  this->file_size = size;
+  this->header = reinterpret_cast<const SpectrumDatabase::Header*>(this->file_data);
+  if (!this->verify()) {
+    this->header = nullptr;
+    return false;
+  }
+
+  this->records = reinterpret_cast<const SpectrumDatabase::Record*>(this->file_data + this->header->offset_records);
+  this->strings = reinterpret_cast<const char*>(this->file_data + this->header->offset_strings);
+  this->floats = reinterpret_cast<const float*>(this->file_data + this->header->offset_floats);
+
+  // Build id lookup
+  this->record_index.reserve(this->header->record_count);
+  for (std::size_t i = 0; i < this->header->record_count; ++i) {
+    this->record_index[this->id(i)] = i;
+  }
+
+  return true;
+}
+
+/*
+Verifies that the header and all records point inside the image
+  :returns: whether the image is valid
+*/
+bool SpectrumDatabase::verify() const {
+  if (std::memcmp(this->header->magic, database_magic, sizeof(database_magic)) != 0) {
+    return false;
+  }
+  if (this->header->version != SpectrumDatabase::version) {
+    return false;
+  }
+
+  quint64 file_size = this->file_size;
+  if (this->header->file_size != file_size) {
+    return false;
+  }
+
+  quint64 records_end = this->header->offset_records + static_cast<quint64>(this->header->record_count) * sizeof(SpectrumDatabase::Record);
+  if (this->header->offset_records < sizeof(SpectrumDatabase::Header) || records_end > this->header->offset_strings ||
+      this->header->offset_strings > this->header->offset_floats || this->header->offset_floats > file_size) {
+    return false;
+  }
+  if (this->header->offset_records % 16 != 0 || this->header->offset_floats % 16 != 0) {
+    return false;
+  }
+
+  quint64 strings_size = this->header->offset_floats - this->header->offset_strings;
+  quint64 floats_size = (file_size - this->header->offset_floats) / sizeof(float);
+
+  const SpectrumDatabase::Record* data = reinterpret_cast<const SpectrumDatabase::Record*>(this->file_data + this->header->offset_records);
+  for (std::size_t i = 0; i < this->header->record_count; ++i) {
+    if (static_cast<quint64>(data[i].id_offset) + data[i].id_size > strings_size ||
+        static_cast<quint64>(data[i].names_offset) + data[i].names_size > strings_size) {
+      return false;
+    }
+    if (static_cast<quint64>(data[i].excitation_offset) + data[i].excitation_size > floats_size ||
+        static_cast<quint64>(data[i].emission_offset) + data[i].emission_size > floats_size ||
+        static_cast<quint64>(data[i].emission_cumulative_offset) + data[i].emission_size > floats_size) {
+      return false;
+    }
+    if (!(data[i].excitation_step > 0.0) || !(data[i].emission_step > 0.0)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/*
+(Static) Compiles a fluorophores.json document into a binary spectrum database.
+  :param document: the parsed fluorophores.json
+  :param path_source: path to fluorophores.json, the database is tagged with its size and modification time
+  :param path_compiled: path to write the compiled database to
+  :returns: whether compiling succeeded
+*/
+bool SpectrumDatabase::compile(const QJsonDocument& document, const QString& path_source, const QString& path_compiled) {
+  if (document.isNull() || !document.isObject()) {
+    qWarning() << "Data::SpectrumDatabase::compile: invalid source document, cannot compile";
+    return false;
+  }
+
+  QFileInfo info_source(path_source);
+  if (!info_source.exists()) {
+    qWarning() << "Data::SpectrumDatabase::compile: source file" << path_source << "does not exist";
+    return false;
+  }
+
+  QJsonObject data = document.object();
+
+  std::vector<SpectrumDatabase::Decoded> decoded;
+  decoded.reserve(static_cast<std::size_t>(data.size()));
+
+  for (const QString& id : data.keys()) {
+    QJsonObject fluorophore = data[id].toObject();
+
+    // Disabled fluorophores are not compiled
+    if (!fluorophore["enable"].toBool(true)) {
+      continue;
+    }
+
+    decoded.emplace_back();
+    SpectrumDatabase::decodeObject(fluorophore, decoded.back());
+    decoded.back().id = id;
+  }
+
+  std::vector<uchar> image = SpectrumDatabase::build(decoded, info_source.size(), info_source.lastModified().toMSecsSinceEpoch());
+  return SpectrumDatabase::write(image.data(), image.size(), path_compiled);
+}
+
+/*
+(Static) Compiles the indexed fluorophores.json into a binary spectrum database. Only the indexed fluorophore objects are parsed,
+the source is never parsed as a full QJsonDocument.
+  :param index: the index of fluorophores.json
+  :param path_compiled: path to write the compiled database to
+  :returns: whether compiling succeeded, fails if the source has changed since indexing
+*/
+bool SpectrumDatabase::compile(const Data::SpectrumIndex& index, const QString& path_compiled) {
+  if (!index.isValid()) {
+    qWarning() << "Data::SpectrumDatabase::compile: invalid source index, cannot compile";
+    return false;
+  }
+
+  QFile source(index.path());
+  if (!source.open(QIODevice::ReadOnly)) {
+    qWarning() << "Data::SpectrumDatabase::compile: cannot open" << index.path();
+    return false;
+  }
+
+  QFileInfo info_source(source);
+  if (info_source.size() != index.sourceSize() || info_source.lastModified().toMSecsSinceEpoch() != index.sourceModified()) {
+    qWarning() << "Data::SpectrumDatabase::compile:" << index.path() << "has changed since indexing, cannot compile";
+    return false;
+  }
+
+  uchar* data = source.map(0, index.sourceSize());
+  if (data == nullptr) {
+    qWarning() << "Data::SpectrumDatabase::compile: cannot map" << index.path() << ":" << source.errorString();
+    return false;
+  }
+
+  std::vector<SpectrumDatabase::Decoded> decoded;
+  SpectrumDatabase::decodeEntries(index, reinterpret_cast<const char*>(data), decoded);
+  source.unmap(data);
+
+  std::vector<uchar> image = SpectrumDatabase::build(decoded, index.sourceSize(), index.sourceModified());
+  return SpectrumDatabase::write(image.data(), image.size(), path_compiled);
+}
+
+/*
+(Static) Decodes the fluorophore objects of an index in parallel, each object is independent
+  :param index: the index of the source data
+  :param data: the source data, as indexed
+  :param decoded: (return) the decoded fluorophores, in index order
+*/
+void SpectrumDatabase::decodeEntries(const Data::SpectrumIndex& index, const char* data, std::vector<SpectrumDatabase::Decoded>& decoded) {
+  decoded.clear();
+  decoded.resize(index.size());
+  Data::parallelFor(index.size(), [&index, data, &decoded](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      const Data::SpectrumIndex::Entry& entry = index.entry(i);
+      QByteArray object = QByteArray::fromRawData(data + entry.begin, static_cast<int>(entry.end - entry.begin));
+      SpectrumDatabase::decodeObject(QJsonDocument::fromJson(object).object(), decoded[i]);
+      decoded[i].id = entry.id;
+    }
+  });
+}
+
+/*
+(Static) Decodes a fluorophore object into its curves and meta data. The id is not part of the object and is not set.
+  :param object: the fluorophore object
+  :param decoded: (return) the decoded fluorophore
+*/
+void SpectrumDatabase::decodeObject(const QJsonObject& object, SpectrumDatabase::Decoded& decoded) {
+  decoded.names.clear();
+  for (const QJsonValue& name : object.value("names").toArray()) {
+    decoded.names.append(name.toString());
+  }
+
+  // Resamples a curve onto its uniform grid, only the intensities are stored
+  auto decode_curve = [](const QJsonArray& wavelength, const QJsonArray& intensity, std::vector<float>& curve, double& start,
+                         double& step) {
+    curve.clear();
+    start = 0.0;
+    step = 1.0;
+    if (wavelength.size() != intensity.size() || wavelength.empty()) {
+      return;
+    }
+    std::vector<float> points;
+    points.reserve(static_cast<std::size_t>(wavelength.size()) * 2);
+    for (const QJsonValue& value : wavelength) {
+      points.push_back(static_cast<float>(value.toDouble()));
+    }
+    for (const QJsonValue& value : intensity) {
+      points.push_back(static_cast<float>(value.toDouble()));
+    }
+    int size = wavelength.size();
+    Data::Polygon::resample(points.data(), points.data() + size, size, curve, start, step);
+  };
+
+  // Excitation, with absorption fallback
+  decoded.flags = 0;
+  decoded.excitation_max = object.value("excitation_max").toDouble(-1);
+  QJsonArray excitation_wavelength = object.value("excitation_wavelength").toArray();
+  QJsonArray excitation_intensity = object.value("excitation_intensity").toArray();
+  if (excitation_wavelength.empty() || excitation_intensity.empty()) {
+    decoded.flags |= SpectrumDatabase::Absorption;
+    decoded.excitation_max = object.value("absorption_max").toDouble(-1);
+    excitation_wavelength = object.value("absorption_wavelength").toArray();
+    excitation_intensity = object.value("absorption_intensity").toArray();
+  }
+  decode_curve(excitation_wavelength, excitation_intensity, decoded.excitation, decoded.excitation_start, decoded.excitation_step);
+
+  decoded.emission_max = object.value("emission_max").toDouble(-1);
+  decode_curve(object.value("emission_wavelength").toArray(), object.value("emission_intensity").toArray(), decoded.emission,
+               decoded.emission_start, decoded.emission_step);
+
+  // Precompute the cumulative integral for O(1) filter integration
+  decoded.emission_cumulative.resize(decoded.emission.size());
+  Data::Polygon::cumulate(decoded.emission.data(), static_cast<int>(decoded.emission.size()), decoded.emission_step,
+                          decoded.emission_cumulative.data());
+}
+
+/*
+(Static) Builds a database image from decoded fluorophores.
+  :param decoded: the decoded fluorophores, in record order
+  :param source_size: the size of the source file
+  :param source_modified: the modification time (msecs since epoch) of the source file
+  :returns: the database image
+*/
+std::vector<uchar> SpectrumDatabase::build(const std::vector<SpectrumDatabase::Decoded>& decoded, qint64 source_size,
+                                           qint64 source_modified) {
+  std::vector<SpectrumDatabase::Record> records(decoded.size());
+  QByteArray strings;
+  quint64 floats_size = 0;
+
+  // Appends a curve to the float block, each curve starts 16 byte aligned
+  auto place_curve = [&floats_size](const std::vector<float>& curve, quint32& offset, quint32& size) {
+    offset = static_cast<quint32>(floats_size);
+    size = static_cast<quint32>(curve.size());
+    floats_size += SpectrumDatabase::align(curve.size() * sizeof(float)) / sizeof(float);
+  };
+
+  for (std::size_t i = 0; i < decoded.size(); ++i) {
+    SpectrumDatabase::Record& record = records[i];
+    std::memset(&record, 0, sizeof(SpectrumDatabase::Record));
+
+    QByteArray id_utf8 = decoded[i].id.toUtf8();
+    record.id_offset = static_cast<quint32>(strings.size());
+    record.id_size = static_cast<quint32>(id_utf8.size());
+    strings.append(id_utf8);
+
+    QByteArray names_utf8 = decoded[i].names.join(QChar('\0')).toUtf8();
+    record.names_offset = static_cast<quint32>(strings.size());
+    record.names_size = static_cast<quint32>(names_utf8.size());
+    strings.append(names_utf8);
+
+    place_curve(decoded[i].excitation, record.excitation_offset, record.excitation_size);
+    place_curve(decoded[i].emission, record.emission_offset, record.emission_size);
+    quint32 cumulative_size = 0;
+    place_curve(decoded[i].emission_cumulative, record.emission_cumulative_offset, cumulative_size);
+
+    record.excitation_start = decoded[i].excitation_start;
+    record.excitation_step = decoded[i].excitation_step;
+    record.emission_start = decoded[i].emission_start;
+    record.emission_step = decoded[i].emission_step;
+    record.excitation_max = decoded[i].excitation_max;
+    record.emission_max = decoded[i].emission_max;
+    record.flags = decoded[i].flags;
+  }
+
+  // Build the header
+  SpectrumDatabase::Header header;
+  std::memset(&header, 0, sizeof(SpectrumDatabase::Header));
+  std::memcpy(header.magic, database_magic, sizeof(database_magic));
+  header.version = SpectrumDatabase::version;
+  header.record_count = static_cast<quint32>(records.size());
+  header.source_size = source_size;
+  header.source_modified = source_modified;
+  header.offset_records = SpectrumDatabase::align(sizeof(SpectrumDatabase::Header));
+  header.offset_strings = SpectrumDatabase::align(header.offset_records + records.size() * sizeof(SpectrumDatabase::Record));
+  header.offset_floats = SpectrumDatabase::align(header.offset_strings + static_cast<quint64>(strings.size()));
+  header.file_size = header.offset_floats + floats_size * sizeof(float);
+
+  // Assemble the image
+  std::vector<uchar> image(header.file_size, 0);
+  uchar* image_data = image.data();
+  std::memcpy(image_data, &header, sizeof(SpectrumDatabase::Header));
+  if (!records.empty()) {
+    std::memcpy(image_data + header.offset_records, records.data(), records.size() * sizeof(SpectrumDatabase::Record));
+  }
+  std::memcpy(image_data + header.offset_strings, strings.constData(), static_cast<std::size_t>(strings.size()));
+
+  float* floats = reinterpret_cast<float*>(image_data + header.offset_floats);
+  for (std::size_t i = 0; i < decoded.size(); ++i) {
+    if (!decoded[i].excitation.empty()) {
+      std::memcpy(floats + records[i].excitation_offset, decoded[i].excitation.data(), decoded[i].excitation.size() * sizeof(float));
+    }
+    if (!decoded[i].emission.empty()) {
+      std::memcpy(floats + records[i].emission_offset, decoded[i].emission.data(), decoded[i].emission.size() * sizeof(float));
+    }
+    if (!decoded[i].emission_cumulative.empty()) {
+      std::memcpy(floats + records[i].emission_cumulative_offset, decoded[i].emission_cumulative.data(),
+                  decoded[i].emission_cumulative.size() * sizeof(float));
+    }
+  }
+
+  return image;
+}
+
+/*
+(Static) Writes a database image to file. The file is written atomically, so a running instance never maps a half-written database.
+  :param data: the image
+  :param size: the image size in bytes
+  :param path_compiled: path to write the compiled database to
+  :returns: whether writing succeeded
+*/
+bool SpectrumDatabase::write(const uchar* data, quint64 size, const QString& path_compiled) {
+  QSaveFile file(path_compiled);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qWarning() << "Data::SpectrumDatabase::write: cannot write" << path_compiled << ":" << file.errorString();
+    return false;
+  }
+  if (file.write(reinterpret_cast<const char*>(data), static_cast<qint64>(size)) != static_cast<qint64>(size)) {
+    qWarning() << "Data::SpectrumDatabase::write: writing" << path_compiled << "failed:" << file.errorString();
+    file.cancelWriting();
+    return false;
+  }
+  return file.commit();
+}
+
+/*
+(Static) Rounds a file offset up to the 16 byte section alignment
+  :param value: offset
+  :returns: aligned offset
+*/
+quint64 SpectrumDatabase::align(quint64 value) { return (value + 15) & ~static_cast<quint64>(15); }
+
+/* ############################################################################################################## */
+
+/*
+Constructor: Construct an empty (invalid) index
+*/
+SpectrumIndex::SpectrumIndex()
+    : path_source(), source_size(0), source_modified(0), entries(), entry_index(), cache_mutex(), cache_spectra() {}
+
+/*
+Scans the fluorophores.json source file and builds the byte-offset index. The file is only mapped during the scan.
+  :param path_source: path to fluorophores.json
+  :returns: whether the file could be indexed, if false the file should be parsed as a QJsonDocument for error reporting
+*/
+bool SpectrumIndex::open(const QString& path_source) {
+  this->close();
+
+  QFile file(path_source);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << "Data::SpectrumIndex::open: cannot open" << path_source;
+    return false;
+  }
+
+  qint64 size = file.size();
+  if (size <= 0) {
+    return false;
+  }
+
+  uchar* data = file.map(0, size);
+  if (data == nullptr) {
+    qWarning() << "Data::SpectrumIndex::open: cannot map" << path_source << ":" << file.errorString();
+    return false;
+  }
+
+  bool valid = this->scan(reinterpret_cast<const char*>(data), size);
+  file.unmap(data);
+
+  if (!valid) {
+    qWarning() << "Data::SpectrumIndex::open: cannot index" << path_source;
+    this->close();
+    return false;
+  }
+
+  QFileInfo info(file);
+  this->path_source = path_source;
+  this->source_size = size;
+  this->source_modified = info.lastModified().toMSecsSinceEpoch();
+
+  return true;
+}
+
+/*
+Clears the index
+*/
+void SpectrumIndex::close() {
+  this->path_source.clear();
+  this->source_size = 0;
+  this->source_modified = 0;
+  std::vector<SpectrumIndex::Entry>().swap(this->entries);
+  std::unordered_map<QString, std::size_t>().swap(this->entry_index);
+
+  std::lock_guard<std::mutex> lock(this->cache_mutex);
+  std::unordered_map<std::size_t, std::pair<Data::Spectrum, Data::Meta>>().swap(this->cache_spectra);
+}
+
+/*
+Returns whether the index is usable
+  :returns: validity
+*/
+bool SpectrumIndex::isValid() const { return !this->path_source.isEmpty(); }
+
+/*
+Getter for the path of the indexed source file
+  :returns: path to fluorophores.json
+*/
+const QString& SpectrumIndex::path() const { return this->path_source; }
+
+/*
+Getter for the size of the source file at indexing
+  :returns: size in bytes
+*/
+qint64 SpectrumIndex::sourceSize() const { return this->source_size; }
+
+/*
+Getter for the modification time of the source file at indexing
+  :returns: modification time in milliseconds since epoch
+*/
+qint64 SpectrumIndex::sourceModified() const { return this->source_modified; }
+
+/*
+Returns the amount of (enabled) fluorophores in the index
+  :returns: entry count
+*/
+std::size_t SpectrumIndex::size() const { return this->entries.size(); }
+
+/*
+Looks up the entry index of a fluorophore
+  :param id: fluorophore id
+  :returns: the entry index, or size() if the id is not indexed
+*/
+std::size_t SpectrumIndex::find(const QString& id) const {
+  auto entry = this->entry_index.find(id);
+  if (entry == this->entry_index.end()) {
+    return this->size();
+  }
+  return entry->second;
+}
+
+/*
+Getter for the fluorophore id of an entry
+  :param entry: entry index
+  :returns: fluorophore id
+*/
+const QString& SpectrumIndex::id(std::size_t entry) const { return this->entries[entry].id; }
+
+/*
+Getter for the fluorophore names of an entry
+  :param entry: entry index
+  :returns: the names
+*/
+const QStringList& SpectrumIndex::names(std::size_t entry) const { return this->entries[entry].names; }
+
+/*
+Getter for an entry
+  :param index: entry index
+  :returns: the entry
+*/
+const SpectrumIndex::Entry& SpectrumIndex::entry(std::size_t index) const { return this->entries[index]; }
+
+/*
+Reads and parses the fluorophore object of an entry from the source file
+  :param entry: entry index
+  :returns: the fluorophore object, empty if the source could not be read or has changed since indexing
+*/
+QJsonObject SpectrumIndex::object(std::size_t entry) const {
+  const SpectrumIndex::Entry& data = this->entries[entry];
+
+  QFile file(this->path_source);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << "Data::SpectrumIndex::object: cannot open" << this->path_source;
+    return QJsonObject();
+  }
+
+  QFileInfo info(file);
+  if (info.size() != this->source_size || info.lastModified().toMSecsSinceEpoch() != this->source_modified) {
+    qWarning() << "Data::SpectrumIndex::object:" << this->path_source << "has changed since indexing, cannot read" << data.id;
+    return QJsonObject();
+  }
+
+  if (!file.seek(data.begin)) {
+    qWarning() << "Data::SpectrumIndex::object: cannot seek" << this->path_source;
+    return QJsonObject();
+  }
+
+  QJsonParseError error;
+  QJsonDocument document = QJsonDocument::fromJson(file.read(data.end - data.begin), &error);
+  if (error.error != QJsonParseError::NoError) {
+    qWarning() << "Data::SpectrumIndex::object: invalid fluorophore object" << data.id << ":" << error.errorString();
+    return QJsonObject();
+  }
+
+  return document.object();
+}
+
+/*
+Looks up the cached spectrum of an entry
+  :param entry: entry index
+  :param spectrum: (return) the cached spectrum, untouched if not cached
+  :param meta: (return) the cached meta data, untouched if not cached
+  :returns: whether the entry is cached
+*/
+bool SpectrumIndex::cached(std::size_t entry, Data::Spectrum& spectrum, Data::Meta& meta) const {
+  std::lock_guard<std::mutex> lock(this->cache_mutex);
+  auto cached = this->cache_spectra.find(entry);
+  if (cached == this->cache_spectra.end()) {
+    return false;
+  }
+  spectrum = cached->second.first;
+  meta = cached->second.second;
+  return true;
+}
+
+/*
+Caches the spectrum decoded from an entry, so the entry's object does not have to be parsed again
+  :param entry: entry index
+  :param spectrum: the decoded spectrum
+  :param meta: the decoded meta data
+*/
+void SpectrumIndex::cache(std::size_t entry, const Data::Spectrum& spectrum, const Data::Meta& meta) const {
+  std::lock_guard<std::mutex> lock(this->cache_mutex);
+  this->cache_spectra.emplace(entry, std::make_pair(spectrum, meta));
+}
+
+/*
+Streaming scan over the top-level fluorophores object. Only the 'names' and 'enable' fields are parsed,
+all other values (the spectra arrays) are skipped without decoding. Does not (re)set the source file.
+  :param data: the file data
+  :param size: the file size in bytes
+  :returns: whether scanning succeeded
+*/
+bool SpectrumIndex::scan(const char* data, qint64 size) {
+  std::vector<SpectrumIndex::Entry>().swap(this->entries);
+  std::unordered_map<QString, std::size_t>().swap(this->entry_index);
+
+  if (!this->scanObject(data, size)) {
+    std::vector<SpectrumIndex::Entry>().swap(this->entries);
+    return false;
+  }
+
+  // Order by id, equal to the QJsonObject key ordering
+  std::sort(this->entries.begin(), this->entries.end(),
+            [](const SpectrumIndex::Entry& left, const SpectrumIndex::Entry& right) { return left.id < right.id; });
+
+  this->entry_index.reserve(this->entries.size());
+  for (std::size_t i = 0; i < this->entries.size(); ++i) {
+    this->entry_index[this->entries[i].id] = i;
+  }
+
+  return true;
+}
+
+/*
+Scans the top-level object and adds all enabled fluorophore objects to the entries
+  :param data: the file data
+  :param size: the file size in bytes
+  :returns: whether scanning succeeded
+*/
+bool SpectrumIndex::scanObject(const char* data, qint64 size) {
+  qint64 pos = skipWhitespace(data, size, 0);
+  if (pos >= size || data[pos] != '{') {
+    return false;
+  }
+
+  pos = skipWhitespace(data, size, pos + 1);
+  if (pos < size && data[pos] == '}') {
+    return true;
+  }
+
+  while (pos < size) {
+    // Fluorophore id
+    if (data[pos] != '"') {
+      return false;
+    }
+    qint64 key_end = skipString(data, size, pos);
+    if (key_end < 0) {
+      return false;
+    }
+    QString id = readString(data, pos, key_end);
+
+    pos = skipWhitespace(data, size, key_end);
+    if (pos >= size || data[pos] != ':') {
+      return false;
+    }
+    pos = skipWhitespace(data, size, pos + 1);
+
+    qint64 value_end = skipValue(data, size, pos);
+    if (value_end < 0) {
+      return false;
+    }
+
+    // Non-object values are ignored, equal to the QJsonDocument parser returning an empty object
+    if (data[pos] == '{') {
+      SpectrumIndex::Entry entry{id, QStringList(), pos, value_end};
+      bool enable = true;
+
+      // Scan the fields of the fluorophore object
+      qint64 field = skipWhitespace(data, size, pos + 1);
+      while (field < value_end && data[field] == '"') {
+        qint64 field_key_end = skipString(data, size, field);
+        if (field_key_end < 0) {
+          return false;
+        }
+        QByteArray key = QByteArray::fromRawData(data + field + 1, static_cast<int>(field_key_end - field - 2));
+
+        qint64 field_value = skipWhitespace(data, size, field_key_end);
+        if (field_value >= value_end || data[field_value] != ':') {
+          return false;
+        }
+        field_value = skipWhitespace(data, size, field_value + 1);
+        qint64 field_value_end = skipValue(data, size, field_value);
+        if (field_value_end < 0) {
+          return false;
+        }
+
+        if (key == "names") {
+          QByteArray names = QByteArray::fromRawData(data + field_value, static_cast<int>(field_value_end - field_value));
+          for (const QJsonValue& name : QJsonDocument::fromJson(names).array()) {
+            entry.names.append(name.toString());
+          }
+        } else if (key == "enable") {
+          enable = QByteArray::fromRawData(data + field_value, static_cast<int>(field_value_end - field_value)) != "false";
+        }
+
+        field = skipWhitespace(data, size, field_value_end);
+        if (field < value_end && data[field] == ',') {
+          field = skipWhitespace(data, size, field + 1);
+        }
+      }
+
+      if (enable) {
+        this->entries.push_back(std::move(entry));
+      }
+    }
+
+    pos = skipWhitespace(data, size, value_end);
+    if (pos >= size) {
+      return false;
+    }
+    if (data[pos] == '}') {
+      return true;
+    }
+    if (data[pos] != ',') {
+      return false;
+    }
+    pos = skipWhitespace(data, size, pos + 1);
+  }
+
+  return false;
+}
+
+}  // namespace Data
@@ -0,0 +1,432 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_density.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "data_kernels.h"
+#include "data_parallel.h"
+
+namespace Data {
+
+namespace {
+
+// Resolution of the base grid, per axis
+const std::size_t base_resolution_density = 1024;
+const std::size_t base_resolution_histogram = 16384;
+
+// Events per kernel call, the bin indices stay in the L1 cache
+const std::size_t bin_block = 4096;
+
+// Events per binning thread, below this the threads cost more than they gain
+const std::size_t bin_grain = 262144;
+
+/*
+The overlap of a (small) base bin with the (larger) target bins. A base bin overlaps atmost two target bins.
+*/
+struct Overlap {
+  std::ptrdiff_t target;  // the first overlapped target bin, can be outside the target grid
+  float first;            // fraction of the base bin inside the first target bin
+  float second;           // fraction of the base bin inside the next target bin
+};
+
+/*
+Calculates the overlap of every base bin of an axis with the target bins
+  :param base_min: low edge of the base axis
+  :param base_width: width of a base bin
+  :param base_count: amount of base bins
+  :param target_min: low edge of the target axis
+  :param target_width: width of a target bin, atleast base_width
+  :returns: the overlaps
+*/
+std::vector<Overlap> axisOverlap(double base_min, double base_width, std::size_t base_count, double target_min, double target_width) {
+  std::vector<Overlap> overlaps(base_count);
+  double ratio = base_width / target_width;
+  for (std::size_t b = 0; b < base_count; ++b) {
+    double low = (base_min + static_cast<double>(b) * base_width - target_min) / target_width;
+    double high = low + ratio;
+    double target = std::floor(low);
+
+    Overlap& overlap = overlaps[b];
+    overlap.target = static_cast<std::ptrdiff_t>(target);
+    if (high <= target + 1.0) {
+      overlap.first = 1.0f;
+      overlap.second = 0.0f;
+    } else {
+      overlap.first = static_cast<float>((target + 1.0 - low) / ratio);
+      overlap.second = 1.0f - overlap.first;
+    }
+  }
+  return overlaps;
+}
+
+/*
+Finds the minimum and maximum of the finite values, in parallel
+  :param values: the values
+  :param minimum: (return) the minimum, 0.0 if there are no finite values
+  :param maximum: (return) the maximum, 1.0 if there are no finite values
+*/
+void finiteRange(const std::vector<float>& values, double& minimum, double& maximum) {
+  std::size_t slices = std::max<std::size_t>(1, std::min(Data::parallelThreads(), values.size() / bin_grain));
+  std::vector<float> minima(slices, std::numeric_limits<float>::infinity());
+  std::vector<float> maxima(slices, -std::numeric_limits<float>::infinity());
+
+  Data::parallelFor(slices, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t slice = begin; slice < end; ++slice) {
+      float low = std::numeric_limits<float>::infinity();
+      float high = -std::numeric_limits<float>::infinity();
+      std::size_t last = (values.size() * (slice + 1)) / slices;
+      for (std::size_t i = (values.size() * slice) / slices; i < last; ++i) {
+        // Comparisons with NaN are false, infinities are excluded explicitly
+        float value = values[i];
+        if (value < low && std::isfinite(value)) {
+          low = value;
+        }
+        if (value > high && std::isfinite(value)) {
+          high = value;
+        }
+      }
+      minima[slice] = low;
+      maxima[slice] = high;
+    }
+  });
+
+  float low = *std::min_element(minima.begin(), minima.end());
+  float high = *std::max_element(maxima.begin(), maxima.end());
+  if (low > high) {
+    minimum = 0.0;
+    maximum = 1.0;
+    return;
+  }
+
+  minimum = static_cast<double>(low);
+  maximum = static_cast<double>(high);
+  if (maximum - minimum <= 0.0) {
+    minimum -= 0.5;
+    maximum += 0.5;
+  }
+  // The bins are exclusive on the high edge, make sure the maximum is inside
+  maximum += (maximum - minimum) * 1e-5;
+}
+
+}  // namespace
+
+/*
+Constructor: constructs an empty grid
+*/
+DensityGrid::DensityGrid()
+    : events_x(nullptr),
+      events_y(nullptr),
+      extent_x_min(0.0),
+      extent_x_max(1.0),
+      extent_y_min(0.0),
+      extent_y_max(1.0),
+      base_columns(0),
+      base_rows(0),
+      base_counts(nullptr),
+      grid_x_min(0.0),
+      grid_x_max(0.0),
+      grid_y_min(0.0),
+      grid_y_max(0.0),
+      grid_columns(0),
+      grid_rows(0),
+      grid_counts(),
+      grid_maximum(0.0f),
+      grid_resampled(false) {}
+
+/*
+Bins the events into a grid. The events are divided over the threads, every thread counts into its own grid.
+  :param x_min: low edge of the first column
+  :param x_max: high edge of the last column
+  :param columns: amount of columns
+  :param y_min: low edge of the first row, ignored for a histogram
+  :param y_max: high edge of the last row, ignored for a histogram
+  :param rows: amount of rows, ignored for a histogram
+  :param counts: (return) the counts of the columns * rows bins
+*/
+void DensityGrid::binEvents(double x_min, double x_max, std::size_t columns, double y_min, double y_max, std::size_t rows,
+                            std::vector<std::uint32_t>& counts) const {
+  if (this->isHistogram()) {
+    rows = 1;
+  }
+  const std::size_t bins = columns * rows;
+  const std::size_t events = this->eventCount();
+  const float* x = this->events_x->data();
+  const float* y = this->events_y ? this->events_y->data() : nullptr;
+
+  // Every thread needs its own grid (with an additional bin for the events outside), limit their total memory to 64 MiB
+  std::size_t slices = std::min(Data::parallelThreads(), events / bin_grain);
+  slices = std::min(slices, (static_cast<std::size_t>(1) << 24) / (bins + 1));
+  slices = std::max<std::size_t>(1, slices);
+  std::vector<std::vector<std::uint32_t>> grids(slices);
+
+  Data::parallelFor(slices, [&](std::size_t begin, std::size_t end) {
+    std::uint32_t indices[bin_block];
+    for (std::size_t slice = begin; slice < end; ++slice) {
+      std::vector<std::uint32_t>& grid = grids[slice];
+      grid.assign(bins + 1, 0);
+
+      std::size_t last = (events * (slice + 1)) / slices;
+      for (std::size_t i = (events * slice) / slices; i < last; i += bin_block) {
+        std::size_t count = std::min(bin_block, last - i);
+        Data::Kernel::binIndices(x + i, y != nullptr ? y + i : nullptr, count, x_min, x_max, columns, y_min, y_max, rows, indices);
+        for (std::size_t j = 0; j < count; ++j) {
+          ++grid[indices[j]];
+        }
+      }
+    }
+  });
+
+  // Sum the thread grids, in parallel over the bins
+  counts.resize(bins);
+  Data::parallelFor(
+      bins,
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end; ++b) {
+          std::uint32_t count = 0;
+          for (const std::vector<std::uint32_t>& grid : grids) {
+            count += grid[b];
+          }
+          counts[b] = count;
+        }
+      },
+      16384);
+}
+
+/*
+Resamples the base grid into the current grid. The count of a base bin is divided over the grid bins it overlaps.
+*/
+void DensityGrid::resample() {
+  const double base_width_x = (this->extent_x_max - this->extent_x_min) / static_cast<double>(this->base_columns);
+  const double grid_width_x = (this->grid_x_max - this->grid_x_min) / static_cast<double>(this->grid_columns);
+  std::vector<Overlap> overlap_x = axisOverlap(this->extent_x_min, base_width_x, this->base_columns, this->grid_x_min, grid_width_x);
+
+  std::vector<Overlap> overlap_y;
+  if (this->isHistogram()) {
+    overlap_y.push_back(Overlap{0, 1.0f, 0.0f});
+  } else {
+    const double base_width_y = (this->extent_y_max - this->extent_y_min) / static_cast<double>(this->base_rows);
+    const double grid_width_y = (this->grid_y_max - this->grid_y_min) / static_cast<double>(this->grid_rows);
+    overlap_y = axisOverlap(this->extent_y_min, base_width_y, this->base_rows, this->grid_y_min, grid_width_y);
+  }
+
+  const std::ptrdiff_t columns = static_cast<std::ptrdiff_t>(this->grid_columns);
+  const std::ptrdiff_t rows = static_cast<std::ptrdiff_t>(this->grid_rows);
+
+  // First resample every base row along x
+  std::vector<float> resampled_x(this->base_rows * this->grid_columns, 0.0f);
+  Data::parallelFor(this->base_rows, [&](std::size_t begin, std::size_t end) {
+    for (std::size_t row = begin; row < end; ++row) {
+      const std::uint32_t* base = this->base_counts->data() + row * this->base_columns;
+      float* target = resampled_x.data() + row * this->grid_columns;
+      for (std::size_t b = 0; b < this->base_columns; ++b) {
+        if (base[b] == 0) {
+          continue;
+        }
+        const Overlap& overlap = overlap_x[b];
+        float count = static_cast<float>(base[b]);
+        if (overlap.target >= 0 && overlap.target < columns) {
+          target[overlap.target] += count * overlap.first;
+        }
+        if (overlap.second > 0.0f && overlap.target + 1 >= 0 && overlap.target + 1 < columns) {
+          target[overlap.target + 1] += count * overlap.second;
+        }
+      }
+    }
+  });
+
+  // Then divide the rows over the grid rows
+  this->grid_counts.assign(this->grid_rows * this->grid_columns, 0.0f);
+  for (std::size_t row = 0; row < this->base_rows; ++row) {
+    const Overlap& overlap = overlap_y[row];
+    const float* source = resampled_x.data() + row * this->grid_columns;
+    if (overlap.target >= 0 && overlap.target < rows) {
+      float* target = this->grid_counts.data() + static_cast<std::size_t>(overlap.target) * this->grid_columns;
+      for (std::size_t c = 0; c < this->grid_columns; ++c) {
+        target[c] += source[c] * overlap.first;
+      }
+    }
+    if (overlap.second > 0.0f && overlap.target + 1 >= 0 && overlap.target + 1 < rows) {
+      float* target = this->grid_counts.data() + static_cast<std::size_t>(overlap.target + 1) * this->grid_columns;
+      for (std::size_t c = 0; c < this->grid_columns; ++c) {
+        target[c] += source[c] * overlap.second;
+      }
+    }
+  }
+}
+
+/*
+Sets the events and bins them into the base grid. The event vectors are shared, not copied.
+  :param x: the x parameter of the events
+  :param y: the y parameter of the events, nullptr for a histogram of x. Must be the same size as x.
+*/
+void DensityGrid::setEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y) {
+  this->clear();
+  if (!x || (y && y->size() != x->size())) {
+    return;
+  }
+  this->events_x = std::move(x);
+  this->events_y = std::move(y);
+
+  finiteRange(*this->events_x, this->extent_x_min, this->extent_x_max);
+  if (this->events_y) {
+    finiteRange(*this->events_y, this->extent_y_min, this->extent_y_max);
+    this->base_columns = base_resolution_density;
+    this->base_rows = base_resolution_density;
+  } else {
+    this->base_columns = base_resolution_histogram;
+    this->base_rows = 1;
+  }
+
+  std::vector<std::uint32_t> counts;
+  this->binEvents(this->extent_x_min, this->extent_x_max, this->base_columns, this->extent_y_min, this->extent_y_max, this->base_rows,
+                  counts);
+  this->base_counts = std::make_shared<const std::vector<std::uint32_t>>(std::move(counts));
+}
+
+/*
+Removes the events and grids
+*/
+void DensityGrid::clear() {
+  this->events_x.reset();
+  this->events_y.reset();
+  this->extent_x_min = 0.0;
+  this->extent_x_max = 1.0;
+  this->extent_y_min = 0.0;
+  this->extent_y_max = 1.0;
+  this->base_columns = 0;
+  this->base_rows = 0;
+  this->base_counts.reset();
+  this->grid_columns = 0;
+  this->grid_rows = 0;
+  this->grid_counts.clear();
+  this->grid_maximum = 0.0f;
+  this->grid_resampled = false;
+}
+
+/*
+Whether the grid has (no) events
+*/
+bool DensityGrid::isEmpty() const { return !this->events_x || this->events_x->empty(); }
+
+/*
+Whether the grid is a histogram of one parameter
+*/
+bool DensityGrid::isHistogram() const { return !this->events_y; }
+
+/*
+Getter for the amount of events
+*/
+std::size_t DensityGrid::eventCount() const { return this->events_x ? this->events_x->size() : 0; }
+
+/*
+Getter for the extent of the (finite) events
+  :param x_min: (return) the minimum x
+  :param x_max: (return) the (slightly extended) maximum x
+  :param y_min: (return) the minimum y, 0.0 for a histogram
+  :param y_max: (return) the (slightly extended) maximum y, 1.0 for a histogram
+*/
+void DensityGrid::extent(double& x_min, double& x_max, double& y_min, double& y_max) const {
+  x_min = this->extent_x_min;
+  x_max = this->extent_x_max;
+  y_min = this->extent_y_min;
+  y_max = this->extent_y_max;
+}
+
+/*
+(Re)calculates the grid for a range and size. Resamples the base grid if possible, otherwise bins the events.
+  :param x_min: low edge of the first column
+  :param x_max: high edge of the last column
+  :param columns: amount of columns
+  :param y_min: low edge of the first row, ignored for a histogram
+  :param y_max: high edge of the last row, ignored for a histogram
+  :param rows: amount of rows, ignored for a histogram
+  :returns: whether the grid changed
+*/
+bool DensityGrid::bin(double x_min, double x_max, std::size_t columns, double y_min, double y_max, std::size_t rows) {
+  if (this->isHistogram()) {
+    y_min = 0.0;
+    y_max = 1.0;
+    rows = 1;
+  }
+  if (this->isEmpty() || columns == 0 || rows == 0 || !(x_max > x_min) || !(y_max > y_min)) {
+    bool changed = !this->grid_counts.empty();
+    this->grid_columns = 0;
+    this->grid_rows = 0;
+    this->grid_counts.clear();
+    this->grid_maximum = 0.0f;
+    return changed;
+  }
+
+  if (x_min == this->grid_x_min && x_max == this->grid_x_max && columns == this->grid_columns && y_min == this->grid_y_min &&
+      y_max == this->grid_y_max && rows == this->grid_rows) {
+    return false;
+  }
+
+  this->grid_x_min = x_min;
+  this->grid_x_max = x_max;
+  this->grid_y_min = y_min;
+  this->grid_y_max = y_max;
+  this->grid_columns = columns;
+  this->grid_rows = rows;
+
+  // The base grid is only accurate enough if its bins are smaller than the grid bins
+  bool resample = (x_max - x_min) / static_cast<double>(columns) >=
+                  (this->extent_x_max - this->extent_x_min) / static_cast<double>(this->base_columns);
+  if (!this->isHistogram()) {
+    resample = resample && (y_max - y_min) / static_cast<double>(rows) >=
+                               (this->extent_y_max - this->extent_y_min) / static_cast<double>(this->base_rows);
+  }
+
+  if (resample) {
+    this->resample();
+  } else {
+    std::vector<std::uint32_t> counts;
+    this->binEvents(x_min, x_max, columns, y_min, y_max, rows, counts);
+    this->grid_counts.resize(counts.size());
+    std::transform(counts.begin(), counts.end(), this->grid_counts.begin(), [](std::uint32_t count) { return static_cast<float>(count); });
+  }
+  this->grid_resampled = resample;
+
+  this->grid_maximum = 0.0f;
+  for (float count : this->grid_counts) {
+    this->grid_maximum = std::max(this->grid_maximum, count);
+  }
+  return true;
+}
+
+/*
+Getter for the amount of columns of the grid
+*/
+std::size_t DensityGrid::columns() const { return this->grid_columns; }
+
+/*
+Getter for the amount of rows of the grid, 1 for a histogram
+*/
+std::size_t DensityGrid::rows() const { return this->grid_rows; }
+
+/*
+Getter for the counts of the grid, row-major with row 0 at the lowest y. Resampled counts can be fractional.
+*/
+const float* DensityGrid::counts() const { return this->grid_counts.data(); }
+
+/*
+Getter for the highest count of the grid
+*/
+float DensityGrid::maximum() const { return this->grid_maximum; }
+
+/*
+Whether the grid was resampled from the base grid, instead of binned from the events
+*/
+bool DensityGrid::isResampled() const { return this->grid_resampled; }
+
+}  // namespace Data
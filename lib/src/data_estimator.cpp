@@ -0,0 +1,591 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_estimator.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+
+#include "data_fcs.h"
+#include "data_parallel.h"
+
+namespace Data {
+
+const std::size_t SpilloverEstimator::none;
+
+namespace {
+
+// Radix selection levels over the 32 bit keys: the bit shift and the amount of bits of every level
+const int radix_levels = 3;
+const int radix_shift[radix_levels] = {21, 10, 0};
+const int radix_bits[radix_levels] = {11, 11, 10};
+const std::size_t radix_bins = 2048;
+
+/*
+Maps a float to an unsigned key with the same ordering
+*/
+std::uint32_t floatKey(float value) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+/*
+Maps a key back to its float
+*/
+float keyFloat(std::uint32_t key) {
+  std::uint32_t bits = (key & 0x80000000u) ? (key & 0x7FFFFFFFu) : ~key;
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+/*
+Reduces a name to lower case letters and digits, so 'BV 421' matches 'bv421'
+*/
+QString simplifyName(const QString& name) {
+  QString simple;
+  for (const QChar& character : name) {
+    if (character.isLetterOrNumber()) {
+      simple.append(character.toLower());
+    }
+  }
+  return simple;
+}
+
+/*
+Finds the bin that contains a rank within a histogram
+  :param histogram: the bins
+  :param bins: amount of bins
+  :param rank: (in/out) the rank, returned relative to the found bin
+  :returns: the bin
+*/
+std::size_t selectBin(const std::uint64_t* histogram, std::size_t bins, std::uint64_t& rank) {
+  for (std::size_t b = 0; b < bins; ++b) {
+    if (rank < histogram[b]) {
+      return b;
+    }
+    rank -= histogram[b];
+  }
+  return bins - 1;
+}
+
+/*
+Streams all events of a control in parallel chunks, and counts the keys of every population and column at a radix level.
+Only keys that match the prefix of the previous levels are counted.
+  :param reader: the opened control
+  :param columns: the parameters to count
+  :param primary: the column that gates the populations, or none to count all events as population 0
+  :param negative_key: events with a primary key upto this key are population 0
+  :param positive_key: events with a primary key from this key are population 1
+  :param level: the radix level
+  :param prefixes: per [population][column] the prefix of the previous levels
+  :param histogram: (return) the [population][column][bin] counts
+  :param chunk_events: amount of events per chunk
+  :param token: the cancellation token
+*/
+void countLevel(const Data::FCSReader& reader, const std::vector<std::size_t>& columns, std::size_t primary, std::uint32_t negative_key,
+                std::uint32_t positive_key, int level, const std::vector<std::uint64_t>& prefixes, std::vector<std::uint64_t>& histogram,
+                std::size_t chunk_events, const Data::JobToken& token) {
+  const std::size_t column_count = columns.size();
+  const std::size_t stride = reader.parameterCount();
+  const std::size_t events = reader.eventCount();
+  const std::size_t chunks = (events + chunk_events - 1) / chunk_events;
+  const int shift = radix_shift[level];
+  const int prefix_shift = shift + radix_bits[level];
+  const std::uint64_t mask = (static_cast<std::uint64_t>(1) << radix_bits[level]) - 1;
+  const float* mapped = reader.floatData();
+
+  histogram.assign(2 * column_count * radix_bins, 0);
+  std::mutex mutex;
+
+  Data::parallelFor(chunks, [&](std::size_t begin, std::size_t end) {
+    std::vector<std::uint64_t> local(histogram.size(), 0);
+    std::vector<float> buffer;
+    std::vector<const float*> column_values(column_count);
+
+    for (std::size_t chunk = begin; chunk < end; ++chunk) {
+      if (token.isCancelled()) {
+        return;
+      }
+
+      // Float data is used in place, otherwise only the counted columns are converted chunk by chunk
+      const std::size_t first = chunk * chunk_events;
+      const std::size_t count = std::min(chunk_events, events - first);
+      std::size_t step = stride;
+      if (mapped != nullptr) {
+        for (std::size_t c = 0; c < column_count; ++c) {
+          column_values[c] = mapped + first * stride + columns[c];
+        }
+      } else {
+        buffer.resize(count * column_count);
+        for (std::size_t c = 0; c < column_count; ++c) {
+          reader.readColumn(columns[c], first, count, buffer.data() + c * count);
+          column_values[c] = buffer.data() + c * count;
+        }
+        step = 1;
+      }
+
+      for (std::size_t e = 0; e < count; ++e) {
+        const std::size_t offset = e * step;
+
+        std::size_t population = 0;
+        if (primary != SpilloverEstimator::none) {
+          std::uint32_t key = floatKey(column_values[primary][offset]);
+          if (key >= positive_key) {
+            population = 1;
+          } else if (key > negative_key) {
+            continue;
+          }
+        }
+
+        const std::uint64_t* prefix = prefixes.data() + population * column_count;
+        std::uint64_t* bins = local.data() + population * column_count * radix_bins;
+        for (std::size_t c = 0; c < column_count; ++c) {
+          std::uint64_t key = floatKey(column_values[c][offset]);
+          if ((key >> prefix_shift) == prefix[c]) {
+            ++bins[c * radix_bins + ((key >> shift) & mask)];
+          }
+        }
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::size_t i = 0; i < local.size(); ++i) {
+      histogram[i] += local[i];
+    }
+  });
+}
+
+}  // namespace
+
+/*
+Constructor: constructs an estimator without instrument and controls
+*/
+SpilloverEstimator::SpilloverEstimator()
+    : estimator_instrument(),
+      library(),
+      library_names(),
+      control_paths(),
+      estimator_options(),
+      estimator_controls(),
+      estimator_measured(),
+      estimator_predicted(),
+      predicted_rows(),
+      cancelled(false),
+      run_progress() {}
+
+/*
+Sets the instrument the controls were acquired on
+  :param instrument: the instrument
+*/
+void SpilloverEstimator::setInstrument(const Data::Instrument& instrument) {
+  this->estimator_instrument = instrument;
+  this->estimator_predicted.setInstrument(instrument);
+}
+
+/*
+Sets the fluorophore library, the controls are matched by name to predict their spillover
+  :param spectra: the library spectra
+  :param names: the library names, one per spectrum
+*/
+void SpilloverEstimator::setLibrary(std::vector<Data::Spectrum> spectra, QStringList names) {
+  this->library = std::move(spectra);
+  this->library_names = std::move(names);
+  if (static_cast<std::size_t>(this->library_names.size()) != this->library.size()) {
+    this->library_names.clear();
+    for (const Data::Spectrum& spectrum : this->library) {
+      this->library_names.append(spectrum.id());
+    }
+  }
+}
+
+/*
+Sets the controls to every .fcs file in a folder
+  :param folder: the folder path
+  :returns: the amount of controls
+*/
+std::size_t SpilloverEstimator::setFolder(const QString& folder) {
+  this->control_paths.clear();
+  QDir directory(folder);
+  for (const QString& file : directory.entryList({"*.fcs", "*.FCS"}, QDir::Files, QDir::Name)) {
+    this->control_paths.append(directory.filePath(file));
+  }
+  this->control_paths.removeDuplicates();
+  return static_cast<std::size_t>(this->control_paths.size());
+}
+
+/*
+Sets the estimation options
+  :param options: the options
+*/
+void SpilloverEstimator::setOptions(const SpilloverEstimator::Options& options) { this->estimator_options = options; }
+
+/*
+Runs the estimation of all controls followed by the prediction, blocks until finished or cancelled
+  :param token: the cancellation token, polled between the chunks
+  :param report: (optional) called upon every progress change with the progress (0.0-1.0), from the worker threads
+  :returns: whether the estimation finished, false if cancelled
+*/
+bool SpilloverEstimator::run(const Data::JobToken& token, std::function<void(double)> report) {
+  this->cancelled = false;
+  this->run_progress.reset(std::move(report));
+
+  const std::size_t detectors = this->estimator_predicted.detectorCount();
+  const std::size_t controls = static_cast<std::size_t>(this->control_paths.size());
+  this->estimator_controls.clear();
+  this->estimator_measured.assign(controls * detectors, std::numeric_limits<double>::quiet_NaN());
+  this->predicted_rows.assign(controls, SpilloverEstimator::none);
+
+  for (std::size_t i = 0; i < controls; ++i) {
+    SpilloverEstimator::Control control;
+    control.path = this->control_paths.at(static_cast<int>(i));
+    control.name = QFileInfo(control.path).completeBaseName();
+    control.primary = SpilloverEstimator::none;
+    control.negative_count = 0;
+    control.positive_count = 0;
+
+    this->estimateControl(i, control, this->estimator_measured.data() + i * detectors, token);
+    this->estimator_controls.push_back(std::move(control));
+
+    if (token.isCancelled()) {
+      this->cancelled = true;
+      return false;
+    }
+  }
+
+  this->predict();
+  this->run_progress.set(1000);
+  return true;
+}
+
+/*
+Estimates the spillover of one control. The events are streamed four times: the first pass finds the primary detector and
+the population gates, the next three passes are the radix levels of the population medians of every detector.
+  :param index: the control index, for the progress
+  :param control: (in/out) the control
+  :param row: (return) the measured spillover of every detector, untouched for unmatched detectors
+  :param token: the cancellation token
+  :returns: whether the control could be estimated
+*/
+bool SpilloverEstimator::estimateControl(std::size_t index, SpilloverEstimator::Control& control, double* row,
+                                         const Data::JobToken& token) {
+  const std::size_t controls = static_cast<std::size_t>(this->control_paths.size());
+  const SpilloverEstimator::Options options = this->estimator_options;
+  const std::size_t chunk_events = std::max<std::size_t>(1, options.chunk_events);
+  auto setProgress = [this, index, controls](int pass) {
+    this->run_progress.set(static_cast<int>(((index * 4 + static_cast<std::size_t>(pass)) * 1000) / (controls * 4)));
+  };
+
+  Data::FCSReader reader;
+  if (!reader.open(control.path)) {
+    return false;
+  }
+  if (reader.eventCount() == 0) {
+    qWarning() << "SpilloverEstimator::estimateControl: no events in" << control.path;
+    return false;
+  }
+
+  // Match the parameters to the detectors: by detector or filter name, preferably the area parameter
+  std::vector<std::size_t> columns;
+  std::vector<std::size_t> column_detectors;
+  for (std::size_t d = 0; d < this->estimator_predicted.detectorCount(); ++d) {
+    const Data::SpilloverMatrix::Detector& detector = this->estimator_predicted.detector(d);
+    const Data::Filter& filter = this->estimator_instrument.optics()[detector.laserline].filters()[detector.filter];
+
+    QStringList candidates = {detector.name + "-A", detector.name};
+    if (!filter.name().isEmpty()) {
+      candidates.append(filter.name() + "-A");
+      candidates.append(filter.name());
+    }
+
+    std::size_t parameter = SpilloverEstimator::none;
+    for (const QString& candidate : candidates) {
+      for (std::size_t p = 0; p < reader.parameterCount() && parameter == SpilloverEstimator::none; ++p) {
+        if (reader.parameter(p).name.compare(candidate, Qt::CaseInsensitive) == 0) {
+          parameter = p;
+        }
+      }
+      if (parameter != SpilloverEstimator::none) {
+        break;
+      }
+    }
+
+    if (parameter != SpilloverEstimator::none) {
+      columns.push_back(parameter);
+      column_detectors.push_back(d);
+    }
+  }
+  if (columns.empty()) {
+    qWarning() << "SpilloverEstimator::estimateControl: no parameters match the instrument's detectors" << control.path;
+    return false;
+  }
+
+  const std::size_t column_count = columns.size();
+  std::vector<std::uint64_t> histogram;
+  std::vector<std::uint64_t> prefixes(2 * column_count, 0);
+
+  // Pass 1: coarse quantiles of all events, the primary detector has the largest positive to negative distance
+  countLevel(reader, columns, SpilloverEstimator::none, 0, 0, 0, prefixes, histogram, chunk_events, token);
+  if (token.isCancelled()) {
+    return false;
+  }
+  setProgress(1);
+
+  const std::uint64_t events = static_cast<std::uint64_t>(reader.eventCount());
+  const double quantile_negative = std::max(0.0, std::min(1.0, options.negative_quantile));
+  const double quantile_positive = std::max(0.0, std::min(1.0, options.positive_quantile));
+  const std::uint64_t rank_negative = static_cast<std::uint64_t>(quantile_negative * static_cast<double>(events - 1));
+  const std::uint64_t rank_positive = static_cast<std::uint64_t>(quantile_positive * static_cast<double>(events - 1));
+
+  std::size_t primary = SpilloverEstimator::none;
+  std::size_t bin_negative = 0;
+  std::size_t bin_positive = 0;
+  double distance_primary = 0.0;
+  for (std::size_t c = 0; c < column_count; ++c) {
+    std::uint64_t rank = rank_negative;
+    std::size_t negative = selectBin(histogram.data() + c * radix_bins, radix_bins, rank);
+    rank = rank_positive;
+    std::size_t positive = selectBin(histogram.data() + c * radix_bins, radix_bins, rank);
+
+    // Distance between the bin centers
+    const std::uint32_t center = static_cast<std::uint32_t>(1) << (radix_shift[0] - 1);
+    double distance = static_cast<double>(keyFloat(static_cast<std::uint32_t>(positive << radix_shift[0]) | center)) -
+                      static_cast<double>(keyFloat(static_cast<std::uint32_t>(negative << radix_shift[0]) | center));
+    if (positive > negative && (primary == SpilloverEstimator::none || distance > distance_primary)) {
+      primary = c;
+      bin_negative = negative;
+      bin_positive = positive;
+      distance_primary = distance;
+    }
+  }
+  if (primary == SpilloverEstimator::none) {
+    qWarning() << "SpilloverEstimator::estimateControl: no positive population in" << control.path;
+    return false;
+  }
+
+  const std::uint32_t negative_key = static_cast<std::uint32_t>(((bin_negative + 1) << radix_shift[0]) - 1);
+  const std::uint32_t positive_key = static_cast<std::uint32_t>(bin_positive << radix_shift[0]);
+  control.primary = column_detectors[primary];
+  const QString& label = reader.parameter(columns[primary]).label;
+  if (!label.isEmpty()) {
+    control.name = label;
+  }
+
+  // Passes 2-4: the population medians of every detector, one radix level per pass
+  std::vector<std::uint64_t> ranks(2 * column_count, 0);
+  for (int level = 0; level < radix_levels; ++level) {
+    countLevel(reader, columns, primary, negative_key, positive_key, level, prefixes, histogram, chunk_events, token);
+    if (token.isCancelled()) {
+      control.primary = SpilloverEstimator::none;
+      return false;
+    }
+    setProgress(2 + level);
+
+    const std::size_t bins = static_cast<std::size_t>(1) << radix_bits[level];
+    for (std::size_t i = 0; i < 2 * column_count; ++i) {
+      const std::uint64_t* slice = histogram.data() + i * radix_bins;
+      if (level == 0) {
+        std::uint64_t count = 0;
+        for (std::size_t b = 0; b < bins; ++b) {
+          count += slice[b];
+        }
+        if (i % column_count == 0) {
+          (i < column_count ? control.negative_count : control.positive_count) = static_cast<std::size_t>(count);
+        }
+        ranks[i] = count > 0 ? (count - 1) / 2 : 0;
+      }
+      prefixes[i] = (prefixes[i] << radix_bits[level]) | selectBin(slice, bins, ranks[i]);
+    }
+  }
+
+  if (control.negative_count == 0 || control.positive_count == 0) {
+    qWarning() << "SpilloverEstimator::estimateControl: empty population in" << control.path;
+    control.primary = SpilloverEstimator::none;
+    return false;
+  }
+
+  // Spillover: the median difference normalized to the primary detector
+  auto median = [&prefixes](std::size_t i) { return static_cast<double>(keyFloat(static_cast<std::uint32_t>(prefixes[i]))); };
+  const double signal = median(column_count + primary) - median(primary);
+  if (!(signal > 0.0)) {
+    qWarning() << "SpilloverEstimator::estimateControl: no signal in the primary detector of" << control.path;
+    control.primary = SpilloverEstimator::none;
+    return false;
+  }
+  for (std::size_t c = 0; c < column_count; ++c) {
+    row[column_detectors[c]] = (median(column_count + c) - median(c)) / signal;
+  }
+  return true;
+}
+
+/*
+Finds the library fluorophore of a control name: an equal (simplified) name, otherwise the longest library name contained in
+the control name (for labels as 'CD3 BV421')
+  :param name: the control name
+  :returns: the library index, or none
+*/
+std::size_t SpilloverEstimator::matchLibrary(const QString& name) const {
+  const QString simple = simplifyName(name);
+  std::size_t match = SpilloverEstimator::none;
+  int match_length = 0;
+
+  for (int i = 0; i < this->library_names.size(); ++i) {
+    QString candidate = simplifyName(this->library_names.at(i));
+    if (candidate.size() < 3) {
+      continue;
+    }
+    if (candidate == simple) {
+      return static_cast<std::size_t>(i);
+    }
+    if (candidate.size() > match_length && simple.contains(candidate)) {
+      match = static_cast<std::size_t>(i);
+      match_length = candidate.size();
+    }
+  }
+  return match;
+}
+
+/*
+Predicts the spillover of the controls that match a library fluorophore
+*/
+void SpilloverEstimator::predict() {
+  std::vector<const Data::Spectrum*> spectra;
+  QStringList names;
+  for (std::size_t i = 0; i < this->estimator_controls.size(); ++i) {
+    std::size_t match = this->matchLibrary(this->estimator_controls[i].name);
+    if (match == SpilloverEstimator::none) {
+      continue;
+    }
+    this->predicted_rows[i] = spectra.size();
+    spectra.push_back(&this->library[match]);
+    names.append(this->library_names.at(static_cast<int>(match)));
+  }
+  this->estimator_predicted.calculate(spectra, names);
+}
+
+/*
+Whether the last estimation was cancelled
+*/
+bool SpilloverEstimator::isCancelled() const { return this->cancelled; }
+
+/*
+Getter for the progress of a running estimation, can be called from any thread
+  :returns: progress (0.0-1.0)
+*/
+double SpilloverEstimator::progress() const { return this->run_progress.value(); }
+
+/*
+Getter for the amount of estimated controls
+*/
+std::size_t SpilloverEstimator::controlCount() const { return this->estimator_controls.size(); }
+
+/*
+Getter for a control
+  :param index: the control index
+*/
+const SpilloverEstimator::Control& SpilloverEstimator::control(std::size_t index) const { return this->estimator_controls[index]; }
+
+/*
+Getter for the amount of detectors of the instrument
+*/
+std::size_t SpilloverEstimator::detectorCount() const { return this->estimator_predicted.detectorCount(); }
+
+/*
+Getter for a detector
+  :param index: the detector index
+*/
+const Data::SpilloverMatrix::Detector& SpilloverEstimator::detector(std::size_t index) const {
+  return this->estimator_predicted.detector(index);
+}
+
+/*
+Whether a control matched a library fluorophore, and therefore has a prediction
+  :param control: the control index
+*/
+bool SpilloverEstimator::isPredicted(std::size_t control) const { return this->predicted_rows[control] != SpilloverEstimator::none; }
+
+/*
+Getter for the measured spillover
+  :param control: the control (row) index
+  :param detector: the detector (column) index
+  :returns: the spillover, NaN if not measured
+*/
+double SpilloverEstimator::measured(std::size_t control, std::size_t detector) const {
+  return this->estimator_measured[control * this->detectorCount() + detector];
+}
+
+/*
+Getter for the predicted spillover
+  :param control: the control (row) index
+  :param detector: the detector (column) index
+  :returns: the spillover, NaN if the control has no prediction
+*/
+double SpilloverEstimator::predicted(std::size_t control, std::size_t detector) const {
+  if (!this->isPredicted(control)) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  return this->estimator_predicted.spillover(this->predicted_rows[control], detector);
+}
+
+/*
+Getter for the measured, predicted or difference (measured - predicted) spillover
+  :param mode: which matrix to return the value of
+  :param control: the control (row) index
+  :param detector: the detector (column) index
+*/
+double SpilloverEstimator::value(SpilloverEstimator::Mode mode, std::size_t control, std::size_t detector) const {
+  switch (mode) {
+    case SpilloverEstimator::Measured:
+      return this->measured(control, detector);
+    case SpilloverEstimator::Predicted:
+      return this->predicted(control, detector);
+    case SpilloverEstimator::Difference:
+    default:
+      return this->measured(control, detector) - this->predicted(control, detector);
+  }
+}
+
+/*
+Exports a matrix as comma separated values, with a header row and column. Missing values are left empty.
+  :param mode: which matrix to export
+*/
+QString SpilloverEstimator::toCSV(SpilloverEstimator::Mode mode) const {
+  // Quote every name, they can contain comma's
+  auto quote = [](const QString& text) {
+    QString quoted = text;
+    quoted.replace('"', "\"\"");
+    return QString("\"%1\"").arg(quoted);
+  };
+
+  QString csv = quote("Control");
+  for (std::size_t j = 0; j < this->detectorCount(); ++j) {
+    csv += "," + quote(this->detector(j).name);
+  }
+  csv += "\n";
+
+  for (std::size_t i = 0; i < this->controlCount(); ++i) {
+    csv += quote(this->control(i).name);
+    for (std::size_t j = 0; j < this->detectorCount(); ++j) {
+      double value = this->value(mode, i, j);
+      csv += "," + (std::isnan(value) ? QString() : QString::number(value, 'f', 6));
+    }
+    csv += "\n";
+  }
+
+  return csv;
+}
+
+}  // namespace Data
@@ -11,6 +11,7 @@
 #include <QApplication>
 #include <QDebug>
 #include <QDir>
+#include <QFileInfo>
 #include <QJsonParseError>
 #include <QSettings>
 
@@ -38,6 +39,7 @@ Factory::Factory()
   this->path_styles = QDir(this->path_exe).filePath(this->file_styles);
   this->path_instruments = QDir(this->path_exe).filePath(this->file_instruments);
   this->path_fluorophores = QDir(this->path_exe).filePath(this->file_fluorophores);
+  this->path_fluorophores_compiled = Factory::compiledPath(this->path_fluorophores);
 
   // Check path validity
   this->valid_settings = Factory::exists(this->path_settings);
@@ -93,6 +95,7 @@ Factory::Factory(const QString settings, const QString styles, const QString ins
   this->path_styles = QDir(this->path_exe).filePath(this->file_styles);
   this->path_instruments = QDir(this->path_exe).filePath(this->file_instruments);
   this->path_fluorophores = QDir(this->path_exe).filePath(this->file_fluorophores);
+  this->path_fluorophores_compiled = Factory::compiledPath(this->path_fluorophores);
 
   // Check path validity
   this->valid_settings = Factory::exists(this->path_settings);
@@ -230,6 +233,12 @@ Getter for path_fluorophores
 */
 QString Factory::getPathFluorophores() const { return this->path_fluorophores; }
 
+/*
+Getter for path_fluorophores_compiled. The compiled database does not have to exist.
+  :returns: absolute path to the compiled (binary) fluorophores database
+*/
+QString Factory::getPathFluorophoresCompiled() const { return this->path_fluorophores_compiled; }
+
 /*
 Builds the QSettings as specified by the parameter.
 This function (again) checks whether the file exists before opening it. Because in the timespan
@@ -364,6 +373,16 @@ bool Factory::exists(const QString& path_file) {
   return file_exists;
 }
 
+/*
+(Static) Convenience function: builds the path of the compiled file next to a json source file
+  :param path_file: the source file
+  :returns: path to the compiled file
+*/
+QString Factory::compiledPath(const QString& path_file) {
+  QFileInfo info(path_file);
+  return QDir(info.absolutePath()).filePath(info.completeBaseName() + ".bin");
+}
+
 /*
 QMessageBox for showing a standard fatal error message
 */
@@ -0,0 +1,606 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_fcs.h"
+
+#include <QDebug>
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Data {
+
+const std::size_t FCSReader::none;
+
+namespace {
+
+/*
+Loads an unaligned value in the specified byte order
+*/
+template <typename T>
+T loadValue(const uchar* source, bool little_endian) {
+  return little_endian ? qFromLittleEndian<T>(source) : qFromBigEndian<T>(source);
+}
+
+/*
+Parses a segment offset of the HEADER, the offsets are right aligned ASCII integers and can be blank
+*/
+qint64 headerOffset(const QByteArray& header, int position) {
+  QByteArray field = header.mid(position, 8).trimmed();
+  if (field.isEmpty()) {
+    return 0;
+  }
+  bool ok = false;
+  qint64 value = field.toLongLong(&ok);
+  return ok ? value : -1;
+}
+
+/*
+Parses an integer keyword value
+*/
+qint64 keywordInteger(const QString& value, bool* ok) { return value.trimmed().toLongLong(ok); }
+
+}  // namespace
+
+/*
+Constructor: constructs an empty reader
+*/
+FCSReader::FCSReader()
+    : file(),
+      fcs_version(),
+      fcs_keywords(),
+      fcs_parameters(),
+      data_type(FCSReader::Float),
+      data_little_endian(true),
+      event_count(0),
+      event_size(0),
+      event_offsets(),
+      event_masks(),
+      data_begin(0),
+      data_size(0),
+      data(nullptr) {}
+
+/*
+Destructor: unmaps the data and closes the file
+*/
+FCSReader::~FCSReader() { this->close(); }
+
+/*
+Reads the HEADER and TEXT segments of an FCS file, without mapping the DATA segment
+  :param path: the file path
+  :returns: whether the file is a valid and supported FCS file
+*/
+bool FCSReader::readHeader(const QString& path) {
+  bool valid = this->parse(path);
+  this->file.close();
+  return valid;
+}
+
+/*
+Reads the HEADER and TEXT segments of an FCS file and maps the DATA segment
+  :param path: the file path
+  :returns: whether the file is a valid and supported FCS file
+*/
+bool FCSReader::open(const QString& path) {
+  if (!this->parse(path)) {
+    this->file.close();
+    return false;
+  }
+
+  if (this->data_size > 0) {
+    this->data = this->file.map(this->data_begin, this->data_size);
+    if (this->data == nullptr) {
+      qWarning() << "FCSReader::open: cannot map the data segment of" << path << this->file.errorString();
+      this->close();
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+Unmaps the data, closes the file and clears the header
+*/
+void FCSReader::close() {
+  if (this->data != nullptr) {
+    this->file.unmap(this->data);
+    this->data = nullptr;
+  }
+  this->file.close();
+
+  this->fcs_version.clear();
+  this->fcs_keywords.clear();
+  this->fcs_parameters.clear();
+  this->event_count = 0;
+  this->event_size = 0;
+  this->event_offsets.clear();
+  this->event_masks.clear();
+  this->data_begin = 0;
+  this->data_size = 0;
+}
+
+/*
+Opens the file and parses its HEADER, (supplemental) TEXT segments and the data layout. The file is left open.
+  :param path: the file path
+  :returns: whether the file is a valid and supported FCS file
+*/
+bool FCSReader::parse(const QString& path) {
+  this->close();
+
+  this->file.setFileName(path);
+  if (!this->file.open(QIODevice::ReadOnly)) {
+    qWarning() << "FCSReader::parse: cannot open" << path;
+    return false;
+  }
+
+  QByteArray header = this->file.read(58);
+  if (header.size() < 58) {
+    qWarning() << "FCSReader::parse: incomplete header" << path;
+    return false;
+  }
+
+  QString version = QString::fromLatin1(header.left(6));
+  if (version != "FCS3.0" && version != "FCS3.1") {
+    qWarning() << "FCSReader::parse: unsupported version" << version << path;
+    return false;
+  }
+
+  const qint64 file_size = this->file.size();
+  qint64 text_begin = headerOffset(header, 10);
+  qint64 text_end = headerOffset(header, 18);
+  if (text_begin < 58 || text_end <= text_begin || text_end >= file_size) {
+    qWarning() << "FCSReader::parse: invalid TEXT segment" << path;
+    return false;
+  }
+  this->file.seek(text_begin);
+  if (!this->parseText(this->file.read(text_end - text_begin + 1))) {
+    qWarning() << "FCSReader::parse: invalid TEXT segment" << path;
+    return false;
+  }
+
+  // The supplemental TEXT segment (if any) adds keywords
+  bool ok_begin = false;
+  bool ok_end = false;
+  qint64 supplement_begin = keywordInteger(this->keyword("$BEGINSTEXT"), &ok_begin);
+  qint64 supplement_end = keywordInteger(this->keyword("$ENDSTEXT"), &ok_end);
+  if (ok_begin && ok_end && supplement_begin > 0 && supplement_end > supplement_begin && supplement_end < file_size) {
+    this->file.seek(supplement_begin);
+    if (!this->parseText(this->file.read(supplement_end - supplement_begin + 1))) {
+      qWarning() << "FCSReader::parse: invalid supplemental TEXT segment" << path;
+    }
+  }
+
+  // The DATA offsets of large files do not fit in the HEADER, then they are only stored in the TEXT
+  qint64 data_begin = headerOffset(header, 26);
+  qint64 data_end = headerOffset(header, 34);
+  if (data_begin <= 0 && data_end <= 0) {
+    data_begin = keywordInteger(this->keyword("$BEGINDATA"), &ok_begin);
+    data_end = keywordInteger(this->keyword("$ENDDATA"), &ok_end);
+    if (!ok_begin || !ok_end) {
+      qWarning() << "FCSReader::parse: missing DATA segment offsets" << path;
+      return false;
+    }
+  }
+  if (data_begin < 0 || data_end >= file_size) {
+    qWarning() << "FCSReader::parse: invalid DATA segment" << path;
+    return false;
+  }
+  this->data_begin = data_begin;
+  this->data_size = data_end > data_begin ? data_end - data_begin + 1 : 0;
+
+  this->fcs_version = version;
+  if (!this->parseLayout()) {
+    qWarning() << "FCSReader::parse: unsupported data layout" << path;
+    this->fcs_version.clear();
+    return false;
+  }
+  return true;
+}
+
+/*
+Parses the keyword value pairs of a TEXT segment. The first character is the delimiter, a doubled delimiter is an escaped
+delimiter within a keyword or value. Keywords are case insensitive and stored in upper case.
+  :param text: the TEXT segment
+  :returns: whether the segment is valid
+*/
+bool FCSReader::parseText(const QByteArray& text) {
+  if (text.size() < 2) {
+    return false;
+  }
+  const char delimiter = text.at(0);
+
+  QByteArray field;
+  QString key;
+  bool is_key = true;
+  for (int i = 1; i < text.size(); ++i) {
+    char character = text.at(i);
+    if (character != delimiter) {
+      field.append(character);
+      continue;
+    }
+    if (i + 1 < text.size() && text.at(i + 1) == delimiter) {
+      field.append(delimiter);
+      ++i;
+      continue;
+    }
+
+    if (is_key) {
+      key = QString::fromUtf8(field).trimmed().toUpper();
+    } else {
+      this->fcs_keywords[key] = QString::fromUtf8(field);
+    }
+    is_key = !is_key;
+    field.clear();
+  }
+
+  return !this->fcs_keywords.empty();
+}
+
+/*
+Builds the parameters and the event layout from the keywords
+  :returns: whether the layout is valid and supported
+*/
+bool FCSReader::parseLayout() {
+  QString mode = this->keyword("$MODE").trimmed().toUpper();
+  if (!mode.isEmpty() && mode != "L") {
+    qWarning() << "FCSReader::parseLayout: only list mode data is supported, not" << mode;
+    return false;
+  }
+
+  QString type = this->keyword("$DATATYPE").trimmed().toUpper();
+  if (type == "I") {
+    this->data_type = FCSReader::Integer;
+  } else if (type == "F") {
+    this->data_type = FCSReader::Float;
+  } else if (type == "D") {
+    this->data_type = FCSReader::Double;
+  } else {
+    qWarning() << "FCSReader::parseLayout: unsupported $DATATYPE" << type;
+    return false;
+  }
+
+  QString order = this->keyword("$BYTEORD").trimmed();
+  if (order == "1,2,3,4" || order == "1,2" || order == "1,2,3,4,5,6,7,8") {
+    this->data_little_endian = true;
+  } else if (order == "4,3,2,1" || order == "2,1" || order == "8,7,6,5,4,3,2,1") {
+    this->data_little_endian = false;
+  } else {
+    qWarning() << "FCSReader::parseLayout: unsupported $BYTEORD" << order;
+    return false;
+  }
+
+  bool ok_parameters = false;
+  bool ok_events = false;
+  qint64 parameters = keywordInteger(this->keyword("$PAR"), &ok_parameters);
+  qint64 events = keywordInteger(this->keyword("$TOT"), &ok_events);
+  if (!ok_parameters || !ok_events || parameters <= 0 || events < 0) {
+    qWarning() << "FCSReader::parseLayout: invalid $PAR or $TOT";
+    return false;
+  }
+  // Every parameter requires its own $PnB keyword, this bounds $PAR before anything is allocated for it
+  if (static_cast<std::uint64_t>(parameters) > this->fcs_keywords.size()) {
+    qWarning() << "FCSReader::parseLayout: $PAR" << parameters << "exceeds the amount of keywords";
+    return false;
+  }
+
+  this->fcs_parameters.reserve(static_cast<std::size_t>(parameters));
+  this->event_size = 0;
+  for (qint64 i = 1; i <= parameters; ++i) {
+    QString prefix = QString("$P%1").arg(i);
+
+    FCSReader::Parameter parameter;
+    parameter.name = this->keyword(prefix + "N").trimmed();
+    parameter.label = this->keyword(prefix + "S").trimmed();
+
+    bool ok = false;
+    qint64 bits = keywordInteger(this->keyword(prefix + "B"), &ok);
+    bool valid_bits = false;
+    switch (this->data_type) {
+      case FCSReader::Integer:
+        valid_bits = ok && (bits == 8 || bits == 16 || bits == 32 || bits == 64);
+        break;
+      case FCSReader::Float:
+        valid_bits = ok && bits == 32;
+        break;
+      case FCSReader::Double:
+        valid_bits = ok && bits == 64;
+        break;
+    }
+    if (!valid_bits) {
+      qWarning() << "FCSReader::parseLayout: unsupported" << prefix + "B" << this->keyword(prefix + "B");
+      return false;
+    }
+    parameter.bits = static_cast<std::size_t>(bits);
+
+    parameter.range = this->keyword(prefix + "R").trimmed().toDouble(&ok);
+    if (!ok) {
+      parameter.range = 0.0;
+    }
+
+    QStringList amplification = this->keyword(prefix + "E").split(',');
+    parameter.decades = amplification.size() == 2 ? amplification[0].trimmed().toDouble() : 0.0;
+    parameter.offset = amplification.size() == 2 ? amplification[1].trimmed().toDouble() : 0.0;
+    if (parameter.decades > 0.0 && parameter.offset <= 0.0) {
+      parameter.offset = 1.0;
+    }
+
+    parameter.gain = this->keyword(prefix + "G").trimmed().toDouble(&ok);
+    if (!ok || parameter.gain <= 0.0) {
+      parameter.gain = 1.0;
+    }
+
+    // Integer values are masked to the bits required for the range
+    std::uint64_t mask = std::numeric_limits<std::uint64_t>::max();
+    if (this->data_type == FCSReader::Integer && parameter.range >= 1.0) {
+      int range_bits = static_cast<int>(std::ceil(std::log2(parameter.range)));
+      if (range_bits < static_cast<int>(parameter.bits)) {
+        mask = (static_cast<std::uint64_t>(1) << range_bits) - 1;
+      }
+    }
+
+    this->event_offsets.push_back(this->event_size);
+    this->event_masks.push_back(mask);
+    this->event_size += parameter.bits / 8;
+    this->fcs_parameters.push_back(std::move(parameter));
+  }
+
+  this->event_count = static_cast<std::size_t>(events);
+  if (static_cast<double>(this->event_count) * static_cast<double>(this->event_size) > static_cast<double>(this->data_size)) {
+    qWarning() << "FCSReader::parseLayout: DATA segment is smaller than $TOT events";
+    return false;
+  }
+  return true;
+}
+
+/*
+Whether a valid header has been read
+*/
+bool FCSReader::isValid() const { return !this->fcs_version.isEmpty(); }
+
+/*
+Whether the DATA segment is accessible
+*/
+bool FCSReader::isOpen() const { return this->isValid() && (this->data != nullptr || this->event_count == 0) && this->file.isOpen(); }
+
+/*
+Getter for the file path
+*/
+QString FCSReader::path() const { return this->file.fileName(); }
+
+/*
+Getter for the FCS version, "FCS3.0" or "FCS3.1"
+*/
+const QString& FCSReader::version() const { return this->fcs_version; }
+
+/*
+Getter for a keyword value
+  :param key: the keyword, case insensitive
+  :returns: the value, or an empty string if the keyword doesnt exist
+*/
+QString FCSReader::keyword(const QString& key) const {
+  std::unordered_map<QString, QString>::const_iterator item = this->fcs_keywords.find(key.toUpper());
+  if (item == this->fcs_keywords.end()) {
+    return QString();
+  }
+  return item->second;
+}
+
+/*
+Getter for all keywords, the keys are in upper case
+*/
+const std::unordered_map<QString, QString>& FCSReader::keywords() const { return this->fcs_keywords; }
+
+/*
+Getter for the cytometer type ($CYT)
+*/
+QString FCSReader::cytometer() const { return this->keyword("$CYT").trimmed(); }
+
+/*
+Getter for the spillover matrix stored in the file ($SPILLOVER, or the pre-3.1 SPILL keywords).
+The value is: n,[n parameter names],[n * n row-major values]
+  :param names: (return) the parameter names
+  :param values: (return) the row-major n * n spillover values
+  :returns: whether a valid spillover matrix was found
+*/
+bool FCSReader::spillover(QStringList& names, std::vector<double>& values) const {
+  names.clear();
+  values.clear();
+
+  QString text;
+  for (const char* key : {"$SPILLOVER", "SPILL", "$SPILL", "SPILLOVER"}) {
+    text = this->keyword(key);
+    if (!text.isEmpty()) {
+      break;
+    }
+  }
+  if (text.isEmpty()) {
+    return false;
+  }
+
+  QStringList fields = text.split(',');
+  bool ok = false;
+  int size = fields.isEmpty() ? 0 : fields[0].trimmed().toInt(&ok);
+  if (!ok || size <= 0 || fields.size() != 1 + size + size * size) {
+    qWarning() << "FCSReader::spillover: invalid spillover keyword" << this->path();
+    return false;
+  }
+
+  for (int i = 0; i < size; ++i) {
+    names.append(fields[1 + i].trimmed());
+  }
+  values.reserve(static_cast<std::size_t>(size * size));
+  for (int i = 0; i < size * size; ++i) {
+    values.push_back(fields[1 + size + i].trimmed().toDouble(&ok));
+    if (!ok) {
+      qWarning() << "FCSReader::spillover: invalid spillover value" << this->path();
+      names.clear();
+      values.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+Getter for the amount of events ($TOT)
+*/
+std::size_t FCSReader::eventCount() const { return this->event_count; }
+
+/*
+Getter for the amount of parameters ($PAR)
+*/
+std::size_t FCSReader::parameterCount() const { return this->fcs_parameters.size(); }
+
+/*
+Getter for a parameter
+  :param index: the parameter index (0 based, $P1 is index 0)
+*/
+const FCSReader::Parameter& FCSReader::parameter(std::size_t index) const { return this->fcs_parameters[index]; }
+
+/*
+Looks up a parameter by ($PnN) name
+  :param name: the parameter name, case sensitive
+  :returns: the parameter index, or none if not found
+*/
+std::size_t FCSReader::parameterIndex(const QString& name) const {
+  for (std::size_t i = 0; i < this->fcs_parameters.size(); ++i) {
+    if (this->fcs_parameters[i].name == name) {
+      return i;
+    }
+  }
+  return FCSReader::none;
+}
+
+/*
+Getter for the data type ($DATATYPE)
+*/
+FCSReader::DataType FCSReader::dataType() const { return this->data_type; }
+
+/*
+Zero-copy access to float data. The values are event major: value p of event e is at e * parameterCount() + p.
+  :returns: the mapped values, or nullptr if the data is not float, not in the native byte order, or not aligned
+*/
+const float* FCSReader::floatData() const {
+  if (this->data == nullptr || this->data_type != FCSReader::Float || this->data_little_endian != (Q_BYTE_ORDER == Q_LITTLE_ENDIAN) ||
+      reinterpret_cast<std::uintptr_t>(this->data) % alignof(float) != 0) {
+    return nullptr;
+  }
+  return reinterpret_cast<const float*>(this->data);
+}
+
+/*
+Zero-copy access to double data. The values are event major: value p of event e is at e * parameterCount() + p.
+  :returns: the mapped values, or nullptr if the data is not double, not in the native byte order, or not aligned
+*/
+const double* FCSReader::doubleData() const {
+  if (this->data == nullptr || this->data_type != FCSReader::Double || this->data_little_endian != (Q_BYTE_ORDER == Q_LITTLE_ENDIAN) ||
+      reinterpret_cast<std::uintptr_t>(this->data) % alignof(double) != 0) {
+    return nullptr;
+  }
+  return reinterpret_cast<const double*>(this->data);
+}
+
+/*
+Converts the values of a parameter of a range of events to float. Integer data is masked to its range and logarithmic
+amplification ($PnE) or linear gain ($PnG) is undone.
+  :param parameter: the parameter index
+  :param begin: the first event
+  :param count: amount of events, the range has to be valid
+  :param values: (return) the first value to write
+  :param stride: distance between the values of two events in values
+*/
+void FCSReader::convert(std::size_t parameter, std::size_t begin, std::size_t count, float* values, std::size_t stride) const {
+  const uchar* source = this->data + begin * this->event_size + this->event_offsets[parameter];
+  const std::size_t step = this->event_size;
+  const bool little = this->data_little_endian;
+
+  if (this->data_type == FCSReader::Float) {
+    for (std::size_t e = 0; e < count; ++e, source += step) {
+      std::uint32_t bits = loadValue<quint32>(source, little);
+      std::memcpy(&values[e * stride], &bits, sizeof(float));
+    }
+    return;
+  }
+  if (this->data_type == FCSReader::Double) {
+    for (std::size_t e = 0; e < count; ++e, source += step) {
+      std::uint64_t bits = loadValue<quint64>(source, little);
+      double value;
+      std::memcpy(&value, &bits, sizeof(double));
+      values[e * stride] = static_cast<float>(value);
+    }
+    return;
+  }
+
+  const FCSReader::Parameter& info = this->fcs_parameters[parameter];
+  const std::uint64_t mask = this->event_masks[parameter];
+  for (std::size_t e = 0; e < count; ++e, source += step) {
+    std::uint64_t raw;
+    switch (info.bits) {
+      case 8:
+        raw = *source;
+        break;
+      case 16:
+        raw = loadValue<quint16>(source, little);
+        break;
+      case 32:
+        raw = loadValue<quint32>(source, little);
+        break;
+      default:
+        raw = loadValue<quint64>(source, little);
+        break;
+    }
+    double value = static_cast<double>(raw & mask);
+
+    if (info.decades > 0.0 && info.range > 0.0) {
+      value = info.offset * std::pow(10.0, info.decades * value / info.range);
+    } else {
+      value /= info.gain;
+    }
+    values[e * stride] = static_cast<float>(value);
+  }
+}
+
+/*
+Reads (converts) the values of one parameter for a range of events, only the touched part of the file is paged in
+  :param parameter: the parameter index
+  :param begin: the first event
+  :param count: maximum amount of events
+  :param values: (return) buffer of atleast count values
+  :returns: the amount of events read, less than count at the end of the data
+*/
+std::size_t FCSReader::readColumn(std::size_t parameter, std::size_t begin, std::size_t count, float* values) const {
+  if (!this->isOpen() || parameter >= this->fcs_parameters.size() || begin >= this->event_count) {
+    return 0;
+  }
+  count = std::min(count, this->event_count - begin);
+  this->convert(parameter, begin, count, values, 1);
+  return count;
+}
+
+/*
+Reads (converts) all parameters for a range of events, only the touched part of the file is paged in
+  :param begin: the first event
+  :param count: maximum amount of events
+  :param values: (return) buffer of atleast count * parameterCount() values, written event major
+  :returns: the amount of events read, less than count at the end of the data
+*/
+std::size_t FCSReader::readEvents(std::size_t begin, std::size_t count, float* values) const {
+  if (!this->isOpen() || begin >= this->event_count) {
+    return 0;
+  }
+  count = std::min(count, this->event_count - begin);
+  const std::size_t parameters = this->fcs_parameters.size();
+  for (std::size_t p = 0; p < parameters; ++p) {
+    this->convert(p, begin, count, values + p, parameters);
+  }
+  return count;
+}
+
+}  // namespace Data
@@ -12,44 +12,80 @@
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonValueRef>
-#include <QPolygonF>
+#include <vector>
+
+#include "data_trace.h"
 
 namespace Data {
 
 /*
 Constructor: Construct the fluorophore data types
 */
-FluorophoreReader::FluorophoreReader() : fluor_data(), fluor_name(), fluor_id(), fluor_names() {}
+FluorophoreReader::FluorophoreReader()
+    : load_mode(FluorophoreReader::Lazy),
+      fluor_data(),
+      fluor_database(nullptr),
+      fluor_index(nullptr),
+      fluor_name(),
+      fluor_id(),
+      fluor_names() {}
 
 /*
-Loads the fluorophores QJsonDocument
+Sets the mode used to load fluorophores.json if the compiled spectrum database is missing or stale.
+Takes effect upon the next load()
+  :param mode: Document parses the full QJsonDocument, Lazy only indexes the file and parses spectra upon request,
+  Eager decodes all spectra in parallel upon loading
+*/
+void FluorophoreReader::setLoadMode(FluorophoreReader::LoadMode mode) { this->load_mode = mode; }
+
+/*
+Loads the fluorophore data. Prefers the compiled (memory mapped) spectrum database, if the compiled database
+is missing or stale fluorophores.json is loaded according to the load mode.
 Note: do not call this if Data::Factory::type::Fluorophores is invalid, that causes the factory to qFatal()
   :param data: the Data::Factory to request the source data from
 */
 void FluorophoreReader::load(Data::Factory& factory) {
-  // Retrieve QSetting
-  this->fluor_data = factory.get_json(Data::Factory::Fluorophores);
-
-  // Clear ids just in case load is called sequentially without unloading first
+  DATA_TRACE_SCOPE("FluorophoreReader::load");
+  // Clear data just in case load is called sequentially without unloading first
+  this->fluor_data = QJsonDocument();
+  this->fluor_database.reset();
+  this->fluor_index.reset();
   this->fluor_id.clear();
   this->fluor_name.clear();
   this->fluor_names.clear();
 
-  if (!this->isValid()) {
-    return;
+  std::shared_ptr<Data::SpectrumDatabase> database = std::make_shared<Data::SpectrumDatabase>();
+  if (database->open(factory.getPathFluorophoresCompiled(), factory.getPathFluorophores())) {
+    this->fluor_database = std::move(database);
+    this->loadDatabase();
+  } else if (this->load_mode == FluorophoreReader::Lazy && this->loadIndex(factory)) {
+    // Index build, spectra are parsed upon request
+  } else if (this->load_mode == FluorophoreReader::Eager && database->decode(factory.getPathFluorophores())) {
+    // All spectra are decoded into a single contiguous arena
+    this->fluor_database = std::move(database);
+    this->loadDatabase();
+  } else {
+    // Retrieve QJsonDocument
+    this->fluor_data = factory.get_json(Data::Factory::Fluorophores);
+    if (!this->isValid()) {
+      return;
+    }
+    this->loadDocument();
   }
 
-  // Reserve the necessary vector size
+  // Sort case-insensitive alphabetical order
+  std::sort(this->fluor_name.begin(), this->fluor_name.end(),
+            [](const QString& left, const QString& right) { return left.toLower() < right.toLower(); });
+}
+
+/*
+Builds the name maps/vectors from the fluorophores QJsonDocument
+*/
+void FluorophoreReader::loadDocument() {
   QJsonObject data = this->fluor_data.object();
 
   // Reserving memory to prevent unnessary growing
-  std::size_t data_size = static_cast<std::size_t>(data.length());
-  std::size_t multi_size =
-      data_size / 4;  // A guess, depends on amount of alternative names, if vector/unordered_map is too small, will auto grow anyway
-
-  this->fluor_id.reserve(data_size + multi_size);
-  this->fluor_name.reserve(data_size + multi_size);
-  this->fluor_names.reserve(multi_size);
+  this->reserve(static_cast<std::size_t>(data.length()));
 
   // Iterate over data file to load all data objects
   for (const QString& group : data.keys()) {
@@ -63,30 +99,95 @@ void FluorophoreReader::load(Data::Factory& factory) {
     // Builds list of names for menu's etc.
     QJsonArray fluorophore_names = fluorophore["names"].toArray();
 
-    // Build fluorophore names map
-    QStringList names_stringlist = QStringList();
-    names_stringlist.reserve(fluorophore_names.size());
-
-    // Fill vectors and maps
+    QStringList names = QStringList();
+    names.reserve(fluorophore_names.size());
     for (const QJsonValueRef name_ref : fluorophore_names) {
-      QString name = name_ref.toString();
-      // Add to name list
-      this->fluor_name.push_back(name);
-      // Add to id lookup
-      this->fluor_id[name] = group;
-      // Add name to alternative name lookup
-      names_stringlist.append(name);
+      names.append(name_ref.toString());
     }
 
-    // Finally add the alternative name stringlist to the storage vector
-    for (const QJsonValueRef name : fluorophore_names) {
-      this->fluor_names[name.toString()] = names_stringlist;
-    }
+    this->addNames(group, names);
   }
+}
 
-  // Sort case-insensitive alphabetical order
-  std::sort(this->fluor_name.begin(), this->fluor_name.end(),
-            [](const QString& left, const QString& right) { return left.toLower() < right.toLower(); });
+/*
+Builds the name maps/vectors from the compiled spectrum database. The database only contains enabled fluorophores.
+*/
+void FluorophoreReader::loadDatabase() {
+  this->reserve(this->fluor_database->size());
+
+  for (std::size_t i = 0; i < this->fluor_database->size(); ++i) {
+    this->addNames(this->fluor_database->id(i), this->fluor_database->names(i));
+  }
+}
+
+/*
+Builds the byte-offset index of fluorophores.json and the name maps/vectors from the index
+  :param factory: the Data::Factory to request the source path from
+  :returns: whether the index could be build, if false the file should be loaded as a QJsonDocument instead
+*/
+bool FluorophoreReader::loadIndex(const Data::Factory& factory) {
+  std::shared_ptr<Data::SpectrumIndex> index = std::make_shared<Data::SpectrumIndex>();
+  if (!index->open(factory.getPathFluorophores())) {
+    return false;
+  }
+  this->fluor_index = std::move(index);
+
+  this->reserve(this->fluor_index->size());
+
+  for (std::size_t i = 0; i < this->fluor_index->size(); ++i) {
+    this->addNames(this->fluor_index->id(i), this->fluor_index->names(i));
+  }
+  return true;
+}
+
+/*
+Reserves the name maps/vectors to prevent unnessary growing
+  :param size: the amount of fluorophores
+*/
+void FluorophoreReader::reserve(std::size_t size) {
+  std::size_t multi_size =
+      size / 4;  // A guess, depends on amount of alternative names, if vector/unordered_map is too small, will auto grow anyway
+
+  this->fluor_id.reserve(size + multi_size);
+  this->fluor_name.reserve(size + multi_size);
+  this->fluor_names.reserve(multi_size);
+}
+
+/*
+Adds a fluorophore's names to the name maps/vectors
+  :param id: the fluorophore id
+  :param names: all name variants of the fluorophore
+*/
+void FluorophoreReader::addNames(const QString& id, const QStringList& names) {
+  for (const QString& name : names) {
+    // Add to name list
+    this->fluor_name.push_back(name);
+    // Add to id lookup
+    this->fluor_id[name] = id;
+    // Add name to alternative name lookup
+    this->fluor_names[name] = names;
+  }
+}
+
+/*
+Compiles the fluorophores source file into the binary spectrum database, which is used by load() on the next start.
+  :param factory: the Data::Factory to request the paths from
+  :returns: whether compiling succeeded
+*/
+bool FluorophoreReader::compile(const Data::Factory& factory) const {
+  // An eagerly decoded database already is a compiled image
+  if (this->fluor_database && !this->fluor_database->isMapped()) {
+    return this->fluor_database->write(factory.getPathFluorophoresCompiled());
+  }
+  // A lazy index only requires the indexed objects to be parsed
+  if (this->fluor_index) {
+    return Data::SpectrumDatabase::compile(*this->fluor_index, factory.getPathFluorophoresCompiled());
+  }
+  if (this->fluor_data.isNull()) {
+    return Data::SpectrumDatabase::compile(factory.get_json(Data::Factory::Fluorophores), factory.getPathFluorophores(),
+                                           factory.getPathFluorophoresCompiled());
+  }
+  return Data::SpectrumDatabase::compile(this->fluor_data, factory.getPathFluorophores(), factory.getPathFluorophoresCompiled());
 }
 
 /*
@@ -94,6 +195,8 @@ Unallocates memory of all loaded data
 */
 void FluorophoreReader::unload() {
   this->fluor_data = QJsonDocument();
+  this->fluor_database.reset();
+  this->fluor_index.reset();
   std::vector<QString>().swap(this->fluor_name);
   std::unordered_map<QString, QString>().swap(this->fluor_id);
   std::unordered_map<QString, QStringList>().swap(this->fluor_names);
@@ -103,23 +206,35 @@ void FluorophoreReader::unload() {
 Returns whether Fluorophores is valid (has loaded fluorophore data)
   :returns: validity
 */
-bool FluorophoreReader::isValid() const { return !this->fluor_data.isNull(); }
+bool FluorophoreReader::isValid() const {
+  return !this->fluor_data.isNull() || this->fluor_database != nullptr || this->fluor_index != nullptr;
+}
+
+/*
+Returns whether the fluorophore data is served from the (mapped) compiled spectrum database file
+  :returns: whether the compiled database file is used
+*/
+bool FluorophoreReader::isCompiled() const { return this->fluor_database != nullptr && this->fluor_database->isMapped(); }
 
 /*
 Fluorophore spectrum accessor
   :param id: the fluorophore id, if id is not in source data, returns valid but otherwise useless data
 */
 Data::Spectrum FluorophoreReader::getSpectrum(const QString& id) const {
-  // Retrieve data
-  QJsonObject data_object = this->fluor_data.object();
-  QJsonValueRef data_ref = data_object[id];
+  if (this->fluor_database) {
+    return this->getDatabaseSpectrum(id);
+  }
+  if (this->fluor_index) {
+    Data::Meta meta;
+    return this->getIndexSpectrum(id, meta);
+  }
 
-  if (data_ref.type() == QJsonValue::Type::Null || data_ref.type() == QJsonValue::Type::Undefined) {
+  // Retrieve data
+  QJsonObject data = this->fluor_data.object().value(id).toObject();
+  if (data.isEmpty()) {
     qWarning() << "InstrumentReader::getSpectrum: Data::Spectrum object of id" << id << "could not be found.";
   }
 
-  QJsonObject data = data_ref.toObject();
-
   // Load data and transform to Data::Polygon's
   bool is_absorption = false;
   QJsonArray excitation_wavelength = data["excitation_wavelength"].toArray();
@@ -135,7 +250,7 @@ Data::Spectrum FluorophoreReader::getSpectrum(const QString& id) const {
 
   QJsonArray emission_wavelength = data["emission_wavelength"].toArray();
   QJsonArray emission_intensity = data["emission_intensity"].toArray();
-  Data::Polygon emission = this->toPolygon(emission_wavelength, emission_intensity);
+  Data::Polygon emission = this->toPolygon(emission_wavelength, emission_intensity, true);
 
   // Set linecolor, cannot use the meta-data shortcut as spectrum doesnt request this info
   emission.setColor();
@@ -159,15 +274,66 @@ Fluorophore CacheSpectrum accessor
   :returns: CacheSpectrum object
 */
 Data::CacheSpectrum FluorophoreReader::getCacheSpectrum(const QString& id, unsigned int index) const {
-  // Retrieve data
-  QJsonObject data_object = this->fluor_data.object();
-  QJsonValueRef data_ref = data_object[id];
+  if (this->fluor_database) {
+    return Data::CacheSpectrum(index, this->getDatabaseSpectrum(id), this->getDatabaseMeta(id));
+  }
 
-  if (data_ref.type() == QJsonValue::Type::Null || data_ref.type() == QJsonValue::Type::Undefined) {
-    qWarning() << "InstrumentReader::getSpectrum: Data::Spectrum object of id" << id << "could not be found.";
+  Data::Meta meta;
+  Data::Spectrum spectrum(id, Data::Polygon(), Data::Polygon());
+  if (this->fluor_index) {
+    spectrum = this->getIndexSpectrum(id, meta);
+  } else {
+    // Retrieve data
+    QJsonObject data = this->fluor_data.object().value(id).toObject();
+    if (data.isEmpty()) {
+      qWarning() << "InstrumentReader::getSpectrum: Data::Spectrum object of id" << id << "could not be found.";
+    }
+    spectrum = FluorophoreReader::toSpectrum(id, data, meta);
+  }
+
+  // Wrap in cache
+  Data::CacheSpectrum cache(index, spectrum, meta);
+  return cache;
+}
+
+/*
+Returns the spectrum of a fluorophore in lazy mode. The fluorophore object is only parsed from the source file upon
+its first request, the decoded spectrum is cached in the index.
+  :param id: the fluorophore id, if id is not in the index, returns valid but otherwise useless data
+  :param meta: (return) the meta data
+  :returns: Spectrum object
+*/
+Data::Spectrum FluorophoreReader::getIndexSpectrum(const QString& id, Data::Meta& meta) const {
+  std::size_t entry = this->fluor_index->find(id);
+  if (entry >= this->fluor_index->size()) {
+    qWarning() << "Data::FluorophoreReader::getIndexSpectrum: Data::Spectrum object of id" << id << "could not be found.";
+    return Data::Spectrum(id, Data::Polygon(), Data::Polygon());
+  }
+
+  Data::Spectrum spectrum(id, Data::Polygon(), Data::Polygon());
+  if (this->fluor_index->cached(entry, spectrum, meta)) {
+    return spectrum;
+  }
+
+  // A read failure is not cached, so it is retried upon the next request
+  QJsonObject data = this->fluor_index->object(entry);
+  if (data.isEmpty()) {
+    return spectrum;
   }
 
-  QJsonObject data = data_ref.toObject();
+  spectrum = FluorophoreReader::toSpectrum(id, data, meta);
+  this->fluor_index->cache(entry, spectrum, meta);
+  return spectrum;
+}
+
+/*
+(Static) Builds a spectrum and its meta data from a fluorophore object
+  :param id: the fluorophore id
+  :param data: the fluorophore object
+  :param meta: (return) the meta data
+  :returns: Spectrum object
+*/
+Data::Spectrum FluorophoreReader::toSpectrum(const QString& id, const QJsonObject& data, Data::Meta& meta) {
   // Load data and transform to Data::Polygon's
   bool is_absorption = false;
   double excitation_max = data["excitation_max"].toDouble(-1);
@@ -181,15 +347,14 @@ Data::CacheSpectrum FluorophoreReader::getCacheSpectrum(const QString& id, unsig
     excitation_wavelength = data["absorption_wavelength"].toArray();
     excitation_intensity = data["absorption_intensity"].toArray();
   }
-  Data::Polygon excitation = this->toPolygon(excitation_wavelength, excitation_intensity);
+  Data::Polygon excitation = FluorophoreReader::toPolygon(excitation_wavelength, excitation_intensity);
 
   double emission_max = data["emission_max"].toDouble(-1);
   QJsonArray emission_wavelength = data["emission_wavelength"].toArray();
   QJsonArray emission_intensity = data["emission_intensity"].toArray();
-  Data::Polygon emission = this->toPolygon(emission_wavelength, emission_intensity);
+  Data::Polygon emission = FluorophoreReader::toPolygon(emission_wavelength, emission_intensity, true);
 
   // Get meta data
-  Data::Meta meta;
   meta.excitation_max = excitation_max;
   meta.emission_max = emission_max;
 
@@ -206,12 +371,89 @@ Data::CacheSpectrum FluorophoreReader::getCacheSpectrum(const QString& id, unsig
   spectrum.setAbsorptionFlag(is_absorption);
 
   if (!spectrum.isValid()) {
-    qWarning() << "Data::FluorophoreReader::getCacheSpectrum: DataSpectrum object of id" << id << "is invalid. Is the data file complete?";
+    qWarning() << "Data::FluorophoreReader::toSpectrum: DataSpectrum object of id" << id << "is invalid. Is the data file complete?";
   }
 
-  // Wrap in cache
-  Data::CacheSpectrum cache(index, spectrum, meta);
-  return cache;
+  return spectrum;
+}
+
+/*
+Builds a spectrum from the compiled spectrum database
+  :param id: the fluorophore id, if id is not in the database, returns valid but otherwise useless data
+  :returns: Spectrum object
+*/
+Data::Spectrum FluorophoreReader::getDatabaseSpectrum(const QString& id) const {
+  std::size_t record = this->fluor_database->find(id);
+  if (record >= this->fluor_database->size()) {
+    qWarning() << "Data::FluorophoreReader::getDatabaseSpectrum: Data::Spectrum object of id" << id << "could not be found.";
+    return Data::Spectrum(id, Data::Polygon(), Data::Polygon());
+  }
+
+  Data::Polygon excitation = this->fluor_database->excitation(record);
+  Data::Polygon emission = this->fluor_database->emission(record);
+
+  // Set linecolor
+  Data::Meta meta = this->fluor_database->meta(record);
+  if (meta.emission_max != -1) {
+    emission.setColor(meta.emission_max);
+  } else {
+    emission.setColor();
+  }
+  excitation.setColor(emission.color());
+
+  Data::Spectrum spectrum(id, excitation, emission);
+  spectrum.setAbsorptionFlag(this->fluor_database->absorptionFlag(record));
+
+  if (!spectrum.isValid()) {
+    qWarning() << "Data::FluorophoreReader::getDatabaseSpectrum: Data::Spectrum object of id" << id << "is invalid. Is the database complete?";
+  }
+
+  return spectrum;
+}
+
+/*
+Builds the spectrum meta data from the compiled spectrum database
+  :param id: the fluorophore id, if id is not in the database, returns default meta data
+  :returns: Meta object
+*/
+Data::Meta FluorophoreReader::getDatabaseMeta(const QString& id) const {
+  std::size_t record = this->fluor_database->find(id);
+  if (record >= this->fluor_database->size()) {
+    return Data::Meta();
+  }
+  return this->fluor_database->meta(record);
+}
+
+/*
+Collects the (valid) spectrum of every fluorophore, multiple names can refer to the same fluorophore. In Lazy mode
+this decodes every spectrum, call it from a job.
+  :param spectra: (return) the spectra, one per fluorophore id
+  :param names: (return) the first name of each spectrum, in name order
+  :param token: (optional) cancellation token, if cancelled the collection stops and the library is incomplete
+*/
+void FluorophoreReader::getLibrary(std::vector<Data::Spectrum>& spectra, QStringList& names, const Data::JobToken& token) const {
+  spectra.clear();
+  names.clear();
+  spectra.reserve(this->fluor_name.size());
+
+  std::unordered_set<QString> ids;
+  for (const QString& name : this->fluor_name) {
+    if (token.isCancelled()) {
+      return;
+    }
+
+    auto id = this->fluor_id.find(name);
+    if (id == this->fluor_id.end() || !ids.insert(id->second).second) {
+      continue;
+    }
+
+    Data::Spectrum spectrum = this->getSpectrum(id->second);
+    if (!spectrum.isValid()) {
+      continue;
+    }
+    spectra.push_back(std::move(spectrum));
+    names.append(name);
+  }
 }
 
 /*
@@ -236,9 +478,10 @@ const std::unordered_map<QString, QStringList>& FluorophoreReader::getFluorNames
 (Static) Convers a QStringList into a Data::Polygon object.
   :param list_x: the list containing the values for the x-axis
   :param list_y: the list containing the values for the y-axis
+  :param cumulative: whether to precompute the cumulative integral table
   :returns: a Data::Polygon object containing the curve
 */
-Data::Polygon FluorophoreReader::toPolygon(const QStringList& list_x, const QStringList& list_y) {
+Data::Polygon FluorophoreReader::toPolygon(const QStringList& list_x, const QStringList& list_y, bool cumulative) {
   if (list_x.size() != list_y.size()) {
     qWarning() << "Fluorophores::toPolygon: x and y stringlist are of unequal size, cannot be parsed, returns default Data::Polygon";
     return Data::Polygon();
@@ -247,39 +490,42 @@ Data::Polygon FluorophoreReader::toPolygon(const QStringList& list_x, const QStr
     qFatal("Fluorophores::toPolygon: x and y values should each consist of a list atleast two values");
   }
 
-  // Reserve enough space, with two additional entrees, which can be used to make a properly closed polygon
-  QPolygonF temp_polygon = QPolygonF();
-  temp_polygon.reserve(list_x.size() + 2);
-  temp_polygon.resize(list_x.size());
-
-  // Get calculation temporaries
-  double x_min = list_x[0].toDouble();
-  double x_max = list_x[list_x.size() - 1].toDouble();
-
-  double y_min = 0.0;
-  double y_max = 100.0;
+  // Temporary single block storage, the x values followed by the y values
+  std::size_t size = static_cast<std::size_t>(list_x.size());
+  std::vector<float> curve(size * 2);
 
-  // Fill temp QPolygonF
   for (int i = 0; i < list_x.size(); ++i) {
-    double x = list_x[i].toDouble();
-    double y = list_y[i].toDouble();
+    std::size_t index = static_cast<std::size_t>(i);
+    curve[index] = list_x[i].toFloat();
+    curve[size + index] = list_y[i].toFloat();
+  }
 
-    // Set QPointF values
-    temp_polygon[i].setX(x);
-    temp_polygon[i].setY(y);
+  // Resample onto the uniform grid, only the grid y values are kept
+  std::shared_ptr<std::vector<float>> grid = std::make_shared<std::vector<float>>();
+  double start = 0.0;
+  double step = 1.0;
+  Data::Polygon::resample(curve.data(), curve.data() + size, list_x.size(), *grid, start, step);
+
+  // The cumulative integral table directly follows the y values
+  int grid_size = static_cast<int>(grid->size());
+  if (cumulative) {
+    grid->resize(grid->size() * 2);
+    Data::Polygon::cumulate(grid->data(), grid_size, step, grid->data() + grid_size);
   }
-  Data::Polygon polygon(x_min, x_max, y_min, y_max, std::move(temp_polygon));
 
-  return polygon;
+  const float* data = grid->data();
+  const float* data_cumulative = cumulative ? data + grid_size : nullptr;
+  return Data::Polygon(std::move(grid), start, step, data, grid_size, data_cumulative);
 }
 
 /*
 (Static) Convers a QJsonArray into a Data::Polygon object.
   :param list_x: the array containing the values for the x-axis
   :param list_y: the array containing the values for the y-axis
+  :param cumulative: whether to precompute the cumulative integral table
   :returns: a Data::Polygon object containing the curve
 */
-Data::Polygon FluorophoreReader::toPolygon(const QJsonArray& list_x, const QJsonArray& list_y) {
+Data::Polygon FluorophoreReader::toPolygon(const QJsonArray& list_x, const QJsonArray& list_y, bool cumulative) {
   if (list_x.size() != list_y.size()) {
     qWarning() << "Fluorophores::toPolygon: x and y QJsonArray's are of unequal size, cannot be parsed, returns default Data::Polygon";
     return Data::Polygon();
@@ -289,30 +535,32 @@ Data::Polygon FluorophoreReader::toPolygon(const QJsonArray& list_x, const QJson
     return Data::Polygon();
   }
 
-  // Reserve enough space, with two additional entrees, which can be used to make a properly closed polygon
-  QPolygonF temp_polygon = QPolygonF();
-  temp_polygon.reserve(list_x.size() + 2);
-  temp_polygon.resize(list_x.size());
-
-  // Get polygon range
-  double x_min = list_x[0].toDouble();
-  double x_max = list_x[list_x.size() - 1].toDouble();
+  // Temporary single block storage, the x values followed by the y values
+  std::size_t size = static_cast<std::size_t>(list_x.size());
+  std::vector<float> curve(size * 2);
 
-  double y_min = 0.0;
-  double y_max = 100.0;
-
-  // Fill temp QPolygonF
   for (int i = 0; i < list_x.size(); ++i) {
-    double x = list_x[i].toDouble();
-    double y = list_y[i].toDouble();
+    std::size_t index = static_cast<std::size_t>(i);
+    curve[index] = static_cast<float>(list_x[i].toDouble());
+    curve[size + index] = static_cast<float>(list_y[i].toDouble());
+  }
 
-    // Set QPointF values
-    temp_polygon[i].setX(x);
-    temp_polygon[i].setY(y);
+  // Resample onto the uniform grid, only the grid y values are kept
+  std::shared_ptr<std::vector<float>> grid = std::make_shared<std::vector<float>>();
+  double start = 0.0;
+  double step = 1.0;
+  Data::Polygon::resample(curve.data(), curve.data() + size, list_x.size(), *grid, start, step);
+
+  // The cumulative integral table directly follows the y values
+  int grid_size = static_cast<int>(grid->size());
+  if (cumulative) {
+    grid->resize(grid->size() * 2);
+    Data::Polygon::cumulate(grid->data(), grid_size, step, grid->data() + grid_size);
   }
-  Data::Polygon polygon(x_min, x_max, y_min, y_max, std::move(temp_polygon));
 
-  return polygon;
+  const float* data = grid->data();
+  const float* data_cumulative = cumulative ? data + grid_size : nullptr;
+  return Data::Polygon(std::move(grid), start, step, data, grid_size, data_cumulative);
 }
 
 /*
@@ -11,6 +11,7 @@
 #include <QDebug>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <algorithm>
 #include <memory>
 
 namespace Data {
@@ -342,8 +343,14 @@ Instrument InstrumentReader::getInstrument(const QString& id) const {
     QJsonObject data_laserline = laserlines[i].toObject();
     QJsonArray data_lasers = data_laserline["lasers"].toArray();
     QJsonArray data_filters = data_laserline["filters"].toArray();
+    QJsonArray data_channels = data_laserline["channels"].toArray();
 
-    optics.push_back(LaserLine(static_cast<std::size_t>(data_lasers.size()), static_cast<std::size_t>(data_filters.size())));
+    std::size_t filter_count = static_cast<std::size_t>(data_filters.size());
+    for (int j = 0; j < data_channels.size(); ++j) {
+      filter_count += static_cast<std::size_t>(std::max(0, data_channels[j].toObject()["count"].toInt(0)));
+    }
+
+    optics.push_back(LaserLine(static_cast<std::size_t>(data_lasers.size()), filter_count));
 
     for (int j = 0; j < data_lasers.size(); ++j) {
       QJsonObject data_laser = data_lasers[j].toObject();
@@ -367,6 +374,9 @@ Instrument InstrumentReader::getInstrument(const QString& id) const {
             Filter(Filter::ShortPass, data_filter["wavelength"].toDouble(0.0), 0.0, data_filter["name"].toString("")));
       }
     }
+    for (int j = 0; j < data_channels.size(); ++j) {
+      InstrumentReader::addChannels(optics[static_cast<std::size_t>(i)], data_channels[j].toObject());
+    }
   }
 
   // Check if the instrument is valid, if not, generate warning
@@ -380,6 +390,33 @@ Instrument InstrumentReader::getInstrument(const QString& id) const {
   return instrument;
 }
 
+/*
+(Static) Adds a range of contiguous spectral channels to a laserline. The range is split into count equally wide
+band pass filters, named by the prefix and their channel number. Example: {"name":"V","start":420,"end":828,"count":48}
+The optional "first" is the number of the first channel (default 1), for a laserline that declares multiple ranges
+with one prefix, e.g. a detector array with a gap: {"name":"V","start":600,"end":828,"count":24,"first":25}
+  :param laserline: the laserline to add the filters to
+  :param data_channels: the json channel range object
+*/
+void InstrumentReader::addChannels(LaserLine& laserline, const QJsonObject& data_channels) {
+  QString prefix = data_channels["name"].toString("");
+  double start = data_channels["start"].toDouble(0.0);
+  double end = data_channels["end"].toDouble(0.0);
+  int count = data_channels["count"].toInt(0);
+  int first = data_channels["first"].toInt(1);
+
+  if (count <= 0 || end <= start) {
+    qWarning() << "InstrumentReader::addChannels: invalid channel range" << prefix << start << end << count;
+    return;
+  }
+
+  double width = (end - start) / static_cast<double>(count);
+  for (int k = 0; k < count; ++k) {
+    double center = start + (static_cast<double>(k) + 0.5) * width;
+    laserline.filters().push_back(Filter(Filter::BandPass, center, width, prefix + QString::number(first + k)));
+  }
+}
+
 /*
 Getter for the list of instrument id's
 */
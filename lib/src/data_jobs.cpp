@@ -0,0 +1,345 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_jobs.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <algorithm>
+#include <deque>
+#include <utility>
+
+#include "data_trace.h"
+
+namespace Data {
+
+namespace {
+
+// The job system and queue index of the worker running on this thread
+thread_local const JobSystem* worker_system = nullptr;
+thread_local std::size_t worker_index = 0;
+
+}  // namespace
+
+/*
+Constructor: constructs a token that is only cancelled by cancel()
+*/
+JobToken::JobToken() : token_cancelled(std::make_shared<std::atomic<bool>>(false)), token_current(nullptr), token_generation(0) {}
+
+/*
+Cancels the token (and all its copies), can be called from any thread
+*/
+void JobToken::cancel() { *this->token_cancelled = true; }
+
+/*
+Whether the token is cancelled or superseded by a newer generation, can be called from any thread
+*/
+bool JobToken::isCancelled() const {
+  return *this->token_cancelled || (this->token_current && *this->token_current != this->token_generation);
+}
+
+/*
+Getter for the generation of the token, 0 if not handed out by a JobGeneration
+*/
+std::uint64_t JobToken::generation() const { return this->token_generation; }
+
+/*
+Constructor: constructs a generation counter without handed out tokens
+*/
+JobGeneration::JobGeneration() : generation_current(std::make_shared<std::atomic<std::uint64_t>>(0)) {}
+
+/*
+Destructor: cancels all handed out tokens
+*/
+JobGeneration::~JobGeneration() { this->cancel(); }
+
+/*
+Hands out the token of the next generation, this cancels all previously handed out tokens
+  :returns: the new token
+*/
+JobToken JobGeneration::next() {
+  JobToken token;
+  token.token_generation = ++*this->generation_current;
+  token.token_current = this->generation_current;
+  return token;
+}
+
+/*
+Cancels all handed out tokens
+*/
+void JobGeneration::cancel() { ++*this->generation_current; }
+
+/*
+Getter for the current generation
+*/
+std::uint64_t JobGeneration::current() const { return *this->generation_current; }
+
+/*
+The jobs of a single worker, a deque per priority
+*/
+struct JobSystem::Queue {
+  std::mutex mutex;
+  std::deque<JobSystem::Job> jobs[3];
+};
+
+/*
+Constructor: starts the workers
+  :param threads: the amount of workers
+*/
+JobSystem::JobSystem(std::size_t threads)
+    : queues(), workers(), submit_next(0), sleep_mutex(), sleep_condition(), pending(0), stopping(false) {
+  threads = std::max<std::size_t>(1, threads);
+  for (std::size_t i = 0; i < threads; ++i) {
+    this->queues.push_back(std::unique_ptr<JobSystem::Queue>(new JobSystem::Queue()));
+  }
+  for (std::size_t i = 0; i < threads; ++i) {
+    this->workers.emplace_back(&JobSystem::work, this, i);
+  }
+}
+
+/*
+Destructor: stops the workers after their current job, the queued jobs are dropped
+*/
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(this->sleep_mutex);
+    this->stopping = true;
+  }
+  this->sleep_condition.notify_all();
+
+  for (std::thread& worker : this->workers) {
+    worker.join();
+  }
+}
+
+/*
+The shared job system, with a worker per (logical) core. Constructed upon first use and never destructed, joining
+threads during static destruction can deadlock (on Windows while unloading the library). The workers sleep when idle.
+*/
+JobSystem& JobSystem::instance() {
+  static JobSystem* system = new JobSystem(static_cast<std::size_t>(std::max(1, QThread::idealThreadCount())));
+  return *system;
+}
+
+/*
+Worker loop: runs jobs until the system stops, sleeps while no jobs are queued
+  :param index: the index of the worker's own queue
+*/
+void JobSystem::work(std::size_t index) {
+  worker_system = this;
+  worker_index = index;
+  DATA_TRACE_THREAD(QString("Worker %1").arg(index));
+
+  JobSystem::Job job;
+  while (true) {
+    if (this->take(index, job)) {
+      if (!job.token.isCancelled()) {
+        job.function();
+      }
+      // Release the captures before sleeping
+      job = JobSystem::Job();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(this->sleep_mutex);
+    this->sleep_condition.wait(lock, [this]() { return this->stopping || this->pending > 0; });
+    if (this->stopping) {
+      return;
+    }
+  }
+}
+
+/*
+Takes the next job, higher priorities first. Per priority the newest job of the own queue is taken, otherwise the
+oldest job of another queue is stolen.
+  :param index: the own queue
+  :param job: (out) the job
+  :returns: whether a job was taken
+*/
+bool JobSystem::take(std::size_t index, JobSystem::Job& job) {
+  const std::size_t count = this->queues.size();
+
+  for (std::size_t priority = JobSystem::High; priority <= JobSystem::Low; ++priority) {
+    {
+      JobSystem::Queue& queue = *this->queues[index];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.jobs[priority].empty()) {
+        job = std::move(queue.jobs[priority].back());
+        queue.jobs[priority].pop_back();
+        --this->pending;
+        return true;
+      }
+    }
+
+    for (std::size_t i = 1; i < count; ++i) {
+      JobSystem::Queue& queue = *this->queues[(index + i) % count];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.jobs[priority].empty()) {
+        job = std::move(queue.jobs[priority].front());
+        queue.jobs[priority].pop_front();
+        --this->pending;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/*
+Queues a job, can be called from any thread. Jobs submitted by a worker are queued to that worker, other
+submissions are distributed round robin.
+  :param function: the job
+  :param priority: the priority
+  :param token: the cancellation token, the job is dropped if cancelled before it starts
+*/
+void JobSystem::submit(std::function<void()> function, JobSystem::Priority priority, const JobToken& token) {
+  if (token.isCancelled()) {
+    return;
+  }
+
+  std::size_t index = worker_system == this ? worker_index : this->submit_next++ % this->queues.size();
+  {
+    JobSystem::Queue& queue = *this->queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs[priority].push_back(JobSystem::Job{std::move(function), token});
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->sleep_mutex);
+    ++this->pending;
+  }
+  this->sleep_condition.notify_one();
+}
+
+/*
+Getter for the amount of workers
+*/
+std::size_t JobSystem::threadCount() const { return this->workers.size(); }
+
+/*
+Constructor: constructs a receiver for results of jobs, construct on the GUI thread
+  :param receiver: the receiving object, has to live on the GUI thread
+*/
+JobReceiver::JobReceiver(QObject* receiver) : receiver(receiver) {}
+
+/*
+Runs function on the GUI thread, if by then the receiver still exists and the token is not cancelled. Can be called
+from any thread.
+  :param function: the function, usually hands a result to the receiver
+  :param token: the token of the job
+*/
+void JobReceiver::post(std::function<void()> function, const JobToken& token) const {
+  QCoreApplication* application = QCoreApplication::instance();
+  if (!application) {
+    return;
+  }
+
+  QPointer<QObject> receiver = this->receiver;
+  QMetaObject::invokeMethod(
+      application,
+      [receiver, function, token]() {
+        if (receiver && !token.isCancelled()) {
+          function();
+        }
+      },
+      Qt::QueuedConnection);
+}
+
+/*
+Constructor: constructs an empty group
+*/
+JobGroup::JobGroup() : group_mutex(), group_condition(), group_running(0) {}
+
+/*
+Destructor: waits for all jobs of the group to finish
+*/
+JobGroup::~JobGroup() { this->wait(); }
+
+/*
+Submits a job to the JobSystem as part of the group. The token is checked by the group itself, so a dropped job is
+still counted as finished.
+  :param function: the job
+  :param priority: the job priority
+  :param token: (optional) cancellation token, the job is dropped if cancelled before it starts
+*/
+void JobGroup::submit(std::function<void()> function, JobSystem::Priority priority, const JobToken& token) {
+  if (token.isCancelled()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->group_mutex);
+    ++this->group_running;
+  }
+
+  JobSystem::instance().submit(
+      [this, function = std::move(function), token]() {
+        if (!token.isCancelled()) {
+          function();
+        }
+        this->finish();
+      },
+      priority);
+}
+
+/*
+Marks a job of the group as finished, notifies while locked as the group can be destroyed as soon as the waiter wakes
+*/
+void JobGroup::finish() {
+  std::lock_guard<std::mutex> lock(this->group_mutex);
+  --this->group_running;
+  this->group_condition.notify_all();
+}
+
+/*
+Blocks until all jobs of the group have finished. Do not call from within a job of the group.
+*/
+void JobGroup::wait() {
+  std::unique_lock<std::mutex> lock(this->group_mutex);
+  this->group_condition.wait(lock, [this]() { return this->group_running == 0; });
+}
+
+/*
+Constructor: constructs a progress of 0 without report callback
+*/
+JobProgress::JobProgress() : progress_permille(0), progress_report(nullptr) {}
+
+/*
+Resets the progress to 0, call before the job starts changing the progress
+  :param report: (optional) called upon every change of the progress with the progress (0.0-1.0), has to be thread-safe
+*/
+void JobProgress::reset(std::function<void(double)> report) {
+  this->progress_report = std::move(report);
+  this->progress_permille = 0;
+}
+
+/*
+Sets the progress, reports the progress if it increased. Can be called from any thread, the progress never decreases
+(until reset) so workers can set their progress out of order.
+  :param permille: the progress in permille (0-1000)
+*/
+void JobProgress::set(int permille) {
+  int previous = this->progress_permille;
+  while (previous < permille && !this->progress_permille.compare_exchange_weak(previous, permille)) {
+  }
+  if (previous < permille && this->progress_report) {
+    this->progress_report(static_cast<double>(permille) * 0.001);
+  }
+}
+
+/*
+Getter for the progress in permille, can be called from any thread
+*/
+int JobProgress::permille() const { return this->progress_permille; }
+
+/*
+Getter for the progress, can be called from any thread
+  :returns: progress (0.0-1.0)
+*/
+double JobProgress::value() const { return static_cast<double>(this->progress_permille) * 0.001; }
+
+}  // namespace Data
@@ -0,0 +1,1262 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DATA_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace Data {
+namespace Kernel {
+
+namespace {
+
+/*
+Parameters of a uniform grid curve, precalculated once per kernel call
+*/
+struct Grid {
+  const float* y;
+  int size;
+  double start;
+  double step_inverse;
+  double x_min;
+  double x_max;
+  double cutoff;
+};
+
+/*
+Scalar sampleGrid kernel, mirrors Data::Polygon::intensityAt
+  :param grid: the curve
+  :param wavelengths: the wavelengths to evaluate
+  :param intensities: (return) the intensities
+  :param begin: first index to evaluate
+  :param end: one past the last index to evaluate
+*/
+void sampleGridScalar(const Grid& grid, const double* wavelengths, double* intensities, std::size_t begin, std::size_t end) {
+  for (std::size_t i = begin; i < end; ++i) {
+    double wavelength = wavelengths[i];
+    if (!(wavelength >= grid.x_min && wavelength <= grid.x_max)) {
+      intensities[i] = 0.0;
+      continue;
+    }
+
+    double position = (wavelength - grid.start) * grid.step_inverse;
+    int index = std::min(static_cast<int>(position), grid.size - 1);
+    int next = std::min(index + 1, grid.size - 1);
+    double fraction = position - index;
+
+    double intensity_index = static_cast<double>(grid.y[index]);
+    double intensity_next = static_cast<double>(grid.y[next]);
+    double intensity = intensity_index + (intensity_next - intensity_index) * fraction;
+
+    intensities[i] = intensity <= grid.cutoff ? 0.0 : intensity;
+  }
+}
+
+/*
+Parameters of an affine curve transform, precalculated once per kernel call
+*/
+struct Affine {
+  const float* y;
+  double x_origin;
+  double x_step;
+  double x_left;
+  double x_right;
+  double y_slope;
+  double y_intercept;
+  double y_top;
+  double y_bottom;
+};
+
+/*
+Scalar affineCurve kernel. The clamps are written as the SSE2/AVX2 max/min, so all variants produce identical points.
+  :param affine: the transform
+  :param points: (return) the interleaved x, y coordinates
+  :param begin: first point to transform
+  :param end: one past the last point to transform
+*/
+void affineCurveScalar(const Affine& affine, double* points, std::size_t begin, std::size_t end) {
+  for (std::size_t i = begin; i < end; ++i) {
+    double y = static_cast<double>(affine.y[i]) * affine.y_slope + affine.y_intercept;
+    y = y > affine.y_top ? y : affine.y_top;
+    y = y < affine.y_bottom ? y : affine.y_bottom;
+
+    double x = affine.x_origin + affine.x_step * static_cast<double>(i);
+    x = x > affine.x_left ? x : affine.x_left;
+    x = x < affine.x_right ? x : affine.x_right;
+
+    points[2 * i] = x;
+    points[2 * i + 1] = y;
+  }
+}
+
+/*
+Parameters of a 2D binning grid, precalculated once per kernel call. All variants use the same float operations.
+*/
+struct Bins {
+  const float* x;
+  const float* y;  // nullptr for a 1D grid
+  float x_offset;
+  float x_scale;
+  float y_offset;
+  float y_scale;
+  float columns;
+  float rows;
+  std::uint32_t column_count;
+  std::uint32_t outside;  // the index of events outside the grid
+};
+
+/*
+Scalar binIndices kernel
+  :param bins: the grid
+  :param indices: (return) the bin indices
+  :param begin: first event to bin
+  :param end: one past the last event to bin
+*/
+void binIndicesScalar(const Bins& bins, std::uint32_t* indices, std::size_t begin, std::size_t end) {
+  for (std::size_t i = begin; i < end; ++i) {
+    float column = (bins.x[i] - bins.x_offset) * bins.x_scale;
+    float row = bins.y != nullptr ? (bins.y[i] - bins.y_offset) * bins.y_scale : 0.0f;
+    if (!(column >= 0.0f && column < bins.columns && row >= 0.0f && row < bins.rows)) {
+      indices[i] = bins.outside;
+      continue;
+    }
+    indices[i] = static_cast<std::uint32_t>(row) * bins.column_count + static_cast<std::uint32_t>(column);
+  }
+}
+
+/*
+Parameters of an ascending search table, precalculated once per kernel call
+*/
+struct Table {
+  const float* entries;
+  std::uint32_t size;
+  std::uint32_t last;
+};
+
+/*
+Scalar lowerBound kernel. A branchless binary search: the amount of steps only depends on the table size, so every
+value takes the same path as the SSE2/AVX2 lanes.
+  :param table: the table
+  :param values: the values to search
+  :param indices: (return) the indices
+  :param begin: first value to search
+  :param end: one past the last value to search
+*/
+void lowerBoundScalar(const Table& table, const float* values, std::uint32_t* indices, std::size_t begin, std::size_t end) {
+  for (std::size_t i = begin; i < end; ++i) {
+    const float value = values[i];
+    std::uint32_t base = 0;
+    for (std::uint32_t n = table.size; n > 1; n -= n / 2) {
+      base += table.entries[base + n / 2] < value ? n / 2 : 0;
+    }
+    base += table.entries[base] < value ? 1 : 0;
+    indices[i] = std::min(base, table.last);
+  }
+}
+
+/*
+Polynomial coefficients (cephes logf, sinf and cosf) of the Box-Muller transform. All instruction set variants evaluate
+them in the same order without fused multiply-add, so they produce bitwise identical values.
+*/
+const float log_coefficients[9] = {7.0376836292e-2f,  -1.1514610310e-1f, 1.1676998740e-1f,  -1.2420140846e-1f, 1.4249322787e-1f,
+                                   -1.6668057665e-1f, 2.0000714765e-1f,  -2.4999993993e-1f, 3.3333331174e-1f};
+const float log_q1 = -2.12194440e-4f;
+const float log_q2 = 0.693359375f;
+const float sqrt_half = 0.707106781186547524f;
+const float sin_coefficients[3] = {-1.9515295891e-4f, 8.3321608736e-3f, -1.6666654611e-1f};
+const float cos_coefficients[3] = {2.443315711809948e-5f, -1.388731625493765e-3f, 4.166664568298827e-2f};
+const float half_pi = 1.57079632679489662f;
+const float random_scale = 5.9604644775390625e-8f;  // 2^-24
+
+#ifdef DATA_KERNEL_X86
+
+/*
+SSE2 sampleGrid kernel, two wavelengths per iteration. SSE2 has no gather, so the grid loads are scalar.
+*/
+__attribute__((target("sse2"))) void sampleGridSSE2(const Grid& grid, const double* wavelengths, double* intensities, std::size_t count) {
+  const __m128d v_start = _mm_set1_pd(grid.start);
+  const __m128d v_inverse = _mm_set1_pd(grid.step_inverse);
+  const __m128d v_min = _mm_set1_pd(grid.x_min);
+  const __m128d v_max = _mm_set1_pd(grid.x_max);
+  const __m128d v_zero = _mm_setzero_pd();
+  const __m128d v_last = _mm_set1_pd(static_cast<double>(grid.size - 1));
+  const __m128d v_cutoff = _mm_set1_pd(grid.cutoff);
+
+  std::size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m128d wavelength = _mm_loadu_pd(wavelengths + i);
+    __m128d position = _mm_mul_pd(_mm_sub_pd(wavelength, v_start), v_inverse);
+    position = _mm_min_pd(_mm_max_pd(position, v_zero), v_last);
+
+    __m128i index = _mm_cvttpd_epi32(position);
+    int index_0 = _mm_cvtsi128_si32(index);
+    int index_1 = _mm_cvtsi128_si32(_mm_shuffle_epi32(index, 0x01));
+    int next_0 = std::min(index_0 + 1, grid.size - 1);
+    int next_1 = std::min(index_1 + 1, grid.size - 1);
+
+    __m128d fraction = _mm_sub_pd(position, _mm_cvtepi32_pd(index));
+    __m128d left = _mm_set_pd(static_cast<double>(grid.y[index_1]), static_cast<double>(grid.y[index_0]));
+    __m128d right = _mm_set_pd(static_cast<double>(grid.y[next_1]), static_cast<double>(grid.y[next_0]));
+    __m128d intensity = _mm_add_pd(left, _mm_mul_pd(_mm_sub_pd(right, left), fraction));
+
+    __m128d mask = _mm_and_pd(_mm_cmpge_pd(wavelength, v_min), _mm_cmple_pd(wavelength, v_max));
+    mask = _mm_and_pd(mask, _mm_cmpgt_pd(intensity, v_cutoff));
+    _mm_storeu_pd(intensities + i, _mm_and_pd(intensity, mask));
+  }
+
+  sampleGridScalar(grid, wavelengths, intensities, i, count);
+}
+
+/*
+AVX2 sampleGrid kernel, four wavelengths per iteration with gathered grid loads
+*/
+__attribute__((target("avx2"))) void sampleGridAVX2(const Grid& grid, const double* wavelengths, double* intensities, std::size_t count) {
+  const __m256d v_start = _mm256_set1_pd(grid.start);
+  const __m256d v_inverse = _mm256_set1_pd(grid.step_inverse);
+  const __m256d v_min = _mm256_set1_pd(grid.x_min);
+  const __m256d v_max = _mm256_set1_pd(grid.x_max);
+  const __m256d v_zero = _mm256_setzero_pd();
+  const __m256d v_last = _mm256_set1_pd(static_cast<double>(grid.size - 1));
+  const __m256d v_cutoff = _mm256_set1_pd(grid.cutoff);
+  const __m128i v_last_index = _mm_set1_epi32(grid.size - 1);
+  const __m128i v_one = _mm_set1_epi32(1);
+
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256d wavelength = _mm256_loadu_pd(wavelengths + i);
+    __m256d position = _mm256_mul_pd(_mm256_sub_pd(wavelength, v_start), v_inverse);
+    // Clamping keeps the gather in bounds, out of range lanes are masked below
+    position = _mm256_min_pd(_mm256_max_pd(position, v_zero), v_last);
+
+    __m128i index = _mm256_cvttpd_epi32(position);
+    __m128i next = _mm_min_epi32(_mm_add_epi32(index, v_one), v_last_index);
+
+    __m256d fraction = _mm256_sub_pd(position, _mm256_cvtepi32_pd(index));
+    __m256d left = _mm256_cvtps_pd(_mm_i32gather_ps(grid.y, index, 4));
+    __m256d right = _mm256_cvtps_pd(_mm_i32gather_ps(grid.y, next, 4));
+    __m256d intensity = _mm256_add_pd(left, _mm256_mul_pd(_mm256_sub_pd(right, left), fraction));
+
+    __m256d mask = _mm256_and_pd(_mm256_cmp_pd(wavelength, v_min, _CMP_GE_OQ), _mm256_cmp_pd(wavelength, v_max, _CMP_LE_OQ));
+    mask = _mm256_and_pd(mask, _mm256_cmp_pd(intensity, v_cutoff, _CMP_GT_OQ));
+    _mm256_storeu_pd(intensities + i, _mm256_and_pd(intensity, mask));
+  }
+
+  sampleGridScalar(grid, wavelengths, intensities, i, count);
+}
+
+/*
+SSE2 dot product kernel, four floats per iteration
+*/
+__attribute__((target("sse2"))) float dotSSE2(const float* left, const float* right, std::size_t count) {
+  __m128 sum = _mm_setzero_ps();
+
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(left + i), _mm_loadu_ps(right + i)));
+  }
+
+  // Horizontal sum
+  __m128 shuffle = _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(2, 3, 0, 1));
+  sum = _mm_add_ps(sum, shuffle);
+  shuffle = _mm_movehl_ps(shuffle, sum);
+  sum = _mm_add_ss(sum, shuffle);
+  float result = _mm_cvtss_f32(sum);
+
+  for (; i < count; ++i) {
+    result += left[i] * right[i];
+  }
+  return result;
+}
+
+/*
+AVX2 dot product kernel, sixteen floats per iteration in two independent accumulators
+*/
+__attribute__((target("avx2"))) float dotAVX2(const float* left, const float* right, std::size_t count) {
+  __m256 sum_0 = _mm256_setzero_ps();
+  __m256 sum_1 = _mm256_setzero_ps();
+
+  std::size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    sum_0 = _mm256_add_ps(sum_0, _mm256_mul_ps(_mm256_loadu_ps(left + i), _mm256_loadu_ps(right + i)));
+    sum_1 = _mm256_add_ps(sum_1, _mm256_mul_ps(_mm256_loadu_ps(left + i + 8), _mm256_loadu_ps(right + i + 8)));
+  }
+  for (; i + 8 <= count; i += 8) {
+    sum_0 = _mm256_add_ps(sum_0, _mm256_mul_ps(_mm256_loadu_ps(left + i), _mm256_loadu_ps(right + i)));
+  }
+  __m256 sum = _mm256_add_ps(sum_0, sum_1);
+
+  // Horizontal sum
+  __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+  half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+  half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 0x01));
+  float result = _mm_cvtss_f32(half);
+
+  for (; i < count; ++i) {
+    result += left[i] * right[i];
+  }
+  return result;
+}
+
+__attribute__((target("sse2"))) void dotRowsSSE2(const float* matrix, std::size_t rows, std::size_t stride, const float* vector,
+                                                 std::size_t count, float* results) {
+  for (std::size_t row = 0; row < rows; ++row) {
+    results[row] = dotSSE2(matrix + row * stride, vector, count);
+  }
+}
+
+__attribute__((target("avx2"))) void dotRowsAVX2(const float* matrix, std::size_t rows, std::size_t stride, const float* vector,
+                                                 std::size_t count, float* results) {
+  for (std::size_t row = 0; row < rows; ++row) {
+    results[row] = dotAVX2(matrix + row * stride, vector, count);
+  }
+}
+
+/*
+SSE2 binIndices kernel, four events per iteration. SSE2 has no 32 bit multiply, the index is combined in float which is
+exact below 2^24 bins.
+*/
+__attribute__((target("sse2"))) void binIndicesSSE2(const Bins& bins, std::uint32_t* indices, std::size_t count) {
+  const __m128 v_x_offset = _mm_set1_ps(bins.x_offset);
+  const __m128 v_x_scale = _mm_set1_ps(bins.x_scale);
+  const __m128 v_y_offset = _mm_set1_ps(bins.y_offset);
+  const __m128 v_y_scale = _mm_set1_ps(bins.y_scale);
+  const __m128 v_columns = _mm_set1_ps(bins.columns);
+  const __m128 v_rows = _mm_set1_ps(bins.rows);
+  const __m128 v_zero = _mm_setzero_ps();
+  const __m128i v_outside = _mm_set1_epi32(static_cast<int>(bins.outside));
+
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 column = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(bins.x + i), v_x_offset), v_x_scale);
+    __m128 row = bins.y != nullptr ? _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(bins.y + i), v_y_offset), v_y_scale) : v_zero;
+
+    // Ordered compares, so NaN is outside
+    __m128 inside = _mm_and_ps(_mm_cmpge_ps(column, v_zero), _mm_cmplt_ps(column, v_columns));
+    inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(row, v_zero), _mm_cmplt_ps(row, v_rows)));
+
+    __m128 index = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(row)), v_columns), _mm_cvtepi32_ps(_mm_cvttps_epi32(column)));
+    __m128i mask = _mm_castps_si128(inside);
+    __m128i result = _mm_or_si128(_mm_and_si128(mask, _mm_cvttps_epi32(index)), _mm_andnot_si128(mask, v_outside));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(indices + i), result);
+  }
+
+  binIndicesScalar(bins, indices, i, count);
+}
+
+/*
+AVX2 binIndices kernel, eight events per iteration
+*/
+__attribute__((target("avx2"))) void binIndicesAVX2(const Bins& bins, std::uint32_t* indices, std::size_t count) {
+  const __m256 v_x_offset = _mm256_set1_ps(bins.x_offset);
+  const __m256 v_x_scale = _mm256_set1_ps(bins.x_scale);
+  const __m256 v_y_offset = _mm256_set1_ps(bins.y_offset);
+  const __m256 v_y_scale = _mm256_set1_ps(bins.y_scale);
+  const __m256 v_columns = _mm256_set1_ps(bins.columns);
+  const __m256 v_rows = _mm256_set1_ps(bins.rows);
+  const __m256 v_zero = _mm256_setzero_ps();
+  const __m256i v_column_count = _mm256_set1_epi32(static_cast<int>(bins.column_count));
+  const __m256i v_outside = _mm256_set1_epi32(static_cast<int>(bins.outside));
+
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 column = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(bins.x + i), v_x_offset), v_x_scale);
+    __m256 row = bins.y != nullptr ? _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(bins.y + i), v_y_offset), v_y_scale) : v_zero;
+
+    // Ordered, non-signalling compares, so NaN is outside
+    __m256 inside = _mm256_and_ps(_mm256_cmp_ps(column, v_zero, _CMP_GE_OQ), _mm256_cmp_ps(column, v_columns, _CMP_LT_OQ));
+    inside = _mm256_and_ps(inside, _mm256_and_ps(_mm256_cmp_ps(row, v_zero, _CMP_GE_OQ), _mm256_cmp_ps(row, v_rows, _CMP_LT_OQ)));
+
+    __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_cvttps_epi32(row), v_column_count), _mm256_cvttps_epi32(column));
+    __m256i result = _mm256_blendv_epi8(v_outside, index, _mm256_castps_si256(inside));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(indices + i), result);
+  }
+
+  binIndicesScalar(bins, indices, i, count);
+}
+
+/*
+SSE2 lowerBound kernel, four values per iteration. SSE2 has no gather, so the table loads are scalar.
+*/
+__attribute__((target("sse2"))) void lowerBoundSSE2(const Table& table, const float* values, std::uint32_t* indices, std::size_t count) {
+  const __m128i v_size = _mm_set1_epi32(static_cast<int>(table.size));
+
+  alignas(16) std::uint32_t base[4];
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128 value = _mm_loadu_ps(values + i);
+    __m128i v_base = _mm_setzero_si128();
+
+    for (std::uint32_t n = table.size; n > 1; n -= n / 2) {
+      const std::uint32_t half = n / 2;
+      _mm_store_si128(reinterpret_cast<__m128i*>(base), v_base);
+      __m128 entry = _mm_set_ps(table.entries[base[3] + half], table.entries[base[2] + half], table.entries[base[1] + half],
+                                table.entries[base[0] + half]);
+      __m128i less = _mm_castps_si128(_mm_cmplt_ps(entry, value));
+      v_base = _mm_add_epi32(v_base, _mm_and_si128(less, _mm_set1_epi32(static_cast<int>(half))));
+    }
+
+    _mm_store_si128(reinterpret_cast<__m128i*>(base), v_base);
+    __m128 entry = _mm_set_ps(table.entries[base[3]], table.entries[base[2]], table.entries[base[1]], table.entries[base[0]]);
+    // The mask is -1 for a lane below the value, past the end lanes are pulled back onto the last entry
+    v_base = _mm_sub_epi32(v_base, _mm_castps_si128(_mm_cmplt_ps(entry, value)));
+    v_base = _mm_add_epi32(v_base, _mm_cmpeq_epi32(v_base, v_size));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(indices + i), v_base);
+  }
+
+  lowerBoundScalar(table, values, indices, i, count);
+}
+
+/*
+AVX2 lowerBound kernel, eight values per iteration with gathered table loads
+*/
+__attribute__((target("avx2"))) void lowerBoundAVX2(const Table& table, const float* values, std::uint32_t* indices, std::size_t count) {
+  const __m256i v_size = _mm256_set1_epi32(static_cast<int>(table.size));
+
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256 value = _mm256_loadu_ps(values + i);
+    __m256i v_base = _mm256_setzero_si256();
+
+    for (std::uint32_t n = table.size; n > 1; n -= n / 2) {
+      const __m256i v_half = _mm256_set1_epi32(static_cast<int>(n / 2));
+      __m256 entry = _mm256_i32gather_ps(table.entries, _mm256_add_epi32(v_base, v_half), 4);
+      __m256i less = _mm256_castps_si256(_mm256_cmp_ps(entry, value, _CMP_LT_OQ));
+      v_base = _mm256_add_epi32(v_base, _mm256_and_si256(less, v_half));
+    }
+
+    __m256 entry = _mm256_i32gather_ps(table.entries, v_base, 4);
+    v_base = _mm256_sub_epi32(v_base, _mm256_castps_si256(_mm256_cmp_ps(entry, value, _CMP_LT_OQ)));
+    v_base = _mm256_add_epi32(v_base, _mm256_cmpeq_epi32(v_base, v_size));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(indices + i), v_base);
+  }
+
+  lowerBoundScalar(table, values, indices, i, count);
+}
+
+/*
+SSE2 affineCurve kernel, four points per iteration
+*/
+__attribute__((target("sse2"))) void affineCurveSSE2(const Affine& affine, double* points, std::size_t count) {
+  const __m128d v_x_origin = _mm_set1_pd(affine.x_origin);
+  const __m128d v_x_step = _mm_set1_pd(affine.x_step);
+  const __m128d v_x_left = _mm_set1_pd(affine.x_left);
+  const __m128d v_x_right = _mm_set1_pd(affine.x_right);
+  const __m128d v_y_slope = _mm_set1_pd(affine.y_slope);
+  const __m128d v_y_intercept = _mm_set1_pd(affine.y_intercept);
+  const __m128d v_y_top = _mm_set1_pd(affine.y_top);
+  const __m128d v_y_bottom = _mm_set1_pd(affine.y_bottom);
+  const __m128d v_two = _mm_set1_pd(2.0);
+  const __m128d v_four = _mm_set1_pd(4.0);
+  __m128d v_index = _mm_set_pd(1.0, 0.0);
+
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 source = _mm_loadu_ps(affine.y + i);
+    __m128d y_low = _mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(source), v_y_slope), v_y_intercept);
+    __m128d y_high = _mm_add_pd(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(source, source)), v_y_slope), v_y_intercept);
+    y_low = _mm_min_pd(_mm_max_pd(y_low, v_y_top), v_y_bottom);
+    y_high = _mm_min_pd(_mm_max_pd(y_high, v_y_top), v_y_bottom);
+
+    __m128d x_low = _mm_add_pd(v_x_origin, _mm_mul_pd(v_x_step, v_index));
+    __m128d x_high = _mm_add_pd(v_x_origin, _mm_mul_pd(v_x_step, _mm_add_pd(v_index, v_two)));
+    x_low = _mm_min_pd(_mm_max_pd(x_low, v_x_left), v_x_right);
+    x_high = _mm_min_pd(_mm_max_pd(x_high, v_x_left), v_x_right);
+    v_index = _mm_add_pd(v_index, v_four);
+
+    _mm_storeu_pd(points + 2 * i, _mm_unpacklo_pd(x_low, y_low));
+    _mm_storeu_pd(points + 2 * i + 2, _mm_unpackhi_pd(x_low, y_low));
+    _mm_storeu_pd(points + 2 * i + 4, _mm_unpacklo_pd(x_high, y_high));
+    _mm_storeu_pd(points + 2 * i + 6, _mm_unpackhi_pd(x_high, y_high));
+  }
+
+  affineCurveScalar(affine, points, i, count);
+}
+
+/*
+AVX2 affineCurve kernel, four points per iteration
+*/
+__attribute__((target("avx2"))) void affineCurveAVX2(const Affine& affine, double* points, std::size_t count) {
+  const __m256d v_x_origin = _mm256_set1_pd(affine.x_origin);
+  const __m256d v_x_step = _mm256_set1_pd(affine.x_step);
+  const __m256d v_x_left = _mm256_set1_pd(affine.x_left);
+  const __m256d v_x_right = _mm256_set1_pd(affine.x_right);
+  const __m256d v_y_slope = _mm256_set1_pd(affine.y_slope);
+  const __m256d v_y_intercept = _mm256_set1_pd(affine.y_intercept);
+  const __m256d v_y_top = _mm256_set1_pd(affine.y_top);
+  const __m256d v_y_bottom = _mm256_set1_pd(affine.y_bottom);
+  const __m256d v_four = _mm256_set1_pd(4.0);
+  __m256d v_index = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256d y = _mm256_add_pd(_mm256_mul_pd(_mm256_cvtps_pd(_mm_loadu_ps(affine.y + i)), v_y_slope), v_y_intercept);
+    y = _mm256_min_pd(_mm256_max_pd(y, v_y_top), v_y_bottom);
+    __m256d x = _mm256_add_pd(v_x_origin, _mm256_mul_pd(v_x_step, v_index));
+    x = _mm256_min_pd(_mm256_max_pd(x, v_x_left), v_x_right);
+    v_index = _mm256_add_pd(v_index, v_four);
+
+    // Interleave: the unpacks work per 128 bit half, {x0 y0 x2 y2} and {x1 y1 x3 y3}
+    __m256d even = _mm256_unpacklo_pd(x, y);
+    __m256d odd = _mm256_unpackhi_pd(x, y);
+    _mm256_storeu_pd(points + 2 * i, _mm256_permute2f128_pd(even, odd, 0x20));
+    _mm256_storeu_pd(points + 2 * i + 4, _mm256_permute2f128_pd(even, odd, 0x31));
+  }
+
+  affineCurveScalar(affine, points, i, count);
+}
+
+/*
+SSE2 xoshiro128+ step of four lanes
+  :param s: the four state words of the lanes
+  :returns: uniform values in (0, 1]
+*/
+__attribute__((target("sse2"))) inline __m128 randomStepSSE2(__m128i* s) {
+  __m128i result = _mm_add_epi32(s[0], s[3]);
+  __m128i t = _mm_slli_epi32(s[1], 9);
+  s[2] = _mm_xor_si128(s[2], s[0]);
+  s[3] = _mm_xor_si128(s[3], s[1]);
+  s[1] = _mm_xor_si128(s[1], s[2]);
+  s[0] = _mm_xor_si128(s[0], s[3]);
+  s[2] = _mm_xor_si128(s[2], t);
+  s[3] = _mm_or_si128(_mm_slli_epi32(s[3], 11), _mm_srli_epi32(s[3], 21));
+
+  __m128i mantissa = _mm_add_epi32(_mm_srli_epi32(result, 8), _mm_set1_epi32(1));
+  return _mm_mul_ps(_mm_cvtepi32_ps(mantissa), _mm_set1_ps(random_scale));
+}
+
+/*
+SSE2 natural logarithm of values in (0, 1], mirrors logFallback
+*/
+__attribute__((target("sse2"))) inline __m128 logSSE2(__m128 x) {
+  __m128i bits = _mm_castps_si128(x);
+  __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+  __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F000000)));
+
+  __m128 mask = _mm_cmplt_ps(m, _mm_set1_ps(sqrt_half));
+  e = _mm_sub_ps(e, _mm_and_ps(mask, _mm_set1_ps(1.0f)));
+  m = _mm_add_ps(m, _mm_and_ps(mask, m));
+  m = _mm_sub_ps(m, _mm_set1_ps(1.0f));
+
+  __m128 z = _mm_mul_ps(m, m);
+  __m128 y = _mm_set1_ps(log_coefficients[0]);
+  for (std::size_t k = 1; k < 9; ++k) {
+    y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(log_coefficients[k]));
+  }
+  y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+  y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(log_q1)));
+  y = _mm_add_ps(y, _mm_mul_ps(z, _mm_set1_ps(-0.5f)));
+  __m128 result = _mm_add_ps(m, y);
+  return _mm_add_ps(result, _mm_mul_ps(e, _mm_set1_ps(log_q2)));
+}
+
+/*
+SSE2 Box-Muller transform of four pairs of uniform values, mirrors normalPairFallback
+*/
+__attribute__((target("sse2"))) inline void normalPairSSE2(__m128 u_radius, __m128 u_angle, float* first, float* second) {
+  __m128 radius = _mm_sqrt_ps(_mm_mul_ps(logSSE2(u_radius), _mm_set1_ps(-2.0f)));
+
+  // Split the angle in a quadrant and an angle within [-pi/4, pi/4]
+  __m128 t = _mm_mul_ps(u_angle, _mm_set1_ps(4.0f));
+  __m128i quadrant = _mm_cvttps_epi32(_mm_add_ps(t, _mm_set1_ps(0.5f)));
+  __m128 phi = _mm_mul_ps(_mm_sub_ps(t, _mm_cvtepi32_ps(quadrant)), _mm_set1_ps(half_pi));
+  __m128 z = _mm_mul_ps(phi, phi);
+
+  __m128 sine = _mm_mul_ps(_mm_set1_ps(sin_coefficients[0]), z);
+  sine = _mm_mul_ps(_mm_add_ps(sine, _mm_set1_ps(sin_coefficients[1])), z);
+  sine = _mm_mul_ps(_mm_mul_ps(_mm_add_ps(sine, _mm_set1_ps(sin_coefficients[2])), z), phi);
+  sine = _mm_add_ps(sine, phi);
+
+  __m128 cosine = _mm_mul_ps(_mm_set1_ps(cos_coefficients[0]), z);
+  cosine = _mm_mul_ps(_mm_add_ps(cosine, _mm_set1_ps(cos_coefficients[1])), z);
+  cosine = _mm_mul_ps(_mm_mul_ps(_mm_add_ps(cosine, _mm_set1_ps(cos_coefficients[2])), z), z);
+  cosine = _mm_add_ps(_mm_add_ps(cosine, _mm_mul_ps(z, _mm_set1_ps(-0.5f))), _mm_set1_ps(1.0f));
+
+  // Rotate by the quadrant
+  const __m128i one = _mm_set1_epi32(1);
+  const __m128i two = _mm_set1_epi32(2);
+  __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+  __m128 a = _mm_or_ps(_mm_and_ps(swap, sine), _mm_andnot_ps(swap, cosine));
+  __m128 b = _mm_or_ps(_mm_and_ps(swap, cosine), _mm_andnot_ps(swap, sine));
+  a = _mm_xor_ps(a, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30)));
+  b = _mm_xor_ps(b, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30)));
+
+  _mm_storeu_ps(first, _mm_mul_ps(radius, a));
+  _mm_storeu_ps(second, _mm_mul_ps(radius, b));
+}
+
+__attribute__((target("sse2"))) void uniformFillSSE2(RandomState& state, float* values, std::size_t count) {
+  __m128i low[4];
+  __m128i high[4];
+  for (std::size_t word = 0; word < 4; ++word) {
+    low[word] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state.words[word][0]));
+    high[word] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state.words[word][4]));
+  }
+
+  float buffer[8];
+  for (std::size_t i = 0; i < count; i += 8) {
+    float* output = i + 8 <= count ? values + i : buffer;
+    _mm_storeu_ps(output, randomStepSSE2(low));
+    _mm_storeu_ps(output + 4, randomStepSSE2(high));
+    if (output == buffer) {
+      std::copy(buffer, buffer + (count - i), values + i);
+    }
+  }
+
+  for (std::size_t word = 0; word < 4; ++word) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state.words[word][0]), low[word]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state.words[word][4]), high[word]);
+  }
+}
+
+__attribute__((target("sse2"))) void normalFillSSE2(RandomState& state, float* values, std::size_t count) {
+  __m128i low[4];
+  __m128i high[4];
+  for (std::size_t word = 0; word < 4; ++word) {
+    low[word] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state.words[word][0]));
+    high[word] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state.words[word][4]));
+  }
+
+  float buffer[16];
+  for (std::size_t i = 0; i < count; i += 16) {
+    float* output = i + 16 <= count ? values + i : buffer;
+    __m128 radius_low = randomStepSSE2(low);
+    __m128 radius_high = randomStepSSE2(high);
+    __m128 angle_low = randomStepSSE2(low);
+    __m128 angle_high = randomStepSSE2(high);
+    normalPairSSE2(radius_low, angle_low, output, output + 8);
+    normalPairSSE2(radius_high, angle_high, output + 4, output + 12);
+    if (output == buffer) {
+      std::copy(buffer, buffer + (count - i), values + i);
+    }
+  }
+
+  for (std::size_t word = 0; word < 4; ++word) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state.words[word][0]), low[word]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state.words[word][4]), high[word]);
+  }
+}
+
+/*
+AVX2 xoshiro128+ step of the eight lanes
+  :param s: the four state words of the lanes
+  :returns: uniform values in (0, 1]
+*/
+__attribute__((target("avx2"))) inline __m256 randomStepAVX2(__m256i* s) {
+  __m256i result = _mm256_add_epi32(s[0], s[3]);
+  __m256i t = _mm256_slli_epi32(s[1], 9);
+  s[2] = _mm256_xor_si256(s[2], s[0]);
+  s[3] = _mm256_xor_si256(s[3], s[1]);
+  s[1] = _mm256_xor_si256(s[1], s[2]);
+  s[0] = _mm256_xor_si256(s[0], s[3]);
+  s[2] = _mm256_xor_si256(s[2], t);
+  s[3] = _mm256_or_si256(_mm256_slli_epi32(s[3], 11), _mm256_srli_epi32(s[3], 21));
+
+  __m256i mantissa = _mm256_add_epi32(_mm256_srli_epi32(result, 8), _mm256_set1_epi32(1));
+  return _mm256_mul_ps(_mm256_cvtepi32_ps(mantissa), _mm256_set1_ps(random_scale));
+}
+
+/*
+AVX2 natural logarithm of values in (0, 1], mirrors logFallback
+*/
+__attribute__((target("avx2"))) inline __m256 logAVX2(__m256 x) {
+  __m256i bits = _mm256_castps_si256(x);
+  __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+  __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F000000)));
+
+  __m256 mask = _mm256_cmp_ps(m, _mm256_set1_ps(sqrt_half), _CMP_LT_OQ);
+  e = _mm256_sub_ps(e, _mm256_and_ps(mask, _mm256_set1_ps(1.0f)));
+  m = _mm256_add_ps(m, _mm256_and_ps(mask, m));
+  m = _mm256_sub_ps(m, _mm256_set1_ps(1.0f));
+
+  __m256 z = _mm256_mul_ps(m, m);
+  __m256 y = _mm256_set1_ps(log_coefficients[0]);
+  for (std::size_t k = 1; k < 9; ++k) {
+    y = _mm256_add_ps(_mm256_mul_ps(y, m), _mm256_set1_ps(log_coefficients[k]));
+  }
+  y = _mm256_mul_ps(_mm256_mul_ps(y, m), z);
+  y = _mm256_add_ps(y, _mm256_mul_ps(e, _mm256_set1_ps(log_q1)));
+  y = _mm256_add_ps(y, _mm256_mul_ps(z, _mm256_set1_ps(-0.5f)));
+  __m256 result = _mm256_add_ps(m, y);
+  return _mm256_add_ps(result, _mm256_mul_ps(e, _mm256_set1_ps(log_q2)));
+}
+
+/*
+AVX2 Box-Muller transform of eight pairs of uniform values, mirrors normalPairFallback
+*/
+__attribute__((target("avx2"))) inline void normalPairAVX2(__m256 u_radius, __m256 u_angle, float* first, float* second) {
+  __m256 radius = _mm256_sqrt_ps(_mm256_mul_ps(logAVX2(u_radius), _mm256_set1_ps(-2.0f)));
+
+  // Split the angle in a quadrant and an angle within [-pi/4, pi/4]
+  __m256 t = _mm256_mul_ps(u_angle, _mm256_set1_ps(4.0f));
+  __m256i quadrant = _mm256_cvttps_epi32(_mm256_add_ps(t, _mm256_set1_ps(0.5f)));
+  __m256 phi = _mm256_mul_ps(_mm256_sub_ps(t, _mm256_cvtepi32_ps(quadrant)), _mm256_set1_ps(half_pi));
+  __m256 z = _mm256_mul_ps(phi, phi);
+
+  __m256 sine = _mm256_mul_ps(_mm256_set1_ps(sin_coefficients[0]), z);
+  sine = _mm256_mul_ps(_mm256_add_ps(sine, _mm256_set1_ps(sin_coefficients[1])), z);
+  sine = _mm256_mul_ps(_mm256_mul_ps(_mm256_add_ps(sine, _mm256_set1_ps(sin_coefficients[2])), z), phi);
+  sine = _mm256_add_ps(sine, phi);
+
+  __m256 cosine = _mm256_mul_ps(_mm256_set1_ps(cos_coefficients[0]), z);
+  cosine = _mm256_mul_ps(_mm256_add_ps(cosine, _mm256_set1_ps(cos_coefficients[1])), z);
+  cosine = _mm256_mul_ps(_mm256_mul_ps(_mm256_add_ps(cosine, _mm256_set1_ps(cos_coefficients[2])), z), z);
+  cosine = _mm256_add_ps(_mm256_add_ps(cosine, _mm256_mul_ps(z, _mm256_set1_ps(-0.5f))), _mm256_set1_ps(1.0f));
+
+  // Rotate by the quadrant
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i two = _mm256_set1_epi32(2);
+  __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one));
+  __m256 a = _mm256_blendv_ps(cosine, sine, swap);
+  __m256 b = _mm256_blendv_ps(sine, cosine, swap);
+  a = _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, one), two), 30)));
+  b = _mm256_xor_ps(b, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, two), 30)));
+
+  _mm256_storeu_ps(first, _mm256_mul_ps(radius, a));
+  _mm256_storeu_ps(second, _mm256_mul_ps(radius, b));
+}
+
+__attribute__((target("avx2"))) void uniformFillAVX2(RandomState& state, float* values, std::size_t count) {
+  __m256i s[4];
+  for (std::size_t word = 0; word < 4; ++word) {
+    s[word] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state.words[word]));
+  }
+
+  float buffer[8];
+  for (std::size_t i = 0; i < count; i += 8) {
+    float* output = i + 8 <= count ? values + i : buffer;
+    _mm256_storeu_ps(output, randomStepAVX2(s));
+    if (output == buffer) {
+      std::copy(buffer, buffer + (count - i), values + i);
+    }
+  }
+
+  for (std::size_t word = 0; word < 4; ++word) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(state.words[word]), s[word]);
+  }
+}
+
+__attribute__((target("avx2"))) void normalFillAVX2(RandomState& state, float* values, std::size_t count) {
+  __m256i s[4];
+  for (std::size_t word = 0; word < 4; ++word) {
+    s[word] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state.words[word]));
+  }
+
+  float buffer[16];
+  for (std::size_t i = 0; i < count; i += 16) {
+    float* output = i + 16 <= count ? values + i : buffer;
+    __m256 radius = randomStepAVX2(s);
+    __m256 angle = randomStepAVX2(s);
+    normalPairAVX2(radius, angle, output, output + 8);
+    if (output == buffer) {
+      std::copy(buffer, buffer + (count - i), values + i);
+    }
+  }
+
+  for (std::size_t word = 0; word < 4; ++word) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(state.words[word]), s[word]);
+  }
+}
+
+#endif  // DATA_KERNEL_X86
+
+void dotRowsFallback(const float* matrix, std::size_t rows, std::size_t stride, const float* vector, std::size_t count, float* results) {
+  for (std::size_t row = 0; row < rows; ++row) {
+    const float* left = matrix + row * stride;
+    float result = 0.0f;
+    for (std::size_t i = 0; i < count; ++i) {
+      result += left[i] * vector[i];
+    }
+    results[row] = result;
+  }
+}
+
+void sampleGridFallback(const Grid& grid, const double* wavelengths, double* intensities, std::size_t count) {
+  sampleGridScalar(grid, wavelengths, intensities, 0, count);
+}
+
+void binIndicesFallback(const Bins& bins, std::uint32_t* indices, std::size_t count) { binIndicesScalar(bins, indices, 0, count); }
+
+void affineCurveFallback(const Affine& affine, double* points, std::size_t count) { affineCurveScalar(affine, points, 0, count); }
+
+void lowerBoundFallback(const Table& table, const float* values, std::uint32_t* indices, std::size_t count) {
+  lowerBoundScalar(table, values, indices, 0, count);
+}
+
+/*
+Scalar xoshiro128+ step of the eight lanes
+  :param state: the generator state
+  :param values: (return) buffer of 8 uniform values in (0, 1]
+*/
+void randomStepFallback(RandomState& state, float* values) {
+  for (std::size_t lane = 0; lane < 8; ++lane) {
+    std::uint32_t s0 = state.words[0][lane];
+    std::uint32_t s1 = state.words[1][lane];
+    std::uint32_t s2 = state.words[2][lane];
+    std::uint32_t s3 = state.words[3][lane];
+
+    std::uint32_t result = s0 + s3;
+    std::uint32_t t = s1 << 9;
+    s2 ^= s0;
+    s3 ^= s1;
+    s1 ^= s2;
+    s0 ^= s3;
+    s2 ^= t;
+    s3 = (s3 << 11) | (s3 >> 21);
+
+    state.words[0][lane] = s0;
+    state.words[1][lane] = s1;
+    state.words[2][lane] = s2;
+    state.words[3][lane] = s3;
+    values[lane] = static_cast<float>((result >> 8) + 1) * random_scale;
+  }
+}
+
+/*
+Scalar natural logarithm of a value in (0, 1] (cephes logf)
+*/
+float logFallback(float x) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+  float e = static_cast<float>(static_cast<std::int32_t>(bits >> 23) - 126);
+  bits = (bits & 0x007FFFFFu) | 0x3F000000u;
+  float m;
+  std::memcpy(&m, &bits, sizeof(m));
+
+  if (m < sqrt_half) {
+    e = e - 1.0f;
+    m = m + m;
+  }
+  m = m - 1.0f;
+
+  float z = m * m;
+  float y = log_coefficients[0];
+  for (std::size_t k = 1; k < 9; ++k) {
+    y = y * m + log_coefficients[k];
+  }
+  y = y * m * z;
+  y = y + e * log_q1;
+  y = y + z * -0.5f;
+  float result = m + y;
+  return result + e * log_q2;
+}
+
+/*
+Scalar Box-Muller transform of a pair of uniform values
+  :param u_radius: uniform value in (0, 1], determines the radius
+  :param u_angle: uniform value in (0, 1], determines the angle
+  :param first: (return) first normal value
+  :param second: (return) second normal value
+*/
+void normalPairFallback(float u_radius, float u_angle, float& first, float& second) {
+  float radius = std::sqrt(logFallback(u_radius) * -2.0f);
+
+  // Split the angle in a quadrant and an angle within [-pi/4, pi/4]
+  float t = u_angle * 4.0f;
+  std::int32_t quadrant = static_cast<std::int32_t>(t + 0.5f);
+  float phi = (t - static_cast<float>(quadrant)) * half_pi;
+  float z = phi * phi;
+
+  float sine = ((sin_coefficients[0] * z + sin_coefficients[1]) * z + sin_coefficients[2]) * z * phi + phi;
+  float cosine = ((cos_coefficients[0] * z + cos_coefficients[1]) * z + cos_coefficients[2]) * z * z + z * -0.5f + 1.0f;
+
+  // Rotate by the quadrant
+  float a = (quadrant & 1) ? sine : cosine;
+  float b = (quadrant & 1) ? cosine : sine;
+  if ((quadrant + 1) & 2) {
+    a = -a;
+  }
+  if (quadrant & 2) {
+    b = -b;
+  }
+
+  first = radius * a;
+  second = radius * b;
+}
+
+void uniformFillFallback(RandomState& state, float* values, std::size_t count) {
+  float buffer[8];
+  for (std::size_t i = 0; i < count; i += 8) {
+    randomStepFallback(state, buffer);
+    std::copy(buffer, buffer + std::min<std::size_t>(8, count - i), values + i);
+  }
+}
+
+void normalFillFallback(RandomState& state, float* values, std::size_t count) {
+  float radius[8];
+  float angle[8];
+  float buffer[16];
+  for (std::size_t i = 0; i < count; i += 16) {
+    randomStepFallback(state, radius);
+    randomStepFallback(state, angle);
+    for (std::size_t lane = 0; lane < 8; ++lane) {
+      normalPairFallback(radius[lane], angle[lane], buffer[lane], buffer[lane + 8]);
+    }
+    std::copy(buffer, buffer + std::min<std::size_t>(16, count - i), values + i);
+  }
+}
+
+enum class InstructionSet { Scalar, SSE2, AVX2 };
+
+/*
+Determines the best supported instruction set, only run once. The FLUOR_KERNELS environment variable ("SSE2" or
+"Scalar") caps the instruction set, so every variant can be tested on a single cpu.
+*/
+InstructionSet detectInstructionSet() {
+  InstructionSet instruction_set = InstructionSet::Scalar;
+#ifdef DATA_KERNEL_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    instruction_set = InstructionSet::AVX2;
+  } else if (__builtin_cpu_supports("sse2")) {
+    instruction_set = InstructionSet::SSE2;
+  }
+#endif
+
+  const char* cap = std::getenv("FLUOR_KERNELS");
+  if (cap != nullptr && std::strcmp(cap, "Scalar") == 0) {
+    return InstructionSet::Scalar;
+  }
+  if (cap != nullptr && std::strcmp(cap, "SSE2") == 0 && instruction_set == InstructionSet::AVX2) {
+    return InstructionSet::SSE2;
+  }
+  return instruction_set;
+}
+
+InstructionSet supportedInstructionSet() {
+  static const InstructionSet instruction_set = detectInstructionSet();
+  return instruction_set;
+}
+
+using SampleGridFunction = void (*)(const Grid&, const double*, double*, std::size_t);
+
+SampleGridFunction resolveSampleGrid() {
+  switch (supportedInstructionSet()) {
+#ifdef DATA_KERNEL_X86
+    case InstructionSet::AVX2:
+      return &sampleGridAVX2;
+    case InstructionSet::SSE2:
+      return &sampleGridSSE2;
+#endif
+    default:
+      return &sampleGridFallback;
+  }
+}
+
+using DotRowsFunction = void (*)(const float*, std::size_t, std::size_t, const float*, std::size_t, float*);
+
+DotRowsFunction resolveDotRows() {
+  switch (supportedInstructionSet()) {
+#ifdef DATA_KERNEL_X86
+    case InstructionSet::AVX2:
+      return &dotRowsAVX2;
+    case InstructionSet::SSE2:
+      return &dotRowsSSE2;
+#endif
+    default:
+      return &dotRowsFallback;
+  }
+}
+
+using BinIndicesFunction = void (*)(const Bins&, std::uint32_t*, std::size_t);
+
+BinIndicesFunction resolveBinIndices() {
+  switch (supportedInstructionSet()) {
+#ifdef DATA_KERNEL_X86
+    case InstructionSet::AVX2:
+      return &binIndicesAVX2;
+    case InstructionSet::SSE2:
+      return &binIndicesSSE2;
+#endif
+    default:
+      return &binIndicesFallback;
+  }
+}
+
+using AffineCurveFunction = void (*)(const Affine&, double*, std::size_t);
+
+AffineCurveFunction resolveAffineCurve() {
+  switch (supportedInstructionSet()) {
+#ifdef DATA_KERNEL_X86
+    case InstructionSet::AVX2:
+      return &affineCurveAVX2;
+    case InstructionSet::SSE2:
+      return &affineCurveSSE2;
+#endif
+    default:
+      return &affineCurveFallback;
+  }
+}
+
+using LowerBoundFunction = void (*)(const Table&, const float*, std::uint32_t*, std::size_t);
+
+LowerBoundFunction resolveLowerBound() {
+  switch (supportedInstructionSet()) {
+#ifdef DATA_KERNEL_X86
+    case InstructionSet::AVX2:
+      return &lowerBoundAVX2;
+    case InstructionSet::SSE2:
+      return &lowerBoundSSE2;
+#endif
+    default:
+      return &lowerBoundFallback;
+  }
+}
+
+using FillFunction = void (*)(RandomState&, float*, std::size_t);
+
+FillFunction resolveUniformFill() {
+  switch (supportedInstructionSet()) {
+#ifdef DATA_KERNEL_X86
+    case InstructionSet::AVX2:
+      return &uniformFillAVX2;
+    case InstructionSet::SSE2:
+      return &uniformFillSSE2;
+#endif
+    default:
+      return &uniformFillFallback;
+  }
+}
+
+FillFunction resolveNormalFill() {
+  switch (supportedInstructionSet()) {
+#ifdef DATA_KERNEL_X86
+    case InstructionSet::AVX2:
+      return &normalFillAVX2;
+    case InstructionSet::SSE2:
+      return &normalFillSSE2;
+#endif
+    default:
+      return &normalFillFallback;
+  }
+}
+
+}  // namespace
+
+/*
+Evaluates a uniform grid curve at the specified wavelengths. The result is equal to calling
+Data::Polygon::intensityAt for each wavelength.
+  :param y: the grid intensities
+  :param size: amount of grid points, if 0 all intensities are set to 0.0
+  :param start: wavelength of the first grid point
+  :param step: (positive) wavelength step of the grid
+  :param wavelengths: the wavelengths to evaluate
+  :param intensities: (return) buffer of atleast count values to write the intensities into
+  :param count: amount of wavelengths
+  :param cutoff: intensities below or equal to cutoff are set to 0.0
+*/
+void sampleGrid(const float* y, int size, double start, double step, const double* wavelengths, double* intensities, std::size_t count,
+                double cutoff) {
+  if (size <= 0 || y == nullptr || !(step > 0.0)) {
+    std::fill(intensities, intensities + count, 0.0);
+    return;
+  }
+
+  Grid grid;
+  grid.y = y;
+  grid.size = size;
+  grid.start = start;
+  grid.step_inverse = 1.0 / step;
+  grid.x_min = start;
+  grid.x_max = start + step * (size - 1);
+  grid.cutoff = cutoff;
+
+  static const SampleGridFunction function = resolveSampleGrid();
+  function(grid, wavelengths, intensities, count);
+}
+
+/*
+Calculates the dot product of a vector with every row of a row-major matrix
+  :param matrix: the matrix
+  :param rows: amount of rows
+  :param stride: distance (in floats) between the starts of two rows
+  :param vector: the vector
+  :param count: amount of values in the vector, atmost stride
+  :param results: (return) buffer of atleast rows values
+*/
+void dotRows(const float* matrix, std::size_t rows, std::size_t stride, const float* vector, std::size_t count, float* results) {
+  static const DotRowsFunction function = resolveDotRows();
+  function(matrix, rows, stride, vector, count, results);
+}
+
+/*
+Calculates the bin of every event in a (row-major) 2D grid of equal sized bins. The bin edges are inclusive on the low side.
+  :param x: the x values of the events
+  :param y: the y values of the events, nullptr for a 1D grid of one row
+  :param count: amount of events
+  :param x_min: the low edge of the first column
+  :param x_max: the high edge of the last column
+  :param columns: amount of columns
+  :param y_min: the low edge of the first row
+  :param y_max: the high edge of the last row
+  :param rows: amount of rows, ignored for a 1D grid
+  :param indices: (return) buffer of atleast count values; row * columns + column, or columns * rows for events outside
+  the grid (and NaN)
+*/
+void binIndices(const float* x, const float* y, std::size_t count, double x_min, double x_max, std::size_t columns, double y_min,
+                double y_max, std::size_t rows, std::uint32_t* indices) {
+  if (y == nullptr) {
+    rows = 1;
+    y_min = 0.0;
+    y_max = 1.0;
+  }
+  if (columns == 0 || rows == 0 || !(x_max > x_min) || !(y_max > y_min)) {
+    std::fill(indices, indices + count, static_cast<std::uint32_t>(columns * rows));
+    return;
+  }
+
+  Bins bins;
+  bins.x = x;
+  bins.y = y;
+  bins.x_offset = static_cast<float>(x_min);
+  bins.x_scale = static_cast<float>(static_cast<double>(columns) / (x_max - x_min));
+  bins.y_offset = static_cast<float>(y_min);
+  bins.y_scale = static_cast<float>(static_cast<double>(rows) / (y_max - y_min));
+  bins.columns = static_cast<float>(columns);
+  bins.rows = static_cast<float>(rows);
+  bins.column_count = static_cast<std::uint32_t>(columns);
+  bins.outside = static_cast<std::uint32_t>(columns * rows);
+
+  // The SSE2 kernel combines the index in float
+  if (columns * rows >= (static_cast<std::size_t>(1) << 24)) {
+    binIndicesScalar(bins, indices, 0, count);
+    return;
+  }
+
+  static const BinIndicesFunction function = resolveBinIndices();
+  function(bins, indices, count);
+}
+
+/*
+Transforms a uniform grid curve into interleaved (x, y) points: x = x_origin + x_step * i and y = y[i] * y_slope + y_intercept.
+The points are clamped branchless to [x_left, x_right] and [y_top, y_bottom], NaN becomes x_left / y_top.
+  :param y: the grid intensities
+  :param count: amount of points
+  :param x_origin: the x of the first point
+  :param x_step: the x distance between two points
+  :param x_left: the lowest x value
+  :param x_right: the highest x value
+  :param y_slope: the y scale
+  :param y_intercept: the y offset
+  :param y_top: the lowest y value
+  :param y_bottom: the highest y value
+  :param points: (return) buffer of atleast 2 * count values
+*/
+void affineCurve(const float* y, std::size_t count, double x_origin, double x_step, double x_left, double x_right, double y_slope,
+                 double y_intercept, double y_top, double y_bottom, double* points) {
+  Affine affine;
+  affine.y = y;
+  affine.x_origin = x_origin;
+  affine.x_step = x_step;
+  affine.x_left = x_left;
+  affine.x_right = x_right;
+  affine.y_slope = y_slope;
+  affine.y_intercept = y_intercept;
+  affine.y_top = y_top;
+  affine.y_bottom = y_bottom;
+
+  static const AffineCurveFunction function = resolveAffineCurve();
+  function(affine, points, count);
+}
+
+/*
+Finds for every value the first table entry that is not less than the value, clamped to the last entry. With a cumulative
+distribution table this samples the distribution by inversion of uniform values. NaN values find the first entry.
+  :param table: the ascending table
+  :param size: amount of table entries, if 0 all indices are set to 0
+  :param values: the values to search
+  :param count: amount of values
+  :param indices: (return) buffer of atleast count values
+*/
+void lowerBound(const float* table, std::size_t size, const float* values, std::size_t count, std::uint32_t* indices) {
+  if (size == 0 || table == nullptr) {
+    std::fill(indices, indices + count, static_cast<std::uint32_t>(0));
+    return;
+  }
+
+  Table search;
+  search.entries = table;
+  search.size = static_cast<std::uint32_t>(size);
+  search.last = static_cast<std::uint32_t>(size - 1);
+
+  static const LowerBoundFunction function = resolveLowerBound();
+  function(search, values, indices, count);
+}
+
+/*
+Seeds the eight generators of a random state, every lane gets its own SplitMix64 derived state
+  :param state: the state to seed
+  :param seed: the seed
+*/
+void seedRandom(RandomState& state, std::uint64_t seed) {
+  for (std::size_t lane = 0; lane < 8; ++lane) {
+    for (std::size_t word = 0; word < 4; word += 2) {
+      seed += 0x9E3779B97F4A7C15ull;
+      std::uint64_t z = seed;
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+      z = z ^ (z >> 31);
+      state.words[word][lane] = static_cast<std::uint32_t>(z);
+      state.words[word + 1][lane] = static_cast<std::uint32_t>(z >> 32);
+    }
+
+    // An all zero state never leaves zero
+    if ((state.words[0][lane] | state.words[1][lane] | state.words[2][lane] | state.words[3][lane]) == 0) {
+      state.words[0][lane] = 1;
+    }
+  }
+}
+
+/*
+Fills a buffer with uniform random values in (0, 1] with a 24 bit resolution. Every eight values advance the state
+by one step, a partial step still advances the state.
+  :param state: the generator state
+  :param values: (return) buffer of atleast count values
+  :param count: amount of values
+*/
+void uniformFill(RandomState& state, float* values, std::size_t count) {
+  static const FillFunction function = resolveUniformFill();
+  function(state, values, count);
+}
+
+/*
+Fills a buffer with standard normal random values. Every sixteen values advance the state by two steps, a partial
+block still advances the state. The (uniform) radius resolution limits the values to about 5.8 standard deviations.
+  :param state: the generator state
+  :param values: (return) buffer of atleast count values
+  :param count: amount of values
+*/
+void normalFill(RandomState& state, float* values, std::size_t count) {
+  static const FillFunction function = resolveNormalFill();
+  function(state, values, count);
+}
+
+/*
+Getter for the instruction set the kernels dispatch to
+  :returns: "AVX2", "SSE2" or "Scalar"
+*/
+const char* instructionSet() {
+  switch (supportedInstructionSet()) {
+    case InstructionSet::AVX2:
+      return "AVX2";
+    case InstructionSet::SSE2:
+      return "SSE2";
+    default:
+      return "Scalar";
+  }
+}
+
+}  // namespace Kernel
+}  // namespace Data
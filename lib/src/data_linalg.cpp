@@ -0,0 +1,176 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_linalg.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+namespace Data {
+namespace LinearAlgebra {
+
+namespace {
+
+// Relative size of the squared pivot below which a vector is considered dependent on the previous vectors
+const double pivot_tolerance = 1e-14;
+
+// Relative size of the inner product below which two columns are considered orthogonal
+const double orthogonal_tolerance = 1e-15;
+const int sweeps_max = 60;
+
+}  // namespace
+
+/*
+Appends a vector to the Cholesky factor of a Gram matrix
+  :param r: the row-major size x size upper triangular factor
+  :param size: the amount of vectors in the factor
+  :param column: the size + 1 inner products of the new vector with the factor's vectors and (last) itself
+  :param result: (return) buffer of (size + 1) x (size + 1) values, the extended factor
+  :returns: whether the new vector is independent of the factor's vectors, if false result is incomplete
+*/
+bool choleskyAppend(const double* r, std::size_t size, const double* column, double* result) {
+  const std::size_t stride = size + 1;
+  std::fill(result, result + stride * stride, 0.0);
+  for (std::size_t i = 0; i < size; ++i) {
+    std::copy(r + i * size + i, r + (i + 1) * size, result + i * stride + i);
+  }
+
+  double pivot = column[size];
+  for (std::size_t i = 0; i < size; ++i) {
+    double value = column[i];
+    for (std::size_t k = 0; k < i; ++k) {
+      value -= result[k * stride + i] * result[k * stride + size];
+    }
+    value /= r[i * size + i];
+    result[i * stride + size] = value;
+    pivot -= value * value;
+  }
+
+  if (pivot <= column[size] * pivot_tolerance || pivot <= 0.0) {
+    return false;
+  }
+  result[size * stride + size] = std::sqrt(pivot);
+  return true;
+}
+
+/*
+Removes a vector from the Cholesky factor of a Gram matrix. Removing column index leaves an upper Hessenberg matrix,
+the subdiagonal is rotated away row pair by row pair.
+  :param r: the row-major size x size upper triangular factor
+  :param size: the amount of vectors in the factor, atleast 1
+  :param index: the index of the vector to remove
+  :param result: (return) buffer of (size - 1) x (size - 1) values, the reduced factor
+*/
+void choleskyErase(const double* r, std::size_t size, std::size_t index, double* result) {
+  // Hessenberg matrix: all rows, all but the removed column
+  const std::size_t columns = size - 1;
+  std::vector<double> h(size * columns);
+  for (std::size_t i = 0; i < size; ++i) {
+    for (std::size_t j = 0; j < columns; ++j) {
+      h[i * columns + j] = r[i * size + (j < index ? j : j + 1)];
+    }
+  }
+
+  for (std::size_t j = index; j < columns; ++j) {
+    double a = h[j * columns + j];
+    double b = h[(j + 1) * columns + j];
+    double norm = std::hypot(a, b);
+    if (norm == 0.0) {
+      continue;
+    }
+    double c = a / norm;
+    double s = b / norm;
+
+    for (std::size_t k = j; k < columns; ++k) {
+      double upper = h[j * columns + k];
+      double lower = h[(j + 1) * columns + k];
+      h[j * columns + k] = c * upper + s * lower;
+      h[(j + 1) * columns + k] = c * lower - s * upper;
+    }
+  }
+
+  // Keep the diagonal positive, a rotation can flip the sign of a row
+  for (std::size_t i = 0; i < columns; ++i) {
+    double sign = h[i * columns + i] < 0.0 ? -1.0 : 1.0;
+    for (std::size_t j = 0; j < columns; ++j) {
+      result[i * columns + j] = j < i ? 0.0 : sign * h[i * columns + j];
+    }
+  }
+}
+
+/*
+Calculates the singular values of a square matrix. Rotates the column pairs until all columns are orthogonal,
+the singular values are then the column norms.
+  :param matrix: the row-major size x size matrix
+  :param size: the amount of rows and columns
+  :param values: (return) buffer of size values, the singular values in descending order
+*/
+void singularValues(const double* matrix, std::size_t size, double* values) {
+  // Column-major working copy, the rotations work on columns
+  std::vector<double> u(size * size);
+  for (std::size_t i = 0; i < size; ++i) {
+    for (std::size_t j = 0; j < size; ++j) {
+      u[j * size + i] = matrix[i * size + j];
+    }
+  }
+
+  for (int sweep = 0; sweep < sweeps_max; ++sweep) {
+    bool rotated = false;
+
+    for (std::size_t p = 0; p + 1 < size; ++p) {
+      double* column_p = u.data() + p * size;
+      for (std::size_t q = p + 1; q < size; ++q) {
+        double* column_q = u.data() + q * size;
+
+        double alpha = 0.0;
+        double beta = 0.0;
+        double gamma = 0.0;
+        for (std::size_t i = 0; i < size; ++i) {
+          alpha += column_p[i] * column_p[i];
+          beta += column_q[i] * column_q[i];
+          gamma += column_p[i] * column_q[i];
+        }
+
+        if (gamma == 0.0 || std::abs(gamma) <= orthogonal_tolerance * std::sqrt(alpha * beta)) {
+          continue;
+        }
+        rotated = true;
+
+        double zeta = (beta - alpha) / (2.0 * gamma);
+        double t = (zeta >= 0.0 ? 1.0 : -1.0) / (std::abs(zeta) + std::sqrt(1.0 + zeta * zeta));
+        double c = 1.0 / std::sqrt(1.0 + t * t);
+        double s = c * t;
+
+        for (std::size_t i = 0; i < size; ++i) {
+          double value_p = column_p[i];
+          double value_q = column_q[i];
+          column_p[i] = c * value_p - s * value_q;
+          column_q[i] = s * value_p + c * value_q;
+        }
+      }
+    }
+
+    if (!rotated) {
+      break;
+    }
+  }
+
+  for (std::size_t j = 0; j < size; ++j) {
+    double norm = 0.0;
+    for (std::size_t i = 0; i < size; ++i) {
+      norm += u[j * size + i] * u[j * size + i];
+    }
+    values[j] = std::sqrt(norm);
+  }
+  std::sort(values, values + size, std::greater<double>());
+}
+
+}  // namespace LinearAlgebra
+}  // namespace Data
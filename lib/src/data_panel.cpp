@@ -0,0 +1,279 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_panel.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "data_parallel.h"
+
+namespace Data {
+
+const std::size_t PanelOptimizer::none;
+
+namespace {
+
+/*
+A (partial) panel in the beam. The panel is stored as a tree, every node refers to its parent in the previous beam.
+*/
+struct PanelNode {
+  std::size_t parent;     // index in the previous beam
+  std::size_t candidate;  // the candidate assigned to this level's detector, or PanelOptimizer::none
+  double signal;
+  double spillover_total;
+  double spillover_worst;
+  double score;
+};
+
+/*
+Moves the (at most) count highest scoring nodes to the front of the vector and removes the others
+*/
+void keepBest(std::vector<PanelNode>& nodes, std::size_t count) {
+  if (nodes.size() <= count) {
+    return;
+  }
+  auto higher = [](const PanelNode& left, const PanelNode& right) { return left.score > right.score; };
+  std::nth_element(nodes.begin(), nodes.begin() + static_cast<std::ptrdiff_t>(count), nodes.end(), higher);
+  nodes.resize(count);
+}
+
+}  // namespace
+
+/*
+Constructor: constructs an optimizer without candidates and detectors
+*/
+PanelOptimizer::PanelOptimizer()
+    : candidates(),
+      candidate_names(),
+      optimizer_matrix(),
+      optimizer_options(),
+      optimizer_result(),
+      cancelled(false),
+      run_progress() {
+  this->optimizer_result.score = 0.0;
+  this->optimizer_result.signal = 0.0;
+  this->optimizer_result.spillover_total = 0.0;
+  this->optimizer_result.spillover_worst = 0.0;
+}
+
+/*
+Sets the instrument, the detectors to fill
+  :param instrument: the instrument
+*/
+void PanelOptimizer::setInstrument(const Data::Instrument& instrument) { this->optimizer_matrix.setInstrument(instrument); }
+
+/*
+Sets the candidate fluorophores
+  :param spectra: the candidate spectra
+  :param names: the candidate names, if the size doesnt match the spectra the spectrum id's are used
+*/
+void PanelOptimizer::setCandidates(std::vector<Data::Spectrum> spectra, QStringList names) {
+  this->candidates = std::move(spectra);
+  this->candidate_names = std::move(names);
+
+  if (static_cast<std::size_t>(this->candidate_names.size()) != this->candidates.size()) {
+    this->candidate_names.clear();
+    for (const Data::Spectrum& spectrum : this->candidates) {
+      this->candidate_names.append(spectrum.id());
+    }
+  }
+}
+
+/*
+Sets the search options
+  :param options: the options
+*/
+void PanelOptimizer::setOptions(const PanelOptimizer::Options& options) { this->optimizer_options = options; }
+
+/*
+Runs the panel search, blocks until finished or cancelled.
+Every level of the search assigns one detector. Each partial panel in the beam is expanded with every unused candidate
+that reaches the minimum signal in that detector (or with no fluorophore), the best beam_width expansions form the next beam.
+The spillover terms are only dependent on the pairs of chosen fluorophores, so they are added incrementally.
+  :param token: the cancellation token, polled between the beam expansions
+  :param report: (optional) called upon every progress change with the progress (0.0-1.0), from the worker threads
+  :returns: whether the search finished, false if cancelled
+*/
+bool PanelOptimizer::run(const Data::JobToken& token, std::function<void(double)> report) {
+  this->cancelled = token.isCancelled();
+  this->run_progress.reset(std::move(report));
+  if (this->cancelled) {
+    return false;
+  }
+
+  // Signal of all candidates in all detectors
+  std::vector<const Data::Spectrum*> spectra;
+  spectra.reserve(this->candidates.size());
+  for (const Data::Spectrum& spectrum : this->candidates) {
+    spectra.push_back(&spectrum);
+  }
+  this->optimizer_matrix.calculate(spectra, this->candidate_names);
+
+  const std::size_t detector_count = this->optimizer_matrix.detectorCount();
+  const std::size_t candidate_count = this->candidates.size();
+  const std::size_t beam_width = std::max<std::size_t>(1, this->optimizer_options.beam_width);
+  const double signal_minimum = std::max(1e-6, this->optimizer_options.signal_minimum);
+  const double weight = this->optimizer_options.spillover_weight;
+  const bool worst_case = this->optimizer_options.objective == PanelOptimizer::WorstSpillover;
+  const Data::SpilloverMatrix& matrix = this->optimizer_matrix;
+
+  // Per detector the candidates with sufficient signal, brightest first
+  std::vector<std::vector<std::size_t>> options(detector_count);
+  for (std::size_t d = 0; d < detector_count; ++d) {
+    for (std::size_t f = 0; f < candidate_count; ++f) {
+      if (matrix.signal(f, d) >= signal_minimum) {
+        options[d].push_back(f);
+      }
+    }
+    std::sort(options[d].begin(), options[d].end(),
+              [&matrix, d](std::size_t left, std::size_t right) { return matrix.signal(left, d) > matrix.signal(right, d); });
+  }
+
+  std::vector<std::vector<PanelNode>> levels;
+  levels.reserve(detector_count + 1);
+  levels.push_back({PanelNode{PanelOptimizer::none, PanelOptimizer::none, 0.0, 0.0, 0.0, 0.0}});
+
+  for (std::size_t d = 0; d < detector_count; ++d) {
+    const std::vector<PanelNode>& beam = levels.back();
+    std::vector<std::vector<PanelNode>> children(beam.size());
+
+    Data::parallelFor(beam.size(), [&](std::size_t begin, std::size_t end) {
+      std::vector<std::pair<std::size_t, std::size_t>> assigned;  // candidate, detector
+      std::vector<bool> used(candidate_count);
+
+      for (std::size_t p = begin; p < end; ++p) {
+        if (token.isCancelled()) {
+          return;
+        }
+
+        // Rebuild the partial panel of this node
+        assigned.clear();
+        used.assign(candidate_count, false);
+        std::size_t node = p;
+        for (std::size_t level = d; level > 0; --level) {
+          const PanelNode& ancestor = levels[level][node];
+          if (ancestor.candidate != PanelOptimizer::none) {
+            assigned.emplace_back(ancestor.candidate, level - 1);
+            used[ancestor.candidate] = true;
+          }
+          node = ancestor.parent;
+        }
+
+        const PanelNode& parent = beam[p];
+        std::vector<PanelNode>& local = children[p];
+        local.reserve(options[d].size() + 1);
+
+        // Leaving the detector empty is always an option
+        local.push_back(PanelNode{p, PanelOptimizer::none, parent.signal, parent.spillover_total, parent.spillover_worst, parent.score});
+
+        for (std::size_t f : options[d]) {
+          if (used[f]) {
+            continue;
+          }
+
+          double signal = matrix.signal(f, d);
+          double spillover_total = parent.spillover_total;
+          double spillover_worst = parent.spillover_worst;
+          for (const std::pair<std::size_t, std::size_t>& pair : assigned) {
+            // Spillover of the new fluorophore into the assigned detector, and vice versa
+            double spill_into = matrix.signal(f, pair.second) / signal;
+            double spill_from = matrix.signal(pair.first, d) / matrix.signal(pair.first, pair.second);
+            spillover_total += spill_into + spill_from;
+            spillover_worst = std::max(spillover_worst, std::max(spill_into, spill_from));
+          }
+
+          double total_signal = parent.signal + signal;
+          double score = total_signal - weight * (worst_case ? spillover_worst : spillover_total);
+          local.push_back(PanelNode{p, f, total_signal, spillover_total, spillover_worst, score});
+        }
+
+        keepBest(local, beam_width);
+      }
+    });
+
+    if (token.isCancelled()) {
+      this->cancelled = true;
+      return false;
+    }
+
+    std::vector<PanelNode> next;
+    for (const std::vector<PanelNode>& local : children) {
+      next.insert(next.end(), local.begin(), local.end());
+    }
+    keepBest(next, beam_width);
+    levels.push_back(std::move(next));
+
+    this->run_progress.set(static_cast<int>(((d + 1) * 1000) / detector_count));
+  }
+
+  // Find the best panel and rebuild its assignment
+  const std::vector<PanelNode>& beam = levels.back();
+  std::size_t best = 0;
+  for (std::size_t i = 1; i < beam.size(); ++i) {
+    if (beam[i].score > beam[best].score) {
+      best = i;
+    }
+  }
+
+  this->optimizer_result.assignment.assign(detector_count, PanelOptimizer::none);
+  this->optimizer_result.score = beam[best].score;
+  this->optimizer_result.signal = beam[best].signal;
+  this->optimizer_result.spillover_total = beam[best].spillover_total;
+  this->optimizer_result.spillover_worst = beam[best].spillover_worst;
+
+  std::size_t node = best;
+  for (std::size_t level = detector_count; level > 0; --level) {
+    const PanelNode& ancestor = levels[level][node];
+    this->optimizer_result.assignment[level - 1] = ancestor.candidate;
+    node = ancestor.parent;
+  }
+
+  this->run_progress.set(1000);
+  return true;
+}
+
+/*
+Whether the last search was cancelled
+*/
+bool PanelOptimizer::isCancelled() const { return this->cancelled; }
+
+/*
+Getter for the progress of a running search, can be called from any thread
+  :returns: progress (0.0-1.0)
+*/
+double PanelOptimizer::progress() const { return this->run_progress.value(); }
+
+/*
+Getter for the result of the last finished search
+*/
+const PanelOptimizer::Result& PanelOptimizer::result() const { return this->optimizer_result; }
+
+/*
+Getter for the signal/spillover matrix of all candidates, calculated by run()
+*/
+const Data::SpilloverMatrix& PanelOptimizer::matrix() const { return this->optimizer_matrix; }
+
+/*
+Getter for the amount of candidates
+*/
+std::size_t PanelOptimizer::candidateCount() const { return this->candidates.size(); }
+
+/*
+Getter for a candidate spectrum
+  :param index: candidate index
+*/
+const Data::Spectrum& PanelOptimizer::candidate(std::size_t index) const { return this->candidates[index]; }
+
+/*
+Getter for a candidate name
+  :param index: candidate index
+*/
+const QString& PanelOptimizer::candidateName(std::size_t index) const { return this->candidate_names.at(static_cast<int>(index)); }
+
+}  // namespace Data
@@ -0,0 +1,109 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include "data_jobs.h"
+
+namespace Data {
+
+namespace {
+
+/*
+Shared state of a parallelFor call. Chunks are claimed through an atomic counter, so it does not matter
+how many (or how late) the workers join in.
+*/
+class ParallelState {
+ public:
+  ParallelState(std::size_t count, std::size_t chunk, const std::function<void(std::size_t, std::size_t)>& function)
+      : count(count), chunk(chunk), chunks((count + chunk - 1) / chunk), function(function), next(0), done(0), mutex(), condition() {}
+
+  const std::size_t count;
+  const std::size_t chunk;
+  const std::size_t chunks;
+  const std::function<void(std::size_t, std::size_t)>& function;  // only accessed while chunks are unclaimed
+
+  std::atomic<std::size_t> next;
+  std::size_t done;
+  std::mutex mutex;
+  std::condition_variable condition;
+
+  void run() {
+    while (true) {
+      std::size_t index = this->next.fetch_add(1);
+      if (index >= this->chunks) {
+        return;
+      }
+
+      std::size_t begin = index * this->chunk;
+      std::size_t end = std::min(this->count, begin + this->chunk);
+      this->function(begin, end);
+
+      std::lock_guard<std::mutex> lock(this->mutex);
+      ++this->done;
+      if (this->done == this->chunks) {
+        this->condition.notify_all();
+      }
+    }
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->condition.wait(lock, [this]() { return this->done == this->chunks; });
+  }
+};
+
+}  // namespace
+
+/*
+Runs function over the range [0, count) in chunks distributed over the job system workers. The helper jobs have
+high priority and keep the state alive until the worker is finished with it.
+  :param count: the size of the index range
+  :param function: called with a [begin, end) subrange, has to be thread safe for disjoint subranges
+  :param grain: the minimum chunk size
+*/
+void parallelFor(std::size_t count, const std::function<void(std::size_t, std::size_t)>& function, std::size_t grain) {
+  if (count == 0) {
+    return;
+  }
+
+  std::size_t threads = Data::parallelThreads();
+
+  // Oversubscribe chunks a bit to even out unequal chunk durations
+  std::size_t chunk = std::max(std::max(grain, static_cast<std::size_t>(1)), (count + threads * 4 - 1) / (threads * 4));
+  std::size_t chunks = (count + chunk - 1) / chunk;
+
+  if (threads == 1 || chunks == 1) {
+    function(0, count);
+    return;
+  }
+
+  std::shared_ptr<ParallelState> state = std::make_shared<ParallelState>(count, chunk, function);
+
+  std::size_t helpers = std::min(threads, chunks) - 1;
+  for (std::size_t i = 0; i < helpers; ++i) {
+    Data::JobSystem::instance().submit([state]() { state->run(); }, Data::JobSystem::High);
+  }
+
+  state->run();
+  state->wait();
+}
+
+/*
+Returns the amount of threads work is distributed over
+  :returns: thread count (including the calling thread)
+*/
+std::size_t parallelThreads() { return Data::JobSystem::instance().threadCount(); }
+
+}  // namespace Data
@@ -0,0 +1,445 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_signature.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "data_linalg.h"
+
+namespace Data {
+
+const std::size_t SignatureMatrix::none;
+
+/*
+Constructor: constructs an empty signature matrix
+*/
+SignatureMatrix::SignatureMatrix()
+    : signature_channels(0),
+      signature_fluorophores(),
+      signature_order(),
+      slot_ids(),
+      slot_signal(),
+      slot_peak(),
+      slot_gram(),
+      slot_factor(),
+      factor_slots(),
+      factor(),
+      signature_complexity(0.0) {}
+
+/*
+Calculates the signatures, similarity matrix and complexity index of the fluorophores in a calculated spillover matrix
+  :param matrix: the spillover matrix, every detector is a channel
+*/
+void SignatureMatrix::calculate(const Data::SpilloverMatrix& matrix) {
+  this->clear();
+  this->sync(matrix);
+}
+
+/*
+Updates the signatures to the fluorophores of a spillover matrix. Fluorophores that are no longer in the matrix are removed,
+new fluorophores are added: O(fluorophores * channels) each. The signals of known fluorophores are assumed unchanged, the
+matrix has to be of the same instrument and lasers (see clear() and updateChannels()).
+  :param matrix: the spillover matrix, every detector is a channel
+*/
+void SignatureMatrix::sync(const Data::SpilloverMatrix& matrix) {
+  if (matrix.detectorCount() != this->signature_channels) {
+    this->clear();
+    this->signature_channels = matrix.detectorCount();
+  }
+
+  std::unordered_set<QString> ids;
+  for (std::size_t i = 0; i < matrix.fluorophoreCount(); ++i) {
+    ids.insert(matrix.id(i));
+  }
+
+  bool changed = false;
+  for (std::size_t slot = this->slotCount(); slot > 0; --slot) {
+    if (ids.find(this->slot_ids[static_cast<int>(slot - 1)]) == ids.end()) {
+      this->eraseSlot(slot - 1);
+      changed = true;
+    }
+  }
+
+  // A removed fluorophore can make a dependent fluorophore independent again
+  if (changed && this->isDependent()) {
+    this->rebuildFactor();
+  }
+
+  std::unordered_map<QString, std::size_t> slots;
+  for (std::size_t slot = 0; slot < this->slotCount(); ++slot) {
+    slots[this->slot_ids[static_cast<int>(slot)]] = slot;
+  }
+
+  this->signature_fluorophores.clear();
+  this->signature_order.clear();
+  for (std::size_t i = 0; i < matrix.fluorophoreCount(); ++i) {
+    auto slot = slots.find(matrix.id(i));
+    if (slot == slots.end()) {
+      this->appendSlot(matrix, i);
+      this->signature_order.push_back(this->slotCount() - 1);
+      changed = true;
+    } else {
+      this->signature_order.push_back(slot->second);
+    }
+    this->signature_fluorophores.append(matrix.fluorophore(i));
+  }
+
+  if (changed) {
+    this->calculateComplexity();
+  }
+}
+
+/*
+Updates the signals of a range of channels, for example after the lasers of a laserline have changed: O(fluorophores^2 * range)
+for the Gram matrix, the factor is rebuild from the Gram matrix.
+  :param matrix: the spillover matrix, with the same fluorophores as the last sync
+  :param begin: the first channel
+  :param end: the channel past the last channel
+*/
+void SignatureMatrix::updateChannels(const Data::SpilloverMatrix& matrix, std::size_t begin, std::size_t end) {
+  const std::size_t channels = this->signature_channels;
+  if (matrix.detectorCount() != channels || matrix.fluorophoreCount() != this->signature_order.size()) {
+    this->calculate(matrix);
+    return;
+  }
+  if (begin >= end) {
+    return;
+  }
+
+  const std::size_t count = this->slotCount();
+  const std::size_t range = end - begin;
+
+  // Replace the signals, but keep the previous to remove their contribution from the Gram matrix
+  std::vector<double> previous(count * range);
+  for (std::size_t i = 0; i < this->signature_order.size(); ++i) {
+    std::size_t slot = this->signature_order[i];
+    double* signal = this->slot_signal.data() + slot * channels;
+    for (std::size_t j = begin; j < end; ++j) {
+      previous[slot * range + (j - begin)] = signal[j];
+      signal[j] = matrix.signal(i, j);
+    }
+    this->slot_peak[slot] = *std::max_element(signal, signal + channels);
+  }
+
+  for (std::size_t a = 0; a < count; ++a) {
+    const double* signal_a = this->slot_signal.data() + a * channels + begin;
+    const double* previous_a = previous.data() + a * range;
+    for (std::size_t b = a; b < count; ++b) {
+      const double* signal_b = this->slot_signal.data() + b * channels + begin;
+      const double* previous_b = previous.data() + b * range;
+
+      double delta = 0.0;
+      for (std::size_t j = 0; j < range; ++j) {
+        delta += signal_a[j] * signal_b[j] - previous_a[j] * previous_b[j];
+      }
+      this->slot_gram[a * count + b] += delta;
+      this->slot_gram[b * count + a] = this->slot_gram[a * count + b];
+    }
+  }
+
+  this->rebuildFactor();
+  this->calculateComplexity();
+}
+
+/*
+Clears the signatures
+*/
+void SignatureMatrix::clear() {
+  this->signature_channels = 0;
+  this->signature_fluorophores.clear();
+  this->signature_order.clear();
+  this->slot_ids.clear();
+  this->slot_signal.clear();
+  this->slot_peak.clear();
+  this->slot_gram.clear();
+  this->slot_factor.clear();
+  this->factor_slots.clear();
+  this->factor.clear();
+  this->signature_complexity = 0.0;
+}
+
+/*
+Whether the matrix contains any values
+*/
+bool SignatureMatrix::isEmpty() const { return this->slot_signal.empty(); }
+
+/*
+Getter for the amount of fluorophores
+*/
+std::size_t SignatureMatrix::fluorophoreCount() const { return static_cast<std::size_t>(this->signature_fluorophores.size()); }
+
+/*
+Getter for the amount of channels (detectors)
+*/
+std::size_t SignatureMatrix::channelCount() const { return this->signature_channels; }
+
+/*
+Getter for a fluorophore name
+  :param fluorophore: the fluorophore index
+*/
+const QString& SignatureMatrix::fluorophore(std::size_t fluorophore) const {
+  return this->signature_fluorophores.at(static_cast<int>(fluorophore));
+}
+
+/*
+Getter for the signature of a fluorophore in a channel
+  :param fluorophore: the fluorophore index
+  :param channel: the channel (detector) index
+  :returns: the signal relative to the brightest channel (0.0-1.0)
+*/
+double SignatureMatrix::signature(std::size_t fluorophore, std::size_t channel) const {
+  std::size_t slot = this->signature_order[fluorophore];
+  if (this->slot_peak[slot] <= 0.0) {
+    return 0.0;
+  }
+  return this->slot_signal[slot * this->signature_channels + channel] / this->slot_peak[slot];
+}
+
+/*
+Getter for the similarity of two fluorophores
+  :param fluorophore_a: the first fluorophore index
+  :param fluorophore_b: the second fluorophore index
+  :returns: the cosine similarity of the signatures (0.0-1.0), 0.0 if either fluorophore has no signal
+*/
+double SignatureMatrix::similarity(std::size_t fluorophore_a, std::size_t fluorophore_b) const {
+  std::size_t count = this->slotCount();
+  std::size_t slot_a = this->signature_order[fluorophore_a];
+  std::size_t slot_b = this->signature_order[fluorophore_b];
+
+  double norm_a = this->slot_gram[slot_a * count + slot_a];
+  double norm_b = this->slot_gram[slot_b * count + slot_b];
+  if (norm_a <= 0.0 || norm_b <= 0.0) {
+    return 0.0;
+  }
+  if (slot_a == slot_b) {
+    return 1.0;
+  }
+  return this->slot_gram[slot_a * count + slot_b] / std::sqrt(norm_a * norm_b);
+}
+
+/*
+Getter for the complexity index
+  :returns: the condition number of the signature matrix, infinity if it cannot be unmixed, 0.0 if there are no signatures
+*/
+double SignatureMatrix::complexity() const { return this->signature_complexity; }
+
+/*
+Exports the similarity matrix as comma separated values, with a header row and a first column of fluorophore names
+*/
+QString SignatureMatrix::toCSV() const {
+  // Quote every name, they can contain comma's
+  auto quote = [](const QString& text) {
+    QString quoted = text;
+    quoted.replace('"', "\"\"");
+    return QString("\"%1\"").arg(quoted);
+  };
+
+  QString csv = quote("Fluorophore");
+  for (const QString& name : this->signature_fluorophores) {
+    csv += "," + quote(name);
+  }
+  csv += "\n";
+
+  if (this->isEmpty()) {
+    return csv;
+  }
+
+  for (std::size_t i = 0; i < this->fluorophoreCount(); ++i) {
+    csv += quote(this->fluorophore(i));
+    for (std::size_t j = 0; j < this->fluorophoreCount(); ++j) {
+      csv += "," + QString::number(this->similarity(i, j), 'f', 6);
+    }
+    csv += "\n";
+  }
+
+  return csv;
+}
+
+/*
+Getter for the amount of slots
+*/
+std::size_t SignatureMatrix::slotCount() const { return static_cast<std::size_t>(this->slot_ids.size()); }
+
+/*
+Adds a fluorophore of the spillover matrix to a new slot, and extends the Gram matrix and factor: O(slots * channels)
+  :param matrix: the spillover matrix
+  :param fluorophore: the fluorophore (row) index in the matrix
+*/
+void SignatureMatrix::appendSlot(const Data::SpilloverMatrix& matrix, std::size_t fluorophore) {
+  const std::size_t channels = this->signature_channels;
+  const std::size_t count = this->slotCount();
+  const std::size_t slot = count;
+
+  this->slot_ids.append(matrix.id(fluorophore));
+  this->slot_signal.resize((count + 1) * channels);
+  double* signal = this->slot_signal.data() + slot * channels;
+  double peak = 0.0;
+  for (std::size_t j = 0; j < channels; ++j) {
+    signal[j] = matrix.signal(fluorophore, j);
+    peak = std::max(peak, signal[j]);
+  }
+  this->slot_peak.push_back(peak);
+
+  // Grow the Gram matrix by a row and column
+  std::vector<double> gram((count + 1) * (count + 1));
+  for (std::size_t a = 0; a < count; ++a) {
+    std::copy(this->slot_gram.begin() + static_cast<std::ptrdiff_t>(a * count),
+              this->slot_gram.begin() + static_cast<std::ptrdiff_t>((a + 1) * count),
+              gram.begin() + static_cast<std::ptrdiff_t>(a * (count + 1)));
+  }
+  for (std::size_t a = 0; a <= count; ++a) {
+    const double* signal_a = this->slot_signal.data() + a * channels;
+    double dot = 0.0;
+    for (std::size_t j = 0; j < channels; ++j) {
+      dot += signal_a[j] * signal[j];
+    }
+    gram[a * (count + 1) + slot] = dot;
+    gram[slot * (count + 1) + a] = dot;
+  }
+  this->slot_gram = std::move(gram);
+
+  this->slot_factor.push_back(SignatureMatrix::none);
+  if (peak > 0.0) {
+    this->appendFactor(slot);
+  }
+}
+
+/*
+Removes a slot, and shrinks the Gram matrix and factor: O(slots^2 + slots * channels)
+  :param slot: the slot index
+*/
+void SignatureMatrix::eraseSlot(std::size_t slot) {
+  const std::size_t channels = this->signature_channels;
+  const std::size_t count = this->slotCount();
+
+  std::size_t index = this->slot_factor[slot];
+  if (index != SignatureMatrix::none) {
+    const std::size_t size = this->factor_slots.size();
+    std::vector<double> reduced((size - 1) * (size - 1));
+    Data::LinearAlgebra::choleskyErase(this->factor.data(), size, index, reduced.data());
+    this->factor = std::move(reduced);
+    this->factor_slots.erase(this->factor_slots.begin() + static_cast<std::ptrdiff_t>(index));
+  }
+
+  std::vector<double> gram;
+  gram.reserve((count - 1) * (count - 1));
+  for (std::size_t a = 0; a < count; ++a) {
+    for (std::size_t b = 0; b < count; ++b) {
+      if (a != slot && b != slot) {
+        gram.push_back(this->slot_gram[a * count + b]);
+      }
+    }
+  }
+  this->slot_gram = std::move(gram);
+
+  this->slot_ids.removeAt(static_cast<int>(slot));
+  this->slot_signal.erase(this->slot_signal.begin() + static_cast<std::ptrdiff_t>(slot * channels),
+                          this->slot_signal.begin() + static_cast<std::ptrdiff_t>((slot + 1) * channels));
+  this->slot_peak.erase(this->slot_peak.begin() + static_cast<std::ptrdiff_t>(slot));
+
+  // Shift the slot indices of the factor
+  this->slot_factor.assign(count - 1, SignatureMatrix::none);
+  for (std::size_t i = 0; i < this->factor_slots.size(); ++i) {
+    if (this->factor_slots[i] > slot) {
+      --this->factor_slots[i];
+    }
+    this->slot_factor[this->factor_slots[i]] = i;
+  }
+}
+
+/*
+Appends a slot to the Cholesky factor: O(factor^2)
+  :param slot: the slot index
+  :returns: whether the slot was added, false if its signal depends on the signals in the factor
+*/
+bool SignatureMatrix::appendFactor(std::size_t slot) {
+  const std::size_t count = this->slotCount();
+  const std::size_t size = this->factor_slots.size();
+
+  std::vector<double> column(size + 1);
+  for (std::size_t i = 0; i < size; ++i) {
+    column[i] = this->slot_gram[this->factor_slots[i] * count + slot];
+  }
+  column[size] = this->slot_gram[slot * count + slot];
+
+  std::vector<double> extended((size + 1) * (size + 1));
+  if (!Data::LinearAlgebra::choleskyAppend(this->factor.data(), size, column.data(), extended.data())) {
+    return false;
+  }
+
+  this->factor = std::move(extended);
+  this->factor_slots.push_back(slot);
+  this->slot_factor[slot] = size;
+  return true;
+}
+
+/*
+Rebuilds the Cholesky factor from the Gram matrix: O(slots^3)
+*/
+void SignatureMatrix::rebuildFactor() {
+  this->factor.clear();
+  this->factor_slots.clear();
+  this->slot_factor.assign(this->slotCount(), SignatureMatrix::none);
+
+  for (std::size_t slot = 0; slot < this->slotCount(); ++slot) {
+    if (this->slot_peak[slot] > 0.0) {
+      this->appendFactor(slot);
+    }
+  }
+}
+
+/*
+Whether any fluorophore with signal depends on the other fluorophores, and therefore is not part of the factor
+*/
+bool SignatureMatrix::isDependent() const {
+  for (std::size_t slot = 0; slot < this->slotCount(); ++slot) {
+    if (this->slot_peak[slot] > 0.0 && this->slot_factor[slot] == SignatureMatrix::none) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+Calculates the complexity index. The factor is of the signals, the signatures are the signals scaled by their peak,
+so the factor of the signatures is the factor with its columns scaled. The singular values of the signatures equal those
+of the (small) scaled factor: O(factor^3) per Jacobi sweep.
+*/
+void SignatureMatrix::calculateComplexity() {
+  const std::size_t size = this->factor_slots.size();
+
+  if (this->isDependent()) {
+    this->signature_complexity = std::numeric_limits<double>::infinity();
+    return;
+  }
+  if (size == 0) {
+    this->signature_complexity = 0.0;
+    return;
+  }
+
+  std::vector<double> scaled(this->factor);
+  for (std::size_t j = 0; j < size; ++j) {
+    double scale = 1.0 / this->slot_peak[this->factor_slots[j]];
+    for (std::size_t i = 0; i <= j; ++i) {
+      scaled[i * size + j] *= scale;
+    }
+  }
+
+  std::vector<double> singular(size);
+  Data::LinearAlgebra::singularValues(scaled.data(), size, singular.data());
+  double largest = singular.front();
+  double smallest = singular.back();
+  this->signature_complexity = smallest > 0.0 ? largest / smallest : std::numeric_limits<double>::infinity();
+}
+
+}  // namespace Data
@@ -0,0 +1,291 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_similarity.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+#include "data_kernels.h"
+#include "data_parallel.h"
+
+namespace Data {
+
+const std::size_t SimilarityIndex::none;
+
+namespace {
+
+// The wavelength grid (in nm) of the spectral signatures
+const double grid_start = 300.0;
+const double grid_step = 2.0;
+const std::size_t grid_size = 301;
+
+/*
+Builds the wavelengths of the spectral signature grid
+*/
+const std::vector<double>& gridWavelengths() {
+  static const std::vector<double> wavelengths = []() {
+    std::vector<double> values(grid_size);
+    for (std::size_t i = 0; i < grid_size; ++i) {
+      values[i] = grid_start + grid_step * static_cast<double>(i);
+    }
+    return values;
+  }();
+  return wavelengths;
+}
+
+/*
+Orders matches on descending similarity, equal similarities on ascending index
+*/
+bool higherMatch(const SimilarityIndex::Match& left, const SimilarityIndex::Match& right) {
+  if (left.similarity != right.similarity) {
+    return left.similarity > right.similarity;
+  }
+  return left.index < right.index;
+}
+
+}  // namespace
+
+/*
+Constructor: constructs an empty index
+*/
+SimilarityIndex::SimilarityIndex()
+    : index_mode(SimilarityIndex::Spectral),
+      index_detectors(),
+      index_ids(),
+      index_names(),
+      index_rows(),
+      index_dimension(0),
+      index_stride(0),
+      index_signatures() {}
+
+/*
+Sets the instrument of the detector signatures. A detector index is cleared and has to be rebuild.
+  :param instrument: the instrument
+*/
+void SimilarityIndex::setInstrument(const Data::Instrument& instrument) {
+  this->index_detectors.setInstrument(instrument);
+  if (this->index_mode == SimilarityIndex::Detector) {
+    this->clear();
+  }
+}
+
+/*
+Builds the signatures of all spectra, in parallel
+  :param mode: the signature type
+  :param spectra: the library spectra
+  :param names: the names of the spectra, if the size doesnt match the spectra the spectrum id's are used
+*/
+void SimilarityIndex::build(SimilarityIndex::Mode mode, const std::vector<Data::Spectrum>& spectra, const QStringList& names) {
+  this->clear();
+  this->index_mode = mode;
+
+  bool use_names = static_cast<std::size_t>(names.size()) == spectra.size();
+  for (std::size_t i = 0; i < spectra.size(); ++i) {
+    this->index_ids.append(spectra[i].id());
+    this->index_names.append(use_names ? names[static_cast<int>(i)] : spectra[i].id());
+    this->index_rows.emplace(spectra[i].id(), i);
+  }
+
+  // Pad the rows to whole 256 bit vectors
+  this->index_dimension = this->signatureDimension(mode);
+  this->index_stride = ((this->index_dimension + 7) / 8) * 8;
+  this->index_signatures.assign(spectra.size() * this->index_stride, 0.0f);
+
+  if (this->index_dimension == 0) {
+    return;
+  }
+
+  Data::parallelFor(spectra.size(), [this, &spectra](std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      this->signature(spectra[i], this->index_signatures.data() + i * this->index_stride);
+    }
+  }, 64);
+}
+
+/*
+Clears the index, keeps the instrument
+*/
+void SimilarityIndex::clear() {
+  this->index_ids.clear();
+  this->index_names.clear();
+  this->index_rows.clear();
+  this->index_dimension = 0;
+  this->index_stride = 0;
+  this->index_signatures.clear();
+}
+
+/*
+Whether the index contains any fluorophores
+*/
+bool SimilarityIndex::isEmpty() const { return this->index_ids.isEmpty(); }
+
+/*
+Getter for the signature type of the index
+*/
+SimilarityIndex::Mode SimilarityIndex::mode() const { return this->index_mode; }
+
+/*
+Getter for the amount of fluorophores in the index
+*/
+std::size_t SimilarityIndex::size() const { return static_cast<std::size_t>(this->index_ids.size()); }
+
+/*
+Getter for the amount of values in a signature
+*/
+std::size_t SimilarityIndex::dimension() const { return this->index_dimension; }
+
+/*
+Finds the index of a fluorophore
+  :param id: the spectrum id
+  :returns: the index, or none if not found
+*/
+std::size_t SimilarityIndex::find(const QString& id) const {
+  auto row = this->index_rows.find(id);
+  if (row == this->index_rows.end()) {
+    return SimilarityIndex::none;
+  }
+  return row->second;
+}
+
+/*
+Getter for the spectrum id of an index
+*/
+const QString& SimilarityIndex::id(std::size_t index) const { return this->index_ids.at(static_cast<int>(index)); }
+
+/*
+Getter for the name of an index
+*/
+const QString& SimilarityIndex::name(std::size_t index) const { return this->index_names.at(static_cast<int>(index)); }
+
+/*
+Finds the most similar fluorophores to a fluorophore of the index, excluding itself
+  :param index: the fluorophore index
+  :param count: the (maximum) amount of matches to return
+  :returns: the matches, most similar first
+*/
+std::vector<SimilarityIndex::Match> SimilarityIndex::query(std::size_t index, std::size_t count) const {
+  if (index >= this->size() || this->index_stride == 0) {
+    return std::vector<SimilarityIndex::Match>();
+  }
+  return this->search(this->index_signatures.data() + index * this->index_stride, count, index);
+}
+
+/*
+Finds the most similar fluorophores to a spectrum
+  :param spectrum: the spectrum, does not have to be part of the index
+  :param count: the (maximum) amount of matches to return
+  :returns: the matches, most similar first
+*/
+std::vector<SimilarityIndex::Match> SimilarityIndex::query(const Data::Spectrum& spectrum, std::size_t count) const {
+  if (this->index_stride == 0) {
+    return std::vector<SimilarityIndex::Match>();
+  }
+
+  std::vector<float> values(this->index_stride, 0.0f);
+  if (!this->signature(spectrum, values.data())) {
+    return std::vector<SimilarityIndex::Match>();
+  }
+  return this->search(values.data(), count, SimilarityIndex::none);
+}
+
+/*
+Getter for the signature dimension of a mode
+*/
+std::size_t SimilarityIndex::signatureDimension(SimilarityIndex::Mode mode) const {
+  if (mode == SimilarityIndex::Detector) {
+    return this->index_detectors.detectorCount();
+  }
+  return 2 * grid_size;
+}
+
+/*
+Calculates the L2 normalized signature of a spectrum for the current mode
+  :param spectrum: the spectrum
+  :param values: (return) buffer of atleast dimension() values
+  :returns: whether the signature is non-zero
+*/
+bool SimilarityIndex::signature(const Data::Spectrum& spectrum, float* values) const {
+  std::vector<double> signal(this->index_dimension, 0.0);
+
+  if (this->index_mode == SimilarityIndex::Detector) {
+    this->index_detectors.calculateSignal(spectrum, signal.data());
+  } else {
+    const std::vector<double>& wavelengths = gridWavelengths();
+    spectrum.excitationAt(wavelengths.data(), signal.data(), grid_size);
+    spectrum.emissionAt(wavelengths.data(), signal.data() + grid_size, grid_size);
+  }
+
+  double norm = 0.0;
+  for (double value : signal) {
+    norm += value * value;
+  }
+  if (norm <= 0.0) {
+    std::fill(values, values + this->index_dimension, 0.0f);
+    return false;
+  }
+
+  double scale = 1.0 / std::sqrt(norm);
+  for (std::size_t i = 0; i < this->index_dimension; ++i) {
+    values[i] = static_cast<float>(signal[i] * scale);
+  }
+  return true;
+}
+
+/*
+Ranks all signatures on their cosine similarity to a (normalized) signature. Every chunk of rows keeps a bounded
+min-heap of its best matches, the chunk results are merged afterwards.
+  :param values: the signature
+  :param count: the (maximum) amount of matches to return
+  :param exclude: index to exclude from the result, or none
+  :returns: the matches, most similar first
+*/
+std::vector<SimilarityIndex::Match> SimilarityIndex::search(const float* values, std::size_t count, std::size_t exclude) const {
+  std::vector<SimilarityIndex::Match> matches;
+  if (count == 0 || this->isEmpty()) {
+    return matches;
+  }
+
+  std::mutex matches_mutex;
+  Data::parallelFor(this->size(), [this, values, count, exclude, &matches, &matches_mutex](std::size_t begin, std::size_t end) {
+    std::vector<float> products(end - begin);
+    Data::Kernel::dotRows(this->index_signatures.data() + begin * this->index_stride, end - begin, this->index_stride, values,
+                          this->index_dimension, products.data());
+
+    // Heap ordered with the worst match on top
+    std::vector<SimilarityIndex::Match> heap;
+    heap.reserve(count);
+    for (std::size_t i = begin; i < end; ++i) {
+      if (i == exclude) {
+        continue;
+      }
+
+      SimilarityIndex::Match match = {i, std::min(1.0, static_cast<double>(products[i - begin]))};
+      if (heap.size() < count) {
+        heap.push_back(match);
+        std::push_heap(heap.begin(), heap.end(), higherMatch);
+      } else if (higherMatch(match, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), higherMatch);
+        heap.back() = match;
+        std::push_heap(heap.begin(), heap.end(), higherMatch);
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(matches_mutex);
+    matches.insert(matches.end(), heap.begin(), heap.end());
+  }, 1024);
+
+  std::sort(matches.begin(), matches.end(), higherMatch);
+  if (matches.size() > count) {
+    matches.resize(count);
+  }
+  return matches;
+}
+
+}  // namespace Data
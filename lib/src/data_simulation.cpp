@@ -0,0 +1,421 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_simulation.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+#include "data_kernels.h"
+#include "data_linalg.h"
+#include "data_parallel.h"
+
+namespace Data {
+
+namespace {
+
+const std::size_t chunk_events = 4096;  // events per random stream, fixed so the result is independent of the threads
+const std::size_t block_events = 256;   // events per sampling block
+const double poisson_limit = 64.0;      // above this mean the Poisson distribution is approximated by a normal distribution
+const std::size_t poisson_maximum = 512;
+
+/*
+The mean and sum of squared deviations (M2) of the unmixed values of one chunk of events
+*/
+struct ChunkMoments {
+  std::vector<double> mean;
+  std::vector<double> m2;
+};
+
+/*
+Rounds a probability down onto a float. The uniform values are floats, so comparing them with the rounded down
+probability gives the same result as comparing them with the exact probability.
+  :param value: the probability
+  :returns: the largest float not above value
+*/
+float floorFloat(double value) {
+  float result = static_cast<float>(value);
+  if (static_cast<double>(result) > value) {
+    result = std::nextafter(result, -1.0f);
+  }
+  return result;
+}
+
+/*
+Builds the cumulative distribution table of a Poisson distribution, up to a cumulative probability of (nearly) 1.0
+  :param mean: the (small) mean
+  :returns: the table, entry k is the probability of atmost k
+*/
+std::vector<float> poissonTable(double mean) {
+  std::vector<float> table;
+  double probability = std::exp(-mean);
+  double cumulative = probability;
+  table.push_back(floorFloat(cumulative));
+  for (std::size_t k = 1; k < poisson_maximum && cumulative < 1.0 - 1e-12; ++k) {
+    probability *= mean / static_cast<double>(k);
+    cumulative += probability;
+    table.push_back(floorFloat(cumulative));
+  }
+  return table;
+}
+
+/*
+Simulates the photon counts of a block of events in one detector
+  :param state: the random stream
+  :param mean: mean photon count
+  :param table: the Poisson table of the mean, only used below the poisson_limit
+  :param noise: standard deviation of the detector noise
+  :param count: amount of events
+  :param offset: subtracted from every count
+  :param buffer: scratch buffer of atleast 2 * count values
+  :param counts: scratch buffer of atleast count values
+  :param output: (return) the first value of the detector in an event major buffer
+  :param stride: distance between the detector values of two events
+*/
+void sampleDetector(Data::Kernel::RandomState& state, double mean, const std::vector<float>& table, double noise, std::size_t count,
+                    double offset, float* buffer, std::uint32_t* counts, float* output, std::size_t stride) {
+  float* uniform = buffer;
+  float* normal = buffer + count;
+
+  if (mean >= poisson_limit) {
+    // Sum of a normal approximated Poisson and the normal noise
+    Data::Kernel::normalFill(state, normal, count);
+    const double deviation = std::sqrt(mean + noise * noise);
+    for (std::size_t e = 0; e < count; ++e) {
+      output[e * stride] = static_cast<float>(mean - offset + deviation * static_cast<double>(normal[e]));
+    }
+    return;
+  }
+
+  // Poisson by (vectorized) inversion of the cumulative table
+  Data::Kernel::uniformFill(state, uniform, count);
+  if (noise > 0.0) {
+    Data::Kernel::normalFill(state, normal, count);
+  }
+  Data::Kernel::lowerBound(table.data(), table.size(), uniform, count, counts);
+  for (std::size_t e = 0; e < count; ++e) {
+    double value = static_cast<double>(counts[e]) - offset;
+    if (noise > 0.0) {
+      value += noise * static_cast<double>(normal[e]);
+    }
+    output[e * stride] = static_cast<float>(value);
+  }
+}
+
+}  // namespace
+
+/*
+Constructor: constructs an empty simulation
+*/
+SpreadingSimulation::SpreadingSimulation()
+    : simulation_matrix(),
+      simulation_options(),
+      unmixing(),
+      spreading_matrix(),
+      event_count(0),
+      cancelled(false),
+      run_progress() {}
+
+/*
+Sets the fluorophores and detectors to simulate
+  :param matrix: the spillover matrix of the panel
+*/
+void SpreadingSimulation::setMatrix(const Data::SpilloverMatrix& matrix) {
+  this->simulation_matrix = matrix;
+  this->spreading_matrix.clear();
+  this->event_count = 0;
+}
+
+/*
+Sets the simulation options
+  :param options: the options
+*/
+void SpreadingSimulation::setOptions(const SpreadingSimulation::Options& options) { this->simulation_options = options; }
+
+/*
+Builds the ordinary least squares unmixing matrix U = (S S^T)^-1 S of the spillover signatures S
+  :returns: whether the signatures are unmixable
+*/
+bool SpreadingSimulation::buildUnmixing() {
+  const std::size_t fluorophores = this->simulation_matrix.fluorophoreCount();
+  const std::size_t detectors = this->simulation_matrix.detectorCount();
+  const Data::SpilloverMatrix& matrix = this->simulation_matrix;
+
+  // Cholesky factor of the Gram matrix, one signature at a time
+  std::vector<double> factor;
+  std::vector<double> extended;
+  std::vector<double> column;
+  for (std::size_t i = 0; i < fluorophores; ++i) {
+    column.assign(i + 1, 0.0);
+    for (std::size_t k = 0; k <= i; ++k) {
+      for (std::size_t j = 0; j < detectors; ++j) {
+        column[k] += matrix.spillover(k, j) * matrix.spillover(i, j);
+      }
+    }
+
+    extended.resize((i + 1) * (i + 1));
+    if (!Data::LinearAlgebra::choleskyAppend(factor.data(), i, column.data(), extended.data())) {
+      return false;
+    }
+    factor.swap(extended);
+  }
+
+  // Solve R^T R u = s for every detector column s of S
+  this->unmixing.assign(fluorophores * detectors, 0.0f);
+  std::vector<double> solve(fluorophores);
+  for (std::size_t j = 0; j < detectors; ++j) {
+    for (std::size_t i = 0; i < fluorophores; ++i) {
+      double sum = matrix.spillover(i, j);
+      for (std::size_t k = 0; k < i; ++k) {
+        sum -= factor[k * fluorophores + i] * solve[k];
+      }
+      solve[i] = sum / factor[i * fluorophores + i];
+    }
+    for (std::size_t i = fluorophores; i > 0; --i) {
+      double sum = solve[i - 1];
+      for (std::size_t k = i; k < fluorophores; ++k) {
+        sum -= factor[(i - 1) * fluorophores + k] * solve[k];
+      }
+      solve[i - 1] = sum / factor[(i - 1) * fluorophores + (i - 1)];
+    }
+    for (std::size_t i = 0; i < fluorophores; ++i) {
+      this->unmixing[i * detectors + j] = static_cast<float>(solve[i]);
+    }
+  }
+
+  return true;
+}
+
+/*
+Runs the simulation, blocks until finished or cancelled.
+Every fluorophore has a single stained control, the last control is unstained. A stained event has a mean of
+brightness * spillover photons in every detector, every event has the background on top. The controls are split in
+chunks of events that each have their own random stream. The mean and M2 of the unmixed values are accumulated per chunk
+(Welford), and the chunks are merged in chunk order (Chan et al.), so the result is deterministic for a seed.
+The spillover spreading of stained fluorophore i into fluorophore j is
+  sqrt(variance_stained(j) - variance_unstained(j)) / sqrt(mean_stained(i) - mean_unstained(i))
+  :param token: the cancellation token, polled between the chunks
+  :param report: (optional) called upon every progress change with the progress (0.0-1.0), from the worker threads
+  :returns: whether the simulation finished, false if cancelled or the fluorophores cannot be unmixed
+*/
+bool SpreadingSimulation::run(const Data::JobToken& token, std::function<void(double)> report) {
+  this->cancelled = token.isCancelled();
+  this->run_progress.reset(std::move(report));
+  this->spreading_matrix.clear();
+  this->event_count = 0;
+  if (this->cancelled) {
+    return false;
+  }
+
+  const std::size_t fluorophores = this->simulation_matrix.fluorophoreCount();
+  const std::size_t detectors = this->simulation_matrix.detectorCount();
+  const SpreadingSimulation::Options options = this->simulation_options;
+  if (fluorophores == 0 || detectors == 0 || options.events < 2) {
+    this->run_progress.set(1000);
+    return true;
+  }
+
+  if (!this->buildUnmixing()) {
+    qWarning() << "SpreadingSimulation::run: the fluorophores cannot be unmixed";
+    return false;
+  }
+
+  const std::size_t controls = fluorophores + 1;
+  const std::size_t chunks = (options.events + chunk_events - 1) / chunk_events;
+  const std::size_t jobs = controls * chunks;
+  std::vector<ChunkMoments> moments(jobs);
+  std::atomic<std::size_t> finished(0);
+
+  // Mean photon counts per control and detector
+  std::vector<double> means(controls * detectors, options.background);
+  for (std::size_t i = 0; i < fluorophores; ++i) {
+    for (std::size_t j = 0; j < detectors; ++j) {
+      means[i * detectors + j] += options.brightness * std::max(0.0, this->simulation_matrix.spillover(i, j));
+    }
+  }
+  std::vector<std::vector<float>> tables(controls * detectors);
+  for (std::size_t i = 0; i < tables.size(); ++i) {
+    if (means[i] < poisson_limit) {
+      tables[i] = poissonTable(means[i]);
+    }
+  }
+
+  Data::parallelFor(jobs, [&](std::size_t begin, std::size_t end) {
+    std::vector<float> events(block_events * detectors);
+    std::vector<float> buffer(block_events * 2);
+    std::vector<std::uint32_t> counts(block_events);
+    std::vector<float> unmixed(fluorophores);
+
+    for (std::size_t job = begin; job < end; ++job) {
+      if (token.isCancelled()) {
+        return;
+      }
+
+      const std::size_t control = job / chunks;
+      const std::size_t chunk = job % chunks;
+      const std::size_t chunk_count = std::min(chunk_events, options.events - chunk * chunk_events);
+
+      Data::Kernel::RandomState state;
+      Data::Kernel::seedRandom(state, options.seed ^ (static_cast<std::uint64_t>(job + 1) * 0xD1B54A32D192ED03ull));
+
+      ChunkMoments& local = moments[job];
+      local.mean.assign(fluorophores, 0.0);
+      local.m2.assign(fluorophores, 0.0);
+
+      for (std::size_t block = 0; block < chunk_count; block += block_events) {
+        const std::size_t count = std::min(block_events, chunk_count - block);
+
+        // Detector major sampling into event major rows, without the (known) background
+        for (std::size_t j = 0; j < detectors; ++j) {
+          const std::size_t index = control * detectors + j;
+          sampleDetector(state, means[index], tables[index], options.noise, count, options.background, buffer.data(), counts.data(),
+                         events.data() + j, detectors);
+        }
+
+        for (std::size_t e = 0; e < count; ++e) {
+          Data::Kernel::dotRows(this->unmixing.data(), fluorophores, detectors, events.data() + e * detectors, detectors, unmixed.data());
+          const double inverse = 1.0 / static_cast<double>(block + e + 1);
+          for (std::size_t i = 0; i < fluorophores; ++i) {
+            const double value = static_cast<double>(unmixed[i]);
+            const double delta = value - local.mean[i];
+            local.mean[i] += delta * inverse;
+            local.m2[i] += delta * (value - local.mean[i]);
+          }
+        }
+      }
+
+      const std::size_t done = ++finished;
+      this->run_progress.set(static_cast<int>((done * 1000) / jobs));
+    }
+  });
+
+  if (token.isCancelled()) {
+    this->cancelled = true;
+    return false;
+  }
+
+  // Merge the chunks in order into the mean and variance of every control
+  std::vector<double> mean(controls * fluorophores, 0.0);
+  std::vector<double> variance(controls * fluorophores, 0.0);
+  for (std::size_t control = 0; control < controls; ++control) {
+    for (std::size_t i = 0; i < fluorophores; ++i) {
+      double count = 0.0;
+      double merged_mean = 0.0;
+      double merged_m2 = 0.0;
+      for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+        const ChunkMoments& local = moments[control * chunks + chunk];
+        const double chunk_count = static_cast<double>(std::min(chunk_events, options.events - chunk * chunk_events));
+        const double total = count + chunk_count;
+        const double delta = local.mean[i] - merged_mean;
+        merged_mean += delta * chunk_count / total;
+        merged_m2 += local.m2[i] + delta * delta * count * chunk_count / total;
+        count = total;
+      }
+      mean[control * fluorophores + i] = merged_mean;
+      variance[control * fluorophores + i] = merged_m2 / (count - 1.0);
+    }
+  }
+
+  const double* unstained_mean = mean.data() + fluorophores * fluorophores;
+  const double* unstained_variance = variance.data() + fluorophores * fluorophores;
+  this->spreading_matrix.assign(fluorophores * fluorophores, 0.0);
+  for (std::size_t i = 0; i < fluorophores; ++i) {
+    const double signal = mean[i * fluorophores + i] - unstained_mean[i];
+    if (!(signal > 0.0)) {
+      continue;
+    }
+    for (std::size_t j = 0; j < fluorophores; ++j) {
+      if (i == j) {
+        continue;
+      }
+      const double spread = std::max(0.0, variance[i * fluorophores + j] - unstained_variance[j]);
+      this->spreading_matrix[i * fluorophores + j] = std::sqrt(spread) / std::sqrt(signal);
+    }
+  }
+
+  this->event_count = controls * options.events;
+  this->run_progress.set(1000);
+  return true;
+}
+
+/*
+Whether the last simulation was cancelled
+*/
+bool SpreadingSimulation::isCancelled() const { return this->cancelled; }
+
+/*
+Getter for the progress of a running simulation, can be called from any thread
+  :returns: progress (0.0-1.0)
+*/
+double SpreadingSimulation::progress() const { return this->run_progress.value(); }
+
+/*
+Whether the simulation has a result
+*/
+bool SpreadingSimulation::isEmpty() const { return this->spreading_matrix.empty(); }
+
+/*
+Getter for the amount of fluorophores
+*/
+std::size_t SpreadingSimulation::fluorophoreCount() const { return this->simulation_matrix.fluorophoreCount(); }
+
+/*
+Getter for the total amount of simulated events of the last finished simulation
+*/
+std::size_t SpreadingSimulation::eventCount() const { return this->event_count; }
+
+/*
+Getter for a fluorophore name
+  :param fluorophore: the fluorophore index
+*/
+const QString& SpreadingSimulation::fluorophore(std::size_t fluorophore) const { return this->simulation_matrix.fluorophore(fluorophore); }
+
+/*
+Getter for a spillover spreading value, the spread the stained fluorophore causes in another fluorophore
+  :param stained: the stained fluorophore (row) index
+  :param fluorophore: the spread into fluorophore (column) index
+  :returns: the spreading in sqrt(photons), 0.0 on the diagonal
+*/
+double SpreadingSimulation::spreading(std::size_t stained, std::size_t fluorophore) const {
+  return this->spreading_matrix[stained * this->fluorophoreCount() + fluorophore];
+}
+
+/*
+Exports the spillover spreading matrix as comma separated values, with a header row and column
+*/
+QString SpreadingSimulation::toCSV() const {
+  // Quote every name, they can contain comma's
+  auto quote = [](const QString& text) {
+    QString quoted = text;
+    quoted.replace('"', "\"\"");
+    return QString("\"%1\"").arg(quoted);
+  };
+
+  QString csv = quote("Stained");
+  for (std::size_t j = 0; j < this->fluorophoreCount(); ++j) {
+    csv += "," + quote(this->fluorophore(j));
+  }
+  csv += "\n";
+
+  if (this->isEmpty()) {
+    return csv;
+  }
+
+  for (std::size_t i = 0; i < this->fluorophoreCount(); ++i) {
+    csv += quote(this->fluorophore(i));
+    for (std::size_t j = 0; j < this->fluorophoreCount(); ++j) {
+      csv += "," + QString::number(this->spreading(i, j), 'f', 6);
+    }
+    csv += "\n";
+  }
+
+  return csv;
+}
+
+}  // namespace Data
@@ -8,6 +8,12 @@
 
 #include "data_spectrum.h"
 
+#include <algorithm>
+#include <cmath>
+
+#include "data_kernels.h"
+#include "data_trace.h"
+
 namespace Data {
 
 /*
@@ -25,36 +31,81 @@ Meta::Meta(double excitation_max, double emission_max) : excitation_max(excitati
 /* ######################################################################################### */
 
 /*
-Constructor: Construct an empty Polygon object with a 0-1 curve
+Constructor: Construct an empty Polygon object
 */
-Polygon::Polygon() : x_min(-1.0), x_max(-1.0), y_min(-1.0), y_max(-1.0), curve_color(0, 0, 0), curve(2) {
-  // Build a mock curve to always have 'valid' data for calculations even if Polygon is empty
-  this->curve << QPointF(0, 0) << QPointF(1, 1);
-}
+Polygon::Polygon()
+    : x_min(-1.0),
+      x_max(-1.0),
+      y_min(-1.0),
+      y_max(-1.0),
+      curve_color(0, 0, 0),
+      source_owner(nullptr),
+      source_start(0.0),
+      source_step(1.0),
+      source_step_inverse(1.0),
+      source_y(nullptr),
+      source_cumulative(nullptr),
+      source_size(0),
+      curve() {}
 
 /*
-Constructor: Construct a polygon object
-  :param x_min: global scale x[0] value in wavelength nanometers
-  :param x_max: global scale x[-1] value in wavelength nanometers
-  :param y_min: global scale y[0] value in intensity percentage
-  :param y_max: global scale y[-1] value in intensity percentage
+Constructor: Construct a polygon object as a view on a uniform grid curve in the spectrum storage. Does not copy the curve data.
+  :param owner: the owner of the storage, kept alive for the lifetime of the polygon
+  :param start: the wavelength of the first y value in nanometers
+  :param step: the (positive) wavelength step between two y values in nanometers
+  :param y: pointer to the y values, in intensity percentage
+  :param size: amount of points
+  :param cumulative: (optional) pointer to the cumulative integral of y, see Polygon::cumulate
 */
-Polygon::Polygon(double x_min, double x_max, double y_min, double y_max, QPolygonF curve)
-    : x_min(x_min), x_max(x_max), y_min(y_min), y_max(y_max), curve_color(0, 0, 0), curve(curve) {}
+Polygon::Polygon(std::shared_ptr<const void> owner, double start, double step, const float* y, int size, const float* cumulative)
+    : x_min(-1.0),
+      x_max(-1.0),
+      y_min(-1.0),
+      y_max(-1.0),
+      curve_color(0, 0, 0),
+      source_owner(std::move(owner)),
+      source_start(start),
+      source_step(step > 0.0 ? step : 1.0),
+      source_step_inverse(1.0 / this->source_step),
+      source_y(y),
+      source_cumulative(cumulative),
+      source_size(size),
+      curve() {
+  if (this->source_size > 0) {
+    this->x_min = this->source_start;
+    this->x_max = this->source_start + this->source_step * (this->source_size - 1);
+    this->y_min = 0.0;
+    this->y_max = 100.0;
+  } else {
+    this->source_size = 0;
+  }
+}
 
 /*
-Copy constructor: copy construct a polygon object.
+Copy constructor: copy construct a polygon object. The source view is shared.
 Necessary cause the internal QVector<QPointF> of QPolygonF defaults to shallow copies. As polygon objects are copied for plotting they will
 always be modified. I would like to incur this performance hit upon curve adding and upon the first draw.
 */
 Polygon::Polygon(const Polygon& other)
-    : x_min(other.x_min), x_max(other.x_max), y_min(other.y_min), y_max(other.y_max), curve_color(other.curve_color), curve(other.curve) {
+    : x_min(other.x_min),
+      x_max(other.x_max),
+      y_min(other.y_min),
+      y_max(other.y_max),
+      curve_color(other.curve_color),
+      source_owner(other.source_owner),
+      source_start(other.source_start),
+      source_step(other.source_step),
+      source_step_inverse(other.source_step_inverse),
+      source_y(other.source_y),
+      source_cumulative(other.source_cumulative),
+      source_size(other.source_size),
+      curve(other.curve) {
   // Detach to make deepcopy
   this->curve.detach();
 }
 
 /*
-Assignment operator. Deepcopies the QPolygonF curve.
+Assignment operator. Shares the source view, deepcopies the QPolygonF curve.
 */
 Polygon& Polygon::operator=(const Polygon& other) {
   if (this != &other) {
@@ -63,6 +114,13 @@ Polygon& Polygon::operator=(const Polygon& other) {
     this->y_min = other.y_min;
     this->y_max = other.y_max;
     this->curve_color = other.curve_color;
+    this->source_owner = other.source_owner;
+    this->source_start = other.source_start;
+    this->source_step = other.source_step;
+    this->source_step_inverse = other.source_step_inverse;
+    this->source_y = other.source_y;
+    this->source_cumulative = other.source_cumulative;
+    this->source_size = other.source_size;
     this->curve = other.curve;
     // Detach to make deepcopy
     this->curve.detach();
@@ -70,15 +128,6 @@ Polygon& Polygon::operator=(const Polygon& other) {
   return *this;
 }
 
-// QDebug operator<<(QDebug stream, const Polygon& object) {
-//   if (object.empty()) {
-//     return stream << "Data::Polygon{}";
-//   }
-//
-//   return stream << "Data::Polygon{" << object.x_min << "-" << object.x_max << ":" << object.curve[0] << "-" <<
-//   object.curve[object.curve.size() - 1] << "}";
-// }
-
 /*
 Checks whether polygon is empty
   :returns: whether the polygon is empty. Althought the object is empty it is always in a defined state
@@ -91,26 +140,31 @@ bool Polygon::empty() const {
 }
 
 /*
-Returns the intensity at the specified wavelength. Calculates the index to it and returns that wavelength.
-Assumes a linear distribution of the curve to be able to calculate the index
+Getter for the amount of points in the source curve
+  :returns: source curve size
+*/
+int Polygon::size() const { return this->source_size; }
+
+/*
+Returns the intensity at the specified wavelength. The index is calculated directly from the uniform grid,
+and the intensity is linearly interpolated between the two neighbouring grid points.
   :param wavelength: global wavelength in nanometers
   :param cutoff: if intensity is below cutoff, reduces intensity to 0.0
-  :returns: intensity (0.0-1.0)
+  :returns: intensity (0.0-100.0)
 */
 double Polygon::intensityAt(double wavelength, double cutoff) const {
-  if (wavelength < this->x_min || wavelength > this->x_max) {
+  if (this->source_size == 0 || wavelength < this->x_min || wavelength > this->x_max) {
     return 0.0;
   }
 
-  double fraction = (wavelength - x_min) / (x_max - x_min);
-  fraction *= (this->curve.size() - 1);
-  int index = static_cast<int>(fraction);
+  double position = (wavelength - this->source_start) * this->source_step_inverse;
+  int index = std::min(static_cast<int>(position), this->source_size - 1);
+  int next = std::min(index + 1, this->source_size - 1);
+  double fraction = position - index;
 
-  double intensity = 0.0;
-  // Prevent indexing outside of curve; can happen if fluorophore.json data does not adhere to 1nm steps for x.
-  if (index < this->curve.size()) {
-    intensity = this->curve[index].y();
-  }
+  double intensity_index = static_cast<double>(this->source_y[index]);
+  double intensity_next = static_cast<double>(this->source_y[next]);
+  double intensity = intensity_index + (intensity_next - intensity_index) * fraction;
 
   if (intensity <= cutoff) {
     intensity = 0.0;
@@ -120,21 +174,29 @@ double Polygon::intensityAt(double wavelength, double cutoff) const {
 }
 
 /*
-Returns the intensity at the specified wavelength. Uses binary search to find the wavelength.
+Evaluates the intensity at many wavelengths in a single (vectorized) call. Equal to calling intensityAt for each wavelength.
+  :param wavelengths: global wavelengths in nanometers
+  :param intensities: (return) buffer of atleast count values to write the intensities (0.0-100.0) into
+  :param count: amount of wavelengths
+  :param cutoff: if intensity is below cutoff, reduces intensity to 0.0
+*/
+void Polygon::intensityAt(const double* wavelengths, double* intensities, std::size_t count, double cutoff) const {
+  Data::Kernel::sampleGrid(this->source_y, this->source_size, this->source_start, this->source_step, wavelengths, intensities, count, cutoff);
+}
+
+/*
+Returns the intensity of the grid point at or directly below the specified wavelength, without interpolation.
   :param wavelength: global wavelength in nanometers
   :param cutoff: if intensity is below cutoff, reduces intensity to 0.0
-  :returns: intensity (0.0-1.0)
+  :returns: intensity (0.0-100.0)
 */
 double Polygon::intensityAtIter(double wavelength, double cutoff) const {
-  if (wavelength < this->x_min || wavelength > this->x_max) {
+  if (this->source_size == 0 || wavelength < this->x_min || wavelength > this->x_max) {
     return 0.0;
   }
 
-  double fraction = (wavelength - x_min) / (x_max - x_min);
-  auto index =
-      std::lower_bound(this->curve.cbegin(), this->curve.cend(), fraction, [](const QPointF& lhs, double rhs) { return lhs.x() < rhs; });
-
-  double intensity = index->y();
+  int index = std::min(static_cast<int>((wavelength - this->source_start) * this->source_step_inverse), this->source_size - 1);
+  double intensity = static_cast<double>(this->source_y[index]);
 
   if (intensity <= cutoff) {
     intensity = 0.0;
@@ -148,22 +210,82 @@ Finds the wavelength of the (first) highest y value. Technically could look for
 that value. :returns: wavelength in nanometers
 */
 double Polygon::intensityMax() const {
-  double max = 0.0;
+  if (this->source_size == 0) {
+    return this->x_min;
+  }
+
+  float max = 0.0f;
   int max_index = 0;
 
-  for (int i = 0; i < this->curve.size(); ++i) {
-    if (this->curve[i].y() > max) {
-      max = this->curve[i].y();
+  for (int i = 0; i < this->source_size; ++i) {
+    if (this->source_y[i] > max) {
+      max = this->source_y[i];
       max_index = i;
     }
   }
 
-  // Transform back to global wavelength
-  double fraction = (this->x_max - this->x_min);
-  fraction *= this->curve[max_index].x();
-  fraction += this->x_min;
+  return this->source_start + this->source_step * max_index;
+}
 
-  return fraction;
+/*
+Integrates the curve over a wavelength window using the trapezoidal rule. The window is clipped to the curve,
+the window edges are linearly interpolated. If the curve has a cumulative integral table this is two lookups.
+  :param wavelength_min: window start in nanometers
+  :param wavelength_max: window end in nanometers
+  :returns: the integral in intensity (%) * wavelength (nm)
+*/
+double Polygon::integral(double wavelength_min, double wavelength_max) const {
+  double begin = std::max(wavelength_min, this->x_min);
+  double end = std::min(wavelength_max, this->x_max);
+  if (this->source_size < 2 || !(end > begin)) {
+    return 0.0;
+  }
+
+  if (this->source_cumulative) {
+    return this->cumulativeAt(end) - this->cumulativeAt(begin);
+  }
+
+  // First grid point at/above begin, and last grid point at/below end
+  int index_begin = std::min(static_cast<int>(std::ceil((begin - this->source_start) * this->source_step_inverse)), this->source_size - 1);
+  int index_end = std::min(static_cast<int>(std::floor((end - this->source_start) * this->source_step_inverse)), this->source_size - 1);
+
+  double intensity_begin = this->intensityAt(begin);
+  double intensity_end = this->intensityAt(end);
+
+  // Window in between two grid points
+  if (index_begin > index_end) {
+    return 0.5 * (intensity_begin + intensity_end) * (end - begin);
+  }
+
+  double x_begin = this->source_start + this->source_step * index_begin;
+  double x_end = this->source_start + this->source_step * index_end;
+
+  double sum = 0.5 * (intensity_begin + static_cast<double>(this->source_y[index_begin])) * (x_begin - begin);
+  for (int i = index_begin; i < index_end; ++i) {
+    sum += 0.5 * static_cast<double>(this->source_y[i] + this->source_y[i + 1]) * this->source_step;
+  }
+  sum += 0.5 * (static_cast<double>(this->source_y[index_end]) + intensity_end) * (end - x_end);
+
+  return sum;
+}
+
+/*
+Returns the cumulative integral from the start of the curve up to the wavelength, uses the cumulative integral table.
+  :param wavelength: wavelength in nanometers, should be within the curve bounds
+  :returns: the integral in intensity (%) * wavelength (nm)
+*/
+double Polygon::cumulativeAt(double wavelength) const {
+  double position = (wavelength - this->source_start) * this->source_step_inverse;
+  int index = std::max(0, std::min(static_cast<int>(position), this->source_size - 1));
+  int next = std::min(index + 1, this->source_size - 1);
+  double fraction = position - index;
+
+  // Integral of the trapezoid between the grid point and the wavelength
+  double intensity_index = static_cast<double>(this->source_y[index]);
+  double intensity = intensity_index + (static_cast<double>(this->source_y[next]) - intensity_index) * fraction;
+  double partial = 0.5 * (intensity_index + intensity) * (fraction * this->source_step);
+
+  return static_cast<double>(this->source_cumulative[index]) + partial;
 }
 
 /*
@@ -198,6 +320,12 @@ Getter for the curve
 */
 QPolygonF& Polygon::polygon() { return this->curve; }
 
+/*
+Const getter for the curve
+  :returns: the curve polygon
+*/
+const QPolygonF& Polygon::polygon() const { return this->curve; }
+
 /*
 Calculates whether a point is contained within the polygon.
 As the scaling is unknown, will use a binary search instead
@@ -232,49 +360,6 @@ bool Polygon::contains(const QPointF& point, double line_width) const {
   }
 }
 
-/*
-Calculates whether a point is contained within the polygon.
-Function uses the scaling functions for lookup in scaled curves
-Note: this function assumes a x-stepsize of 1 after scaling (to global)
-  :param point: the poin to check in local coordinates
-  :param line_width: the polygon line width size. If not applicable use 0.
-  :param scale_x: the local to global scaling function for the x-value
-  :returns: true if the point is on or below the polygon, otherwise false.
-*/
-bool Polygon::contains(const QPointF& point, double line_width, std::function<double(double)> scale_x) const {
-  // Polygon is empty if it is outside of the axis
-  if (this->curve.empty()) {
-    return false;
-  }
-
-  // Determine if point is within the curve range
-  double start = this->curve[0].x();
-  double end = this->curve[this->curve.size() - 1].x();
-  if (point.x() < start || point.x() > end) {
-    return false;
-  }
-
-  double point_x_global = scale_x(point.x());
-  double point_begin_global = scale_x(this->curve[0].x());
-
-  // Determine entree index in
-  int index = static_cast<int>(point_x_global - point_begin_global + 0.5);
-  // Prevent indexing outside of curve; can happen if fluorophore.json data does not adhere to 1nm steps for x.
-  if (index >= this->curve.size()) {
-    return false;
-  }
-  double entree_y = this->curve[index].y();
-
-  // Correct for line tickness
-  entree_y -= (0.5 * line_width);
-
-  if (point.y() >= entree_y) {
-    return true;
-  } else {
-    return false;
-  }
-}
-
 /*
 (Static) Returns the color of the maximum emission intensity, uses linear approximation
 Source: http://www.efg2.com/Lab/ScienceAndEngineering/Spectra.htm
@@ -333,155 +418,149 @@ QColor Polygon::visibleSpectrum(double wavelength) {
 }
 
 /*
-Scales the curve in the given/local space according to the global space
-  :param base: the unmodified original of this polygon; used as base for all the calculations
-  :param size: the local size the curve is fitted into
-  :param xg_begin: the global x begin value, eg wavelength (nm)
-  :param xg_end: the global x end value, eg wavelength (nm)
-  :param yg_begin: the global y begin value, eg intensity (%)
-  :param yg_end: the global y end value, eg intensity (%)
-  :param intensity: the y (intensity) scaling value
+(Static) Resamples a curve onto a uniform grid. A curve that already is on a uniform grid is copied as-is,
+otherwise the curve is linearly interpolated onto a 1 nm grid.
+  :param x: the x values in wavelength nanometers, in ascending order
+  :param y: the y values in intensity percentage
+  :param size: amount of points
+  :param grid: (return) the y values on the uniform grid
+  :param start: (return) the wavelength of grid[0]
+  :param step: (return) the grid step size
 */
-void Polygon::scale(const Data::Polygon& base, const QRectF& size, const double xg_begin, const double xg_end, const double yg_begin,
-                    const double yg_end, const double intensity) {
-  // Double check for base size, there should not be any resizing of the internal QVector
-  if (base.curve.capacity() != this->curve.capacity()) {
-    qWarning() << "Data::Polygon::scale: base and this object have different capacity QPolygonF, operation is not guaranteed to be safe, "
-                  "function call is ignored.";
+void Polygon::resample(const float* x, const float* y, int size, std::vector<float>& grid, double& start, double& step) {
+  grid.clear();
+  start = 0.0;
+  step = 1.0;
+  if (size <= 0) {
     return;
   }
 
-  // Check for fully out of bound curve
-  if (xg_begin > this->x_max || xg_end < this->x_min) {
-    // Empty curve
-    this->curve.resize(0);
+  start = static_cast<double>(x[0]);
+  double range = static_cast<double>(x[size - 1]) - start;
+  if (size == 1 || range <= 0.0) {
+    grid.assign(y, y + 1);
     return;
   }
 
-  // First resize polygon to base size to prevent undefined behavior
-  this->curve.resize(base.curve.size());
-
-  // Calculate x parameters
-  double x_fraction = size.width() / (xg_end - xg_begin);
-  double xl_start = (this->x_min - xg_begin) * x_fraction;
-  double xl_end = (this->x_max - xg_begin) * x_fraction;
-  double xl_diff = xl_end - xl_start;
-
-  // Calculate y parameters
-  double y_fraction = size.height() / (yg_end - yg_begin);
-  double yl_start = (this->y_min - yg_begin) * y_fraction;
-  double yl_end = (this->y_max - yg_begin) * y_fraction;
-  double yl_diff = yl_start - yl_end;
-
-  // Iterate through polygons, while keeping in mind the x-limits
-  int this_i = 0;
-  for (int base_i = 0; base_i < base.curve.size(); ++base_i) {
-    double x = base.curve.at(base_i).x();
-    double y = base.curve.at(base_i).y();
-
-    // Calculate scaled x and y; y has to be reversed because the local coordinate system of y is from top to bottom
-    x = xl_start + (x * xl_diff);
-    y = yl_start - (y * yl_diff * intensity);
-
-    // Make sure that the y values are not outside the size rectangle
-    if (y < size.top()) {
-      y = size.top();
-    } else if (y > size.bottom()) {
-      y = size.bottom();
-    }
-
-    // Make sure that x is within the size rectangle
-    if (x < size.left()) {
-      this->curve[0].setX(size.left());
-      this->curve[0].setY(y);
-
-      // Set i to 1, to allow for normal continuation, but not throw-off repeated hits of this if statement
-      this_i = 1;
-      continue;
-    } else if (x > size.right()) {
-      // further x-values are outside of the plotting rect
-      this->curve[this_i].setX(size.right());
-      this->curve[this_i].setY(y);
-      ++this_i;
+  // Check for uniform spacing, the json data commonly is on 1 nm steps
+  double mean_step = range / (size - 1);
+  bool uniform = true;
+  for (int i = 1; i < size; ++i) {
+    double difference = static_cast<double>(x[i]) - static_cast<double>(x[i - 1]);
+    if (std::abs(difference - mean_step) > mean_step * 1e-3) {
+      uniform = false;
       break;
     }
+  }
 
-    // Parse values
-    this->curve[this_i].setX(x);
-    this->curve[this_i].setY(y);
-    ++this_i;
+  if (uniform) {
+    step = mean_step;
+    grid.assign(y, y + size);
+    return;
   }
 
-  // Remove unused polygon entrees
-  this->curve.remove(this_i, this->curve.size() - this_i);
+  // Linear interpolation onto a 1 nm grid
+  std::size_t count = static_cast<std::size_t>(range / step) + 1;
+  grid.resize(count);
+
+  int j = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    double wavelength = start + step * static_cast<double>(i);
+    while (j < size - 2 && static_cast<double>(x[j + 1]) < wavelength) {
+      ++j;
+    }
+
+    double x_left = static_cast<double>(x[j]);
+    double x_right = static_cast<double>(x[j + 1]);
+    double fraction = x_right > x_left ? (wavelength - x_left) / (x_right - x_left) : 0.0;
+    fraction = std::max(0.0, std::min(1.0, fraction));
+
+    double y_left = static_cast<double>(y[j]);
+    double y_right = static_cast<double>(y[j + 1]);
+    grid[i] = static_cast<float>(y_left + (y_right - y_left) * fraction);
+  }
 }
 
 /*
-Scales the curve in the given/local space according to the global space
-  :param base: the unmodified original of this polygon; used as base for all the calculations
-  :param scale_x: the scaling function for the x value
-  :param scale_y: the scaling function for the y value
-  :param intensity: the y (intensity) scaling value
+(Static) Calculates the cumulative (trapezoidal) integral table of a uniform grid curve. The sum is accumulated in double precision.
+  :param y: the grid intensities
+  :param size: amount of grid points
+  :param step: the grid step size
+  :param cumulative: (return) buffer of size values, cumulative[i] is the integral from grid point 0 to grid point i
 */
-void Polygon::scale(const Data::Polygon& base, const QRectF& size, std::function<double(double)> scale_x,
-                    std::function<double(double, double)> scale_y, const double intensity) {
-  // Double check for base size, there should not be any resizing of the internal QVector
-  if (base.curve.capacity() != this->curve.capacity()) {
-    qWarning() << "Data::Polygon::scale: base and this object have different capacity QPolygonF, operation is not guaranteed to be safe, "
-                  "function call is ignored.";
+void Polygon::cumulate(const float* y, int size, double step, float* cumulative) {
+  if (size <= 0) {
     return;
   }
 
+  double sum = 0.0;
+  cumulative[0] = 0.0f;
+  for (int i = 1; i < size; ++i) {
+    sum += 0.5 * static_cast<double>(y[i - 1] + y[i]) * step;
+    cumulative[i] = static_cast<float>(sum);
+  }
+}
+
+/*
+Scales the curve in the given/local space according to an affine global to local transform.
+The x-range clipping is resolved once from the (ascending) grid, the points within are transformed in one vectorized pass.
+  :param base: the unmodified original of this polygon; used as base for all the calculations
+  :param size: the local size the curve is fitted into
+  :param transform: the global to local transform, only the scale (m11, m22) and translation (dx, dy) are used. m11 has to be positive
+  :param intensity: the y (intensity) scaling value
+*/
+void Polygon::scale(const Data::Polygon& base, const QRectF& size, const QTransform& transform, const double intensity) {
+  DATA_TRACE_SCOPE("Polygon::scale");
   // Check for fully out of bound curve
-  if (size.left() > scale_x(this->x_max) || size.right() < scale_x(this->x_min)) {
+  if (base.source_size == 0 || !(transform.m11() > 0.0) || size.left() > base.x_max * transform.m11() + transform.dx() ||
+      size.right() < base.x_min * transform.m11() + transform.dx()) {
     // Empty curve
     this->curve.resize(0);
     return;
   }
 
-  // First resize polygon to base size to prevent undefined behavior
-  this->curve.resize(base.curve.size());
-
-  // Iterate through polygons, while keeping in mind the x-limits
-  int this_i = 0;
-  for (int base_i = 0; base_i < base.curve.size(); ++base_i) {
-    double x = base.curve.at(base_i).x();
-    double y = base.curve.at(base_i).y();
-
-    x = scale_x(x);
-    y = scale_y(y, intensity);
-
-    // Make sure that the y values are not outside the size rectangle
-    if (y < size.top()) {
-      y = size.top();
-    } else if (y > size.bottom()) {
-      y = size.bottom();
-    }
+  // Reserve once (with two additional entrees for closeCurve), afterwards the internal QVector is never reallocated
+  if (this->curve.capacity() < base.source_size + 2) {
+    this->curve.reserve(base.source_size + 2);
+  }
 
-    // Make sure that x is within the size rectangle
-    if (x < size.left()) {
-      this->curve[0].setX(size.left());
-      this->curve[0].setY(y);
-
-      // Set i to 1, to allow for normal continuation, but not throw-off repeated hits of this if statement
-      this_i = 1;
-      continue;
-    } else if (x > size.right()) {
-      // further x-values are outside of the plotting rect
-      this->curve[this_i].setX(size.right());
-      this->curve[this_i].setY(y);
-      ++this_i;
-      break;
-    }
+  // The local x of the grid: x[i] = x_origin + x_step * i
+  const double x_origin = base.source_start * transform.m11() + transform.dx();
+  const double x_step = base.source_step * transform.m11();
+  auto x_at = [x_origin, x_step](int i) { return x_origin + x_step * static_cast<double>(i); };
+
+  // First point at or right of the left edge, estimated (NaN for a single point grid) and then corrected for rounding
+  const double last = static_cast<double>(base.source_size);
+  double estimate_begin = std::ceil((size.left() - x_origin) / x_step);
+  int inside_begin = !(estimate_begin > 0.0) ? 0 : estimate_begin < last ? static_cast<int>(estimate_begin) : base.source_size;
+  while (inside_begin > 0 && x_at(inside_begin - 1) >= size.left()) {
+    --inside_begin;
+  }
+  while (inside_begin < base.source_size && x_at(inside_begin) < size.left()) {
+    ++inside_begin;
+  }
 
-    // Parse values
-    this->curve[this_i].setX(x);
-    this->curve[this_i].setY(y);
-    ++this_i;
+  // First point right of the right edge
+  double estimate_end = std::floor((size.right() - x_origin) / x_step) + 1.0;
+  int inside_end = !(estimate_end > inside_begin) ? inside_begin : estimate_end < last ? static_cast<int>(estimate_end) : base.source_size;
+  while (inside_end > inside_begin && x_at(inside_end - 1) > size.right()) {
+    --inside_end;
+  }
+  while (inside_end < base.source_size && x_at(inside_end) <= size.right()) {
+    ++inside_end;
   }
 
-  // Remove unused polygon entrees
-  this->curve.remove(this_i, this->curve.size() - this_i);
+  // Include the neighbouring points outside the edges, the kernel clamps them onto the edge
+  int begin = std::max(inside_begin - 1, 0);
+  int end = std::min(inside_end + 1, base.source_size);
+  this->curve.resize(end - begin);
+
+  // The y has to be reversed because the local coordinate system of y is from top to bottom, this is part of the transform
+  // Intensity scaling is folded into the slope, so the excitation and emission share the kernel
+  // QPointF is a pair of doubles, so the kernel can write the polygon directly
+  Data::Kernel::affineCurve(base.source_y + begin, static_cast<std::size_t>(end - begin), x_at(begin), x_step, size.left(), size.right(),
+                            transform.m22() * intensity, transform.dy(), size.top(), size.bottom(),
+                            reinterpret_cast<double*>(this->curve.data()));
 }
 
 /*
@@ -513,6 +592,54 @@ void Polygon::closeCurve(const QRectF& size) {
   this->curve[length - 1] = QPointF(this->curve[0].x(), size.bottom());
 }
 
+/*
+Decimates the scaled curve to at most four points per column: the first, lowest, highest and last point, in x order.
+A polyline/polygon through the remaining points rasterizes identical to the full curve if a column is (at most) a device pixel.
+Requires the curve x values to be ascending, so decimate before closeCurve().
+  :param origin: the x value of a column edge
+  :param width: the column width, in local coordinates
+*/
+void Polygon::decimate(double origin, double width) {
+  DATA_TRACE_SCOPE("Polygon::decimate");
+  int size = this->curve.size();
+  if (size <= 4 || width <= 0.0) {
+    return;
+  }
+
+  const double width_inverse = 1.0 / width;
+  QPolygonF decimated;
+
+  int begin = 0;
+  while (begin < size) {
+    const double column = std::floor((this->curve[begin].x() - origin) * width_inverse);
+    int low = begin;
+    int high = begin;
+    int end = begin + 1;
+    for (; end < size && std::floor((this->curve[end].x() - origin) * width_inverse) == column; ++end) {
+      if (this->curve[end].y() < this->curve[low].y()) {
+        low = end;
+      } else if (this->curve[end].y() > this->curve[high].y()) {
+        high = end;
+      }
+    }
+
+    // Append in x order, without duplicates
+    int last = end - 1;
+    int points[4] = {begin, std::min(low, high), std::max(low, high), last};
+    int previous = -1;
+    for (int point : points) {
+      if (point != previous) {
+        decimated.append(this->curve[point]);
+        previous = point;
+      }
+    }
+
+    begin = end;
+  }
+
+  this->curve.swap(decimated);
+}
+
 /* ######################################################################################### */
 
 /*
@@ -605,18 +732,69 @@ void Spectrum::setTwoPhotonFlag(bool flag) { this->two_photon = flag; }
 /*
 Returns the excitation intensity at a specific wavelength
   :param wavelength: the excitation wavelength
-  :returns: the excitation intensity fraction, out of bounds returns 0.0, an unspecified wavelength returns the first specified lower
-value
+  :returns: the excitation intensity, out of bounds returns 0.0, in between grid points the intensity is linearly interpolated
 */
 double Spectrum::excitationAt(double wavelength, double cutoff) const { return this->polygon_excitation.intensityAt(wavelength, cutoff); }
 
 /*
 Returns the emission intensity at a specific wavelength
   :param wavelength: the emission wavelength
-  :returns: the emission intensity fraction, out of bounds returns 0.0, an unspecified wavelength returns the first specified higher value
+  :returns: the emission intensity, out of bounds returns 0.0, in between grid points the intensity is linearly interpolated
 */
 double Spectrum::emissionAt(double wavelength, double cutoff) const { return this->polygon_emission.intensityAt(wavelength, cutoff); }
 
+/*
+Returns the excitation intensities at many wavelengths
+  :param wavelengths: the excitation wavelengths
+  :param intensities: (return) buffer of atleast count values for the excitation intensities
+  :param count: amount of wavelengths
+  :param cutoff: intensities below cutoff are reduced to 0.0
+*/
+void Spectrum::excitationAt(const double* wavelengths, double* intensities, std::size_t count, double cutoff) const {
+  this->polygon_excitation.intensityAt(wavelengths, intensities, count, cutoff);
+}
+
+/*
+Returns the emission intensities at many wavelengths
+  :param wavelengths: the emission wavelengths
+  :param intensities: (return) buffer of atleast count values for the emission intensities
+  :param count: amount of wavelengths
+  :param cutoff: intensities below cutoff are reduced to 0.0
+*/
+void Spectrum::emissionAt(const double* wavelengths, double* intensities, std::size_t count, double cutoff) const {
+  this->polygon_emission.intensityAt(wavelengths, intensities, count, cutoff);
+}
+
+/*
+(Static) Evaluates the excitation of many spectra at many wavelengths
+  :param spectra: the spectra
+  :param wavelengths: the excitation wavelengths
+  :param count: amount of wavelengths
+  :param intensities: (return) buffer of atleast spectra.size() * count values, row-major: [spectrum][wavelength]
+  :param cutoff: intensities below cutoff are reduced to 0.0
+*/
+void Spectrum::excitationMatrix(const std::vector<const Data::Spectrum*>& spectra, const double* wavelengths, std::size_t count,
+                                double* intensities, double cutoff) {
+  for (std::size_t i = 0; i < spectra.size(); ++i) {
+    spectra[i]->excitationAt(wavelengths, intensities + i * count, count, cutoff);
+  }
+}
+
+/*
+(Static) Evaluates the emission of many spectra at many wavelengths
+  :param spectra: the spectra
+  :param wavelengths: the emission wavelengths
+  :param count: amount of wavelengths
+  :param intensities: (return) buffer of atleast spectra.size() * count values, row-major: [spectrum][wavelength]
+  :param cutoff: intensities below cutoff are reduced to 0.0
+*/
+void Spectrum::emissionMatrix(const std::vector<const Data::Spectrum*>& spectra, const double* wavelengths, std::size_t count,
+                              double* intensities, double cutoff) {
+  for (std::size_t i = 0; i < spectra.size(); ++i) {
+    spectra[i]->emissionAt(wavelengths, intensities + i * count, count, cutoff);
+  }
+}
+
 /*
 Returns the wavelength of the maximum excitation intensity
   :returns: the wavelength of the (first) maximum excitation
@@ -824,4 +1002,52 @@ Returns the emission intensity (0.0 - 100.0) at the specified wavelength
 */
 double CacheSpectrum::emissionAt(double wavelength) const { return this->spectrum_data.emissionAt(wavelength, 0.0); }
 
+/*
+Returns the excitation intensities (0.0 - 100.0) at the specified wavelengths
+  :param wavelengths: the wavelengths to find the intensity of
+  :param intensities: (return) buffer of atleast count values
+  :param count: amount of wavelengths
+*/
+void CacheSpectrum::excitationAt(const double* wavelengths, double* intensities, std::size_t count) const {
+  this->spectrum_data.excitationAt(wavelengths, intensities, count, 0.0);
+}
+
+/*
+Returns the emission intensities (0.0 - 100.0) at the specified wavelengths
+  :param wavelengths: the wavelengths to find the intensity of
+  :param intensities: (return) buffer of atleast count values
+  :param count: amount of wavelengths
+*/
+void CacheSpectrum::emissionAt(const double* wavelengths, double* intensities, std::size_t count) const {
+  this->spectrum_data.emissionAt(wavelengths, intensities, count, 0.0);
+}
+
+/*
+(Static) Evaluates the excitation of many cache spectra at many wavelengths
+  :param spectra: the cache spectra
+  :param wavelengths: the wavelengths
+  :param count: amount of wavelengths
+  :param intensities: (return) buffer of atleast spectra.size() * count values, row-major: [spectrum][wavelength]
+*/
+void CacheSpectrum::excitationMatrix(const std::vector<const Data::CacheSpectrum*>& spectra, const double* wavelengths, std::size_t count,
+                                     double* intensities) {
+  for (std::size_t i = 0; i < spectra.size(); ++i) {
+    spectra[i]->excitationAt(wavelengths, intensities + i * count, count);
+  }
+}
+
+/*
+(Static) Evaluates the emission of many cache spectra at many wavelengths
+  :param spectra: the cache spectra
+  :param wavelengths: the wavelengths
+  :param count: amount of wavelengths
+  :param intensities: (return) buffer of atleast spectra.size() * count values, row-major: [spectrum][wavelength]
+*/
+void CacheSpectrum::emissionMatrix(const std::vector<const Data::CacheSpectrum*>& spectra, const double* wavelengths, std::size_t count,
+                                   double* intensities) {
+  for (std::size_t i = 0; i < spectra.size(); ++i) {
+    spectra[i]->emissionAt(wavelengths, intensities + i * count, count);
+  }
+}
+
 }  // namespace Data
@@ -0,0 +1,479 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_spillover.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+#include "data_parallel.h"
+
+namespace Data {
+
+/*
+Constructor: constructs an empty spillover matrix
+*/
+SpilloverMatrix::SpilloverMatrix()
+    : matrix_detectors(),
+      laserline_wavelengths(),
+      laser_wavelengths(),
+      matrix_ids(),
+      matrix_fluorophores(),
+      matrix_signal(),
+      matrix_spillover(),
+      matrix_primary() {}
+
+/*
+Builds the detectors of an instrument, one per filter of every laserline. Clears the calculated matrices.
+  :param instrument: the instrument
+*/
+void SpilloverMatrix::setInstrument(const Data::Instrument& instrument) {
+  this->clear();
+  this->matrix_detectors.clear();
+  this->laserline_wavelengths.assign(instrument.optics().size(), std::vector<double>());
+
+  for (std::size_t i = 0; i < instrument.optics().size(); ++i) {
+    const Data::LaserLine& laserline = instrument.optics()[i];
+
+    for (const Data::Laser& laser : laserline.lasers()) {
+      this->laserline_wavelengths[i].push_back(laser.wavelength());
+    }
+
+    for (std::size_t j = 0; j < laserline.filters().size(); ++j) {
+      const Data::Filter& filter = laserline.filters()[j];
+      SpilloverMatrix::Detector detector;
+      detector.name = SpilloverMatrix::detectorName(laserline, filter);
+      detector.laserline = i;
+      detector.filter = j;
+      detector.laser_offset = 0;
+      detector.laser_count = 0;
+      detector.wavelength_min = filter.wavelengthMin();
+      detector.wavelength_max = filter.wavelengthMax();
+      this->matrix_detectors.push_back(detector);
+    }
+  }
+
+  this->buildLasers();
+}
+
+/*
+Flattens the lasers of the laserlines into laser_wavelengths, and points the detectors to their laserline's lasers
+*/
+void SpilloverMatrix::buildLasers() {
+  this->laser_wavelengths.clear();
+
+  std::vector<std::size_t> offsets(this->laserline_wavelengths.size());
+  for (std::size_t i = 0; i < this->laserline_wavelengths.size(); ++i) {
+    offsets[i] = this->laser_wavelengths.size();
+    this->laser_wavelengths.insert(this->laser_wavelengths.end(), this->laserline_wavelengths[i].begin(),
+                                   this->laserline_wavelengths[i].end());
+  }
+
+  for (SpilloverMatrix::Detector& detector : this->matrix_detectors) {
+    detector.laser_offset = offsets[detector.laserline];
+    detector.laser_count = this->laserline_wavelengths[detector.laserline].size();
+  }
+}
+
+/*
+Calculates the signal and spillover matrices of the spectra for the detectors of the current instrument.
+The fluorophores are calculated in parallel.
+  :param spectra: the spectra, the rows of the matrix
+  :param names: the row names, if the size doesnt match the spectra the spectrum id's are used
+*/
+void SpilloverMatrix::calculate(const std::vector<const Data::Spectrum*>& spectra, const QStringList& names) {
+  this->clear();
+  this->setNames(spectra, names);
+
+  std::size_t detector_count = this->matrix_detectors.size();
+  std::size_t fluorophore_count = spectra.size();
+
+  this->matrix_signal.assign(fluorophore_count * detector_count, 0.0);
+  this->matrix_spillover.assign(fluorophore_count * detector_count, 0.0);
+  this->matrix_primary.assign(fluorophore_count, detector_count);
+
+  if (detector_count == 0) {
+    return;
+  }
+
+  Data::parallelFor(fluorophore_count, [this, &spectra, detector_count](std::size_t begin, std::size_t end) {
+    std::vector<double> excitation(this->laser_wavelengths.size());
+
+    for (std::size_t i = begin; i < end; ++i) {
+      this->calculateSignal(*spectra[i], excitation.data(), this->matrix_signal.data() + i * detector_count, 0, detector_count);
+      this->normalizeRow(i);
+    }
+  });
+}
+
+/*
+Calculates the signal and spillover matrices of the cached spectra for the detectors of the current instrument.
+  :param spectra: the cached spectra, the rows of the matrix
+  :param names: the row names, if the size doesnt match the spectra the spectrum id's are used
+*/
+void SpilloverMatrix::calculate(const std::vector<const Data::CacheSpectrum*>& spectra, const QStringList& names) {
+  std::vector<const Data::Spectrum*> data;
+  data.reserve(spectra.size());
+  for (const Data::CacheSpectrum* spectrum : spectra) {
+    data.push_back(&spectrum->spectrum());
+  }
+  this->calculate(data, names);
+}
+
+/*
+Calculates the signal of a single spectrum in all detectors of the current instrument. Does not modify the matrices.
+  :param spectrum: the spectrum
+  :param signal: (return) buffer of atleast detectorCount() values
+*/
+void SpilloverMatrix::calculateSignal(const Data::Spectrum& spectrum, double* signal) const {
+  std::vector<double> excitation(this->laser_wavelengths.size());
+  this->calculateSignal(spectrum, excitation.data(), signal, 0, this->matrix_detectors.size());
+}
+
+/*
+Updates the matrices to the spectra. Rows of spectra that are already in the matrix are reused, only the
+rows of new spectra are calculated. The rows are (re)ordered to the order of the spectra.
+  :param spectra: the spectra, the rows of the matrix
+  :param names: the row names, if the size doesnt match the spectra the spectrum id's are used
+*/
+void SpilloverMatrix::sync(const std::vector<const Data::Spectrum*>& spectra, const QStringList& names) {
+  std::size_t detector_count = this->matrix_detectors.size();
+  std::size_t fluorophore_count = spectra.size();
+
+  std::unordered_map<QString, std::size_t> rows;
+  for (int i = 0; i < this->matrix_ids.size(); ++i) {
+    rows[this->matrix_ids[i]] = static_cast<std::size_t>(i);
+  }
+
+  std::vector<double> signal(fluorophore_count * detector_count, 0.0);
+  std::vector<std::size_t> calculate_rows;
+  for (std::size_t i = 0; i < fluorophore_count; ++i) {
+    auto row = rows.find(spectra[i]->id());
+    if (row == rows.end()) {
+      calculate_rows.push_back(i);
+      continue;
+    }
+    std::copy(this->matrix_signal.begin() + static_cast<std::ptrdiff_t>(row->second * detector_count),
+              this->matrix_signal.begin() + static_cast<std::ptrdiff_t>((row->second + 1) * detector_count),
+              signal.begin() + static_cast<std::ptrdiff_t>(i * detector_count));
+  }
+
+  this->clear();
+  this->setNames(spectra, names);
+  this->matrix_signal = std::move(signal);
+  this->matrix_spillover.assign(fluorophore_count * detector_count, 0.0);
+  this->matrix_primary.assign(fluorophore_count, detector_count);
+
+  if (detector_count == 0) {
+    return;
+  }
+
+  Data::parallelFor(calculate_rows.size(), [this, &spectra, &calculate_rows, detector_count](std::size_t begin, std::size_t end) {
+    std::vector<double> excitation(this->laser_wavelengths.size());
+
+    for (std::size_t i = begin; i < end; ++i) {
+      std::size_t row = calculate_rows[i];
+      this->calculateSignal(*spectra[row], excitation.data(), this->matrix_signal.data() + row * detector_count, 0, detector_count);
+    }
+  });
+
+  for (std::size_t i = 0; i < fluorophore_count; ++i) {
+    this->normalizeRow(i);
+  }
+}
+
+/*
+Sets the (active) lasers of a laserline, recalculates only the signal of the laserline's detectors
+  :param laserline: the index of the laserline in the instrument's optics
+  :param wavelengths: the laser wavelengths, can be empty
+  :param spectra: the spectra of the rows, in row order
+  :returns: whether the lasers have changed
+*/
+bool SpilloverMatrix::setLasers(std::size_t laserline, const std::vector<double>& wavelengths,
+                                const std::vector<const Data::Spectrum*>& spectra) {
+  if (laserline >= this->laserline_wavelengths.size() || this->laserline_wavelengths[laserline] == wavelengths) {
+    return false;
+  }
+  bool matching = spectra.size() == this->fluorophoreCount();
+  for (std::size_t i = 0; matching && i < spectra.size(); ++i) {
+    matching = spectra[i]->id() == this->id(i);
+  }
+  if (!matching) {
+    qWarning() << "Data::SpilloverMatrix::setLasers: spectra do not match the rows of the matrix";
+    return false;
+  }
+
+  this->laserline_wavelengths[laserline] = wavelengths;
+  this->buildLasers();
+
+  std::pair<std::size_t, std::size_t> range = this->detectorRange(laserline);
+  if (range.first == range.second) {
+    return true;
+  }
+
+  std::size_t detector_count = this->matrix_detectors.size();
+  Data::parallelFor(spectra.size(), [this, &spectra, &range, detector_count](std::size_t begin, std::size_t end) {
+    std::vector<double> excitation(this->laser_wavelengths.size());
+
+    for (std::size_t i = begin; i < end; ++i) {
+      this->calculateSignal(*spectra[i], excitation.data(), this->matrix_signal.data() + i * detector_count, range.first, range.second);
+      this->normalizeRow(i);
+    }
+  });
+
+  return true;
+}
+
+/*
+Sets the row ids and names
+  :param spectra: the spectra, the rows of the matrix
+  :param names: the row names, if the size doesnt match the spectra the spectrum id's are used
+*/
+void SpilloverMatrix::setNames(const std::vector<const Data::Spectrum*>& spectra, const QStringList& names) {
+  for (std::size_t i = 0; i < spectra.size(); ++i) {
+    this->matrix_ids.append(spectra[i]->id());
+    if (static_cast<std::size_t>(names.size()) == spectra.size()) {
+      this->matrix_fluorophores.append(names[static_cast<int>(i)]);
+    } else {
+      this->matrix_fluorophores.append(spectra[i]->id());
+    }
+  }
+}
+
+/*
+Calculates the primary detector and the spillover of a row from its signal
+  :param fluorophore: the fluorophore (row) index
+*/
+void SpilloverMatrix::normalizeRow(std::size_t fluorophore) {
+  std::size_t detector_count = this->matrix_detectors.size();
+  const double* signal = this->matrix_signal.data() + fluorophore * detector_count;
+  double* spillover = this->matrix_spillover.data() + fluorophore * detector_count;
+
+  std::size_t primary = detector_count;
+  double signal_max = 0.0;
+  for (std::size_t j = 0; j < detector_count; ++j) {
+    if (signal[j] > signal_max) {
+      signal_max = signal[j];
+      primary = j;
+    }
+  }
+  this->matrix_primary[fluorophore] = primary;
+
+  for (std::size_t j = 0; j < detector_count; ++j) {
+    spillover[j] = signal_max > 0.0 ? signal[j] / signal_max : 0.0;
+  }
+}
+
+/*
+Calculates the signal of a single spectrum in a range of detectors
+  :param spectrum: the spectrum
+  :param excitation: (scratch) buffer of atleast laser_wavelengths.size() values
+  :param signal: (return) buffer of atleast detectorCount() values, only the values in the range are written
+  :param begin: the first detector
+  :param end: the detector past the last detector
+*/
+void SpilloverMatrix::calculateSignal(const Data::Spectrum& spectrum, double* excitation, double* signal, std::size_t begin,
+                                      std::size_t end) const {
+  std::fill(signal + begin, signal + end, 0.0);
+  if (begin >= end) {
+    return;
+  }
+
+  const Data::Polygon& emission = spectrum.emission();
+  double emission_total = emission.integral(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max());
+  if (emission_total <= 0.0) {
+    return;
+  }
+
+  // The detectors are in laserline order, so the lasers of the range are contiguous
+  std::size_t laser_begin = this->matrix_detectors[begin].laser_offset;
+  std::size_t laser_end = this->matrix_detectors[end - 1].laser_offset + this->matrix_detectors[end - 1].laser_count;
+  if (laser_end > laser_begin) {
+    spectrum.excitationAt(this->laser_wavelengths.data() + laser_begin, excitation + laser_begin, laser_end - laser_begin, 0.0);
+  }
+
+  for (std::size_t j = begin; j < end; ++j) {
+    const SpilloverMatrix::Detector& detector = this->matrix_detectors[j];
+
+    double efficiency = 0.0;
+    for (std::size_t k = 0; k < detector.laser_count; ++k) {
+      efficiency += excitation[detector.laser_offset + k] * 0.01;
+    }
+    if (efficiency <= 0.0) {
+      continue;
+    }
+
+    signal[j] = efficiency * emission.integral(detector.wavelength_min, detector.wavelength_max) / emission_total;
+  }
+}
+
+/*
+Clears the calculated matrices, keeps the detectors
+*/
+void SpilloverMatrix::clear() {
+  this->matrix_ids.clear();
+  this->matrix_fluorophores.clear();
+  this->matrix_signal.clear();
+  this->matrix_spillover.clear();
+  this->matrix_primary.clear();
+}
+
+/*
+Whether the matrix contains any values
+*/
+bool SpilloverMatrix::isEmpty() const { return this->matrix_signal.empty(); }
+
+/*
+Getter for the amount of fluorophores (rows)
+*/
+std::size_t SpilloverMatrix::fluorophoreCount() const { return static_cast<std::size_t>(this->matrix_fluorophores.size()); }
+
+/*
+Getter for the amount of detectors (columns)
+*/
+std::size_t SpilloverMatrix::detectorCount() const { return this->matrix_detectors.size(); }
+
+/*
+Getter for a fluorophore id
+  :param fluorophore: the fluorophore (row) index
+*/
+const QString& SpilloverMatrix::id(std::size_t fluorophore) const { return this->matrix_ids.at(static_cast<int>(fluorophore)); }
+
+/*
+Getter for a fluorophore name
+  :param fluorophore: the fluorophore (row) index
+*/
+const QString& SpilloverMatrix::fluorophore(std::size_t fluorophore) const { return this->matrix_fluorophores.at(static_cast<int>(fluorophore)); }
+
+/*
+Getter for a detector
+  :param detector: the detector (column) index
+*/
+const SpilloverMatrix::Detector& SpilloverMatrix::detector(std::size_t detector) const { return this->matrix_detectors[detector]; }
+
+/*
+Getter for the detectors of a laserline, the detectors of a laserline are contiguous
+  :param laserline: the index of the laserline in the instrument's optics
+  :returns: the first detector and the detector past the last detector, equal if the laserline has no detectors
+*/
+std::pair<std::size_t, std::size_t> SpilloverMatrix::detectorRange(std::size_t laserline) const {
+  std::size_t begin = 0;
+  while (begin < this->matrix_detectors.size() && this->matrix_detectors[begin].laserline < laserline) {
+    ++begin;
+  }
+  std::size_t end = begin;
+  while (end < this->matrix_detectors.size() && this->matrix_detectors[end].laserline == laserline) {
+    ++end;
+  }
+  return std::make_pair(begin, end);
+}
+
+/*
+Getter for the signal of a fluorophore in a detector
+  :param fluorophore: the fluorophore (row) index
+  :param detector: the detector (column) index
+  :returns: the excitation efficiency (fraction) times the fraction of the emission in the detector
+*/
+double SpilloverMatrix::signal(std::size_t fluorophore, std::size_t detector) const {
+  return this->matrix_signal[fluorophore * this->matrix_detectors.size() + detector];
+}
+
+/*
+Getter for the spillover of a fluorophore into a detector
+  :param fluorophore: the fluorophore (row) index
+  :param detector: the detector (column) index
+  :returns: the signal relative to the signal in the primary detector (0.0-1.0)
+*/
+double SpilloverMatrix::spillover(std::size_t fluorophore, std::size_t detector) const {
+  return this->matrix_spillover[fluorophore * this->matrix_detectors.size() + detector];
+}
+
+/*
+Getter for the signal or spillover value
+  :param mode: which matrix to return the value of
+  :param fluorophore: the fluorophore (row) index
+  :param detector: the detector (column) index
+*/
+double SpilloverMatrix::value(SpilloverMatrix::Mode mode, std::size_t fluorophore, std::size_t detector) const {
+  if (mode == SpilloverMatrix::Signal) {
+    return this->signal(fluorophore, detector);
+  }
+  return this->spillover(fluorophore, detector);
+}
+
+/*
+Getter for the primary (brightest) detector of a fluorophore
+  :param fluorophore: the fluorophore (row) index
+  :returns: the detector index, detectorCount() if the fluorophore has no signal in any detector
+*/
+std::size_t SpilloverMatrix::primaryDetector(std::size_t fluorophore) const { return this->matrix_primary[fluorophore]; }
+
+/*
+Exports a matrix as comma separated values, with a header row of detector names and a first column of fluorophore names
+  :param mode: which matrix to export
+*/
+QString SpilloverMatrix::toCSV(SpilloverMatrix::Mode mode) const {
+  // Quote every name, they can contain comma's
+  auto quote = [](const QString& text) {
+    QString quoted = text;
+    quoted.replace('"', "\"\"");
+    return QString("\"%1\"").arg(quoted);
+  };
+
+  QString csv = quote("Fluorophore");
+  for (const SpilloverMatrix::Detector& detector : this->matrix_detectors) {
+    csv += "," + quote(detector.name);
+  }
+  csv += "\n";
+
+  for (std::size_t i = 0; i < this->fluorophoreCount(); ++i) {
+    csv += quote(this->fluorophore(i));
+    for (std::size_t j = 0; j < this->detectorCount(); ++j) {
+      csv += "," + QString::number(this->value(mode, i, j), 'f', 6);
+    }
+    csv += "\n";
+  }
+
+  return csv;
+}
+
+/*
+(Static) Builds a detector name from the laser wavelengths and the filter. Example: '405-BV421' or '488-BP530/30'
+  :param laserline: the laserline of the detector
+  :param filter: the filter of the detector
+*/
+QString SpilloverMatrix::detectorName(const Data::LaserLine& laserline, const Data::Filter& filter) {
+  QStringList lasers;
+  for (const Data::Laser& laser : laserline.lasers()) {
+    lasers.append(QString::number(laser.wavelength()));
+  }
+
+  QString name = filter.name();
+  if (name.isEmpty()) {
+    switch (filter.type()) {
+      case Data::Filter::BandPass:
+        name = QString("BP%1/%2").arg(filter.wavelength()).arg(filter.fwhm());
+        break;
+      case Data::Filter::LongPass:
+        name = QString("LP%1").arg(filter.wavelength());
+        break;
+      case Data::Filter::ShortPass:
+        name = QString("SP%1").arg(filter.wavelength());
+        break;
+      default:
+        qWarning() << "Data::SpilloverMatrix::detectorName: Unknown Filter::Type";
+        break;
+    }
+  }
+
+  return lasers.join("/") + "-" + name;
+}
+
+}  // namespace Data
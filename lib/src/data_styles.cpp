@@ -159,19 +159,32 @@ std::vector<StyleID> StyleBuilder::getStyleIDs(const Data::Factory& data) const
 }
 
 /*
-Loads attributes from settings file
+Loads attributes from settings file and builds the stylesheet
   :param data: a data factory
   :param style_id: the id of the style to load
 */
 void StyleBuilder::loadStyle(const Data::Factory& data, const QString& style_id) {
+  if (this->readStyle(data, style_id)) {
+    this->buildStyleSheet();
+  }
+}
+
+/*
+Loads attributes from settings file without building the stylesheet. Does not touch the (GUI) font, so can be run
+on a worker thread.
+  :param data: a data factory
+  :param style_id: the id of the style to load
+  :returns: whether the style is found
+*/
+bool StyleBuilder::readStyle(const Data::Factory& data, const QString& style_id) {
   std::unique_ptr<QSettings> style = data.get(Data::Factory::Styles);
 
   QStringList style_groups;
   style_groups = style->childGroups();
   if (!style_groups.contains(style_id)) {
-    qWarning() << "StyleBuilder::loadStyle: " << style_id << " group is not found within the styles data object";
+    qWarning() << "StyleBuilder::readStyle: " << style_id << " group is not found within the styles data object";
     this->style_id = QString();
-    return;
+    return false;
   } else {
     this->style_id = style_id;
     style->beginGroup(style_id);
@@ -280,7 +293,7 @@ void StyleBuilder::loadStyle(const Data::Factory& data, const QString& style_id)
 
   style->endGroup();
 
-  this->buildStyleSheet();
+  return true;
 }
 
 /*
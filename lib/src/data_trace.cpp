@@ -0,0 +1,212 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "data_trace.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Data {
+namespace Trace {
+
+namespace {
+
+const std::uint64_t buffer_size = 65536;  // events per thread, a power of 2
+
+/*
+A single recorded event. The fields are atomics as save() reads them while the owning thread may overwrite the slot.
+*/
+struct Event {
+  std::atomic<const char*> name;
+  std::atomic<std::int64_t> begin;  // in ns
+  std::atomic<std::int64_t> value;  // duration in ns, or the bits of the counter value
+  std::atomic<bool> counter;
+};
+
+/*
+The ring buffer of a single thread. Only the owning thread writes, head counts all events ever written.
+*/
+struct Buffer {
+  Buffer() : events(new Event[buffer_size]), head(0), thread_id(0), thread_name() {}
+
+  std::unique_ptr<Event[]> events;
+  std::atomic<std::uint64_t> head;
+  int thread_id;
+  QString thread_name;  // guarded by the registry mutex
+};
+
+/*
+All buffers ever registered, buffers outlive their thread so their events can still be saved
+*/
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<Buffer>> buffers;
+};
+
+Registry& registry() {
+  // Leaked on purpose, threads can still record during static destruction
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+/*
+Nanoseconds since the first use of the trace clock
+*/
+std::int64_t now() {
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+Getter for the buffer of the calling thread, registers the buffer upon first use
+*/
+Buffer& buffer() {
+  thread_local std::shared_ptr<Buffer> local;
+  if (!local) {
+    local = std::make_shared<Buffer>();
+    Registry& shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    local->thread_id = static_cast<int>(shared.buffers.size()) + 1;
+    shared.buffers.push_back(local);
+  }
+  return *local;
+}
+
+/*
+Appends an event to the calling thread's buffer, overwriting the oldest event if full
+*/
+void record(const char* name, std::int64_t begin, std::int64_t value, bool counter) {
+  Buffer& local = buffer();
+  std::uint64_t head = local.head.load(std::memory_order_relaxed);
+  Event& event = local.events[head & (buffer_size - 1)];
+  event.name.store(name, std::memory_order_relaxed);
+  event.begin.store(begin, std::memory_order_relaxed);
+  event.value.store(value, std::memory_order_relaxed);
+  event.counter.store(counter, std::memory_order_relaxed);
+  local.head.store(head + 1, std::memory_order_release);
+}
+
+}  // namespace
+
+/*
+Constructor: starts timing the scope
+  :param name: the event name, has to outlive the trace (a string literal)
+*/
+Scope::Scope(const char* name) : scope_name(name), scope_begin(now()) {}
+
+/*
+Destructor: records the scope as a complete event
+*/
+Scope::~Scope() { record(this->scope_name, this->scope_begin, now() - this->scope_begin, false); }
+
+/*
+Records the current value of a counter
+  :param name: the counter name, has to outlive the trace (a string literal)
+  :param value: the value
+*/
+void counter(const char* name, double value) {
+  std::int64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  record(name, now(), bits, true);
+}
+
+/*
+Sets the name of the calling thread in the trace
+  :param name: the thread name
+*/
+void setThreadName(const QString& name) {
+  Buffer& local = buffer();
+  std::lock_guard<std::mutex> lock(registry().mutex);
+  local.thread_name = name;
+}
+
+/*
+Saves the events of all threads in the Chrome trace event format. Can be called from any thread while others are recording,
+events that are overwritten during the save are skipped.
+  :param path: the output file path
+  :returns: whether the trace was written
+*/
+bool save(const QString& path) {
+  QJsonArray events;
+
+  Registry& shared = registry();
+  std::lock_guard<std::mutex> lock(shared.mutex);
+  for (const std::shared_ptr<Buffer>& local : shared.buffers) {
+    QJsonObject metadata;
+    metadata["ph"] = "M";
+    metadata["name"] = "thread_name";
+    metadata["pid"] = 1;
+    metadata["tid"] = local->thread_id;
+    QString name = local->thread_name.isEmpty() ? QString("Thread %1").arg(local->thread_id) : local->thread_name;
+    metadata["args"] = QJsonObject{{"name", name}};
+    events.append(metadata);
+
+    std::uint64_t head = local->head.load(std::memory_order_acquire);
+    std::uint64_t begin = head > buffer_size ? head - buffer_size : 0;
+
+    std::vector<QJsonObject> copies;
+    copies.reserve(static_cast<std::size_t>(head - begin));
+    for (std::uint64_t i = begin; i < head; ++i) {
+      const Event& event = local->events[i & (buffer_size - 1)];
+
+      QJsonObject copy;
+      copy["name"] = QString::fromUtf8(event.name.load(std::memory_order_relaxed));
+      copy["pid"] = 1;
+      copy["tid"] = local->thread_id;
+      copy["ts"] = static_cast<double>(event.begin.load(std::memory_order_relaxed)) * 0.001;
+      std::int64_t value = event.value.load(std::memory_order_relaxed);
+      if (event.counter.load(std::memory_order_relaxed)) {
+        double bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        copy["ph"] = "C";
+        copy["args"] = QJsonObject{{"value", bits}};
+      } else {
+        copy["ph"] = "X";
+        copy["dur"] = static_cast<double>(value) * 0.001;
+      }
+      copies.push_back(copy);
+    }
+
+    // The owning thread may have lapped the buffer while copying, the slots of events past head - buffer_size are torn
+    std::atomic_thread_fence(std::memory_order_acquire);
+    std::uint64_t head_after = local->head.load(std::memory_order_relaxed);
+    std::uint64_t valid = head_after >= buffer_size ? head_after - buffer_size + 1 : 0;
+    for (std::uint64_t i = std::max(begin, valid); i < head; ++i) {
+      events.append(copies[static_cast<std::size_t>(i - begin)]);
+    }
+  }
+
+  QJsonObject root;
+  root["traceEvents"] = events;
+  root["displayTimeUnit"] = "ms";
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qWarning() << "Data::Trace::save: cannot open" << path;
+    return false;
+  }
+  file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+  if (!file.commit()) {
+    qWarning() << "Data::Trace::save: cannot write" << path;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace Trace
+}  // namespace Data
@@ -0,0 +1,216 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-16
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include <QtTest>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "data_assignment.h"
+#include "data_instruments.h"
+#include "data_spectrum.h"
+
+/*
+Tests the Hungarian fluorophore to detector assignment against a brute force search of all assignments
+*/
+class TestAssignment : public QObject {
+  Q_OBJECT
+
+ private:
+  Data::Instrument instrument;
+  std::vector<Data::Spectrum> spectra;
+
+  static Data::Polygon gaussian(double peak, double width);
+  static double bruteForce(const Data::AssignmentSolver& solver, std::size_t row, std::vector<bool>& used);
+  static void verifyOptimal(const Data::AssignmentSolver& solver);
+
+ private slots:
+  void initTestCase();
+  void optimal_data();
+  void optimal();
+  void incremental();
+  void remove();
+};
+
+/*
+Builds a gaussian curve on a 1 nm grid from 300 to 799 nm
+  :param peak: the wavelength of the maximum
+  :param width: the standard deviation in nm
+*/
+Data::Polygon TestAssignment::gaussian(double peak, double width) {
+  std::shared_ptr<std::vector<float>> y = std::make_shared<std::vector<float>>(500);
+  for (std::size_t i = 0; i < y->size(); ++i) {
+    double distance = (300.0 + static_cast<double>(i) - peak) / width;
+    (*y)[i] = static_cast<float>(100.0 * std::exp(-0.5 * distance * distance));
+  }
+  return Data::Polygon(y, 300.0, 1.0, y->data(), static_cast<int>(y->size()));
+}
+
+/*
+Finds the minimal total cost of the rows from row onwards by trying every free detector and leaving the row unassigned
+  :param solver: the solver, provides the costs
+  :param row: the first row to assign
+  :param used: (in/out) whether a detector is assigned
+*/
+double TestAssignment::bruteForce(const Data::AssignmentSolver& solver, std::size_t row, std::vector<bool>& used) {
+  if (row == solver.fluorophoreCount()) {
+    return 0.0;
+  }
+
+  double best = TestAssignment::bruteForce(solver, row + 1, used);
+  for (std::size_t detector = 0; detector < solver.detectorCount(); ++detector) {
+    if (used[detector]) {
+      continue;
+    }
+    used[detector] = true;
+    best = std::min(best, solver.cost(row, detector) + TestAssignment::bruteForce(solver, row + 1, used));
+    used[detector] = false;
+  }
+  return best;
+}
+
+/*
+Verifies that the assignment of the solver is a valid matching with the brute force minimal cost
+*/
+void TestAssignment::verifyOptimal(const Data::AssignmentSolver& solver) {
+  std::vector<bool> used(solver.detectorCount(), false);
+  double total = 0.0;
+  for (std::size_t row = 0; row < solver.fluorophoreCount(); ++row) {
+    std::size_t detector = solver.assignment(row);
+    if (detector == Data::AssignmentSolver::none) {
+      continue;
+    }
+    QVERIFY(detector < solver.detectorCount());
+    QVERIFY2(!used[detector], "detector is assigned twice");
+    used[detector] = true;
+    total += solver.cost(row, detector);
+  }
+  QVERIFY(std::abs(total - solver.totalCost()) < 1e-9);
+
+  std::vector<bool> scratch(solver.detectorCount(), false);
+  double optimum = TestAssignment::bruteForce(solver, 0, scratch);
+  QVERIFY2(std::abs(solver.totalCost() - optimum) < 1e-9,
+           qPrintable(QString("assignment cost %1, optimum %2").arg(solver.totalCost()).arg(optimum)));
+}
+
+/*
+Builds an instrument of two laserlines with five detectors, and fluorophores with overlapping spectra
+*/
+void TestAssignment::initTestCase() {
+  this->instrument = Data::Instrument("test", "Test", 2);
+
+  Data::LaserLine violet;
+  violet.lasers().push_back(Data::Laser(405.0));
+  violet.filters().push_back(Data::Filter(Data::Filter::BandPass, 450.0, 50.0));
+  violet.filters().push_back(Data::Filter(Data::Filter::BandPass, 525.0, 50.0));
+  this->instrument.setOptics().push_back(violet);
+
+  Data::LaserLine blue;
+  blue.lasers().push_back(Data::Laser(488.0));
+  blue.filters().push_back(Data::Filter(Data::Filter::BandPass, 530.0, 30.0));
+  blue.filters().push_back(Data::Filter(Data::Filter::BandPass, 610.0, 20.0));
+  blue.filters().push_back(Data::Filter(Data::Filter::LongPass, 670.0));
+  this->instrument.setOptics().push_back(blue);
+
+  // Excitation peak, emission peak
+  const double peaks[][2] = {{405.0, 450.0}, {400.0, 520.0}, {490.0, 520.0}, {495.0, 575.0}, {480.0, 610.0},
+                             {490.0, 680.0}, {410.0, 600.0}, {500.0, 530.0}, {430.0, 470.0}};
+  for (std::size_t i = 0; i < sizeof(peaks) / sizeof(peaks[0]); ++i) {
+    this->spectra.emplace_back(QString("F%1").arg(i), TestAssignment::gaussian(peaks[i][0], 20.0),
+                               TestAssignment::gaussian(peaks[i][1], 25.0));
+  }
+}
+
+void TestAssignment::optimal_data() {
+  QTest::addColumn<int>("count");
+  QTest::addColumn<double>("weight");
+
+  // Less, equal and more fluorophores than detectors
+  for (int count : {1, 3, 5, 7, 9}) {
+    for (double weight : {0.0, 0.5, 1.0}) {
+      QTest::newRow(qPrintable(QString("%1 fluorophores, weight %2").arg(count).arg(weight))) << count << weight;
+    }
+  }
+}
+
+/*
+A full solve finds the brute force optimum
+*/
+void TestAssignment::optimal() {
+  QFETCH(int, count);
+  QFETCH(double, weight);
+
+  Data::AssignmentSolver::Options options;
+  options.spillover_weight = weight;
+  options.signal_minimum = 0.0;
+
+  Data::AssignmentSolver solver;
+  solver.setInstrument(this->instrument);
+  solver.setOptions(options);
+  QCOMPARE(solver.detectorCount(), static_cast<std::size_t>(5));
+
+  std::vector<const Data::Spectrum*> selection;
+  for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
+    selection.push_back(&this->spectra[i]);
+  }
+  solver.sync(selection);
+  QCOMPARE(solver.fluorophoreCount(), static_cast<std::size_t>(count));
+
+  TestAssignment::verifyOptimal(solver);
+}
+
+/*
+Adding the fluorophores one by one (a single augmenting phase each) stays optimal
+*/
+void TestAssignment::incremental() {
+  Data::AssignmentSolver::Options options;
+  options.spillover_weight = 0.5;
+  options.signal_minimum = 0.0;
+
+  Data::AssignmentSolver solver;
+  solver.setInstrument(this->instrument);
+  solver.setOptions(options);
+
+  for (const Data::Spectrum& spectrum : this->spectra) {
+    solver.add(spectrum);
+    TestAssignment::verifyOptimal(solver);
+    if (QTest::currentTestFailed()) {
+      return;
+    }
+  }
+}
+
+/*
+Removing fluorophores re-solves to the optimum of the remaining fluorophores
+*/
+void TestAssignment::remove() {
+  Data::AssignmentSolver::Options options;
+  options.spillover_weight = 0.5;
+  options.signal_minimum = 0.0;
+
+  Data::AssignmentSolver solver;
+  solver.setInstrument(this->instrument);
+  solver.setOptions(options);
+  for (const Data::Spectrum& spectrum : this->spectra) {
+    solver.add(spectrum);
+  }
+
+  for (const char* id : {"F2", "F0", "F7", "F4"}) {
+    solver.remove(id);
+    QCOMPARE(solver.assignment(QString(id)), Data::AssignmentSolver::none);
+    TestAssignment::verifyOptimal(solver);
+    if (QTest::currentTestFailed()) {
+      return;
+    }
+  }
+  QCOMPARE(solver.fluorophoreCount(), this->spectra.size() - 4);
+}
+
+QTEST_GUILESS_MAIN(TestAssignment)
+#include "test_assignment.moc"
@@ -0,0 +1,217 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-16
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "data_database.h"
+
+/*
+Tests the compiled (memory mapped) spectrum database against its fluorophores.json source
+*/
+class TestDatabase : public QObject {
+  Q_OBJECT
+
+ private:
+  QTemporaryDir directory;
+  QString path_source;
+  QString path_compiled;
+
+  static QByteArray source();
+  void writeSource(const QByteArray& data) const;
+
+ private slots:
+  void init();
+  void roundTrip();
+  void decodeEqualsCompiled();
+  void staleSize();
+  void staleModified();
+  void truncated();
+};
+
+/*
+Builds a fluorophores.json with a fluorophore, an absorption-only fluorophore and a disabled fluorophore
+*/
+QByteArray TestDatabase::source() {
+  return QByteArray(
+      "{\n"
+      "  \"A\":{\n"
+      "    \"enable\":true,\n"
+      "    \"names\":[\"Alpha\",\"alpha dye\"],\n"
+      "    \"excitation_max\":402,\n"
+      "    \"excitation_wavelength\":[400.0,401.0,402.0,403.0,404.0],\n"
+      "    \"excitation_intensity\":[10.0,50.0,100.0,50.0,10.0],\n"
+      "    \"emission_max\":502,\n"
+      "    \"emission_wavelength\":[500.0,501.0,502.0,503.0,504.0,505.0],\n"
+      "    \"emission_intensity\":[5.0,40.0,100.0,60.0,20.0,1.0]\n"
+      "  },\n"
+      "  \"B\":{\n"
+      "    \"enable\":true,\n"
+      "    \"names\":[\"Beta\"],\n"
+      "    \"absorption_max\":351,\n"
+      "    \"absorption_wavelength\":[350.0,351.0,352.0],\n"
+      "    \"absorption_intensity\":[80.0,100.0,30.0],\n"
+      "    \"emission_max\":451,\n"
+      "    \"emission_wavelength\":[450.0,451.0,452.0],\n"
+      "    \"emission_intensity\":[70.0,100.0,20.0]\n"
+      "  },\n"
+      "  \"C\":{\n"
+      "    \"enable\":false,\n"
+      "    \"names\":[\"Gamma\"],\n"
+      "    \"excitation_wavelength\":[600.0,601.0],\n"
+      "    \"excitation_intensity\":[100.0,50.0],\n"
+      "    \"emission_wavelength\":[650.0,651.0],\n"
+      "    \"emission_intensity\":[100.0,50.0]\n"
+      "  }\n"
+      "}\n");
+}
+
+/*
+Writes the source file
+*/
+void TestDatabase::writeSource(const QByteArray& data) const {
+  QFile file(this->path_source);
+  QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+  QCOMPARE(file.write(data), static_cast<qint64>(data.size()));
+}
+
+/*
+Writes a fresh source and compiles it before every test
+*/
+void TestDatabase::init() {
+  QVERIFY(this->directory.isValid());
+  this->path_source = this->directory.filePath("fluorophores.json");
+  this->path_compiled = this->directory.filePath("fluorophores.bin");
+  QFile::remove(this->path_compiled);
+
+  this->writeSource(TestDatabase::source());
+  QJsonDocument document = QJsonDocument::fromJson(TestDatabase::source());
+  QVERIFY(Data::SpectrumDatabase::compile(document, this->path_source, this->path_compiled));
+}
+
+/*
+The compiled database returns the enabled fluorophores with their names, flags and curves
+*/
+void TestDatabase::roundTrip() {
+  Data::SpectrumDatabase database;
+  QVERIFY(database.open(this->path_compiled, this->path_source));
+  QVERIFY(database.isValid());
+  QVERIFY(database.isMapped());
+  QCOMPARE(database.size(), static_cast<std::size_t>(2));
+
+  std::size_t a = database.find("A");
+  std::size_t b = database.find("B");
+  QVERIFY(a < database.size());
+  QVERIFY(b < database.size());
+  QCOMPARE(database.find("C"), database.size());
+
+  QCOMPARE(database.id(a), QString("A"));
+  QCOMPARE(database.names(a), QStringList({"Alpha", "alpha dye"}));
+  QCOMPARE(database.names(b), QStringList({"Beta"}));
+  QVERIFY(!database.absorptionFlag(a));
+  QVERIFY(database.absorptionFlag(b));
+  QCOMPARE(database.meta(a).excitation_max, 402.0);
+  QCOMPARE(database.meta(b).excitation_max, 351.0);
+  QCOMPARE(database.meta(a).emission_max, 502.0);
+
+  Data::Polygon excitation = database.excitation(a);
+  const double excitation_values[] = {10.0, 50.0, 100.0, 50.0, 10.0};
+  for (int i = 0; i < 5; ++i) {
+    QCOMPARE(excitation.intensityAt(400.0 + i), excitation_values[i]);
+  }
+  QCOMPARE(excitation.intensityAt(400.5), 30.0);
+  QCOMPARE(excitation.intensityAt(399.0), 0.0);
+
+  Data::Polygon emission = database.emission(a);
+  const double emission_values[] = {5.0, 40.0, 100.0, 60.0, 20.0, 1.0};
+  for (int i = 0; i < 6; ++i) {
+    QCOMPARE(emission.intensityAt(500.0 + i), emission_values[i]);
+  }
+  QCOMPARE(database.excitation(b).intensityAt(351.0), 100.0);
+}
+
+/*
+Decoding the source in memory builds the same database as compiling
+*/
+void TestDatabase::decodeEqualsCompiled() {
+  Data::SpectrumDatabase compiled;
+  QVERIFY(compiled.open(this->path_compiled, this->path_source));
+
+  Data::SpectrumDatabase decoded;
+  QVERIFY(decoded.decode(this->path_source));
+  QVERIFY(decoded.isValid());
+  QVERIFY(!decoded.isMapped());
+  QCOMPARE(decoded.size(), compiled.size());
+
+  for (std::size_t i = 0; i < compiled.size(); ++i) {
+    std::size_t j = decoded.find(compiled.id(i));
+    QVERIFY(j < decoded.size());
+    QCOMPARE(decoded.names(j), compiled.names(i));
+    QCOMPARE(decoded.absorptionFlag(j), compiled.absorptionFlag(i));
+    for (double wavelength = 340.0; wavelength <= 520.0; wavelength += 0.25) {
+      QCOMPARE(decoded.excitation(j).intensityAt(wavelength), compiled.excitation(i).intensityAt(wavelength));
+      QCOMPARE(decoded.emission(j).intensityAt(wavelength), compiled.emission(i).intensityAt(wavelength));
+    }
+  }
+}
+
+/*
+A source of a different size makes the compiled database stale
+*/
+void TestDatabase::staleSize() {
+  QDateTime modified = QFileInfo(this->path_source).lastModified();
+  this->writeSource(TestDatabase::source() + "\n");
+
+  // Restore the modification time, so only the size differs
+  QFile file(this->path_source);
+  QVERIFY(file.open(QIODevice::ReadWrite));
+  QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+  file.close();
+
+  Data::SpectrumDatabase database;
+  QVERIFY(!database.open(this->path_compiled, this->path_source));
+  QVERIFY(!database.isValid());
+}
+
+/*
+A source with a different modification time makes the compiled database stale
+*/
+void TestDatabase::staleModified() {
+  QFile file(this->path_source);
+  QVERIFY(file.open(QIODevice::ReadWrite));
+  QVERIFY(file.setFileTime(QFileInfo(file).lastModified().addSecs(60), QFileDevice::FileModificationTime));
+  file.close();
+
+  Data::SpectrumDatabase database;
+  QVERIFY(!database.open(this->path_compiled, this->path_source));
+  QVERIFY(!database.isValid());
+}
+
+/*
+A truncated database is rejected instead of read past its end
+*/
+void TestDatabase::truncated() {
+  QFile file(this->path_compiled);
+  qint64 size = QFileInfo(this->path_compiled).size();
+  QVERIFY(size > 64);
+
+  QVERIFY(file.resize(size / 2));
+  Data::SpectrumDatabase database;
+  QVERIFY(!database.open(this->path_compiled, this->path_source));
+
+  QVERIFY(file.resize(8));
+  QVERIFY(!database.open(this->path_compiled, this->path_source));
+  QVERIFY(!database.isValid());
+}
+
+QTEST_GUILESS_MAIN(TestDatabase)
+#include "test_database.moc"
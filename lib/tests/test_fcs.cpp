@@ -0,0 +1,387 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-16
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "data_fcs.h"
+
+/*
+Tests the FCS reader on small generated FCS 3.1 files
+*/
+class TestFCS : public QObject {
+  Q_OBJECT
+
+ private:
+  using Keywords = std::vector<std::pair<QByteArray, QByteArray>>;
+
+  QTemporaryDir directory;
+
+  static void append(QByteArray& data, const void* value, std::size_t size, bool little_endian);
+  static QByteArray build(const Keywords& keywords, const QByteArray& data, bool header_offsets, const char* version = "FCS3.1");
+  QString write(const QString& name, const QByteArray& file) const;
+
+ private slots:
+  void initTestCase();
+  void floatData();
+  void doubleForeignOrder();
+  void integerData();
+  void textOffsets();
+  void escapedDelimiter();
+  void headerOnly();
+  void invalid();
+};
+
+/*
+Appends a value in the requested byte order
+  :param data: (in/out) the data to append to
+  :param value: the value in native byte order
+  :param size: size of the value in bytes
+  :param little_endian: the byte order to append in
+*/
+void TestFCS::append(QByteArray& data, const void* value, std::size_t size, bool little_endian) {
+  const char* bytes = static_cast<const char*>(value);
+  bool swap = little_endian != (Q_BYTE_ORDER == Q_LITTLE_ENDIAN);
+  for (std::size_t i = 0; i < size; ++i) {
+    data.append(bytes[swap ? size - 1 - i : i]);
+  }
+}
+
+/*
+Builds an FCS file. The DATA segment starts 8 byte aligned, its offsets are written in the HEADER or only in the TEXT.
+  :param keywords: the TEXT keywords, excluding $BEGINDATA and $ENDDATA
+  :param data: the DATA segment
+  :param header_offsets: whether the HEADER contains the DATA offsets
+  :param version: the version string of the HEADER
+*/
+QByteArray TestFCS::build(const TestFCS::Keywords& keywords, const QByteArray& data, bool header_offsets, const char* version) {
+  const qint64 text_begin = 58;
+
+  // The DATA offsets are zero padded to a fixed width, so the TEXT size doesnt depend on them
+  auto make_text = [&keywords](qint64 data_begin, qint64 data_end) {
+    QByteArray text("/");
+    Keywords all = keywords;
+    all.emplace_back("$BEGINDATA", QByteArray::number(data_begin).rightJustified(12, '0'));
+    all.emplace_back("$ENDDATA", QByteArray::number(data_end).rightJustified(12, '0'));
+    for (const std::pair<QByteArray, QByteArray>& keyword : all) {
+      text += keyword.first + "/" + QByteArray(keyword.second).replace("/", "//") + "/";
+    }
+    return text;
+  };
+
+  const qint64 text_end = text_begin + make_text(0, 0).size() - 1;
+  const qint64 data_begin = (text_end + 1 + 7) / 8 * 8;
+  const qint64 data_end = data_begin + data.size() - 1;
+
+  auto offset = [](qint64 value) { return QByteArray::number(value).rightJustified(8, ' '); };
+  QByteArray file = QByteArray(version) + "    ";
+  file += offset(text_begin) + offset(text_end);
+  file += header_offsets ? offset(data_begin) + offset(data_end) : offset(0) + offset(0);
+  file += offset(0) + offset(0);
+  file += make_text(data_begin, data_end);
+  file += QByteArray(static_cast<int>(data_begin - file.size()), ' ');
+  file += data;
+  return file;
+}
+
+/*
+Writes a file into the temporary directory
+  :returns: the file path
+*/
+QString TestFCS::write(const QString& name, const QByteArray& file) const {
+  QString path = this->directory.filePath(name);
+  QFile output(path);
+  if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate) || output.write(file) != file.size()) {
+    return QString();
+  }
+  return path;
+}
+
+void TestFCS::initTestCase() { QVERIFY(this->directory.isValid()); }
+
+/*
+Native float data is exposed without a copy, the keywords, parameters and spillover are parsed
+*/
+void TestFCS::floatData() {
+  const float values[4][3] = {{1.0f, 2.0f, 3.0f}, {4.5f, -5.5f, 6.25f}, {7.0f, 8.0f, 9.0f}, {1e6f, 0.0f, -1.0f}};
+  QByteArray data;
+  for (const auto& event : values) {
+    for (float value : event) {
+      TestFCS::append(data, &value, sizeof(value), true);
+    }
+  }
+
+  Keywords keywords = {{"$BYTEORD", "1,2,3,4"},
+                       {"$DATATYPE", "F"},
+                       {"$MODE", "L"},
+                       {"$PAR", "3"},
+                       {"$TOT", "4"},
+                       {"$NEXTDATA", "0"},
+                       {"$CYT", "Test Cytometer"},
+                       {"$P1N", "FSC-A"},
+                       {"$P1B", "32"},
+                       {"$P1R", "262144"},
+                       {"$P1E", "0,0"},
+                       {"$P2N", "FL1-A"},
+                       {"$P2S", "CD3"},
+                       {"$P2B", "32"},
+                       {"$P2R", "262144"},
+                       {"$P2E", "0,0"},
+                       {"$P3N", "FL2-A"},
+                       {"$P3B", "32"},
+                       {"$P3R", "262144"},
+                       {"$P3E", "0,0"},
+                       {"$SPILLOVER", "2,FL1-A,FL2-A,1,0.1,0.05,1"}};
+  QString path = this->write("float.fcs", TestFCS::build(keywords, data, true));
+  QVERIFY(!path.isEmpty());
+
+  Data::FCSReader reader;
+  QVERIFY(reader.open(path));
+  QVERIFY(reader.isValid());
+  QVERIFY(reader.isOpen());
+  QCOMPARE(reader.version(), QString("FCS3.1"));
+  QCOMPARE(reader.dataType(), Data::FCSReader::Float);
+  QCOMPARE(reader.eventCount(), static_cast<std::size_t>(4));
+  QCOMPARE(reader.parameterCount(), static_cast<std::size_t>(3));
+  QCOMPARE(reader.parameter(1).name, QString("FL1-A"));
+  QCOMPARE(reader.parameter(1).label, QString("CD3"));
+  QCOMPARE(reader.parameter(0).bits, static_cast<std::size_t>(32));
+  QCOMPARE(reader.parameterIndex("FL2-A"), static_cast<std::size_t>(2));
+  QCOMPARE(reader.parameterIndex("SSC-A"), Data::FCSReader::none);
+  QCOMPARE(reader.cytometer(), QString("Test Cytometer"));
+  QCOMPARE(reader.keyword("$cyt"), QString("Test Cytometer"));
+
+  QStringList names;
+  std::vector<double> spillover;
+  QVERIFY(reader.spillover(names, spillover));
+  QCOMPARE(names, QStringList({"FL1-A", "FL2-A"}));
+  QCOMPARE(spillover, std::vector<double>({1.0, 0.1, 0.05, 1.0}));
+
+  if (Q_BYTE_ORDER == Q_LITTLE_ENDIAN) {
+    const float* mapped = reader.floatData();
+    QVERIFY(mapped != nullptr);
+    QVERIFY(std::memcmp(mapped, values, sizeof(values)) == 0);
+  }
+  QVERIFY(reader.doubleData() == nullptr);
+
+  float column[4];
+  QCOMPARE(reader.readColumn(1, 0, 4, column), static_cast<std::size_t>(4));
+  for (std::size_t e = 0; e < 4; ++e) {
+    QCOMPARE(column[e], values[e][1]);
+  }
+
+  // Reading past the end is clipped
+  QCOMPARE(reader.readColumn(2, 3, 4, column), static_cast<std::size_t>(1));
+  QCOMPARE(column[0], -1.0f);
+  QCOMPARE(reader.readColumn(2, 4, 4, column), static_cast<std::size_t>(0));
+  QCOMPARE(reader.readColumn(3, 0, 4, column), static_cast<std::size_t>(0));
+
+  float events[2][3];
+  QCOMPARE(reader.readEvents(1, 2, &events[0][0]), static_cast<std::size_t>(2));
+  for (std::size_t e = 0; e < 2; ++e) {
+    for (std::size_t p = 0; p < 3; ++p) {
+      QCOMPARE(events[e][p], values[e + 1][p]);
+    }
+  }
+}
+
+/*
+Double data in the foreign byte order is converted instead of exposed
+*/
+void TestFCS::doubleForeignOrder() {
+  const bool little_endian = Q_BYTE_ORDER != Q_LITTLE_ENDIAN;
+  const double values[3][2] = {{0.5, -2.0}, {1e-3, 3.25}, {123456.75, 7.0}};
+  QByteArray data;
+  for (const auto& event : values) {
+    for (double value : event) {
+      TestFCS::append(data, &value, sizeof(value), little_endian);
+    }
+  }
+
+  Keywords keywords = {{"$BYTEORD", little_endian ? "1,2,3,4,5,6,7,8" : "8,7,6,5,4,3,2,1"},
+                       {"$DATATYPE", "D"},
+                       {"$MODE", "L"},
+                       {"$PAR", "2"},
+                       {"$TOT", "3"},
+                       {"$P1N", "A"},
+                       {"$P1B", "64"},
+                       {"$P1R", "1024"},
+                       {"$P2N", "B"},
+                       {"$P2B", "64"},
+                       {"$P2R", "1024"}};
+  QString path = this->write("double.fcs", TestFCS::build(keywords, data, true));
+
+  Data::FCSReader reader;
+  QVERIFY(reader.open(path));
+  QCOMPARE(reader.dataType(), Data::FCSReader::Double);
+  QVERIFY(reader.doubleData() == nullptr);
+
+  float column[3];
+  for (std::size_t p = 0; p < 2; ++p) {
+    QCOMPARE(reader.readColumn(p, 0, 3, column), static_cast<std::size_t>(3));
+    for (std::size_t e = 0; e < 3; ++e) {
+      QCOMPARE(column[e], static_cast<float>(values[e][p]));
+    }
+  }
+}
+
+/*
+Integer data is masked to its range, linear gain and logarithmic amplification are undone
+*/
+void TestFCS::integerData() {
+  QByteArray data;
+  const std::uint16_t raw_linear[3] = {5, 0xFC00 | 1000, 2};  // 10 bit range, the upper bits are masked
+  const std::uint32_t raw_log[3] = {0, 512, 1024};             // 4 decades over a range of 2048
+  const std::uint8_t raw_gain[3] = {10, 20, 255};             // gain of 2.0
+  for (std::size_t e = 0; e < 3; ++e) {
+    TestFCS::append(data, &raw_linear[e], sizeof(raw_linear[e]), false);
+    TestFCS::append(data, &raw_log[e], sizeof(raw_log[e]), false);
+    TestFCS::append(data, &raw_gain[e], sizeof(raw_gain[e]), false);
+  }
+
+  Keywords keywords = {{"$BYTEORD", "4,3,2,1"},
+                       {"$DATATYPE", "I"},
+                       {"$MODE", "L"},
+                       {"$PAR", "3"},
+                       {"$TOT", "3"},
+                       {"$P1N", "Linear"},
+                       {"$P1B", "16"},
+                       {"$P1R", "1024"},
+                       {"$P1E", "0,0"},
+                       {"$P2N", "Log"},
+                       {"$P2B", "32"},
+                       {"$P2R", "2048"},
+                       {"$P2E", "4,1"},
+                       {"$P3N", "Gain"},
+                       {"$P3B", "8"},
+                       {"$P3R", "256"},
+                       {"$P3G", "2.0"}};
+  QString path = this->write("integer.fcs", TestFCS::build(keywords, data, true));
+
+  Data::FCSReader reader;
+  QVERIFY(reader.open(path));
+  QCOMPARE(reader.dataType(), Data::FCSReader::Integer);
+  QVERIFY(reader.floatData() == nullptr);
+  QCOMPARE(reader.parameter(1).decades, 4.0);
+  QCOMPARE(reader.parameter(1).offset, 1.0);
+
+  float events[3][3];
+  QCOMPARE(reader.readEvents(0, 3, &events[0][0]), static_cast<std::size_t>(3));
+  QCOMPARE(events[0][0], 5.0f);
+  QCOMPARE(events[1][0], 1000.0f);
+  QCOMPARE(events[2][0], 2.0f);
+  QCOMPARE(events[0][1], 1.0f);
+  QCOMPARE(events[1][1], 10.0f);
+  QCOMPARE(events[2][1], 100.0f);
+  QCOMPARE(events[0][2], 5.0f);
+  QCOMPARE(events[1][2], 10.0f);
+  QCOMPARE(events[2][2], 127.5f);
+}
+
+/*
+The DATA offsets of large files are only stored in the TEXT segment
+*/
+void TestFCS::textOffsets() {
+  QByteArray data;
+  for (float value : {1.0f, 2.0f}) {
+    TestFCS::append(data, &value, sizeof(value), true);
+  }
+  Keywords keywords = {{"$BYTEORD", "1,2,3,4"}, {"$DATATYPE", "F"}, {"$PAR", "1"}, {"$TOT", "2"}, {"$P1N", "A"}, {"$P1B", "32"}};
+  QString path = this->write("offsets.fcs", TestFCS::build(keywords, data, false, "FCS3.0"));
+
+  Data::FCSReader reader;
+  QVERIFY(reader.open(path));
+  QCOMPARE(reader.version(), QString("FCS3.0"));
+  float column[2];
+  QCOMPARE(reader.readColumn(0, 0, 2, column), static_cast<std::size_t>(2));
+  QCOMPARE(column[0], 1.0f);
+  QCOMPARE(column[1], 2.0f);
+}
+
+/*
+A doubled delimiter within a value is an escaped delimiter
+*/
+void TestFCS::escapedDelimiter() {
+  QByteArray data(4, '\0');
+  Keywords keywords = {{"$BYTEORD", "1,2,3,4"}, {"$DATATYPE", "F"}, {"$PAR", "1"}, {"$TOT", "1"},
+                       {"$P1N", "A"},           {"$P1B", "32"},     {"$FIL", "a/b.fcs"}};
+  QString path = this->write("escaped.fcs", TestFCS::build(keywords, data, true));
+
+  Data::FCSReader reader;
+  QVERIFY(reader.readHeader(path));
+  QCOMPARE(reader.keyword("$FIL"), QString("a/b.fcs"));
+  QCOMPARE(reader.keyword("$P1N"), QString("A"));
+}
+
+/*
+Reading only the header gives the keywords and parameters, but no data
+*/
+void TestFCS::headerOnly() {
+  QByteArray data(8, '\0');
+  Keywords keywords = {{"$BYTEORD", "1,2,3,4"}, {"$DATATYPE", "F"}, {"$PAR", "1"}, {"$TOT", "2"}, {"$P1N", "A"}, {"$P1B", "32"}};
+  QString path = this->write("header.fcs", TestFCS::build(keywords, data, true));
+
+  Data::FCSReader reader;
+  QVERIFY(reader.readHeader(path));
+  QVERIFY(reader.isValid());
+  QVERIFY(!reader.isOpen());
+  QCOMPARE(reader.eventCount(), static_cast<std::size_t>(2));
+  float column[2];
+  QCOMPARE(reader.readColumn(0, 0, 2, column), static_cast<std::size_t>(0));
+}
+
+/*
+Unsupported or inconsistent files are rejected
+*/
+void TestFCS::invalid() {
+  QByteArray data(8, '\0');
+  Keywords valid = {{"$BYTEORD", "1,2,3,4"}, {"$DATATYPE", "F"}, {"$PAR", "1"}, {"$TOT", "2"}, {"$P1N", "A"}, {"$P1B", "32"}};
+  Data::FCSReader reader;
+  QVERIFY(reader.readHeader(this->write("valid.fcs", TestFCS::build(valid, data, true))));
+
+  QVERIFY(!reader.readHeader(this->write("version.fcs", TestFCS::build(valid, data, true, "FCS2.0"))));
+  QVERIFY(!reader.isValid());
+
+  // More events than fit in the DATA segment
+  Keywords events = valid;
+  events[3].second = "3";
+  QVERIFY(!reader.readHeader(this->write("events.fcs", TestFCS::build(events, data, true))));
+
+  // Histogram mode
+  Keywords mode = valid;
+  mode.emplace_back("$MODE", "H");
+  QVERIFY(!reader.readHeader(this->write("mode.fcs", TestFCS::build(mode, data, true))));
+
+  // Float data has 32 bits
+  Keywords bits = valid;
+  bits[5].second = "16";
+  QVERIFY(!reader.readHeader(this->write("bits.fcs", TestFCS::build(bits, data, true))));
+
+  // A huge $PAR is rejected instead of allocated
+  Keywords parameters = valid;
+  parameters[2].second = "4611686018427387904";
+  QVERIFY(!reader.readHeader(this->write("parameters.fcs", TestFCS::build(parameters, data, true))));
+
+  // Unknown byte order
+  Keywords order = valid;
+  order[0].second = "3,4,1,2";
+  QVERIFY(!reader.readHeader(this->write("order.fcs", TestFCS::build(order, data, true))));
+
+  // Truncated file, the TEXT segment ends beyond the file
+  QByteArray truncated = TestFCS::build(valid, data, true).left(64);
+  QVERIFY(!reader.open(this->write("truncated.fcs", truncated)));
+  QVERIFY(!reader.isOpen());
+}
+
+QTEST_GUILESS_MAIN(TestFCS)
+#include "test_fcs.moc"
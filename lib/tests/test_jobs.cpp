@@ -0,0 +1,300 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-16
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include <QThread>
+#include <QtTest>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "data_jobs.h"
+#include "data_parallel.h"
+
+/*
+Occupies workers of the job system until released, so the queue state is known while jobs are submitted
+*/
+class Gate {
+ public:
+  Gate() : mutex(), condition(), started(0), released(0) {}
+
+ private:
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::size_t started;
+  std::size_t released;
+
+ public:
+  /*
+  Submits the blocking jobs and waits until every one of them occupies a worker
+    :param group: the group to submit to
+    :param count: amount of workers to block, atmost the amount of workers
+  */
+  void block(Data::JobGroup& group, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+      group.submit([this]() {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        ++this->started;
+        this->condition.notify_all();
+        this->condition.wait(lock, [this]() { return this->released > 0; });
+        --this->released;
+      });
+    }
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->condition.wait(lock, [this, count]() { return this->started == count; });
+  }
+
+  /*
+  Releases blocked workers
+    :param count: amount of workers to release
+  */
+  void release(std::size_t count) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->released += count;
+    this->condition.notify_all();
+  }
+};
+
+/*
+Tests the cancellation, priorities and joining of the shared job system
+*/
+class TestJobs : public QObject {
+  Q_OBJECT
+
+ private slots:
+  void initTestCase();
+  void generation();
+  void cancelledBeforeSubmit();
+  void cancelledWhileQueued();
+  void priority();
+  void nestedParallelFor();
+  void receiver();
+  void progress();
+};
+
+void TestJobs::initTestCase() {
+  QVERIFY(Data::JobSystem::instance().threadCount() >= 1);
+  qInfo() << "Workers:" << Data::JobSystem::instance().threadCount();
+}
+
+/*
+Every token handed out by a generation cancels the previous tokens
+*/
+void TestJobs::generation() {
+  Data::JobGeneration generation;
+  Data::JobToken first = generation.next();
+  Data::JobToken copy = first;
+  QVERIFY(!first.isCancelled());
+
+  Data::JobToken second = generation.next();
+  QVERIFY(first.isCancelled());
+  QVERIFY(copy.isCancelled());
+  QVERIFY(!second.isCancelled());
+  QVERIFY(second.generation() > first.generation());
+  QCOMPARE(generation.current(), second.generation());
+
+  generation.cancel();
+  QVERIFY(second.isCancelled());
+
+  Data::JobToken plain;
+  Data::JobToken plain_copy = plain;
+  QVERIFY(!plain.isCancelled());
+  plain_copy.cancel();
+  QVERIFY(plain.isCancelled());
+}
+
+/*
+A job of an already cancelled token is never run
+*/
+void TestJobs::cancelledBeforeSubmit() {
+  std::atomic<int> runs(0);
+  Data::JobToken token;
+  token.cancel();
+
+  Data::JobGroup group;
+  group.submit([&runs]() { ++runs; }, Data::JobSystem::Normal, token);
+  Data::JobSystem::instance().submit([&runs]() { ++runs; }, Data::JobSystem::Normal, token);
+  group.submit([]() {});
+  group.wait();
+
+  QCOMPARE(runs.load(), 0);
+}
+
+/*
+Jobs cancelled while queued are dropped before they start, and still count as finished for their group
+*/
+void TestJobs::cancelledWhileQueued() {
+  const std::size_t workers = Data::JobSystem::instance().threadCount();
+  std::atomic<int> runs(0);
+  Gate gate;
+
+  Data::JobGroup group;
+  gate.block(group, workers);
+
+  Data::JobGeneration generation;
+  Data::JobToken token = generation.next();
+  for (int i = 0; i < 16; ++i) {
+    group.submit([&runs]() { ++runs; }, Data::JobSystem::Normal, token);
+  }
+  Data::JobToken latest = generation.next();
+  group.submit([&runs]() { runs += 100; }, Data::JobSystem::Normal, latest);
+
+  gate.release(workers);
+  group.wait();
+
+  QCOMPARE(runs.load(), 100);
+}
+
+/*
+A worker runs all queued high priority jobs before a low priority job, even if the low priority job was queued first
+*/
+void TestJobs::priority() {
+  const std::size_t workers = Data::JobSystem::instance().threadCount();
+  std::mutex mutex;
+  std::vector<Data::JobSystem::Priority> order;
+  Gate gate;
+
+  Data::JobGroup group;
+  gate.block(group, workers);
+
+  auto record = [&mutex, &order](Data::JobSystem::Priority priority) {
+    return [&mutex, &order, priority]() {
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(priority);
+    };
+  };
+  group.submit(record(Data::JobSystem::Low), Data::JobSystem::Low);
+  group.submit(record(Data::JobSystem::Normal), Data::JobSystem::Normal);
+  for (std::size_t i = 0; i < 2 * workers; ++i) {
+    group.submit(record(Data::JobSystem::High), Data::JobSystem::High);
+  }
+
+  auto finished = [&mutex, &order]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !order.empty() && order.back() == Data::JobSystem::Low;
+  };
+
+  // A single free worker takes the queued jobs one by one
+  gate.release(1);
+  QTRY_VERIFY(finished());
+  gate.release(workers - 1);
+  group.wait();
+
+  QCOMPARE(order.size(), 2 * workers + 2);
+  for (std::size_t i = 0; i < 2 * workers; ++i) {
+    QCOMPARE(order[i], Data::JobSystem::High);
+  }
+  QCOMPARE(order[2 * workers], Data::JobSystem::Normal);
+  QCOMPARE(order[2 * workers + 1], Data::JobSystem::Low);
+}
+
+/*
+A parallelFor inside a job completes, even if all other workers are occupied
+*/
+void TestJobs::nestedParallelFor() {
+  const std::size_t workers = Data::JobSystem::instance().threadCount();
+  std::vector<int> visits(10000, 0);
+  std::atomic<bool> done(false);
+  Gate gate;
+
+  Data::JobGroup group;
+  gate.block(group, workers - 1);
+  group.submit([&visits, &done]() {
+    Data::parallelFor(
+        visits.size(),
+        [&visits](std::size_t begin, std::size_t end) {
+          for (std::size_t i = begin; i < end; ++i) {
+            ++visits[i];
+          }
+        },
+        16);
+    done = true;
+  });
+
+  // The job finishes with the other workers blocked, afterwards they run the (idle) queued helpers
+  QTRY_VERIFY(done.load());
+  gate.release(workers - 1);
+  group.wait();
+
+  QVERIFY(std::all_of(visits.begin(), visits.end(), [](int visit) { return visit == 1; }));
+}
+
+/*
+A posted result runs on the GUI thread, unless the token is cancelled or the receiver deleted
+*/
+void TestJobs::receiver() {
+  QObject* object = new QObject();
+  Data::JobReceiver receiver(object);
+  Data::JobGeneration generation;
+  Data::JobToken cancelled = generation.next();
+  Data::JobToken token = generation.next();
+
+  std::atomic<int> received(0);
+  std::atomic<bool> gui_thread(false);
+  QThread* thread = QThread::currentThread();
+
+  Data::JobGroup group;
+  group.submit([&]() {
+    receiver.post([&received]() { received += 100; }, cancelled);
+    receiver.post(
+        [&received, &gui_thread, thread]() {
+          gui_thread = QThread::currentThread() == thread;
+          ++received;
+        },
+        token);
+  });
+  group.wait();
+
+  // Posts run by the event loop only
+  QCOMPARE(received.load(), 0);
+  QTRY_COMPARE(received.load(), 1);
+  QVERIFY(gui_thread.load());
+
+  receiver.post([&received]() { ++received; });
+  delete object;
+  QTest::qWait(50);
+  QCOMPARE(received.load(), 1);
+}
+
+/*
+Progress never decreases until reset, and only increases are reported
+*/
+void TestJobs::progress() {
+  std::vector<double> reports;
+  Data::JobProgress progress;
+  progress.reset([&reports](double value) { reports.push_back(value); });
+  QCOMPARE(progress.permille(), 0);
+
+  progress.set(100);
+  progress.set(50);
+  progress.set(100);
+  progress.set(250);
+  QCOMPARE(progress.permille(), 250);
+  QCOMPARE(progress.value(), 0.25);
+  QCOMPARE(reports, std::vector<double>({0.1, 0.25}));
+
+  progress.reset();
+  QCOMPARE(progress.permille(), 0);
+  progress.set(1000);
+  QCOMPARE(progress.value(), 1.0);
+  QCOMPARE(reports.size(), static_cast<std::size_t>(2));
+
+  // Out of order sets of many workers end at the maximum
+  progress.reset();
+  Data::JobGroup group;
+  for (int i = 1; i <= 100; ++i) {
+    group.submit([&progress, i]() { progress.set(i * 10); });
+  }
+  group.wait();
+  QCOMPARE(progress.permille(), 1000);
+}
+
+QTEST_GUILESS_MAIN(TestJobs)
+#include "test_jobs.moc"
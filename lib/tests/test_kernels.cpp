@@ -0,0 +1,319 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-16
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include <QtTest>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "data_kernels.h"
+
+/*
+Tests the dispatched kernels against their scalar definition. The test runs once per instruction set (see the
+FLUOR_KERNELS environment variable), the counts are odd to include the tails of the vector loops.
+*/
+class TestKernels : public QObject {
+  Q_OBJECT
+
+ private:
+  static std::vector<float> uniformReference(Data::Kernel::RandomState state, std::size_t count);
+
+ private slots:
+  void initTestCase();
+  void sampleGrid();
+  void dotRows();
+  void binIndices();
+  void affineCurve();
+  void lowerBound();
+  void uniformFill();
+  void normalFill();
+};
+
+/*
+Scalar xoshiro128+ of the eight lanes
+  :param state: the generator state
+  :param count: amount of values
+  :returns: the uniform values in (0, 1]
+*/
+std::vector<float> TestKernels::uniformReference(Data::Kernel::RandomState state, std::size_t count) {
+  std::vector<float> values;
+  while (values.size() < count) {
+    for (std::size_t lane = 0; lane < 8; ++lane) {
+      std::uint32_t* s[4] = {&state.words[0][lane], &state.words[1][lane], &state.words[2][lane], &state.words[3][lane]};
+      std::uint32_t result = *s[0] + *s[3];
+      std::uint32_t t = *s[1] << 9;
+      *s[2] ^= *s[0];
+      *s[3] ^= *s[1];
+      *s[1] ^= *s[2];
+      *s[0] ^= *s[3];
+      *s[2] ^= t;
+      *s[3] = (*s[3] << 11) | (*s[3] >> 21);
+      values.push_back(static_cast<float>((result >> 8) + 1) * 5.9604644775390625e-8f);
+    }
+  }
+  values.resize(count);
+  return values;
+}
+
+void TestKernels::initTestCase() { qInfo() << "Instruction set:" << Data::Kernel::instructionSet(); }
+
+/*
+sampleGrid equals the linear interpolation of Data::Polygon::intensityAt
+*/
+void TestKernels::sampleGrid() {
+  std::vector<float> y(50);
+  for (std::size_t i = 0; i < y.size(); ++i) {
+    y[i] = static_cast<float>((i * 37) % 101);
+  }
+  const double start = 400.0;
+  const double step = 2.0;
+  const double cutoff = 10.0;
+
+  std::vector<double> wavelengths;
+  for (double wavelength = 390.0; wavelength < 510.0; wavelength += 0.37) {
+    wavelengths.push_back(wavelength);
+  }
+  wavelengths.push_back(start);
+  wavelengths.push_back(start + step * 49.0);
+  wavelengths.push_back(std::numeric_limits<double>::quiet_NaN());
+
+  std::vector<double> reference(wavelengths.size());
+  for (std::size_t i = 0; i < wavelengths.size(); ++i) {
+    double wavelength = wavelengths[i];
+    if (!(wavelength >= start && wavelength <= start + step * 49.0)) {
+      reference[i] = 0.0;
+      continue;
+    }
+    double position = (wavelength - start) * (1.0 / step);
+    int index = std::min(static_cast<int>(position), 49);
+    int next = std::min(index + 1, 49);
+    double intensity_index = static_cast<double>(y[static_cast<std::size_t>(index)]);
+    double intensity_next = static_cast<double>(y[static_cast<std::size_t>(next)]);
+    double intensity = intensity_index + (intensity_next - intensity_index) * (position - index);
+    reference[i] = intensity <= cutoff ? 0.0 : intensity;
+  }
+
+  std::vector<double> intensities(wavelengths.size(), -1.0);
+  Data::Kernel::sampleGrid(y.data(), static_cast<int>(y.size()), start, step, wavelengths.data(), intensities.data(),
+                           wavelengths.size(), cutoff);
+  QCOMPARE(intensities, reference);
+
+  // An empty curve is zero everywhere
+  Data::Kernel::sampleGrid(nullptr, 0, start, step, wavelengths.data(), intensities.data(), wavelengths.size(), cutoff);
+  QCOMPARE(intensities, std::vector<double>(wavelengths.size(), 0.0));
+}
+
+/*
+dotRows equals the naive dot product, within the rounding of a different summation order
+*/
+void TestKernels::dotRows() {
+  const std::size_t rows = 13;
+  const std::size_t stride = 40;
+  for (std::size_t count : {std::size_t{1}, std::size_t{7}, std::size_t{16}, std::size_t{37}}) {
+    std::vector<float> matrix(rows * stride);
+    for (std::size_t i = 0; i < matrix.size(); ++i) {
+      matrix[i] = static_cast<float>(static_cast<int>((i * 7919) % 200) - 100) * 0.01f;
+    }
+    std::vector<float> vector(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      vector[i] = static_cast<float>(static_cast<int>((i * 104729) % 50) - 25) * 0.1f;
+    }
+
+    std::vector<float> results(rows);
+    Data::Kernel::dotRows(matrix.data(), rows, stride, vector.data(), count, results.data());
+    for (std::size_t row = 0; row < rows; ++row) {
+      double reference = 0.0;
+      double magnitude = 0.0;
+      for (std::size_t i = 0; i < count; ++i) {
+        double product = static_cast<double>(matrix[row * stride + i]) * static_cast<double>(vector[i]);
+        reference += product;
+        magnitude += std::abs(product);
+      }
+      QVERIFY(std::abs(static_cast<double>(results[row]) - reference) <= 1e-6 * magnitude + 1e-7);
+    }
+  }
+}
+
+/*
+binIndices equals the float binning of every event, outside events (and NaN) get columns * rows
+*/
+void TestKernels::binIndices() {
+  const std::size_t columns = 17;
+  const std::size_t rows = 11;
+  const double x_min = -1.5;
+  const double x_max = 2.5;
+  const double y_min = 0.0;
+  const double y_max = 100.0;
+
+  std::vector<float> x;
+  std::vector<float> y;
+  for (std::size_t i = 0; i < 1001; ++i) {
+    x.push_back(static_cast<float>(-2.0 + 5.0 * static_cast<double>((i * 7919) % 1000) / 1000.0));
+    y.push_back(static_cast<float>(-10.0 + 120.0 * static_cast<double>((i * 104729) % 1000) / 1000.0));
+  }
+  x[3] = static_cast<float>(x_min);
+  x[4] = static_cast<float>(x_max);
+  y[5] = std::numeric_limits<float>::quiet_NaN();
+  x[6] = std::numeric_limits<float>::quiet_NaN();
+
+  const float x_offset = static_cast<float>(x_min);
+  const float x_scale = static_cast<float>(static_cast<double>(columns) / (x_max - x_min));
+  const float y_offset = static_cast<float>(y_min);
+  const float y_scale = static_cast<float>(static_cast<double>(rows) / (y_max - y_min));
+  const std::uint32_t outside = static_cast<std::uint32_t>(columns * rows);
+
+  std::vector<std::uint32_t> reference(x.size());
+  std::vector<std::uint32_t> reference_1d(x.size());
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    float column = (x[i] - x_offset) * x_scale;
+    float row = (y[i] - y_offset) * y_scale;
+    bool inside_x = column >= 0.0f && column < static_cast<float>(columns);
+    bool inside_y = row >= 0.0f && row < static_cast<float>(rows);
+    reference[i] = inside_x && inside_y ? static_cast<std::uint32_t>(row) * static_cast<std::uint32_t>(columns) +
+                                              static_cast<std::uint32_t>(column)
+                                        : outside;
+    reference_1d[i] = inside_x ? static_cast<std::uint32_t>(column) : static_cast<std::uint32_t>(columns);
+  }
+
+  std::vector<std::uint32_t> indices(x.size());
+  Data::Kernel::binIndices(x.data(), y.data(), x.size(), x_min, x_max, columns, y_min, y_max, rows, indices.data());
+  QCOMPARE(indices, reference);
+  QCOMPARE(indices[5], outside);
+  QCOMPARE(indices[6], outside);
+
+  Data::Kernel::binIndices(x.data(), nullptr, x.size(), x_min, x_max, columns, 0.0, 0.0, 0, indices.data());
+  QCOMPARE(indices, reference_1d);
+}
+
+/*
+affineCurve equals the clamped affine transform, NaN becomes the left / top edge
+*/
+void TestKernels::affineCurve() {
+  std::vector<float> y(203);
+  for (std::size_t i = 0; i < y.size(); ++i) {
+    y[i] = static_cast<float>((i * 37) % 120) - 10.0f;
+  }
+  y[7] = std::numeric_limits<float>::quiet_NaN();
+
+  const double x_origin = 300.0;
+  const double x_step = 1.5;
+  const double x_left = 320.0;
+  const double x_right = 550.0;
+  const double y_slope = -2.5;
+  const double y_intercept = 260.0;
+  const double y_top = 10.0;
+  const double y_bottom = 250.0;
+
+  std::vector<double> reference(2 * y.size());
+  for (std::size_t i = 0; i < y.size(); ++i) {
+    double point_y = static_cast<double>(y[i]) * y_slope + y_intercept;
+    point_y = point_y > y_top ? point_y : y_top;
+    point_y = point_y < y_bottom ? point_y : y_bottom;
+    double point_x = x_origin + x_step * static_cast<double>(i);
+    point_x = point_x > x_left ? point_x : x_left;
+    point_x = point_x < x_right ? point_x : x_right;
+    reference[2 * i] = point_x;
+    reference[2 * i + 1] = point_y;
+  }
+
+  std::vector<double> points(2 * y.size());
+  Data::Kernel::affineCurve(y.data(), y.size(), x_origin, x_step, x_left, x_right, y_slope, y_intercept, y_top, y_bottom,
+                            points.data());
+  QCOMPARE(points, reference);
+  QCOMPARE(points[2 * 7 + 1], y_top);
+}
+
+/*
+lowerBound equals std::lower_bound clamped to the last entry, for table sizes around the powers of two
+*/
+void TestKernels::lowerBound() {
+  for (std::size_t size : {std::size_t{1}, std::size_t{2}, std::size_t{3}, std::size_t{7}, std::size_t{8}, std::size_t{9},
+                           std::size_t{64}, std::size_t{100}}) {
+    // Ascending with duplicates
+    std::vector<float> table(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      table[i] = static_cast<float>(i / 2) * 0.5f;
+    }
+
+    std::vector<float> values;
+    for (float value = -1.0f; value < static_cast<float>(size) * 0.25f + 1.0f; value += 0.125f) {
+      values.push_back(value);
+    }
+    values.push_back(std::numeric_limits<float>::quiet_NaN());
+
+    std::vector<std::uint32_t> reference(values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      std::size_t index = static_cast<std::size_t>(std::lower_bound(table.begin(), table.end(), values[i]) - table.begin());
+      reference[i] = static_cast<std::uint32_t>(std::min(index, size - 1));
+    }
+
+    std::vector<std::uint32_t> indices(values.size());
+    Data::Kernel::lowerBound(table.data(), table.size(), values.data(), values.size(), indices.data());
+    QCOMPARE(indices, reference);
+    QCOMPARE(indices.back(), static_cast<std::uint32_t>(0));
+  }
+}
+
+/*
+uniformFill equals the scalar xoshiro128+ lanes, and a partial step still advances the state
+*/
+void TestKernels::uniformFill() {
+  Data::Kernel::RandomState state;
+  Data::Kernel::seedRandom(state, 2022);
+  std::vector<float> reference = TestKernels::uniformReference(state, 1016);
+
+  std::vector<float> values(1003);
+  Data::Kernel::uniformFill(state, values.data(), values.size());
+  QVERIFY(std::equal(values.begin(), values.end(), reference.begin()));
+  QVERIFY(std::all_of(values.begin(), values.end(), [](float value) { return value > 0.0f && value <= 1.0f; }));
+
+  // The last (partial) step of 1003 values ends at 1008
+  Data::Kernel::uniformFill(state, values.data(), 5);
+  QVERIFY(std::equal(values.begin(), values.begin() + 5, reference.begin() + 1008));
+}
+
+/*
+normalFill is the Box-Muller transform of the uniform lanes, and bitwise identical on every instruction set
+*/
+void TestKernels::normalFill() {
+  Data::Kernel::RandomState state;
+  Data::Kernel::seedRandom(state, 2022);
+  std::vector<float> uniform = TestKernels::uniformReference(state, 1008);
+
+  std::vector<float> values(1000);
+  Data::Kernel::normalFill(state, values.data(), values.size());
+
+  // Every block of sixteen values uses a step of radii and a step of angles
+  const double pi = 3.14159265358979323846;
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    std::size_t block = i / 16;
+    std::size_t lane = i % 8;
+    double radius = std::sqrt(-2.0 * std::log(static_cast<double>(uniform[block * 16 + lane])));
+    double angle = 2.0 * pi * static_cast<double>(uniform[block * 16 + 8 + lane]);
+    double reference = (i % 16) < 8 ? radius * std::cos(angle) : radius * std::sin(angle);
+    QVERIFY(std::abs(static_cast<double>(values[i]) - reference) < 1e-5 * (1.0 + radius));
+  }
+
+  // FNV-1a of the bits, equal for every instruction set. The value is of a build without floating point contraction
+  // (the default flags), fused multiply-adds change the bits of all instruction sets alike.
+  std::uint32_t hash = 2166136261u;
+  for (float value : values) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (std::uint32_t shift = 0; shift < 32; shift += 8) {
+      hash = (hash ^ ((bits >> shift) & 0xFFu)) * 16777619u;
+    }
+  }
+  QCOMPARE(hash, 0xd660d4dcu);
+}
+
+QTEST_GUILESS_MAIN(TestKernels)
+#include "test_kernels.moc"
@@ -0,0 +1,99 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** catalogue_window.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** The FCS catalogue window
+**
+** :class: Catalogue::Window
+** Indexes a folder of FCS files with a Data::FCSCatalogue. The scan runs in
+** a job, which posts its progress and end to the window, and can be cancelled. The catalogue is
+** stored next to the application data, so a rescan only reads new and
+** changed files. Shows the amount of files matched to every instrument.
+**
+***************************************************************************/
+
+#ifndef CATALOGUE_WINDOW_H
+#define CATALOGUE_WINDOW_H
+
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QLineEdit>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTableWidget>
+#include <memory>
+
+#include "data_catalogue.h"
+#include "data_instruments.h"
+#include "data_jobs.h"
+#include "general_widgets.h"
+
+namespace Catalogue {
+
+class Window : public General::StyledWidget {
+  Q_OBJECT
+
+ public:
+  explicit Window(QWidget* parent = nullptr);
+  Window(const Window& obj) = delete;
+  Window& operator=(const Window& obj) = delete;
+  Window(Window&&) = delete;
+  Window& operator=(Window&&) = delete;
+  virtual ~Window();
+
+ private:
+  const Data::InstrumentReader* instruments;
+
+  std::shared_ptr<Data::FCSCatalogue> catalogue;  // only touched by the window in between scans
+  Data::JobGeneration catalogue_generation;
+  bool catalogue_running;
+  QElapsedTimer catalogue_elapsed;
+
+  QLineEdit* widget_folder;
+  QPushButton* widget_browse;
+  QPushButton* widget_scan;
+  QPushButton* widget_cancel;
+  QProgressBar* widget_progress;
+  QLabel* widget_summary;
+  QTableWidget* widget_table;
+
+  static QString cataloguePath();
+  bool isRunning() const;
+  void setRunning(bool running);
+  void buildTable();
+  void finishScan();
+
+ private slots:
+  void receiveBrowse(bool checked);
+  void receiveScan(bool checked);
+  void receiveCancel(bool checked);
+
+ public slots:
+  void receiveInstruments(const Data::InstrumentReader& instruments);
+};
+
+}  // namespace Catalogue
+
+#endif  // CATALOGUE_WINDOW_H
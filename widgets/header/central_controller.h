@@ -37,6 +37,7 @@
 
 #include <QPaintEvent>
 #include <QWidget>
+#include <memory>
 #include <vector>
 
 #include "cache.h"
@@ -86,6 +87,7 @@ class Controller : public QWidget {
 
   void receiveGraphSelect(std::size_t index, bool state);
   void receiveGraphState(std::vector<State::GraphState>& state);
+  void receiveEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y);
 
  signals:
   void sendGlobalEvent(QEvent* event);
@@ -107,6 +109,7 @@ class Controller : public QWidget {
 
   void sendGraphSelect(std::size_t index, bool state);
   void sendGraphState(std::vector<State::GraphState>& state);
+  void sendEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y);
 };
 
 }  // namespace Central
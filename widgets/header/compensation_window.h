@@ -0,0 +1,106 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** compensation_window.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** The spillover from controls window
+**
+** :class: Compensation::Window
+** Runs a Data::SpilloverEstimator over a folder of single stain control FCS
+** files for the detectors of the current instrument. The estimation runs in
+** a job, which posts its progress and result to the window, and can be
+** cancelled. The measured,
+** predicted, and difference matrices can be shown and exported.
+**
+***************************************************************************/
+
+#ifndef COMPENSATION_WINDOW_H
+#define COMPENSATION_WINDOW_H
+
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTableWidget>
+#include <memory>
+
+#include "data_estimator.h"
+#include "data_fluorophores.h"
+#include "data_jobs.h"
+#include "data_instruments.h"
+#include "general_widgets.h"
+
+namespace Compensation {
+
+class Window : public General::StyledWidget {
+  Q_OBJECT
+
+ public:
+  explicit Window(QWidget* parent = nullptr);
+  Window(const Window& obj) = delete;
+  Window& operator=(const Window& obj) = delete;
+  Window(Window&&) = delete;
+  Window& operator=(Window&&) = delete;
+  virtual ~Window();
+
+ private:
+  Data::Instrument instrument;
+  const Data::FluorophoreReader* fluorophores;
+
+  std::shared_ptr<Data::SpilloverEstimator> estimator;  // the finished estimation
+  Data::JobGeneration estimator_generation;
+
+  QLineEdit* widget_folder;
+  QPushButton* widget_browse;
+  QDoubleSpinBox* widget_positive;
+  QDoubleSpinBox* widget_negative;
+  QPushButton* widget_start;
+  QPushButton* widget_cancel;
+  QProgressBar* widget_progress;
+  QLabel* widget_summary;
+  QComboBox* widget_mode;
+  QPushButton* widget_export;
+  QTableWidget* widget_table;
+
+  void setRunning(bool running);
+  void buildTable();
+  void finishEstimation(std::shared_ptr<Data::SpilloverEstimator> estimator);
+
+ private slots:
+  void receiveBrowse(bool checked);
+  void receiveStart(bool checked);
+  void receiveCancel(bool checked);
+  void receiveMode(int index);
+  void receiveExport(bool checked);
+
+ public slots:
+  void receiveInstrument(const Data::Instrument& instrument);
+  void receiveFluorophores(const Data::FluorophoreReader& fluorophores);
+};
+
+}  // namespace Compensation
+
+#endif  // COMPENSATION_WINDOW_H
@@ -60,7 +60,7 @@ enum class SortMode {
 
 namespace Main {
 
-enum class MenuBarAction { SaveAs, Open, Print, Exit, InstrumentID, SortOrder, StyleID, About };
+enum class MenuBarAction { SaveAs, Open, Print, Exit, InstrumentID, SortOrder, StyleID, Spillover, Panel, Similarity, Spreading, Compensation, Catalogue, Events, Trace, About };
 
 }  // namespace Main
 
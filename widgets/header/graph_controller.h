@@ -78,6 +78,7 @@ class Controller : public QWidget {
 
   void sendGraphSelect(const Controller* graph, bool state);
   void sendGraphState(const State::GraphState& state);
+  void sendEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y);
 
   void sendPainterUpdate(const Graph::Format::Style* style);
 
@@ -90,6 +91,7 @@ class Controller : public QWidget {
   void setSelect(bool state);
   void receivePlotSelected(bool state);
   void receiveGraphState(const State::GraphState& state);
+  void receiveEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y);
 
   void receiveStyleChanged();
 };
@@ -132,6 +134,7 @@ class ScrollController : public QScrollArea {
   void sendCacheRequestUpdate();
 
   void sendGraphSelect(std::size_t index, bool state);
+  void sendEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y);
 
  private slots:
   void hidingScrollBar();
@@ -145,6 +148,7 @@ class ScrollController : public QScrollArea {
 
   void receiveGraphState(std::vector<State::GraphState>& state);
   void receiveGraphSelect(const Controller* graph, bool state);
+  void receiveEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y);
 };
 
 }  // namespace Graph
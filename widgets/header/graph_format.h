@@ -59,10 +59,10 @@
 #include <QFont>
 #include <QPen>
 #include <QString>
+#include <QTransform>
 #include <QWidget>
 #include <Qt>
 #include <array>
-#include <functional>
 
 namespace Graph {
 
@@ -343,14 +343,8 @@ class PlotRectF {
   void setSettings(const QRectF& rect);
 
   double toLocalX(double global) const;
-  double toGlobalX(double local) const;
   double toLocalY(double global, double intensity = 1.0) const;
-  double toGlobalY(double local, double intensity = 1.0) const;
-
-  std::function<double(double)> toLocalXFunction() const;
-  std::function<double(double)> toGlobalXFunction() const;
-  std::function<double(double, double)> toLocalYFunction() const;
-  std::function<double(double, double)> toGlobalYFunction() const;
+  QTransform toLocalTransform() const;
 
  private:
   void calculate();
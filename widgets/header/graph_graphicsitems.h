@@ -74,6 +74,10 @@
 ** :class: Graph::Colorbar
 ** A rectangle for the horizontal (x) axis. Shows the human visible colorspectrum of light
 **
+** :class: Graph::SpectrumGeometry
+** The scaled excitation/emission curves of one fluorophore in one plotting region. Immutable and shared
+** between all graphs with an identical plotting region
+**
 ** :class: Graph::Spectrum
 ** A graphicsitem class for painting, and contain-detection of excitation/emission curves of one fluorophore
 **
@@ -83,8 +87,14 @@
 ** :class: Graph::Filter
 ** A graphicsitem class for the painting of a filter of BandPass, LongPass, Shortpass type
 **
+** :class: Graph::Density
+** A graphicsitem class for the painting of an event density (two parameters) or histogram (one parameter) as a cached image.
+** The events are binned against the visible axis ranges of the plot, so they share the wavelength and intensity axes.
+** The binning and rendering of the image happens in jobs of the GraphicsScene, the item only draws the result.
+**
 ** :class: Graph::AbstractCollection
-** A abstract storage class that contains a collection of graphicsitem.
+** A abstract storage class that contains a collection of graphicsitem. The items are
+** painted by the collection as a single layer, cached until the items change.
 **
 ** :class: Graph::SpectrumCollection
 ** A storage class holding multiple Graph::Spectrum classes
@@ -105,19 +115,26 @@
 #include <QGraphicsItem>
 #include <QGraphicsScene>
 #include <QGraphicsSimpleTextItem>
+#include <QImage>
 #include <QMargins>
 #include <QObject>
 #include <QPainter>
 #include <QPen>
+#include <QPixmap>
 #include <QRectF>
 #include <QString>
 #include <QStyleOptionGraphicsItem>
 #include <QWidget>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 #include "cache.h"
+#include "data_density.h"
 #include "data_instruments.h"
 #include "data_spectrum.h"
 #include "graph_format.h"
+#include "state_gui.h"
 
 namespace Graph {
 
@@ -495,6 +512,35 @@ class Colorbar : public QGraphicsRectItem {
   bool isSelected() const;
 };
 
+class SpectrumGeometry {
+ public:
+  SpectrumGeometry();
+  SpectrumGeometry(const SpectrumGeometry& obj) = delete;
+  SpectrumGeometry& operator=(const SpectrumGeometry& obj) = delete;
+  SpectrumGeometry(SpectrumGeometry&&) = delete;
+  SpectrumGeometry& operator=(SpectrumGeometry&&) = delete;
+  ~SpectrumGeometry() = default;
+
+ private:
+  Data::Polygon geometry_excitation;
+  Data::Polygon geometry_emission;
+  Data::Polygon geometry_emission_fill;
+  QRectF geometry_bounds;
+
+  void scale(const Data::CacheSpectrum& source, const PlotRectF& space, double intensity, double width_excitation, double width_emission,
+             double ratio);
+
+ public:
+  static std::shared_ptr<const SpectrumGeometry> empty();
+  static std::shared_ptr<const SpectrumGeometry> get(const Data::CacheSpectrum& source, const PlotRectF& space, double intensity,
+                                                     double width_excitation, double width_emission);
+
+  const Data::Polygon& excitation() const;
+  const Data::Polygon& emission() const;
+  const Data::Polygon& emissionFill() const;
+  const QRectF& bounds() const;
+};
+
 class Spectrum : public QGraphicsItem {
  public:
   explicit Spectrum(Data::CacheSpectrum& data, QGraphicsItem* parent = nullptr);
@@ -506,9 +552,7 @@ class Spectrum : public QGraphicsItem {
 
  private:
   Data::CacheSpectrum& spectrum_source;
-  Data::Polygon spectrum_excitation;
-  Data::Polygon spectrum_emission;
-  Data::Polygon spectrum_emission_fill;
+  std::shared_ptr<const SpectrumGeometry> spectrum_geometry;
 
   QRectF spectrum_space;
 
@@ -534,16 +578,21 @@ class Spectrum : public QGraphicsItem {
   virtual QRectF boundingRect() const override;
   virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
   virtual bool contains(const QPointF& point) const override;
-  bool contains(const PlotRectF& space, const QPointF& point) const;
 
   void setPosition(const PlotRectF& space);
-  void updateSpectrum();
+  bool updateSpectrum();
   void updateIntensity(const std::vector<Data::Laser>& lasers);
+  void updateIntensity(const double* excitation, std::size_t count);
   void updatePainter(const Graph::Format::Style* style);
 
   Data::CacheSpectrum& source() const;
+  const SpectrumGeometry& geometry() const;
+  bool visibleExcitation() const;
+  bool visibleEmission() const;
+  double widthExcitation() const;
+  double widthEmission() const;
 
-  void setSelect(bool selection);
+  bool setSelect(bool selection);
 };
 
 class Laser : public QGraphicsLineItem {
@@ -601,6 +650,12 @@ class Filter : public QGraphicsItem {
   QPen pen_right = Qt::NoPen;
   QPen pen_top = Qt::NoPen;
 
+  QString label_text;
+  QString label_elided;
+  QColor label_color;
+  QFont label_font;
+  QRectF label_rect;
+
  public:
   virtual QRectF boundingRect() const override;
   virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
@@ -615,6 +670,41 @@ class Filter : public QGraphicsItem {
   void setWavelengths(double left, double right);
   void setLineStyle(Qt::PenStyle left, Qt::PenStyle right);
   void setBevel(BevelShape left, BevelShape right);
+  void setLabel(const QString& text, const QColor& color);
+};
+
+class Density : public QGraphicsItem {
+ public:
+  explicit Density(QGraphicsItem* parent = nullptr);
+  Density(const Density& obj) = delete;
+  Density& operator=(const Density& obj) = delete;
+  Density(Density&&) = delete;
+  Density& operator=(Density&&) = delete;
+  virtual ~Density() = default;
+
+ private:
+  Data::DensityGrid density_grid;
+  QRectF density_range;  // the visible axis ranges, x: left to right, y: top (low) to bottom (high)
+  QRectF density_space;
+  QImage density_image;
+  QColor density_color;
+
+ public:
+  virtual QRectF boundingRect() const override;
+  virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+  bool isEmpty() const;
+  void setEvents(const Data::DensityGrid& grid);
+  void setGrid(const Data::DensityGrid& grid, const QImage& image);
+  const Data::DensityGrid& grid() const;
+  const QRectF& range() const;
+  QSize binSize() const;
+  const QColor& color() const;
+
+  static QImage render(const Data::DensityGrid& grid, int height, const QColor& color);
+
+  void setPosition(const PlotRectF& space);
+  void updatePainter(const Graph::Format::Style* style);
 };
 
 template <typename ITEM>
@@ -637,6 +727,13 @@ class AbstractCollection : public QGraphicsItem {
   int minimum_width;
   int minimum_height;
 
+  QRectF layer_rect;    // the plot space united with the items' bounding rectangles
+  QPixmap layer_cache;  // all (visible) items rendered
+  bool layer_valid;
+
+ protected:
+  void invalidate();
+
  public:
   virtual QRectF boundingRect() const override;
   std::vector<ITEM*> containsItems(const QPointF& point) const;
@@ -650,7 +747,7 @@ class AbstractCollection : public QGraphicsItem {
   int minimumWidth() const;
   int minimumHeight() const;
 
-  void setPosition();
+  virtual void setPosition();
 };
 
 class SpectrumCollection : public AbstractCollection<Spectrum> {
@@ -663,16 +760,31 @@ class SpectrumCollection : public AbstractCollection<Spectrum> {
   virtual ~SpectrumCollection() = default;
 
  public:
-  void setSelect(bool select);
+  bool setSelect(bool select);
+  bool select(const Spectrum* selection);
+  void setPosition() override;
+  void updatePainter(const Graph::Format::Style* style);
 
   void syncSpectra(const std::vector<Cache::ID>& cache_state);
   void updateSpectra();
   void updateIntensity(const std::vector<Data::Laser>& lasers);
 
-  std::vector<Spectrum*> containsItems(const PlotRectF& space, const QPointF& point) const;
+  std::vector<Spectrum*> pickItems(const QPointF& point) const;
 
  private:
+  // Picking index, per pixel column of the plot the curves covering it sorted by their top (in local coordinates)
+  struct PickEntry {
+    float top;            // the curve height minus half the line width
+    std::uint32_t curve;  // item index * 2, + 1 for the emission curve
+  };
+
+  mutable std::vector<std::size_t> pick_offsets;  // column i spans pick_entries[pick_offsets[i], pick_offsets[i + 1])
+  mutable std::vector<PickEntry> pick_entries;
+  mutable double pick_left;
+  mutable bool pick_valid;
+
   std::size_t findIndex(const Data::CacheSpectrum& id, std::size_t index_start) const;
+  void buildPickIndex() const;
 };
 
 class LaserCollection : public AbstractCollection<Laser> {
@@ -700,7 +812,7 @@ class FilterCollection : public AbstractCollection<Filter> {
   virtual ~FilterCollection() = default;
 
  public:
-  void syncFilters(const std::vector<Data::Filter>& filters);
+  void syncFilters(const std::vector<Data::Filter>& filters, const std::vector<State::FilterLabel>& labels);
   void updateFilters(bool visible);
 };
 
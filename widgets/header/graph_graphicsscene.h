@@ -27,7 +27,8 @@
 ** The graphicsscene object of a graph
 **
 ** :class: Graph::GraphicsScene
-** The graphicsscene holding all QGraphicsItem of a single plot
+** The graphicsscene holding all QGraphicsItem of a single plot. The density events are binned against the
+** visible axis ranges in jobs, a resize or axis range change supersedes the rebin of the previous one.
 **
 ***************************************************************************/
 
@@ -40,8 +41,11 @@
 #include <QGraphicsSceneWheelEvent>
 #include <QSize>
 #include <QWidget>
+#include <memory>
+#include <vector>
 
 #include "data_instruments.h"
+#include "data_jobs.h"
 #include "graph_format.h"
 #include "graph_graphicsitems.h"
 #include "state_gui.h"
@@ -64,6 +68,7 @@ class GraphicsScene : public QGraphicsScene {
   Graph::PlotRectF plot_rect;
 
   Graph::Background* item_background;
+  Graph::Density* item_density;
   Graph::Axis::LabelX* item_x_axis_label;
   Graph::Axis::GridLabelsX* item_x_axis_gridlabels;
   Graph::Axis::TicksX* item_x_axis_ticks;
@@ -78,6 +83,12 @@ class GraphicsScene : public QGraphicsScene {
   Graph::FilterCollection* item_filters;
   Graph::Outline* item_outline;
 
+  // The density events of the last sync, the binning of the events and rebinning of the grid supersede older jobs
+  std::shared_ptr<const std::vector<float>> density_x;
+  std::shared_ptr<const std::vector<float>> density_y;
+  Data::JobGeneration density_events;
+  Data::JobGeneration density_rebin;
+
   // Keeps track of scroll rotation to be able to scroll through the spectrum items
   std::size_t scroll_count;
   // Keep track of current size for style/dpi changes
@@ -89,6 +100,7 @@ class GraphicsScene : public QGraphicsScene {
 
  private:
   void calculateSizes(const QSize& rect);
+  void rebinDensity();
 
  public:
   bool isPressed() const;
@@ -103,6 +115,8 @@ class GraphicsScene : public QGraphicsScene {
   void syncSpectra(const std::vector<Cache::ID>& cache_state);
   void updateSpectra();
 
+  void syncDensity(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y);
+
   void syncGraphState(const State::GraphState& state);
 
  private slots:
@@ -111,7 +125,7 @@ class GraphicsScene : public QGraphicsScene {
   void syncAxisY();
   void syncLasers(const std::vector<Data::Laser>& lasers);
   void updateLasers(bool visible);
-  void syncFilters(const std::vector<Data::Filter>& filters);
+  void syncFilters(const std::vector<Data::Filter>& filters, const std::vector<State::FilterLabel>& labels);
   void updateFilters(bool visible);
 
  public slots:
@@ -38,6 +38,7 @@
 #include <QMainWindow>
 #include <QScreen>
 #include <QShowEvent>
+#include <memory>
 #include <vector>
 
 #include "cache.h"
@@ -97,6 +98,7 @@ class Controller : public QMainWindow {
 
   void receiveGraphSelect(std::size_t index, bool state);
   void receiveGraphState(std::vector<State::GraphState>& state);
+  void receiveEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y);
 
  signals:
   void resized(const QWidget* widget);
@@ -127,6 +129,7 @@ class Controller : public QMainWindow {
 
   void sendGraphSelect(std::size_t index, bool state);
   void sendGraphState(std::vector<State::GraphState>& state);
+  void sendEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y);
 };
 
 }  // namespace Main
@@ -123,6 +123,31 @@ class OptionsMenu : public QMenu {
   void sendAction(Main::MenuBarAction action, const QVariant& id = QVariant());
 };
 
+class ToolsMenu : public QMenu {
+  Q_OBJECT
+
+ public:
+  explicit ToolsMenu(QWidget* parent = nullptr);
+  ToolsMenu(const ToolsMenu& obj) = delete;
+  ToolsMenu& operator=(const ToolsMenu& obj) = delete;
+  ToolsMenu(ToolsMenu&&) = delete;
+  ToolsMenu& operator=(ToolsMenu&&) = delete;
+  virtual ~ToolsMenu() = default;
+
+ protected slots:
+  void triggered_spillover(bool checked);
+  void triggered_panel(bool checked);
+  void triggered_similarity(bool checked);
+  void triggered_spreading(bool checked);
+  void triggered_compensation(bool checked);
+  void triggered_catalogue(bool checked);
+  void triggered_events(bool checked);
+  void triggered_trace(bool checked);
+
+ signals:
+  void sendAction(Main::MenuBarAction action, const QVariant& id = QVariant());
+};
+
 class HelpMenu : public QMenu {
   Q_OBJECT
 
@@ -156,6 +181,7 @@ class MenuBar : public QMenuBar {
   FileMenu* file_menu;
   InstrumentMenu* instrument_menu;
   OptionsMenu* options_menu;
+  ToolsMenu* tools_menu;
   HelpMenu* help_menu;
 
  public slots:
@@ -0,0 +1,105 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** panel_window.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** The panel optimizer window
+**
+** :class: Panel::Window
+** Runs a Data::PanelOptimizer over the whole fluorophore library for the
+** detectors of the current instrument. The search runs in a job, which posts
+** its progress and result to the window, and can be cancelled. The resulting panel can be
+** applied to the cache.
+**
+***************************************************************************/
+
+#ifndef PANEL_WINDOW_H
+#define PANEL_WINDOW_H
+
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <memory>
+
+#include "data_fluorophores.h"
+#include "data_instruments.h"
+#include "data_jobs.h"
+#include "data_panel.h"
+#include "general_widgets.h"
+
+namespace Panel {
+
+class Window : public General::StyledWidget {
+  Q_OBJECT
+
+ public:
+  explicit Window(QWidget* parent = nullptr);
+  Window(const Window& obj) = delete;
+  Window& operator=(const Window& obj) = delete;
+  Window(Window&&) = delete;
+  Window& operator=(Window&&) = delete;
+  virtual ~Window();
+
+ private:
+  Data::Instrument instrument;
+  const Data::FluorophoreReader* fluorophores;
+
+  std::shared_ptr<Data::PanelOptimizer> optimizer;  // the finished search
+  Data::JobGeneration optimizer_generation;
+
+  QComboBox* widget_objective;
+  QDoubleSpinBox* widget_weight;
+  QDoubleSpinBox* widget_minimum;
+  QSpinBox* widget_beam;
+  QPushButton* widget_start;
+  QPushButton* widget_cancel;
+  QPushButton* widget_apply;
+  QProgressBar* widget_progress;
+  QLabel* widget_summary;
+  QTableWidget* widget_table;
+
+  void setRunning(bool running);
+  void buildTable();
+  void finishSearch(std::shared_ptr<Data::PanelOptimizer> optimizer);
+
+ private slots:
+  void receiveStart(bool checked);
+  void receiveCancel(bool checked);
+  void receiveApply(bool checked);
+
+ public slots:
+  void receiveInstrument(const Data::Instrument& instrument);
+  void receiveFluorophores(const Data::FluorophoreReader& fluorophores);
+
+ signals:
+  void sendPanel(std::vector<Data::FluorophoreID>& fluorophores);
+};
+
+}  // namespace Panel
+
+#endif  // PANEL_WINDOW_H
@@ -0,0 +1,113 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** similarity_window.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** The similar fluorophores window
+**
+** :class: Similarity::Window
+** Ranks the fluorophore library on its similarity to a cached fluorophore,
+** either on the full excitation+emission spectrum or on the signal in the
+** detectors of the current instrument. The library index is built upon the
+** first search. Searches run as jobs, a new search supersedes the running one.
+** Selected matches can be added to the cache.
+**
+***************************************************************************/
+
+#ifndef SIMILARITY_WINDOW_H
+#define SIMILARITY_WINDOW_H
+
+#include <QComboBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <memory>
+#include <vector>
+
+#include "cache.h"
+#include "data_fluorophores.h"
+#include "data_instruments.h"
+#include "data_jobs.h"
+#include "data_similarity.h"
+#include "general_widgets.h"
+
+namespace Similarity {
+
+class Window : public General::StyledWidget {
+  Q_OBJECT
+
+ public:
+  explicit Window(QWidget* parent = nullptr);
+  Window(const Window& obj) = delete;
+  Window& operator=(const Window& obj) = delete;
+  Window(Window&&) = delete;
+  Window& operator=(Window&&) = delete;
+  virtual ~Window() = default;
+
+ private:
+  const Data::FluorophoreReader* fluorophores;
+  std::shared_ptr<const std::vector<Data::Spectrum>> library;
+  std::shared_ptr<const QStringList> library_names;
+  Data::Instrument instrument;
+
+  std::shared_ptr<const Data::SimilarityIndex> index_spectral;
+  std::shared_ptr<const Data::SimilarityIndex> index_detector;
+  std::shared_ptr<const Data::SimilarityIndex> matches_index;  // the index the matches refer to
+  std::vector<Data::SimilarityIndex::Match> matches;
+  Data::JobGeneration search_generation;
+
+  std::vector<Cache::ID> sources;
+
+  QComboBox* widget_source;
+  QComboBox* widget_mode;
+  QSpinBox* widget_count;
+  QPushButton* widget_add;
+  QLabel* widget_summary;
+  QTableWidget* widget_table;
+
+  std::shared_ptr<const Data::SimilarityIndex>& index(Data::SimilarityIndex::Mode mode);
+  void search();
+  void finishSearch(Data::SimilarityIndex::Mode mode, std::shared_ptr<const Data::SimilarityIndex> index,
+                    std::vector<Data::SimilarityIndex::Match> matches, double elapsed);
+  void buildTable();
+
+ private slots:
+  void receiveSource(int index);
+  void receiveMode(int index);
+  void receiveCount(int count);
+  void receiveAdd(bool checked);
+
+ public slots:
+  void receiveFluorophores(const Data::FluorophoreReader& fluorophores);
+  void receiveInstrument(const Data::Instrument& instrument);
+  void receiveCacheState(const std::vector<Cache::ID>& cache_state);
+
+ signals:
+  void sendCacheAdd(std::vector<Data::FluorophoreID>& fluorophores);
+};
+
+}  // namespace Similarity
+
+#endif  // SIMILARITY_WINDOW_H
@@ -0,0 +1,91 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** spillover_window.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** The spillover matrix window
+**
+** :class: Spillover::Window
+** Shows the spillover (or signal) matrix of the cached fluorophores in the
+** detectors of the current instrument. The primary detector of each
+** fluorophore is shown in bold. Alternatively shows the similarity matrix of
+** the fluorophore signatures, with the complexity index of the panel. The
+** matrix can be exported as a .csv file.
+**
+***************************************************************************/
+
+#ifndef SPILLOVER_WINDOW_H
+#define SPILLOVER_WINDOW_H
+
+#include <QComboBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+
+#include "data_signature.h"
+#include "data_spillover.h"
+#include "general_widgets.h"
+
+namespace Spillover {
+
+class Window : public General::StyledWidget {
+  Q_OBJECT
+
+ public:
+  explicit Window(QWidget* parent = nullptr);
+  Window(const Window& obj) = delete;
+  Window& operator=(const Window& obj) = delete;
+  Window(Window&&) = delete;
+  Window& operator=(Window&&) = delete;
+  virtual ~Window() = default;
+
+  enum Mode { Spillover, Signal, Similarity };
+
+ private:
+  Data::SpilloverMatrix matrix;
+  Data::SignatureMatrix signature;
+  Window::Mode matrix_mode;
+
+  QComboBox* widget_mode;
+  QLabel* widget_complexity;
+  QPushButton* widget_export;
+  QTableWidget* widget_table;
+
+  void buildTable();
+  void buildSpillover();
+  void buildSimilarity();
+  void buildComplexity();
+
+ private slots:
+  void receiveMode(int index);
+  void receiveExport(bool checked);
+
+ public slots:
+  void receiveSpillover(const Data::SpilloverMatrix& matrix);
+  void receiveSignature(const Data::SignatureMatrix& signature);
+};
+
+}  // namespace Spillover
+
+#endif  // SPILLOVER_WINDOW_H
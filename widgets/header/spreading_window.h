@@ -0,0 +1,101 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+/**** LGPLv3 License *******************************************************
+** spreading_window.h is part of Fluor
+**
+** Fluor is free software: you can redistribute it and/or
+** modify it under the terms of the Lesser GNU General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** Fluor is distributed in the hope that it will be useful, but
+** WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the Lesser
+** GNU General Public License for more details.
+**
+** You should have received a copy of the Lesser GNU General Public License
+** along with Fluor. If not, see <https://www.gnu.org/licenses/>.
+***************************************************************************/
+
+/**** DOC ******************************************************************
+** The spillover spreading simulation window
+**
+** :class: Spreading::Window
+** Runs a Data::SpreadingSimulation of the cached fluorophores on the current
+** instrument, and shows the resulting spillover spreading matrix. The
+** simulation runs in a job, which posts its progress and result to the
+** window, and can be cancelled.
+**
+***************************************************************************/
+
+#ifndef SPREADING_WINDOW_H
+#define SPREADING_WINDOW_H
+
+#include <QDoubleSpinBox>
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <memory>
+
+#include "data_jobs.h"
+#include "data_simulation.h"
+#include "data_spillover.h"
+#include "general_widgets.h"
+
+namespace Spreading {
+
+class Window : public General::StyledWidget {
+  Q_OBJECT
+
+ public:
+  explicit Window(QWidget* parent = nullptr);
+  Window(const Window& obj) = delete;
+  Window& operator=(const Window& obj) = delete;
+  Window(Window&&) = delete;
+  Window& operator=(Window&&) = delete;
+  virtual ~Window();
+
+ private:
+  Data::SpilloverMatrix matrix;
+
+  std::shared_ptr<Data::SpreadingSimulation> simulation;  // the finished simulation
+  Data::JobGeneration simulation_generation;
+  QElapsedTimer simulation_time;
+
+  QSpinBox* widget_events;
+  QDoubleSpinBox* widget_brightness;
+  QDoubleSpinBox* widget_background;
+  QDoubleSpinBox* widget_noise;
+  QSpinBox* widget_seed;
+  QPushButton* widget_start;
+  QPushButton* widget_cancel;
+  QPushButton* widget_export;
+  QProgressBar* widget_progress;
+  QLabel* widget_summary;
+  QTableWidget* widget_table;
+
+  void setRunning(bool running);
+  void buildTable();
+  void finishSimulation(std::shared_ptr<Data::SpreadingSimulation> simulation);
+
+ private slots:
+  void receiveStart(bool checked);
+  void receiveCancel(bool checked);
+  void receiveExport(bool checked);
+
+ public slots:
+  void receiveSpillover(const Data::SpilloverMatrix& matrix);
+};
+
+}  // namespace Spreading
+
+#endif  // SPREADING_WINDOW_H
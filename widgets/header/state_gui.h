@@ -26,6 +26,9 @@
 /**** DOC ******************************************************************
 ** Stores the current GUI state (except for the spectra -> see cache)
 **
+** :class: State::FilterLabel
+** The label (assigned fluorophore) of a filter
+**
 ** :class: State::GraphState
 ** GUI graph state
 **
@@ -37,6 +40,8 @@
 #ifndef STATE_GUI_H
 #define STATE_GUI_H
 
+#include <QColor>
+#include <QString>
 #include <vector>
 
 #include "data_instruments.h"
@@ -44,6 +49,11 @@
 
 namespace State {
 
+struct FilterLabel {
+  QString text;  // empty if no fluorophore is assigned
+  QColor color;
+};
+
 class GraphState {
  public:
   GraphState();
@@ -58,6 +68,7 @@ class GraphState {
  private:
   std::vector<Data::Laser> graph_lasers;
   const Data::LaserLine* graph_laserline;
+  std::vector<FilterLabel> graph_filter_labels;
   bool selected;
   bool visible_lasers;
   bool visible_filters;
@@ -77,6 +88,9 @@ class GraphState {
 
   const Data::LaserLine* laserLine() const;
   void setLaserLine(const Data::LaserLine* laserline);
+
+  const std::vector<FilterLabel>& filterLabels() const;
+  std::vector<FilterLabel>& setFilterLabels();
 };
 
 class GUI {
@@ -36,14 +36,27 @@
 #define STATE_PROGRAM_H
 
 #include <QObject>
+#include <QPointer>
+#include <memory>
+#include <vector>
 
 #include "cache.h"
+#include "catalogue_window.h"
+#include "compensation_window.h"
+#include "data_assignment.h"
 #include "data_factory.h"
 #include "data_fluorophores.h"
 #include "data_instruments.h"
+#include "data_jobs.h"
+#include "data_signature.h"
+#include "data_spillover.h"
 #include "data_styles.h"
 #include "global.h"
 #include "main_controller.h"
+#include "panel_window.h"
+#include "similarity_window.h"
+#include "spillover_window.h"
+#include "spreading_window.h"
 #include "state_gui.h"
 
 namespace State {
@@ -57,7 +70,7 @@ class Program : public QObject {
   Program& operator=(const Program&) = delete;
   Program(Program&&) = delete;
   Program& operator=(Program&&) = delete;
-  ~Program() = default;
+  ~Program();
 
  private:
   Data::Factory& factory;
@@ -65,14 +78,39 @@ class Program : public QObject {
   Data::InstrumentReader data_instruments;
   Data::StyleBuilder style;
   Data::Instrument instrument;
+  Data::SpilloverMatrix spillover;
+  Data::SignatureMatrix signature;
+  Data::AssignmentSolver assignment;
 
   Cache::Cache cache;
   State::GUI state_gui;
   Main::Controller gui;
+  QPointer<Spillover::Window> window_spillover;
+  QPointer<Panel::Window> window_panel;
+  QPointer<Similarity::Window> window_similarity;
+  QPointer<Spreading::Window> window_spreading;
+  QPointer<Compensation::Window> window_compensation;
+  QPointer<Catalogue::Window> window_catalogue;
+
+  bool loaded_instruments;
+
+  // The events of the density overlay, shared (not copied) with the graphs
+  std::shared_ptr<const std::vector<float>> events_x;
+  std::shared_ptr<const std::vector<float>> events_y;
+  Data::JobGeneration events_generation;
+
+  // The loading jobs, last member so they are joined before the rest of the program is destroyed
+  Data::JobGroup jobs;
+
+  void loadData();
+  void finishFluorophores(Data::FluorophoreReader& fluorophores);
+  void finishInstruments(Data::InstrumentReader& instruments);
+  void finishStyle(Data::StyleBuilder& style);
 
   void retreiveGUIState();
   void retreiveGUIPosition();
   void retreiveInstrument();
+  void retreiveLoadMode();
 
   void storeStateGUI();
 
@@ -85,9 +123,16 @@ class Program : public QObject {
   void syncStyle();
   void syncStyles();
   void syncOptions();
+  void syncSpillover();
+  void syncLasers();
+  bool updateLasers(const std::vector<const Data::Spectrum*>& spectra);
+  void syncAssignment();
+  void syncEvents();
+  bool labelGraphs();
 
   void loadInstrument(const QString& instrument_id);
   void loadStyle(const QString& style_id);
+  void loadEvents(const QString& path, std::size_t x, std::size_t y);
   void refreshToolbar();
 
  signals:
@@ -103,6 +148,10 @@ class Program : public QObject {
   void sendCacheUpdate();
 
   void sendGraphState(std::vector<State::GraphState>& state);
+  void sendEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y);
+
+  void sendSpillover(const Data::SpilloverMatrix& spillover);
+  void sendSignature(const Data::SignatureMatrix& signature);
 
  public slots:
   void receiveMenuBarState(Main::MenuBarAction action, const QVariant& id);
@@ -115,6 +164,8 @@ class Program : public QObject {
   void receiveCacheRequestSync();
   void receiveCacheRequestUpdate();
 
+  void receivePanel(std::vector<Data::FluorophoreID>& fluorophores);
+
   void receiveGraphSelect(std::size_t index, bool state);
 
  private slots:
@@ -10,6 +10,8 @@
 
 #include <QDebug>
 
+#include "data_trace.h"
+
 namespace Cache {
 
 /*
@@ -215,6 +217,7 @@ Slot: receives fluorophores additions from the GUI. Adds the fluorophores ID to
 the items & data attributes :param fluorophores: fluorophores to add
 */
 void Cache::add(std::vector<Data::FluorophoreID>& fluorophores) {
+  DATA_TRACE_SCOPE("Cache::add");
   // Taking for granted that std::size_t is much bigger then unsigned int, but
   // so be it, highly unlikely that you ever add more then INT_MAX options in
   // one go
@@ -232,6 +235,7 @@ void Cache::add(std::vector<Data::FluorophoreID>& fluorophores) {
       // If unsuccesfull, the entree already exists, no update needed
     }
   }
+  DATA_TRACE_COUNTER("Cache::items", this->items.size());
 
   // this->printState();
 }
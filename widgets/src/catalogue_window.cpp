@@ -0,0 +1,289 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+
+#include "catalogue_window.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFileDialog>
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QTableWidgetItem>
+#include <map>
+
+#include "data_jobs.h"
+
+namespace Catalogue {
+
+namespace {
+
+/*
+The files matched to a single instrument
+*/
+struct InstrumentFiles {
+  std::size_t count;
+  QStringList cytometers;
+};
+
+}  // namespace
+
+/*
+Constructor: constructs the catalogue window and loads the stored catalogue
+  :param parent: parent widget
+*/
+Window::Window(QWidget* parent)
+    : General::StyledWidget(parent),
+      instruments(nullptr),
+      catalogue(std::make_shared<Data::FCSCatalogue>()),
+      catalogue_generation(),
+      catalogue_running(false),
+      catalogue_elapsed(),
+      widget_folder(nullptr),
+      widget_browse(nullptr),
+      widget_scan(nullptr),
+      widget_cancel(nullptr),
+      widget_progress(nullptr),
+      widget_summary(nullptr),
+      widget_table(nullptr) {
+  this->setWindowTitle("FCS Catalogue");
+  this->setAttribute(Qt::WA_DeleteOnClose);
+
+  // Set base properties
+  this->setContentsMargins(8, 8, 8, 8);
+
+  // Build layout
+  QGridLayout* controller_layout = new QGridLayout(this);
+  controller_layout->setColumnStretch(0, 0);
+  controller_layout->setColumnStretch(1, 1);
+  controller_layout->setColumnStretch(2, 0);
+  controller_layout->setRowStretch(3, 1);
+  controller_layout->setContentsMargins(0, 0, 0, 0);
+  controller_layout->setSpacing(6);
+
+  this->widget_folder = new QLineEdit(this);
+  this->widget_folder->setPlaceholderText("Folder with FCS files");
+
+  this->widget_browse = new QPushButton("Browse...", this);
+  QObject::connect(this->widget_browse, &QPushButton::clicked, this, &Catalogue::Window::receiveBrowse);
+
+  this->widget_scan = new QPushButton("Scan", this);
+  QObject::connect(this->widget_scan, &QPushButton::clicked, this, &Catalogue::Window::receiveScan);
+
+  this->widget_cancel = new QPushButton("Cancel", this);
+  QObject::connect(this->widget_cancel, &QPushButton::clicked, this, &Catalogue::Window::receiveCancel);
+
+  this->widget_progress = new QProgressBar(this);
+  this->widget_progress->setRange(0, 1000);
+  this->widget_progress->setValue(0);
+  this->widget_progress->setTextVisible(false);
+
+  this->widget_summary = new QLabel(this);
+
+  this->widget_table = new QTableWidget(this);
+  this->widget_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  this->widget_table->setSelectionMode(QAbstractItemView::NoSelection);
+  this->widget_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+  this->widget_table->horizontalHeader()->setStretchLastSection(true);
+
+  controller_layout->addWidget(this->widget_folder, 0, 0, 1, 2);
+  controller_layout->addWidget(this->widget_browse, 0, 2, 1, 1);
+  controller_layout->addWidget(this->widget_scan, 1, 0, 1, 1);
+  controller_layout->addWidget(this->widget_progress, 1, 1, 1, 1);
+  controller_layout->addWidget(this->widget_cancel, 1, 2, 1, 1);
+  controller_layout->addWidget(this->widget_summary, 2, 0, 1, 3);
+  controller_layout->addWidget(this->widget_table, 3, 0, 1, 3);
+
+  // The stored catalogue is valid without the instruments, the matches are stored with it
+  if (this->catalogue->load(Window::cataloguePath())) {
+    this->widget_folder->setText(QDir::toNativeSeparators(this->catalogue->folders().value(0)));
+    this->widget_summary->setText(QString("%1 files cataloged").arg(this->catalogue->entryCount()));
+  }
+
+  this->setRunning(false);
+  this->buildTable();
+}
+
+/*
+Destructor: cancels a running scan, the scan job cleans up after itself
+*/
+Window::~Window() { this->catalogue_generation.cancel(); }
+
+/*
+The path of the stored catalogue
+*/
+QString Window::cataloguePath() { return QDir(QCoreApplication::applicationDirPath()).filePath("data/catalogue.json"); }
+
+/*
+Whether a scan is running
+*/
+bool Window::isRunning() const { return this->catalogue_running; }
+
+/*
+Enables/disables the controls depending on the scan state
+  :param running: whether a scan is running
+*/
+void Window::setRunning(bool running) {
+  this->widget_folder->setEnabled(!running);
+  this->widget_browse->setEnabled(!running);
+  this->widget_scan->setEnabled(!running);
+  this->widget_cancel->setEnabled(running);
+}
+
+/*
+(Re)builds the table with the amount of files and the cytometers per matched instrument
+*/
+void Window::buildTable() {
+  this->widget_table->clear();
+  this->widget_table->setColumnCount(3);
+  this->widget_table->setHorizontalHeaderLabels({"Instrument", "Files", "Cytometers"});
+
+  std::map<QString, InstrumentFiles> matches;
+  std::size_t unreadable = 0;
+  for (std::size_t i = 0; i < this->catalogue->entryCount(); ++i) {
+    const Data::FCSCatalogue::Entry& entry = this->catalogue->entry(i);
+    if (!entry.valid) {
+      ++unreadable;
+      continue;
+    }
+
+    auto inserted = matches.emplace(entry.instrument, InstrumentFiles{0, QStringList()});
+    InstrumentFiles& files = inserted.first->second;
+    ++files.count;
+    if (!entry.cytometer.isEmpty() && !files.cytometers.contains(entry.cytometer)) {
+      files.cytometers.append(entry.cytometer);
+    }
+  }
+
+  this->widget_table->setRowCount(static_cast<int>(matches.size()) + (unreadable > 0 ? 1 : 0));
+
+  int row = 0;
+  for (const std::pair<const QString, InstrumentFiles>& match : matches) {
+    QString name = match.first.isEmpty() ? QString("No matching instrument") : match.first;
+    if (this->instruments && !match.first.isEmpty()) {
+      for (const Data::InstrumentID& instrument : this->instruments->getInstruments()) {
+        if (instrument.id == match.first) {
+          name = instrument.name;
+          break;
+        }
+      }
+    }
+
+    QTableWidgetItem* item_count = new QTableWidgetItem(QString::number(match.second.count));
+    item_count->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+
+    this->widget_table->setItem(row, 0, new QTableWidgetItem(name));
+    this->widget_table->setItem(row, 1, item_count);
+    this->widget_table->setItem(row, 2, new QTableWidgetItem(match.second.cytometers.join(", ")));
+    ++row;
+  }
+
+  if (unreadable > 0) {
+    QTableWidgetItem* item_count = new QTableWidgetItem(QString::number(unreadable));
+    item_count->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+
+    this->widget_table->setItem(row, 0, new QTableWidgetItem("Unreadable"));
+    this->widget_table->setItem(row, 1, item_count);
+    this->widget_table->setItem(row, 2, new QTableWidgetItem("-"));
+  }
+}
+
+/*
+Slot: receives the browse button click, asks for the folder to catalogue
+*/
+void Window::receiveBrowse(bool checked) {
+  Q_UNUSED(checked);
+
+  QString folder = QFileDialog::getExistingDirectory(this, "FCS Folder", this->widget_folder->text());
+  if (!folder.isEmpty()) {
+    this->widget_folder->setText(QDir::toNativeSeparators(folder));
+  }
+}
+
+/*
+Slot: receives the scan button click, starts the (incremental) scan in the background
+*/
+void Window::receiveScan(bool checked) {
+  Q_UNUSED(checked);
+
+  QString folder = QDir::fromNativeSeparators(this->widget_folder->text().trimmed());
+  if (folder.isEmpty() || !QDir(folder).exists()) {
+    this->widget_summary->setText("Select an existing folder to catalogue");
+    return;
+  }
+
+  // The catalogue is only touched in between scans
+  if (this->instruments) {
+    this->catalogue->setInstruments(*this->instruments);
+  }
+  this->catalogue->setFolders({folder});
+
+  this->widget_progress->setValue(0);
+  this->widget_summary->setText("Scanning...");
+  this->catalogue_running = true;
+  this->setRunning(true);
+
+  Data::JobToken token = this->catalogue_generation.next();
+  Data::JobReceiver receiver(this);
+
+  // The end of the scan is posted without the token, the catalogue can only be touched again once the scan has returned
+  this->catalogue_elapsed.start();
+  Data::JobSystem::instance().submit(
+      [this, receiver, token, catalogue = this->catalogue]() {
+        catalogue->scan(token, [this, receiver, token](double progress) {
+          receiver.post([this, progress]() { this->widget_progress->setValue(static_cast<int>(progress * 1000.0)); }, token);
+        });
+        receiver.post([this]() { this->finishScan(); });
+      },
+      Data::JobSystem::Normal);
+}
+
+/*
+Slot: receives the cancel button click, the scan stops at its next poll of the token
+*/
+void Window::receiveCancel(bool checked) {
+  Q_UNUSED(checked);
+  this->catalogue_generation.cancel();
+  this->widget_cancel->setEnabled(false);
+  this->widget_summary->setText("Cancelling...");
+}
+
+/*
+Receives the end of the (finished or cancelled) scan on the GUI thread
+*/
+void Window::finishScan() {
+  this->catalogue_running = false;
+  this->setRunning(false);
+
+  if (this->catalogue->isCancelled()) {
+    this->widget_summary->setText("Cancelled");
+    return;
+  }
+
+  this->catalogue->save(Window::cataloguePath());
+  this->buildTable();
+
+  this->widget_summary->setText(QString("%1 files - %2 read in %3 s")
+                                    .arg(this->catalogue->entryCount())
+                                    .arg(this->catalogue->scannedCount())
+                                    .arg(static_cast<double>(this->catalogue_elapsed.elapsed()) * 0.001, 0, 'f', 1));
+}
+
+/*
+Slot: receives the instruments to match the files to
+  :param instruments: the instrument reader, has to outlive this window
+*/
+void Window::receiveInstruments(const Data::InstrumentReader& instruments) {
+  this->instruments = &instruments;
+  if (!this->isRunning()) {
+    this->buildTable();
+  }
+}
+
+}  // namespace Catalogue
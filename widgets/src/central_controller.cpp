@@ -76,6 +76,7 @@ Controller::Controller(QWidget* parent) : QWidget(parent) {
   QObject::connect(this, &Central::Controller::sendCacheState, controller_graph, &Graph::ScrollController::receiveCacheState);
   QObject::connect(this, &Central::Controller::sendCacheUpdate, controller_graph, &Graph::ScrollController::receiveCacheUpdate);
   QObject::connect(this, &Central::Controller::sendGraphState, controller_graph, &Graph::ScrollController::receiveGraphState);
+  QObject::connect(this, &Central::Controller::sendEvents, controller_graph, &Graph::ScrollController::receiveEvents);
   QObject::connect(controller_graph, &Graph::ScrollController::sendCacheRequestUpdate, this,
                    &Central::Controller::receiveCacheRequestUpdate);
   QObject::connect(controller_graph, &Graph::ScrollController::sendGraphSelect, this, &Central::Controller::receiveGraphSelect);
@@ -202,4 +203,11 @@ Slot: receives and forwards Graph Set signal
 */
 void Controller::receiveGraphState(std::vector<State::GraphState>& state) { emit this->sendGraphState(state); }
 
+/*
+Slot: receives and forwards the events of the density overlay
+  :param x: the x parameter of the events, nullptr to remove the overlay
+  :param y: the y parameter of the events, nullptr for a histogram of x
+*/
+void Controller::receiveEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y) { emit this->sendEvents(std::move(x), std::move(y)); }
+
 }  // namespace Central
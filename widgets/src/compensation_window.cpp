@@ -0,0 +1,350 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "compensation_window.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileDialog>
+#include <QFont>
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QSaveFile>
+#include <QTableWidgetItem>
+#include <cmath>
+
+#include "data_jobs.h"
+
+namespace Compensation {
+
+/*
+Constructor: constructs the spillover from controls window
+  :param parent: parent widget
+*/
+Window::Window(QWidget* parent)
+    : General::StyledWidget(parent),
+      instrument(),
+      fluorophores(nullptr),
+      estimator(nullptr),
+      estimator_generation(),
+      widget_folder(nullptr),
+      widget_browse(nullptr),
+      widget_positive(nullptr),
+      widget_negative(nullptr),
+      widget_start(nullptr),
+      widget_cancel(nullptr),
+      widget_progress(nullptr),
+      widget_summary(nullptr),
+      widget_mode(nullptr),
+      widget_export(nullptr),
+      widget_table(nullptr) {
+  this->setWindowTitle("Spillover from Controls");
+  this->setAttribute(Qt::WA_DeleteOnClose);
+
+  // Set base properties
+  this->setContentsMargins(8, 8, 8, 8);
+
+  // Build layout
+  QGridLayout* controller_layout = new QGridLayout(this);
+  controller_layout->setColumnStretch(0, 0);
+  controller_layout->setColumnStretch(1, 1);
+  controller_layout->setColumnStretch(2, 0);
+  controller_layout->setColumnStretch(3, 1);
+  controller_layout->setRowStretch(5, 1);
+  controller_layout->setContentsMargins(0, 0, 0, 0);
+  controller_layout->setSpacing(6);
+
+  Data::SpilloverEstimator::Options options;
+
+  this->widget_folder = new QLineEdit(this);
+  this->widget_folder->setPlaceholderText("Folder with single stain controls");
+
+  this->widget_browse = new QPushButton("Browse...", this);
+  QObject::connect(this->widget_browse, &QPushButton::clicked, this, &Compensation::Window::receiveBrowse);
+
+  this->widget_positive = new QDoubleSpinBox(this);
+  this->widget_positive->setRange(0.5, 1.0);
+  this->widget_positive->setDecimals(3);
+  this->widget_positive->setSingleStep(0.01);
+  this->widget_positive->setValue(options.positive_quantile);
+
+  this->widget_negative = new QDoubleSpinBox(this);
+  this->widget_negative->setRange(0.0, 0.99);
+  this->widget_negative->setDecimals(3);
+  this->widget_negative->setSingleStep(0.01);
+  this->widget_negative->setValue(options.negative_quantile);
+
+  this->widget_start = new QPushButton("Start", this);
+  QObject::connect(this->widget_start, &QPushButton::clicked, this, &Compensation::Window::receiveStart);
+
+  this->widget_cancel = new QPushButton("Cancel", this);
+  QObject::connect(this->widget_cancel, &QPushButton::clicked, this, &Compensation::Window::receiveCancel);
+
+  this->widget_progress = new QProgressBar(this);
+  this->widget_progress->setRange(0, 1000);
+  this->widget_progress->setValue(0);
+  this->widget_progress->setTextVisible(false);
+
+  this->widget_summary = new QLabel(this);
+
+  this->widget_mode = new QComboBox(this);
+  this->widget_mode->addItem("Measured (%)", static_cast<int>(Data::SpilloverEstimator::Measured));
+  this->widget_mode->addItem("Predicted (%)", static_cast<int>(Data::SpilloverEstimator::Predicted));
+  this->widget_mode->addItem("Difference (%)", static_cast<int>(Data::SpilloverEstimator::Difference));
+  QObject::connect(this->widget_mode, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &Compensation::Window::receiveMode);
+
+  this->widget_export = new QPushButton("Export...", this);
+  QObject::connect(this->widget_export, &QPushButton::clicked, this, &Compensation::Window::receiveExport);
+
+  this->widget_table = new QTableWidget(this);
+  this->widget_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  this->widget_table->setSelectionMode(QAbstractItemView::NoSelection);
+  this->widget_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+  this->widget_table->verticalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+  controller_layout->addWidget(this->widget_folder, 0, 0, 1, 3);
+  controller_layout->addWidget(this->widget_browse, 0, 3, 1, 1);
+  controller_layout->addWidget(new QLabel("Positive quantile", this), 1, 0, 1, 1);
+  controller_layout->addWidget(this->widget_positive, 1, 1, 1, 1);
+  controller_layout->addWidget(new QLabel("Negative quantile", this), 1, 2, 1, 1);
+  controller_layout->addWidget(this->widget_negative, 1, 3, 1, 1);
+  controller_layout->addWidget(this->widget_start, 2, 0, 1, 1);
+  controller_layout->addWidget(this->widget_progress, 2, 1, 1, 2);
+  controller_layout->addWidget(this->widget_cancel, 2, 3, 1, 1);
+  controller_layout->addWidget(this->widget_summary, 3, 0, 1, 4);
+  controller_layout->addWidget(this->widget_mode, 4, 0, 1, 1);
+  controller_layout->addWidget(this->widget_export, 4, 3, 1, 1);
+  controller_layout->addWidget(this->widget_table, 5, 0, 1, 4);
+
+  this->setRunning(false);
+  this->widget_export->setEnabled(false);
+}
+
+/*
+Destructor: cancels a running estimation, the estimation job cleans up after itself
+*/
+Window::~Window() { this->estimator_generation.cancel(); }
+
+/*
+Enables/disables the controls depending on the estimation state
+  :param running: whether an estimation is running
+*/
+void Window::setRunning(bool running) {
+  this->widget_folder->setEnabled(!running);
+  this->widget_browse->setEnabled(!running);
+  this->widget_positive->setEnabled(!running);
+  this->widget_negative->setEnabled(!running);
+  this->widget_start->setEnabled(!running);
+  this->widget_cancel->setEnabled(running);
+  if (running) {
+    this->widget_export->setEnabled(false);
+  }
+}
+
+/*
+(Re)builds the table of the current mode from the finished estimator, the primary detector of every control is shown in bold
+*/
+void Window::buildTable() {
+  this->widget_table->clear();
+
+  if (!this->estimator || this->estimator->isCancelled()) {
+    this->widget_table->setRowCount(0);
+    this->widget_table->setColumnCount(0);
+    return;
+  }
+
+  const Data::SpilloverEstimator& estimator = *this->estimator;
+  this->widget_table->setRowCount(static_cast<int>(estimator.controlCount()));
+  this->widget_table->setColumnCount(static_cast<int>(estimator.detectorCount()));
+
+  QStringList header_columns;
+  for (std::size_t j = 0; j < estimator.detectorCount(); ++j) {
+    header_columns.append(estimator.detector(j).name);
+  }
+  this->widget_table->setHorizontalHeaderLabels(header_columns);
+
+  QStringList header_rows;
+  for (std::size_t i = 0; i < estimator.controlCount(); ++i) {
+    header_rows.append(estimator.control(i).name);
+  }
+  this->widget_table->setVerticalHeaderLabels(header_rows);
+
+  QFont font_primary = this->widget_table->font();
+  font_primary.setBold(true);
+
+  Data::SpilloverEstimator::Mode mode = static_cast<Data::SpilloverEstimator::Mode>(this->widget_mode->currentData().toInt());
+
+  for (std::size_t i = 0; i < estimator.controlCount(); ++i) {
+    std::size_t primary = estimator.control(i).primary;
+    for (std::size_t j = 0; j < estimator.detectorCount(); ++j) {
+      double value = estimator.value(mode, i, j);
+
+      QTableWidgetItem* item = new QTableWidgetItem(std::isnan(value) ? QString("-") : QString::number(value * 100.0, 'f', 1));
+      item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      if (j == primary) {
+        item->setFont(font_primary);
+      }
+
+      this->widget_table->setItem(static_cast<int>(i), static_cast<int>(j), item);
+    }
+  }
+}
+
+/*
+Slot: receives the browse button click, asks for the folder of controls
+*/
+void Window::receiveBrowse(bool checked) {
+  Q_UNUSED(checked);
+
+  QString folder = QFileDialog::getExistingDirectory(this, "Single Stain Controls", this->widget_folder->text());
+  if (!folder.isEmpty()) {
+    this->widget_folder->setText(QDir::toNativeSeparators(folder));
+  }
+}
+
+/*
+Slot: receives the start button click, collects the controls and starts the estimation in the background
+*/
+void Window::receiveStart(bool checked) {
+  Q_UNUSED(checked);
+
+  if (!this->fluorophores || this->instrument.isEmpty()) {
+    this->widget_summary->setText("Select the instrument the controls were acquired on");
+    return;
+  }
+
+  Data::SpilloverEstimator::Options options;
+  options.positive_quantile = this->widget_positive->value();
+  options.negative_quantile = this->widget_negative->value();
+
+  // The library is used to predict the spillover of the controls, the copy shares the spectrum data and is decoded by the job
+  std::shared_ptr<const Data::FluorophoreReader> library = std::make_shared<const Data::FluorophoreReader>(*this->fluorophores);
+
+  std::shared_ptr<Data::SpilloverEstimator> estimator = std::make_shared<Data::SpilloverEstimator>();
+  estimator->setInstrument(this->instrument);
+  estimator->setOptions(options);
+
+  // The window only holds finished estimations
+  this->estimator.reset();
+  this->buildTable();
+  if (estimator->setFolder(QDir::fromNativeSeparators(this->widget_folder->text())) == 0) {
+    this->widget_summary->setText("No .fcs files in the folder");
+    return;
+  }
+
+  this->widget_progress->setValue(0);
+  this->widget_summary->setText("Estimating...");
+  this->setRunning(true);
+
+  Data::JobToken token = this->estimator_generation.next();
+  Data::JobReceiver receiver(this);
+
+  Data::JobSystem::instance().submit(
+      [this, receiver, token, estimator, library]() {
+        std::vector<Data::Spectrum> spectra;
+        QStringList names;
+        library->getLibrary(spectra, names, token);
+        if (token.isCancelled()) {
+          return;
+        }
+        estimator->setLibrary(std::move(spectra), std::move(names));
+
+        estimator->run(token, [this, receiver, token](double progress) {
+          receiver.post([this, progress]() { this->widget_progress->setValue(static_cast<int>(progress * 1000.0)); }, token);
+        });
+        receiver.post([this, estimator]() { this->finishEstimation(estimator); }, token);
+      },
+      Data::JobSystem::Normal, token);
+}
+
+/*
+Receives the finished estimation on the GUI thread
+  :param estimator: the finished estimator
+*/
+void Window::finishEstimation(std::shared_ptr<Data::SpilloverEstimator> estimator) {
+  this->estimator = std::move(estimator);
+  this->setRunning(false);
+  this->buildTable();
+
+  if (this->estimator->isCancelled()) {
+    this->widget_summary->setText("Cancelled");
+    return;
+  }
+
+  std::size_t estimated = 0;
+  std::size_t predicted = 0;
+  for (std::size_t i = 0; i < this->estimator->controlCount(); ++i) {
+    estimated += this->estimator->control(i).primary != Data::SpilloverEstimator::none ? 1 : 0;
+    predicted += this->estimator->isPredicted(i) ? 1 : 0;
+  }
+  this->widget_summary->setText(QString("%1 of %2 controls estimated - %3 matched to the library")
+                                    .arg(estimated)
+                                    .arg(this->estimator->controlCount())
+                                    .arg(predicted));
+  this->widget_export->setEnabled(estimated > 0);
+}
+
+/*
+Slot: receives the cancel button click, the estimation job is dropped or stops at its next poll of the token
+*/
+void Window::receiveCancel(bool checked) {
+  Q_UNUSED(checked);
+  this->estimator_generation.cancel();
+  this->setRunning(false);
+  this->widget_progress->setValue(0);
+  this->widget_summary->setText("Cancelled");
+}
+
+/*
+Slot: receives the mode combobox changes
+  :param index: the combobox index
+*/
+void Window::receiveMode(int index) {
+  Q_UNUSED(index);
+  this->buildTable();
+}
+
+/*
+Slot: receives the export button click, exports the current matrix as .csv
+*/
+void Window::receiveExport(bool checked) {
+  Q_UNUSED(checked);
+  if (!this->estimator || this->estimator->isCancelled()) {
+    return;
+  }
+
+  QString path = QFileDialog::getSaveFileName(this, "Export Spillover Matrix", QString(), "Comma Separated Values (*.csv)");
+  if (path.isEmpty()) {
+    return;
+  }
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    qWarning() << "Compensation::Window::receiveExport: cannot open" << path;
+    return;
+  }
+  Data::SpilloverEstimator::Mode mode = static_cast<Data::SpilloverEstimator::Mode>(this->widget_mode->currentData().toInt());
+  file.write(this->estimator->toCSV(mode).toUtf8());
+  if (!file.commit()) {
+    qWarning() << "Compensation::Window::receiveExport: cannot write" << path;
+  }
+}
+
+/*
+Slot: receives the instrument the controls were acquired on
+  :param instrument: the instrument
+*/
+void Window::receiveInstrument(const Data::Instrument& instrument) { this->instrument = instrument; }
+
+/*
+Slot: receives the fluorophore library
+  :param fluorophores: the fluorophore reader, has to outlive this window
+*/
+void Window::receiveFluorophores(const Data::FluorophoreReader& fluorophores) { this->fluorophores = &fluorophores; }
+
+}  // namespace Compensation
@@ -62,6 +62,9 @@ LineEdit::LineEdit(QWidget* parent)
 
   // Text editing connections
   QObject::connect(this, &Fluor::LineEdit::textEdited, this, &Fluor::LineEdit::updateTextEdited);
+
+  // Enabled once the fluorophores are loaded
+  this->setEnabled(false);
 }
 
 /*
@@ -750,6 +753,8 @@ void LineEdit::reloadData(const Data::FluorophoreReader& data) {
   this->lookup_names = data.getFluorNames();
 
   static_cast<Fluor::Completer*>(this->completer())->buildModel(data.getFluorName());
+
+  this->setEnabled(data.isValid());
 }
 
 /*
@@ -14,6 +14,8 @@
 #include <QLabel>
 #include <QPixmap>
 
+#include "data_trace.h"
+
 namespace General {
 
 const int CustomItemTypeRole(Qt::UserRole + 1000);
@@ -269,6 +271,7 @@ void Separator::setSeparatorWidth(int width) { this->pen.setWidth(width); }
 int Separator::separatorWidth() const { return this->pen.width(); }
 
 void Separator::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const {
+  DATA_TRACE_SCOPE("Separator::paint");
   Q_UNUSED(index);
 
   painter->fillRect(option.rect, option.backgroundBrush);
@@ -328,6 +331,7 @@ Reimplement the paint function to properly paint SeparatorItem's
   :param index: the index of the item to draw
 */
 void CustomDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const {
+  DATA_TRACE_SCOPE("CustomDelegate::paint");
   // Get pointer to object
   if (index.data(CustomItemTypeRole).canConvert<int>()) {
     int custom_item_type = qvariant_cast<int>(index.data(CustomItemTypeRole));
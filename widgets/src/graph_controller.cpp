@@ -49,6 +49,7 @@ Controller::Controller(QWidget* parent) : QWidget(parent), graphics_scene(nullpt
   QObject::connect(this, &Graph::Controller::sendCacheState, this->graphics_scene, &Graph::GraphicsScene::syncSpectra);
   QObject::connect(this, &Graph::Controller::sendCacheUpdate, this->graphics_scene, &Graph::GraphicsScene::updateSpectra);
   QObject::connect(this, &Graph::Controller::sendGraphState, this->graphics_scene, &Graph::GraphicsScene::syncGraphState);
+  QObject::connect(this, &Graph::Controller::sendEvents, this->graphics_scene, &Graph::GraphicsScene::syncDensity);
 
   QObject::connect(this->graphics_scene, &Graph::GraphicsScene::spectrumSelected, this, &Graph::Controller::sendCacheRequestUpdate);
   QObject::connect(this->graphics_scene, &Graph::GraphicsScene::plotSelected, this, &Graph::Controller::receivePlotSelected);
@@ -101,6 +102,13 @@ Slot: receives a graph state change event
 */
 void Controller::receiveGraphState(const State::GraphState& state) { emit this->sendGraphState(state); }
 
+/*
+Slot: receives the events of the density overlay
+  :param x: the x parameter of the events, nullptr to remove the overlay
+  :param y: the y parameter of the events, nullptr for a histogram of x
+*/
+void Controller::receiveEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y) { emit this->sendEvents(std::move(x), std::move(y)); }
+
 /*
 Slot: receives Graph::Format::Style changes
 */
@@ -218,6 +226,7 @@ void ScrollController::addGraph() {
   QObject::connect(this, &Graph::ScrollController::sendGlobalEvent, graph, &Graph::Controller::receiveGlobalEvent);
   QObject::connect(this, &Graph::ScrollController::sendCacheState, graph, &Graph::Controller::receiveCacheState);
   QObject::connect(this, &Graph::ScrollController::sendCacheUpdate, graph, &Graph::Controller::receiveCacheUpdate);
+  QObject::connect(this, &Graph::ScrollController::sendEvents, graph, &Graph::Controller::receiveEvents);
   QObject::connect(graph, &Graph::Controller::sendCacheRequestUpdate, this, &Graph::ScrollController::receiveCacheRequestUpdate);
   QObject::connect(graph, &Graph::Controller::sendGraphSelect, this, &Graph::ScrollController::receiveGraphSelect);
 
@@ -326,4 +335,11 @@ void ScrollController::receiveGraphSelect(const Controller* graph, bool state) {
   }
 }
 
+/*
+Slot: receives the events of the density overlay and forwards them to all graphs
+  :param x: the x parameter of the events, nullptr to remove the overlay
+  :param y: the y parameter of the events, nullptr for a histogram of x
+*/
+void ScrollController::receiveEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y) { emit this->sendEvents(std::move(x), std::move(y)); }
+
 }  // namespace Graph
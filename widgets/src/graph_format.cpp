@@ -636,7 +636,7 @@ x and y values of the plot
 const QRectF& PlotRectF::global() const { return this->rect_global; }
 
 /*
-Sets a new local rectangle. This forces recalculation of the toLocal/toGlobal functions
+Sets a new local rectangle. This forces recalculation of the transformation
   :param rect: the new local rectangle
 */
 void PlotRectF::setLocal(const QRectF& rect) {
@@ -646,7 +646,7 @@ void PlotRectF::setLocal(const QRectF& rect) {
 }
 
 /*
-Sets a new global rectangle. This forces recalculation of the toLocal/toGlobal functions
+Sets a new global rectangle. This forces recalculation of the transformation
   :param rect: the new global rectangle
 */
 void PlotRectF::setSettings(const QRectF& rect) {
@@ -665,15 +665,6 @@ double PlotRectF::toLocalX(double global) const {
   return global;
 }
 
-/*
-Transform the local X value into the global equivalent
-*/
-double PlotRectF::toGlobalX(double local) const {
-  local -= this->x_intercept;
-  local *= this->x_slope_local_to_global;
-  return local;
-}
-
 /*
 Transforms the global Y value into the local equivalent
   :param global: the global Y value (0-100)
@@ -687,78 +678,10 @@ double PlotRectF::toLocalY(double global, double intensity) const {
 }
 
 /*
-Transform the local Y value into the global equivalent
-  :param global: the local Y value (0-100)
-  :param intensity: the intensity scaling (0.0-1.0)
-*/
-double PlotRectF::toGlobalY(double local, double intensity) const {
-  local -= this->y_intercept;
-  local *= this->y_slope_local_to_global;
-  local /= intensity;
-  return local;
-}
-
-/*
-Returns the function that transforms the global X value into the local X value
-*/
-std::function<double(double)> PlotRectF::toLocalXFunction() const {
-  double slope = this->x_slope_global_to_local;
-  double intercept = this->x_intercept;
-
-  auto lambda = [slope, intercept](double global) {
-    global *= slope;
-    global += intercept;
-    return global;
-  };
-
-  return lambda;
-}
-
-/*
-Returns the function that transforms the local X value into the global X value
-*/
-std::function<double(double)> PlotRectF::toGlobalXFunction() const {
-  double slope = this->x_slope_local_to_global;
-  double intercept = this->x_intercept;
-
-  std::function<double(double)> functor = [slope, intercept](double local) {
-    local *= slope;
-    local += intercept;
-    return local;
-  };
-  return functor;
-}
-
-/*
-Returns the function that transforms the global Y value into the local Y value
+Returns the affine transform from global into local coordinates, intensity scaling of y is not included
 */
-std::function<double(double, double)> PlotRectF::toLocalYFunction() const {
-  double slope = this->y_slope_global_to_local;
-  double intercept = this->y_intercept;
-
-  std::function<double(double, double)> functor = [slope, intercept](double global, double intensity) {
-    global *= intensity;
-    global *= slope;
-    global += intercept;
-    return global;
-  };
-  return functor;
-}
-
-/*
-Returns the function that transforms the local Y value into the global Y value
-*/
-std::function<double(double, double)> PlotRectF::toGlobalYFunction() const {
-  double slope = this->y_slope_global_to_local;
-  double intercept = this->y_intercept;
-
-  std::function<double(double, double)> functor = [slope, intercept](double local, double intensity) {
-    local -= intercept;
-    local *= slope;
-    local /= intensity;
-    return local;
-  };
-  return functor;
+QTransform PlotRectF::toLocalTransform() const {
+  return QTransform(this->x_slope_global_to_local, 0.0, 0.0, this->y_slope_global_to_local, this->x_intercept, this->y_intercept);
 }
 
 /*
@@ -8,12 +8,21 @@
 
 #include "graph_graphicsitems.h"
 
+#include <QApplication>
 #include <QBrush>
 #include <QDebug>
 #include <QFont>
 #include <QFontMetrics>
+#include <QFontMetricsF>
 #include <QLinearGradient>
 #include <QPointF>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <unordered_map>
+
+#include "data_trace.h"
 
 namespace Graph {
 
@@ -25,7 +34,10 @@ Constructor: abstract class for axis title text labels. Make sure to call calcul
   :param parent: parent
 */
 AbstractLabel::AbstractLabel(const QString& text, QGraphicsItem* parent)
-    : QGraphicsSimpleTextItem(text, parent), item_margins(0, 0, 0, 0), minimum_width(0), minimum_height(0) {}
+    : QGraphicsSimpleTextItem(text, parent), item_margins(0, 0, 0, 0), minimum_width(0), minimum_height(0) {
+  // Static content, only rerendered upon text/style changes
+  this->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+}
 
 /*
 Sets margins of the item
@@ -176,7 +188,10 @@ Constructor: a simple line graphicsitem
   :param location: location in 'real' value (x: nanometers/y: percentage)
   :param parent: parent
 */
-GridLine::GridLine(double location, QGraphicsItem* parent) : QGraphicsLineItem(parent), line_location(location) {}
+GridLine::GridLine(double location, QGraphicsItem* parent) : QGraphicsLineItem(parent), line_location(location) {
+  // Static content, only rerendered upon size/style changes
+  this->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+}
 
 /*
 Set location attribute
@@ -220,6 +235,7 @@ Container class - doesnt have its own content, so no painting necessary
   :param widget: (optional) if provided, paints to the widget being painted on
 */
 void AbstractGridLines::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+  DATA_TRACE_SCOPE("AbstractGridLines::paint");
   Q_UNUSED(painter);
   Q_UNUSED(option);
   Q_UNUSED(widget);
@@ -689,6 +705,8 @@ Constructor: construct a label for a specific axis grid/tick location
   :param parent: parent
 */
 GridLabel::GridLabel(double location, QString label, QGraphicsItem* parent) : QGraphicsSimpleTextItem(parent), label_location(location) {
+  // Static content, only rerendered upon text/style changes
+  this->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
   this->setText(label);
 }
 
@@ -736,6 +754,7 @@ Container class, doesnt contain its own object to paint.
   :param widget: (optional) if provided, paints to the widget being painted on
 */
 void AbstractGridLabels::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+  DATA_TRACE_SCOPE("AbstractGridLabels::paint");
   Q_UNUSED(painter);
   Q_UNUSED(option);
   Q_UNUSED(widget);
@@ -1302,6 +1321,9 @@ Colorbar::Colorbar(QGraphicsItem* parent)
   this->gradient.setColorAt(1.0, QColor(0, 0, 0));
 
   this->setBrush(QBrush(this->gradient));
+
+  // The gradient is costly to paint, only rerender upon size/style/border changes
+  this->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
 }
 
 /*
@@ -1437,6 +1459,188 @@ bool Colorbar::isSelected() const { return this->is_selected; }
 
 /* ############################################################################################################## */
 
+/*
+Constructor: builds an empty geometry, use SpectrumGeometry::get() to obtain a scaled geometry
+*/
+SpectrumGeometry::SpectrumGeometry()
+    : geometry_excitation(), geometry_emission(), geometry_emission_fill(), geometry_bounds(0.0, 0.0, 0.0, 0.0) {}
+
+namespace {
+
+/*
+Identifies a scaled geometry. The CacheSpectrum address is only unique while it lives, the id guards against address reuse.
+*/
+struct GeometryKey {
+  const Data::CacheSpectrum* source;
+  QString id;
+  QRectF local;
+  QRectF global;
+  double intensity;
+  double width_excitation;
+  double width_emission;
+  double ratio;
+
+  bool operator==(const GeometryKey& other) const {
+    return this->source == other.source && this->id == other.id && this->local == other.local && this->global == other.global &&
+           this->intensity == other.intensity && this->width_excitation == other.width_excitation &&
+           this->width_emission == other.width_emission && this->ratio == other.ratio;
+  }
+};
+
+struct GeometryKeyHash {
+  std::size_t operator()(const GeometryKey& key) const {
+    std::hash<double> hash;
+    std::size_t seed = std::hash<const void*>()(key.source);
+    for (double value : {key.local.x(), key.local.y(), key.local.width(), key.local.height(), key.global.x(), key.global.y(),
+                         key.global.width(), key.global.height(), key.intensity, key.width_excitation, key.width_emission, key.ratio}) {
+      seed ^= hash(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+  }
+};
+
+/*
+The geometries in use, shared by all graphs. Only accessed from the GUI thread. An entry expires once no Spectrum uses it.
+*/
+std::unordered_map<GeometryKey, std::weak_ptr<const SpectrumGeometry>, GeometryKeyHash>& geometryCache() {
+  static std::unordered_map<GeometryKey, std::weak_ptr<const SpectrumGeometry>, GeometryKeyHash> cache;
+  return cache;
+}
+
+}  // namespace
+
+/*
+Scales the source curves into the plotting region
+  :param source: the source spectrum
+  :param space: the plotting region
+  :param intensity: the emission intensity coefficient
+  :param width_excitation: the excitation pen width, the curve is kept within the region including the line width
+  :param width_emission: the emission pen width
+  :param ratio: the device pixel ratio, the curves are decimated to the device pixel columns
+*/
+void SpectrumGeometry::scale(const Data::CacheSpectrum& source, const PlotRectF& space, double intensity, double width_excitation,
+                             double width_emission, double ratio) {
+  // Correct plotting space for line width
+  QRectF plot_space = space.local();
+  double pen_adjust = width_excitation * 0.5;
+  plot_space.adjust(pen_adjust, pen_adjust, -pen_adjust, -pen_adjust);
+
+  // Scale excitation first
+  this->geometry_excitation = source.spectrum().excitation();
+  this->geometry_excitation.scale(source.spectrum().excitation(), plot_space, space.toLocalTransform(), 1.0);
+  this->geometry_excitation.decimate(space.local().left(), 1.0 / ratio);
+
+  // Correct plotting space for line width
+  plot_space = space.local();
+  pen_adjust = width_emission * 0.5;
+  plot_space.adjust(pen_adjust, pen_adjust, -pen_adjust, -pen_adjust);
+  // Scale emission second
+  this->geometry_emission = source.spectrum().emission();
+  this->geometry_emission.scale(source.spectrum().emission(), plot_space, space.toLocalTransform(), intensity);
+  this->geometry_emission.decimate(space.local().left(), 1.0 / ratio);
+
+  // Copy and close emission data into fill
+  this->geometry_emission_fill = source.spectrum().emission();
+  this->geometry_emission_fill.copyCurve(this->geometry_emission);
+  this->geometry_emission_fill.closeCurve(space.local());
+
+  // Bounding box for efficient drawing and contain look-up
+  // Get outer x-axis bounds of the two spectra
+  // For y assume full plot height, no non-iterative way to find the highest point.
+  const QPolygonF& excitation = this->geometry_excitation.polygon();
+  const QPolygonF& emission = this->geometry_emission.polygon();
+  qreal left;
+  qreal right;
+  if (excitation.empty()) {
+    if (!emission.empty()) {
+      left = emission.first().x();
+      right = emission.last().x();
+    } else {
+      left = 0;
+      right = 0;
+    }
+  } else if (emission.empty()) {
+    left = excitation.first().x();
+    right = excitation.last().x();
+  } else {
+    left = std::min(excitation.first().x(), emission.first().x());
+    right = std::max(excitation.last().x(), emission.last().x());
+  }
+
+  this->geometry_bounds = QRectF(QPointF(left, space.local().top()), QPointF(right, space.local().bottom()));
+}
+
+/*
+Getter for the shared empty geometry
+*/
+std::shared_ptr<const SpectrumGeometry> SpectrumGeometry::empty() {
+  static const std::shared_ptr<const SpectrumGeometry> geometry = std::make_shared<SpectrumGeometry>();
+  return geometry;
+}
+
+/*
+Getter for the scaled geometry of a spectrum. Graphs with an identical plotting region share the geometry,
+it is only scaled if no graph uses it yet. Must be called from the GUI thread.
+  :param source: the source spectrum
+  :param space: the plotting region
+  :param intensity: the emission intensity coefficient
+  :param width_excitation: the excitation pen width
+  :param width_emission: the emission pen width
+  :returns: the (shared) geometry
+*/
+std::shared_ptr<const SpectrumGeometry> SpectrumGeometry::get(const Data::CacheSpectrum& source, const PlotRectF& space, double intensity,
+                                                              double width_excitation, double width_emission) {
+  std::unordered_map<GeometryKey, std::weak_ptr<const SpectrumGeometry>, GeometryKeyHash>& cache = geometryCache();
+
+  // A curve stays visually identical down to one point per device pixel column, use the highest ratio of all screens
+  double ratio = std::max(1.0, qApp->devicePixelRatio());
+
+  GeometryKey key{&source, source.id(), space.local(), space.global(), intensity, width_excitation, width_emission, ratio};
+  auto found = cache.find(key);
+  if (found != cache.end()) {
+    std::shared_ptr<const SpectrumGeometry> geometry = found->second.lock();
+    if (geometry) {
+      return geometry;
+    }
+  }
+
+  // Remove the expired entries whenever the cache doubled in size, amortized over the insertions
+  static std::size_t sweep_size = 64;
+  if (cache.size() >= sweep_size) {
+    for (auto it = cache.begin(); it != cache.end();) {
+      it = it->second.expired() ? cache.erase(it) : std::next(it);
+    }
+    sweep_size = std::max<std::size_t>(64, cache.size() * 2);
+  }
+
+  std::shared_ptr<SpectrumGeometry> geometry = std::make_shared<SpectrumGeometry>();
+  geometry->scale(source, space, intensity, width_excitation, width_emission, ratio);
+  cache[key] = geometry;
+  return geometry;
+}
+
+/*
+Getter for the scaled excitation curve
+*/
+const Data::Polygon& SpectrumGeometry::excitation() const { return this->geometry_excitation; }
+
+/*
+Getter for the scaled emission curve
+*/
+const Data::Polygon& SpectrumGeometry::emission() const { return this->geometry_emission; }
+
+/*
+Getter for the scaled and closed emission curve
+*/
+const Data::Polygon& SpectrumGeometry::emissionFill() const { return this->geometry_emission_fill; }
+
+/*
+Getter for the bounding rectangle of the curves, spans the full plot height
+*/
+const QRectF& SpectrumGeometry::bounds() const { return this->geometry_bounds; }
+
+/* ############################################################################################################## */
+
 /*
 Constructor: builds a Spectrum - contains two QPolygonF curves. Handles all drawing of this curve
   :param data: source data, the curves uses this as base for most calculations
@@ -1445,9 +1649,7 @@ Constructor: builds a Spectrum - contains two QPolygonF curves. Handles all draw
 Spectrum::Spectrum(Data::CacheSpectrum& data, QGraphicsItem* parent)
     : QGraphicsItem(parent),
       spectrum_source(data),
-      spectrum_excitation(this->spectrum_source.spectrum().excitation()),
-      spectrum_emission(this->spectrum_source.spectrum().emission()),
-      spectrum_emission_fill(this->spectrum_source.spectrum().emission()),
+      spectrum_geometry(SpectrumGeometry::empty()),
       spectrum_space(0.0, 0.0, 0.0, 0.0),
       visible_excitation(true),
       visible_emission(true),
@@ -1481,6 +1683,7 @@ Paints the excitation and emission curve
   :param widget: (unused) if provided, points to the widget being painted on
 */
 void Spectrum::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+  DATA_TRACE_SCOPE("Spectrum::paint");
   Q_UNUSED(option);
   Q_UNUSED(widget);
   painter->save();
@@ -1493,7 +1696,7 @@ void Spectrum::paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
       painter->setPen(this->pen_excitation);
     }
     painter->setBrush(Qt::NoBrush);
-    painter->drawPolyline(this->spectrum_excitation.polygon());
+    painter->drawPolyline(this->spectrum_geometry->excitation().polygon());
   }
 
   if (this->visible_emission) {
@@ -1503,7 +1706,7 @@ void Spectrum::paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
       painter->setPen(this->pen_emission);
     }
     painter->setBrush(Qt::NoBrush);
-    painter->drawPolyline(this->spectrum_emission.polygon());
+    painter->drawPolyline(this->spectrum_geometry->emission().polygon());
 
     painter->setPen(Qt::NoPen);
     if (this->select_emission) {
@@ -1511,7 +1714,7 @@ void Spectrum::paint(QPainter* painter, const QStyleOptionGraphicsItem* option,
     } else {
       painter->setBrush(this->brush_emission);
     }
-    painter->drawPolygon(this->spectrum_emission_fill.polygon());
+    painter->drawPolygon(this->spectrum_geometry->emissionFill().polygon());
   }
 
   painter->restore();
@@ -1531,38 +1734,13 @@ bool Spectrum::contains(const QPointF& point) const {
 
   // Within bounding box, now determine if it is on or below the excitation/emission curves
   if (this->visible_excitation) {
-    if (this->spectrum_excitation.contains(this->mapFromScene(point), this->pen_excitation.widthF())) {
-      return true;
-    }
-  }
-
-  if (this->visible_emission) {
-    return this->spectrum_emission.contains(this->mapFromScene(point), this->pen_emission.widthF());
-  }
-
-  return false;
-}
-
-/*
-Function is called to determine if this Spectrum is underneath the cursor.
-  :param point: point to determine if it is contained in the object in scene coordinates.
-  :returns: true if the item contains point, otherwise false is returned
-*/
-bool Spectrum::contains(const PlotRectF& space, const QPointF& point) const {
-  // Quick check is it within the boundingRect?
-  if (!this->spectrum_space.contains(this->mapFromScene(point))) {
-    return false;
-  }
-
-  // Within bounding box, now determine if it is on or below the excitation/emission curves
-  if (this->visible_excitation) {
-    if (this->spectrum_excitation.contains(this->mapFromScene(point), this->pen_excitation.widthF(), space.toGlobalXFunction())) {
+    if (this->spectrum_geometry->excitation().contains(this->mapFromScene(point), this->pen_excitation.widthF())) {
       return true;
     }
   }
 
   if (this->visible_emission) {
-    return this->spectrum_emission.contains(this->mapFromScene(point), this->pen_emission.widthF(), space.toGlobalXFunction());
+    return this->spectrum_geometry->emission().contains(this->mapFromScene(point), this->pen_emission.widthF());
   }
 
   return false;
@@ -1570,71 +1748,35 @@ bool Spectrum::contains(const PlotRectF& space, const QPointF& point) const {
 
 /*
 Sets the location of the item within the space allocated, assumes enough space to adhere to minimumWidth and minimumHeight.
+The scaled curves are shared with all graphs of identical plotting region.
   :param space: the allocated space
 */
 void Spectrum::setPosition(const PlotRectF& space) {
-  // Correct plotting space for line width
-  QRectF plot_space = space.local();
-  double pen_adjust = this->pen_excitation.widthF() * 0.5;
-  plot_space.adjust(pen_adjust, pen_adjust, -pen_adjust, -pen_adjust);
-
-  // Scale excitation first
-  this->spectrum_excitation.scale(this->spectrum_source.spectrum().excitation(), plot_space, space.toLocalXFunction(),
-                                  space.toLocalYFunction(), 1.0);
-
-  // Correct plotting space for line width
-  plot_space = space.local();
-  pen_adjust = this->pen_emission.widthF() * 0.5;
-  plot_space.adjust(pen_adjust, pen_adjust, -pen_adjust, -pen_adjust);
-  // Scale emission second
-  this->spectrum_emission.scale(this->spectrum_source.spectrum().emission(), plot_space, space.toLocalXFunction(), space.toLocalYFunction(),
-                                this->intensity_coefficient);
+  this->spectrum_geometry = SpectrumGeometry::get(this->spectrum_source, space, this->intensity_coefficient, this->pen_excitation.widthF(),
+                                                  this->pen_emission.widthF());
 
-  // Copy and close emission data into fill
-  this->spectrum_emission_fill.copyCurve(this->spectrum_emission);
-  this->spectrum_emission_fill.closeCurve(space.local());
-
-  // Recalculate bounding box for efficient drawing and contain look-up
-  // Get outer x-axis bounds of the two spectra
-  // For y assume full plot height, no non-iterative way to find the highest point.
-  qreal left;
-  qreal right;
-  if (this->spectrum_excitation.polygon().empty()) {
-    if (!this->spectrum_emission.polygon().empty()) {
-      left = this->spectrum_emission.polygon()[0].x();
-      right = this->spectrum_emission.polygon()[this->spectrum_emission.polygon().length() - 1].x();
-    } else {
-      left = 0;
-      right = 0;
-    }
-  } else if (this->spectrum_emission.polygon().empty()) {
-    left = this->spectrum_excitation.polygon()[0].x();
-    right = this->spectrum_excitation.polygon()[this->spectrum_excitation.polygon().length() - 1].x();
-  } else {
-    left = std::min(this->spectrum_excitation.polygon()[0].x(), this->spectrum_emission.polygon()[0].x());
-    right = std::max(this->spectrum_excitation.polygon()[this->spectrum_excitation.polygon().length() - 1].x(),
-                     this->spectrum_emission.polygon()[this->spectrum_emission.polygon().length() - 1].x());
-  }
-
-  QRectF bounding_box(QPointF(left, space.local().top()), QPointF(right, space.local().bottom()));
-
-  if (bounding_box != this->spectrum_space) {
-    this->spectrum_space = bounding_box;
+  if (this->spectrum_geometry->bounds() != this->spectrum_space) {
     this->prepareGeometryChange();
+    this->spectrum_space = this->spectrum_geometry->bounds();
   }
 }
 
 /*
-Update the internal state to the source state
+Update the internal state to the source state. The curve is painted by its collection, which has to be invalidated upon changes
+  :returns: whether the drawing state changed
 */
-void Spectrum::updateSpectrum() {
+bool Spectrum::updateSpectrum() {
+  bool changed = this->visible_excitation != this->spectrum_source.visibleExcitation() ||
+                 this->visible_emission != this->spectrum_source.visibleEmission() ||
+                 this->select_excitation != this->spectrum_source.selectExcitation() ||
+                 this->select_emission != this->spectrum_source.selectEmission();
+
   this->visible_excitation = this->spectrum_source.visibleExcitation();
   this->visible_emission = this->spectrum_source.visibleEmission();
   this->select_excitation = this->spectrum_source.selectExcitation();
   this->select_emission = this->spectrum_source.selectEmission();
 
-  // Now plot the updated curve
-  this->update(this->boundingRect());
+  return changed;
 }
 
 /*
@@ -1642,14 +1784,32 @@ Updates the emission intensity to the excitation efficiency
   :param lasers: the lasers to use for efficiency calculation
 */
 void Spectrum::updateIntensity(const std::vector<Data::Laser>& lasers) {
-  if (lasers.empty()) {
+  std::vector<double> wavelengths;
+  wavelengths.reserve(lasers.size());
+  for (const Data::Laser& laser : lasers) {
+    wavelengths.push_back(laser.wavelength());
+  }
+
+  std::vector<double> excitation(wavelengths.size());
+  this->spectrum_source.excitationAt(wavelengths.data(), excitation.data(), wavelengths.size());
+
+  this->updateIntensity(excitation.data(), excitation.size());
+}
+
+/*
+Updates the emission intensity to the excitation efficiency
+  :param excitation: the excitation intensities (0.0 - 100.0) of this spectrum at each laser wavelength
+  :param count: the amount of lasers
+*/
+void Spectrum::updateIntensity(const double* excitation, std::size_t count) {
+  if (count == 0) {
     this->intensity_coefficient = 1.0;
     return;
   }
 
   double intensity = 0.0;
-  for (const Data::Laser& laser : lasers) {
-    intensity += (this->spectrum_source.excitationAt(laser.wavelength()) * 0.01);
+  for (std::size_t i = 0; i < count; ++i) {
+    intensity += (excitation[i] * 0.01);
   }
 
   if (intensity < this->spectrum_source.intensityCutoff()) {
@@ -1664,18 +1824,19 @@ Updates the pen's and brushes used by the painter
   :param style: pen factory
 */
 void Spectrum::updatePainter(const Graph::Format::Style* style) {
+  const QColor& color = this->spectrum_source.spectrum().emission().color();
   if (this->spectrum_source.absorptionFlag()) {
-    this->pen_excitation = style->penAbsorption(this->spectrum_emission.color());
-    this->pen_excitation_select = style->penAbsorptionSelect(this->spectrum_emission.color());
+    this->pen_excitation = style->penAbsorption(color);
+    this->pen_excitation_select = style->penAbsorptionSelect(color);
   } else {
-    this->pen_excitation = style->penExcitation(this->spectrum_emission.color());
-    this->pen_excitation_select = style->penExcitationSelect(this->spectrum_emission.color());
+    this->pen_excitation = style->penExcitation(color);
+    this->pen_excitation_select = style->penExcitationSelect(color);
   }
-  this->pen_emission = style->penEmission(this->spectrum_emission.color());
-  this->pen_emission_select = style->penEmissionSelect(this->spectrum_emission.color());
+  this->pen_emission = style->penEmission(color);
+  this->pen_emission_select = style->penEmissionSelect(color);
 
-  this->brush_emission = style->brushEmission(this->spectrum_emission.color());
-  this->brush_emission_select = style->brushEmissionSelect(this->spectrum_emission.color());
+  this->brush_emission = style->brushEmission(color);
+  this->brush_emission_select = style->brushEmissionSelect(color);
 }
 
 /*
@@ -1684,15 +1845,46 @@ Getter for the source data
 */
 Data::CacheSpectrum& Spectrum::source() const { return this->spectrum_source; }
 
+/*
+Getter for the (shared) scaled curves
+*/
+const SpectrumGeometry& Spectrum::geometry() const { return *this->spectrum_geometry; }
+
+/*
+Getter for the excitation curve visibility
+*/
+bool Spectrum::visibleExcitation() const { return this->visible_excitation; }
+
+/*
+Getter for the emission curve visibility
+*/
+bool Spectrum::visibleEmission() const { return this->visible_emission; }
+
+/*
+Getter for the excitation curve line width
+*/
+double Spectrum::widthExcitation() const { return this->pen_excitation.widthF(); }
+
+/*
+Getter for the emission curve line width
+*/
+double Spectrum::widthEmission() const { return this->pen_emission.widthF(); }
+
 /*
 Sets selection state of the curves
   :param select: the state to change into
+  :returns: whether the selection state changed
 */
-void Spectrum::setSelect(bool selection) {
+bool Spectrum::setSelect(bool selection) {
+  bool changed = this->select_excitation != selection || this->select_emission != selection ||
+                 this->source().selectExcitation() != selection || this->source().selectEmission() != selection;
+
   this->select_excitation = selection;
   this->select_emission = selection;
   this->source().setSelectExcitation(selection);
   this->source().setSelectEmission(selection);
+
+  return changed;
 }
 
 /* ############################################################################################################## */
@@ -1775,7 +1967,18 @@ void Laser::setPosition(const PlotRectF& space) {
 Constructor: default constructor, builds a valid but empty Filter object
 */
 Filter::Filter(QGraphicsItem* parent)
-    : QGraphicsItem(parent), wavelength_left(0.0), wavelength_right(0.0), item_left(), item_right(), item_top(), filter_space() {
+    : QGraphicsItem(parent),
+      wavelength_left(0.0),
+      wavelength_right(0.0),
+      item_left(),
+      item_right(),
+      item_top(),
+      filter_space(),
+      label_text(),
+      label_elided(),
+      label_color(),
+      label_font(),
+      label_rect() {
   this->item_top.reserve(30);
 }
 
@@ -1789,7 +1992,12 @@ Filter::Filter(double wavelength_left, double wavelength_right, QGraphicsItem* p
       item_left(),
       item_right(),
       item_top(),
-      filter_space() {
+      filter_space(),
+      label_text(),
+      label_elided(),
+      label_color(),
+      label_font(),
+      label_rect() {
   this->item_top.reserve(30);
 }
 
@@ -1806,6 +2014,7 @@ Paints the Filter lines/curve
   :param widget: (unused) if provided, points to the widget being painted on
 */
 void Filter::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+  DATA_TRACE_SCOPE("Filter::paint");
   Q_UNUSED(option);
   Q_UNUSED(widget);
 
@@ -1830,6 +2039,12 @@ void Filter::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QW
     painter->drawPolyline(this->item_top);
   }
 
+  if (!this->label_elided.isEmpty()) {
+    painter->setPen(this->label_color);
+    painter->setFont(this->label_font);
+    painter->drawText(this->label_rect, Qt::AlignHCenter | Qt::AlignTop, this->label_elided);
+  }
+
   painter->restore();
 }
 
@@ -1893,9 +2108,22 @@ void Filter::setPosition(const PlotRectF& space) {
     this->item_left = QLineF();
     this->item_right = QLineF();
     this->item_top.clear();
+    this->label_elided.clear();
     return;
   }
 
+  // The label is placed centered below the top line, and elided to fit in the filter
+  if (!this->label_text.isEmpty()) {
+    QFontMetricsF metrics(this->label_font);
+    double label_left = std::max(left, space.local().left()) + bevel_size_x * 0.5;
+    double label_right = std::min(right, space.local().right()) - bevel_size_x * 0.5;
+    double label_top = space.local().top() + offset + offset_pen + 2.0;
+    this->label_rect = QRectF(label_left, label_top, std::max(0.0, label_right - label_left), metrics.height());
+    this->label_elided = metrics.elidedText(this->label_text, Qt::ElideRight, this->label_rect.width());
+  } else {
+    this->label_elided.clear();
+  }
+
   // Correct bevel size (if necessary)
   double width = right - left;
   if (width < (2 * bevel_size_x)) {
@@ -2046,6 +2274,7 @@ void Filter::updatePainter(const Graph::Format::Style* style) {
   this->pen_left = style->penFilter(this->style_left);
   this->pen_right = style->penFilter(this->style_right);
   this->pen_top = style->penFilter(Qt::SolidLine);
+  this->label_font = style->fontGridLabel();
 }
 
 /*
@@ -2088,6 +2317,170 @@ void Filter::setBevel(BevelShape left, BevelShape right) {
   this->bevel_right = right;
 }
 
+/*
+Sets the label, the fluorophore assigned to the filter. To update the label please call setPosition()
+  :param text: the label text, empty for no label
+  :param color: the text color
+*/
+void Filter::setLabel(const QString& text, const QColor& color) {
+  this->label_text = text;
+  this->label_color = color;
+}
+
+/* ############################################################################################################## */
+
+/*
+Constructor: constructs an empty density graphicsitem. The binning and rendering happens in jobs, painting only draws the cached image.
+  :param parent: parent
+*/
+Density::Density(QGraphicsItem* parent)
+    : QGraphicsItem(parent),
+      density_grid(),
+      density_range(0.0, 0.0, 1.0, 1.0),
+      density_space(0.0, 0.0, 0.0, 0.0),
+      density_image(),
+      density_color(Qt::black) {
+  this->setPos(0.0, 0.0);
+}
+
+/*
+Returns the bounding rectangle of the entire plotting region
+  :returns: bounding rectangle
+*/
+QRectF Density::boundingRect() const { return this->density_space; }
+
+/*
+Paints the cached density image. Until a rebinned image is available, the previous image is stretched over the space.
+  :param painter: the painter
+  :param option: (unused) the style options
+  :param widget: (unused) if provided, points to the widget being painted on
+*/
+void Density::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+  DATA_TRACE_SCOPE("Density::paint");
+  Q_UNUSED(option);
+  Q_UNUSED(widget);
+  if (this->density_image.isNull()) {
+    return;
+  }
+  painter->drawImage(this->density_space, this->density_image);
+}
+
+/*
+Whether there are (no) events to plot
+*/
+bool Density::isEmpty() const { return this->density_grid.isEmpty(); }
+
+/*
+Sets the events, the image is removed until the events are rebinned.
+  :param grid: the grid holding the events (and their base grid)
+*/
+void Density::setEvents(const Data::DensityGrid& grid) {
+  this->density_grid = grid;
+  this->density_image = QImage();
+}
+
+/*
+Sets the result of a rebin
+  :param grid: the rebinned grid
+  :param image: the image rendered from the grid
+*/
+void Density::setGrid(const Data::DensityGrid& grid, const QImage& image) {
+  this->density_grid = grid;
+  this->density_image = image;
+}
+
+/*
+Getter for the grid, copies share the events and base grid
+*/
+const Data::DensityGrid& Density::grid() const { return this->density_grid; }
+
+/*
+Getter for the plotted range of the events, equal to the visible axis ranges
+*/
+const QRectF& Density::range() const { return this->density_range; }
+
+/*
+Getter for the grid size to bin into, one bin per pixel of the space
+*/
+QSize Density::binSize() const {
+  return QSize(std::max(1, qCeil(this->density_space.width())), std::max(1, qCeil(this->density_space.height())));
+}
+
+/*
+Getter for the color of the density
+*/
+const QColor& Density::color() const { return this->density_color; }
+
+/*
+Renders a binned grid into an image. A density is colored by the logarithm of the count, a histogram is drawn as bars.
+Only uses thread-safe QImage functionality, so can be called from a job.
+  :param grid: the binned grid
+  :param height: the height of the image in pixels, the width is the amount of columns
+  :param color: the color of the density
+  :returns: the image, null if there is nothing to draw
+*/
+QImage Density::render(const Data::DensityGrid& grid, int height, const QColor& color) {
+  const std::size_t columns = grid.columns();
+  const std::size_t rows = grid.rows();
+  const float maximum = grid.maximum();
+  if (columns == 0 || height <= 0 || !(maximum > 0.0f)) {
+    return QImage();
+  }
+
+  QImage image(static_cast<int>(columns), height, QImage::Format_ARGB32_Premultiplied);
+  image.fill(Qt::transparent);
+  const float* counts = grid.counts();
+
+  if (grid.isHistogram()) {
+    const QRgb rgb = qPremultiply(color.rgba());
+    for (std::size_t c = 0; c < columns; ++c) {
+      int bar = qRound(static_cast<double>(counts[c] / maximum) * height);
+      for (int y = height - bar; y < height; ++y) {
+        reinterpret_cast<QRgb*>(image.scanLine(y))[c] = rgb;
+      }
+    }
+  } else {
+    // Grid row 0 is the lowest value, so the bottom image line
+    const double scale = 255.0 / std::log1p(static_cast<double>(maximum));
+    for (std::size_t r = 0; r < rows && r < static_cast<std::size_t>(height); ++r) {
+      QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(height - 1 - static_cast<int>(r)));
+      const float* count = counts + r * columns;
+      for (std::size_t c = 0; c < columns; ++c) {
+        if (count[c] > 0.0f) {
+          int alpha = std::min(255, qRound(std::log1p(static_cast<double>(count[c])) * scale));
+          line[c] = qPremultiply(qRgba(color.red(), color.green(), color.blue(), alpha));
+        }
+      }
+    }
+  }
+
+  return image;
+}
+
+/*
+Sets the location of the item within the space allocated and the range to the visible axis ranges of the space.
+Rebin afterwards, until then the image is stretched.
+  :param space: the allocated space
+*/
+void Density::setPosition(const PlotRectF& space) {
+  QRectF plot_space = space.local();
+  if (plot_space != this->density_space) {
+    this->prepareGeometryChange();
+    this->density_space = plot_space;
+  }
+
+  // The global top is the highest intensity, the range stores the lowest intensity on top
+  const QRectF& global = space.global();
+  this->density_range = QRectF(QPointF(global.left(), std::min(global.top(), global.bottom())),
+                               QPointF(global.right(), std::max(global.top(), global.bottom())));
+}
+
+/*
+Updates the color of the density. Rebin afterwards to rerender the image.
+  :param style: pen factory
+*/
+void Density::updatePainter(const Graph::Format::Style* style) { this->density_color = style->penAxis().color(); }
+
 /* ############################################################################################################## */
 
 /*
@@ -2096,18 +2489,50 @@ Constructor: container for any collection of items that have to be plotted withi
 */
 template <typename ITEM>
 AbstractCollection<ITEM>::AbstractCollection(const PlotRectF& rect, QGraphicsItem* scene)
-    : QGraphicsItem(scene), items(), style(nullptr), items_space(rect), minimum_width(0), minimum_height(0) {
+    : QGraphicsItem(scene),
+      items(),
+      style(nullptr),
+      items_space(rect),
+      minimum_width(0),
+      minimum_height(0),
+      layer_rect(0.0, 0.0, 0.0, 0.0),
+      layer_cache(),
+      layer_valid(false) {
   static_assert(std::is_base_of<QGraphicsItem, ITEM>::value, "AbstractCollection<ITEM>: ITEM must inherit QGraphicsItem");
   this->setPos(0.0, 0.0);
 }
 
 /*
-Container class,  the container object itself does not contain anything paintable. Therefore the bounding rectangle is empty
-  :returns: empty QRectF
+The collection paints all its items as a single cached layer, the bounding rectangle covers all items
+  :returns: bounding rectangle
 */
 template <typename ITEM>
 QRectF AbstractCollection<ITEM>::boundingRect() const {
-  return QRectF(0.0, 0.0, 0.0, 0.0);
+  return this->layer_rect;
+}
+
+/*
+Marks the layer for rerendering and schedules a repaint. Has to be called after any change in the drawing state of the items.
+The items themselves have the ItemHasNoContents flag set, so the scene doesnt paint them separately.
+*/
+template <typename ITEM>
+void AbstractCollection<ITEM>::invalidate() {
+  QRectF rect = this->items_space.local();
+  for (ITEM* item : this->items) {
+    if (item->isVisible()) {
+      rect = rect.united(item->mapRectToParent(item->boundingRect()));
+    }
+  }
+  // Pixel aligned, so the cached pixmap is drawn without resampling
+  rect = QRectF(rect.toAlignedRect());
+
+  if (rect != this->layer_rect) {
+    this->prepareGeometryChange();
+    this->layer_rect = rect;
+  }
+
+  this->layer_valid = false;
+  this->update();
 }
 
 /*
@@ -2141,14 +2566,43 @@ const std::vector<ITEM*> AbstractCollection<ITEM>::internal_items() const {
 }
 
 /*
-Container class, the container object itself does not contain anything paintable. Therefore painting does nothing.
+Paints the items as a single layer. The layer is only rerendered after invalidate() or a device pixel ratio change,
+otherwise repaints (hover, selection of other graphs) only draw the cached pixmap.
+  :param painter: the painter
+  :param option: the style options, forwarded to the items
+  :param widget: (optional) if provided, paints to the widget being painted on
 */
 template <typename ITEM>
 void AbstractCollection<ITEM>::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
-  Q_UNUSED(painter);
-  Q_UNUSED(option);
-  Q_UNUSED(widget);
-  return;
+  DATA_TRACE_SCOPE("AbstractCollection::paint");
+  if (this->layer_rect.isEmpty()) {
+    return;
+  }
+
+  qreal ratio = painter->device()->devicePixelRatioF();
+  QSize size(static_cast<int>(std::ceil(this->layer_rect.width() * ratio)), static_cast<int>(std::ceil(this->layer_rect.height() * ratio)));
+
+  if (!this->layer_valid || this->layer_cache.size() != size) {
+    DATA_TRACE_SCOPE("AbstractCollection::render");
+    this->layer_cache = QPixmap(size);
+    this->layer_cache.setDevicePixelRatio(ratio);
+    this->layer_cache.fill(Qt::transparent);
+
+    QPainter layer(&this->layer_cache);
+    layer.translate(-this->layer_rect.topLeft());
+    for (ITEM* item : this->items) {
+      if (!item->isVisible()) {
+        continue;
+      }
+      layer.save();
+      layer.setTransform(item->itemTransform(this), true);
+      item->paint(&layer, option, widget);
+      layer.restore();
+    }
+    this->layer_valid = true;
+  }
+
+  painter->drawPixmap(this->layer_rect.topLeft(), this->layer_cache);
 }
 
 /*
@@ -2169,6 +2623,7 @@ void AbstractCollection<ITEM>::updatePainter(const Graph::Format::Style* style)
   for (ITEM* item : this->items) {
     item->updatePainter(style);
   }
+  this->invalidate();
 }
 
 /*
@@ -2215,6 +2670,7 @@ void AbstractCollection<ITEM>::setPosition() {
   for (ITEM* item : this->items) {
     item->setPosition(this->items_space);
   }
+  this->invalidate();
 }
 
 template class AbstractCollection<Spectrum>;
@@ -2227,18 +2683,59 @@ template class AbstractCollection<Filter>;
 Constructor: container for the spectrum widgets. Handles mainly the adding and removing of the spectra.
   :param parent: parent widget
 */
-SpectrumCollection::SpectrumCollection(const PlotRectF& rect, QGraphicsItem* parent) : AbstractCollection(rect, parent) {
+SpectrumCollection::SpectrumCollection(const PlotRectF& rect, QGraphicsItem* parent)
+    : AbstractCollection(rect, parent), pick_offsets(), pick_entries(), pick_left(0.0), pick_valid(false) {
   this->items.reserve(25);
 }
 
 /*
-Sets the select parameters of all contained spectrum to the specified value
+Sets the select parameters of all contained spectrum to the specified value. The layer is only invalidated upon a change.
   :param select: the select state
+  :returns: whether the selection changed
 */
-void SpectrumCollection::setSelect(bool select) {
+bool SpectrumCollection::setSelect(bool select) {
+  bool changed = false;
   for (Spectrum* item : this->items) {
-    item->setSelect(select);
+    changed = item->setSelect(select) || changed;
+  }
+  if (changed) {
+    this->invalidate();
   }
+  return changed;
+}
+
+/*
+Selects a single contained spectrum and deselects all others. The layer is only invalidated upon a change, so repeated
+selection of the same spectrum (while dragging) keeps the cached layer.
+  :param selection: the spectrum to select, nullptr deselects all
+  :returns: whether the selection changed
+*/
+bool SpectrumCollection::select(const Spectrum* selection) {
+  bool changed = false;
+  for (Spectrum* item : this->items) {
+    changed = item->setSelect(item == selection) || changed;
+  }
+  if (changed) {
+    this->invalidate();
+  }
+  return changed;
+}
+
+/*
+Sets the position of all the spectra, the picking index is rebuild upon the next pick
+*/
+void SpectrumCollection::setPosition() {
+  AbstractCollection::setPosition();
+  this->pick_valid = false;
+}
+
+/*
+Updates the painters of all the spectra, the picking index depends on the line widths so is rebuild upon the next pick
+  :param style: the style to use
+*/
+void SpectrumCollection::updatePainter(const Graph::Format::Style* style) {
+  AbstractCollection::updatePainter(style);
+  this->pick_valid = false;
 }
 
 /*
@@ -2246,12 +2743,17 @@ Synchronizes all the spectra to the Cache state. Handles adding, order and remov
   :param cache_state: the cache state to synchronize the spectrum items to
 */
 void SpectrumCollection::syncSpectra(const std::vector<Cache::ID>& cache_state) {
+  DATA_TRACE_SCOPE("SpectrumCollection::syncSpectra");
+  // The picking index refers to the items by index
+  this->pick_valid = false;
+
   // Special case: cache is empty -> remove all
   if (cache_state.empty()) {
     for (Graph::Spectrum* item : this->items) {
       delete item;
     }
     this->items.clear();
+    this->invalidate();
     return;
   }
 
@@ -2265,6 +2767,7 @@ void SpectrumCollection::syncSpectra(const std::vector<Cache::ID>& cache_state)
     if (index_item >= this->items.size()) {
       // item was not found - create new one
       Graph::Spectrum* item_new = new Graph::Spectrum(*id.data, this);
+      item_new->setFlag(QGraphicsItem::ItemHasNoContents);
 
       // Give new item the correct properties
       if (this->style) {  // Can be nullptr
@@ -2294,14 +2797,22 @@ void SpectrumCollection::syncSpectra(const std::vector<Cache::ID>& cache_state)
     // Delete pointers
     this->items.erase(std::next(this->items.begin(), static_cast<int>(index_current)), this->items.cend());
   }
+
+  this->invalidate();
 }
 
 /*
-Updates the internal spectra to the cache state. Uses the Spectrum internal source to update the drawing state
+Updates the internal spectra to the cache state. Uses the Spectrum internal source to update the drawing state.
+The layer is only rerendered if the drawing state of any spectrum changed.
 */
 void SpectrumCollection::updateSpectra() {
+  bool changed = false;
   for (std::size_t i = 0; i < this->items.size(); ++i) {
-    this->items[i]->updateSpectrum();
+    changed |= this->items[i]->updateSpectrum();
+  }
+
+  if (changed) {
+    this->invalidate();
   }
 }
 
@@ -2310,31 +2821,145 @@ Updates the intensity of the spectrum
   :param lasers: the laser data to use for intensity calculation
 */
 void SpectrumCollection::updateIntensity(const std::vector<Data::Laser>& lasers) {
+  std::vector<double> wavelengths;
+  wavelengths.reserve(lasers.size());
+  for (const Data::Laser& laser : lasers) {
+    wavelengths.push_back(laser.wavelength());
+  }
+
+  std::vector<const Data::CacheSpectrum*> spectra;
+  spectra.reserve(this->items.size());
   for (std::size_t i = 0; i < this->items.size(); ++i) {
-    this->items[i]->updateIntensity(lasers);
+    spectra.push_back(&this->items[i]->source());
+  }
+
+  // Evaluates all spectra at all laser wavelengths in one batch
+  std::size_t count = wavelengths.size();
+  std::vector<double> excitation(spectra.size() * count);
+  Data::CacheSpectrum::excitationMatrix(spectra, wavelengths.data(), count, excitation.data());
+
+  for (std::size_t i = 0; i < this->items.size(); ++i) {
+    this->items[i]->updateIntensity(excitation.data() + i * count, count);
   }
 }
 
 /*
-Builds a vector of Spectrum items that are contained with the given point
-  :param space: the plotting region, internally the scaling properties are used for quick lookup
+Builds a vector of the Spectrum items with a visible curve at or above the given point, in order of distance to the point.
+Uses the picking index, so only the curves that cover the point's pixel column are considered.
   :param point: the point to contain in scene coordinates
-  :returns: a vector of all contained items, can be empty!
+  :returns: the picked items, nearest curve first, can be empty!
 */
-std::vector<Spectrum*> SpectrumCollection::containsItems(const PlotRectF& space, const QPointF& point) const {
-  if (!this->items_space.local().contains(this->mapFromScene(point))) {
+std::vector<Spectrum*> SpectrumCollection::pickItems(const QPointF& point) const {
+  QPointF local = this->mapFromScene(point);
+  if (!this->items_space.local().contains(local)) {
     return std::vector<Spectrum*>();
   }
 
-  std::vector<Spectrum*> is_contained;
-  is_contained.reserve(5);
-  for (Spectrum* item : this->items) {
-    if (item->contains(space, point)) {
-      is_contained.push_back(item);
+  if (!this->pick_valid) {
+    this->buildPickIndex();
+  }
+
+  double column = std::floor(local.x() - this->pick_left);
+  if (column < 0.0 || column >= static_cast<double>(this->pick_offsets.size() - 1)) {
+    return std::vector<Spectrum*>();
+  }
+  std::size_t index = static_cast<std::size_t>(column);
+
+  auto begin = this->pick_entries.cbegin() + static_cast<std::ptrdiff_t>(this->pick_offsets[index]);
+  auto end = this->pick_entries.cbegin() + static_cast<std::ptrdiff_t>(this->pick_offsets[index + 1]);
+
+  // The curves at or above the point are at the front of the column
+  auto below = [](double y, const PickEntry& entry) { return y < static_cast<double>(entry.top); };
+  auto contained = std::upper_bound(begin, end, local.y(), below);
+
+  std::vector<Spectrum*> picked;
+  for (auto it = contained; it != begin;) {
+    --it;
+    Spectrum* item = this->items[it->curve / 2];
+    bool visible = it->curve % 2 == 1 ? item->visibleEmission() : item->visibleExcitation();
+    if (visible && std::find(picked.cbegin(), picked.cend(), item) == picked.cend()) {
+      picked.push_back(item);
     }
   }
 
-  return is_contained;
+  return picked;
+}
+
+/*
+(Re)builds the picking index. Every curve is sampled at every pixel column it covers, using the highest curve point within the column.
+Columns without a curve point use the point nearest to the column center.
+*/
+void SpectrumCollection::buildPickIndex() const {
+  const QRectF& space = this->items_space.local();
+  this->pick_left = std::floor(space.left());
+  std::size_t columns = space.isEmpty() ? 0 : static_cast<std::size_t>(std::ceil(space.right()) - this->pick_left);
+
+  std::vector<std::pair<std::size_t, PickEntry>> samples;  // column, entry
+  for (std::size_t i = 0; i < this->items.size(); ++i) {
+    const Spectrum* item = this->items[i];
+    for (std::uint32_t emission = 0; emission < 2; ++emission) {
+      const QPolygonF& curve = emission == 1 ? item->geometry().emission().polygon() : item->geometry().excitation().polygon();
+      if (curve.empty() || columns == 0) {
+        continue;
+      }
+      double adjust = 0.5 * (emission == 1 ? item->widthEmission() : item->widthExcitation());
+
+      // The columns with their center within the curve
+      double first = std::max(0.0, std::ceil(curve.first().x() - this->pick_left - 0.5));
+      double last = std::min(static_cast<double>(columns - 1), std::floor(curve.last().x() - this->pick_left - 0.5));
+
+      int j = 0;
+      int k = 0;
+      for (double column = first; column <= last; column += 1.0) {
+        double x = this->pick_left + column + 0.5;
+        while (j + 1 < curve.size() && curve[j + 1].x() <= x) {
+          ++j;
+        }
+        int nearest = j;
+        if (j + 1 < curve.size() && curve[j + 1].x() - x < x - curve[j].x()) {
+          nearest = j + 1;
+        }
+
+        // The (decimated) curve can hold multiple points per column
+        while (k < curve.size() && curve[k].x() < x - 0.5) {
+          ++k;
+        }
+        int highest = k < curve.size() && curve[k].x() < x + 0.5 ? k : nearest;
+        for (; k < curve.size() && curve[k].x() < x + 0.5; ++k) {
+          if (curve[k].y() < curve[highest].y()) {
+            highest = k;
+          }
+        }
+        double top = curve[highest].y();
+
+        PickEntry entry{static_cast<float>(top - adjust), static_cast<std::uint32_t>(i * 2) + emission};
+        samples.emplace_back(static_cast<std::size_t>(column), entry);
+      }
+    }
+  }
+
+  // Bucket the samples per column, then sort every column by height
+  this->pick_offsets.assign(columns + 1, 0);
+  for (const std::pair<std::size_t, PickEntry>& sample : samples) {
+    ++this->pick_offsets[sample.first + 1];
+  }
+  for (std::size_t c = 0; c < columns; ++c) {
+    this->pick_offsets[c + 1] += this->pick_offsets[c];
+  }
+
+  std::vector<std::size_t> position(this->pick_offsets.cbegin(), this->pick_offsets.cend() - 1);
+  this->pick_entries.resize(samples.size());
+  for (const std::pair<std::size_t, PickEntry>& sample : samples) {
+    this->pick_entries[position[sample.first]++] = sample.second;
+  }
+
+  auto higher = [](const PickEntry& left, const PickEntry& right) { return left.top < right.top; };
+  for (std::size_t c = 0; c < columns; ++c) {
+    std::sort(this->pick_entries.begin() + static_cast<std::ptrdiff_t>(this->pick_offsets[c]),
+              this->pick_entries.begin() + static_cast<std::ptrdiff_t>(this->pick_offsets[c + 1]), higher);
+  }
+
+  this->pick_valid = true;
 }
 
 /*
@@ -2395,6 +3020,7 @@ void LaserCollection::syncLasers(const std::vector<Data::Laser>& lasers) {
       delete item;
     }
     this->items.clear();
+    this->invalidate();
     return;
   }
 
@@ -2403,6 +3029,7 @@ void LaserCollection::syncLasers(const std::vector<Data::Laser>& lasers) {
     std::size_t to_add = lasers.size() - this->items.size();
     for (std::size_t i = 0; i < to_add; ++i) {
       Laser* item = new Laser(this);
+      item->setFlag(QGraphicsItem::ItemHasNoContents);
       this->items.push_back(item);
     }
   } else if (this->items.size() > lasers.size()) {
@@ -2420,6 +3047,8 @@ void LaserCollection::syncLasers(const std::vector<Data::Laser>& lasers) {
     }
     this->items[i]->setPosition(this->items_space);
   }
+
+  this->invalidate();
 }
 
 /*
@@ -2430,6 +3059,7 @@ void LaserCollection::updateLasers(bool visible) {
   for (std::size_t i = 0; i < this->items.size(); ++i) {
     this->items[i]->setVisible(visible);
   }
+  this->invalidate();
 }
 
 /* ############################################################################################################## */
@@ -2446,15 +3076,16 @@ FilterCollection::FilterCollection(const PlotRectF& rect, QGraphicsItem* parent)
 /*
 Synchronizes the filters to the graph
   :param filters: the filter to synchronize
-  :param visible: the visibility state of the filters
+  :param labels: the labels of the filters, filters without label are unlabeled
 */
-void FilterCollection::syncFilters(const std::vector<Data::Filter>& filters) {
+void FilterCollection::syncFilters(const std::vector<Data::Filter>& filters, const std::vector<State::FilterLabel>& labels) {
   // Special clear state
   if (filters.empty()) {
     for (Graph::Filter* item : this->items) {
       delete item;
     }
     this->items.clear();
+    this->invalidate();
     return;
   }
 
@@ -2463,6 +3094,7 @@ void FilterCollection::syncFilters(const std::vector<Data::Filter>& filters) {
     std::size_t to_add = filters.size() - this->items.size();
     for (std::size_t i = 0; i < to_add; ++i) {
       Filter* item = new Filter(this);
+      item->setFlag(QGraphicsItem::ItemHasNoContents);
       item->setBevel(Filter::BevelShape::Round, Filter::BevelShape::Round);
       item->setLineStyle(Qt::SolidLine, Qt::SolidLine);
       this->items.push_back(item);
@@ -2477,6 +3109,11 @@ void FilterCollection::syncFilters(const std::vector<Data::Filter>& filters) {
   // Synchronize the wavelength
   for (std::size_t i = 0; i < this->items.size(); ++i) {
     this->items[i]->setWavelengths(filters[i].wavelengthMin(), filters[i].wavelengthMax());
+    if (i < labels.size()) {
+      this->items[i]->setLabel(labels[i].text, labels[i].color);
+    } else {
+      this->items[i]->setLabel(QString(), QColor());
+    }
 
     // Set correct bevels for SP, LP filters
     switch (filters[i].type()) {
@@ -2499,6 +3136,8 @@ void FilterCollection::syncFilters(const std::vector<Data::Filter>& filters) {
     }
     this->items[i]->setPosition(this->items_space);
   }
+
+  this->invalidate();
 }
 
 /*
@@ -2509,6 +3148,7 @@ void FilterCollection::updateFilters(bool visible) {
   for (std::size_t i = 0; i < this->items.size(); ++i) {
     this->items[i]->setVisible(visible);
   }
+  this->invalidate();
 }
 
 }  // namespace Graph
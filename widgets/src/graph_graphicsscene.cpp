@@ -15,6 +15,8 @@
 #include <QPointF>
 #include <cmath>
 
+#include "data_trace.h"
+
 namespace Graph {
 
 /*
@@ -26,6 +28,7 @@ GraphicsScene::GraphicsScene(Format::Settings settings, QWidget* parent)
       settings(std::move(settings)),
       plot_rect(),
       item_background(nullptr),
+      item_density(nullptr),
       item_x_axis_label(nullptr),
       item_x_axis_gridlabels(nullptr),
       item_x_axis_ticks(nullptr),
@@ -39,6 +42,10 @@ GraphicsScene::GraphicsScene(Format::Settings settings, QWidget* parent)
       item_lasers(nullptr),
       item_filters(nullptr),
       item_outline(nullptr),
+      density_x(nullptr),
+      density_y(nullptr),
+      density_events(),
+      density_rebin(),
       scroll_count(0),
       size_current(),
       is_hover(false),
@@ -49,6 +56,7 @@ GraphicsScene::GraphicsScene(Format::Settings settings, QWidget* parent)
 
   // Add items to heap, make sure to add to scene for proper memory management
   this->item_background = new Graph::Background();
+  this->item_density = new Graph::Density();
 
   if (this->settings.enable_labels) {
     this->item_x_axis_label = new Graph::Axis::LabelX(this->settings.x_axis.label);
@@ -87,6 +95,7 @@ GraphicsScene::GraphicsScene(Format::Settings settings, QWidget* parent)
 
   // Add items to the scene, this gives the scene class the actual ownership
   this->addItem(this->item_background);
+  this->addItem(this->item_density);
 
   if (this->settings.enable_labels) {
     this->addItem(this->item_x_axis_label);
@@ -151,6 +160,7 @@ Destructor: Not really necessary, as addItem() gives ownership of the item to th
 */
 GraphicsScene::~GraphicsScene() {
   delete this->item_background;
+  delete this->item_density;
 
   if (this->settings.enable_labels) {
     delete this->item_x_axis_label;
@@ -215,6 +225,7 @@ void GraphicsScene::calculateSizes(const QSize& scene) {
 
   // Give regions to items
   this->item_background->setPosition(QRectF(QPointF(x_plot, y_start), QPointF(x_end, y_plot)));
+  this->item_density->setPosition(this->plot_rect);
 
   if (this->settings.enable_labels) {
     this->item_y_axis_label->setPosition(QRectF(QPointF(x_start, y_start), QPointF(x_label, y_plot)));
@@ -250,6 +261,43 @@ void GraphicsScene::calculateSizes(const QSize& scene) {
   this->item_filters->setPosition();
 
   this->item_outline->setPosition(QRectF(QPointF(x_plot, y_start), QPointF(x_end, y_plot)));
+
+  this->rebinDensity();
+}
+
+/*
+Rebins the density events for the current axis ranges and size of the plot in a job, superseding any earlier rebin. Called by
+calculateSizes, so on every resize and change of the axis ranges. The job works on a copy of the grid (sharing the events and
+base grid), the item keeps painting its previous image until the result arrives.
+*/
+void GraphicsScene::rebinDensity() {
+  if (this->item_density->isEmpty()) {
+    this->density_rebin.cancel();
+    return;
+  }
+
+  Data::JobToken token = this->density_rebin.next();
+  Data::JobReceiver receiver(this);
+
+  Data::JobSystem::instance().submit(
+      [this, receiver, token, grid = this->item_density->grid(), range = this->item_density->range(), size = this->item_density->binSize(),
+       color = this->item_density->color()]() mutable {
+        DATA_TRACE_SCOPE("GraphicsScene::rebinDensity");
+        grid.bin(range.left(), range.right(), static_cast<std::size_t>(size.width()), range.top(), range.bottom(),
+                 static_cast<std::size_t>(size.height()));
+        if (token.isCancelled()) {
+          return;
+        }
+        QImage image = Graph::Density::render(grid, size.height(), color);
+
+        receiver.post(
+            [this, grid, image]() {
+              this->item_density->setGrid(grid, image);
+              this->update(this->item_density->boundingRect());
+            },
+            token);
+      },
+      Data::JobSystem::High, token);
 }
 
 /*
@@ -309,6 +357,7 @@ Slot: receives synchronisation requests forwards it to the spectra object
   :param cache_state: the state of the cache
 */
 void GraphicsScene::syncSpectra(const std::vector<Cache::ID>& cache_state) {
+  DATA_TRACE_SCOPE("GraphicsScene::syncSpectra");
   this->item_spectra->syncSpectra(cache_state);
   this->item_spectra->updateSpectra();
   this->item_spectra->updateIntensity(this->item_lasers->lasers());
@@ -335,9 +384,8 @@ Slot: receives update requests forwards it to the spectra object
   :param cache_state: the state of the cache
 */
 void GraphicsScene::updateSpectra() {
+  // The spectra layer schedules its own redraw if changed
   this->item_spectra->updateSpectra();
-  // Schedule a redraw
-  QGraphicsScene::update(this->sceneRect());
 }
 
 /*
@@ -351,9 +399,9 @@ void GraphicsScene::syncGraphState(const State::GraphState& state) {
 
   // Sync LaserLine
   if (state.laserLine()) {
-    this->syncFilters(state.laserLine()->filters());
+    this->syncFilters(state.laserLine()->filters(), state.filterLabels());
   } else {
-    this->syncFilters({});
+    this->syncFilters({}, {});
   }
   this->updateFilters(state.visibleFilters());
 
@@ -435,6 +483,47 @@ void GraphicsScene::syncAxisY() {
   };
 }
 
+/*
+Slot: sets the events of the density plot, drawn below the spectra on the same axes. The events are shared, not copied.
+The base grid of the events is binned in a job, superseding the binning of earlier events.
+  :param x: the x parameter of the events, nullptr to remove the density
+  :param y: the y parameter of the events, nullptr for a histogram of x
+*/
+void GraphicsScene::syncDensity(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y) {
+  if (x == this->density_x && y == this->density_y) {
+    return;
+  }
+  this->density_x = x;
+  this->density_y = y;
+
+  if (!x) {
+    this->density_events.cancel();
+    this->item_density->setEvents(Data::DensityGrid());
+    this->rebinDensity();
+    this->update(this->item_density->boundingRect());
+    return;
+  }
+
+  Data::JobToken token = this->density_events.next();
+  Data::JobReceiver receiver(this);
+
+  Data::JobSystem::instance().submit(
+      [this, receiver, token, x = std::move(x), y = std::move(y)]() {
+        DATA_TRACE_SCOPE("GraphicsScene::syncDensity");
+        Data::DensityGrid grid;
+        grid.setEvents(x, y);
+
+        receiver.post(
+            [this, grid]() {
+              this->item_density->setEvents(grid);
+              this->rebinDensity();
+              this->update(this->item_density->boundingRect());
+            },
+            token);
+      },
+      Data::JobSystem::Normal, token);
+}
+
 /*
 Synchronizes the lasers to the graph
 */
@@ -468,12 +557,11 @@ void GraphicsScene::updateLasers(bool visible) { this->item_lasers->updateLasers
 
 /*
 Synchronizes the detectors of the laserline to the graph
-  :param laser_line: the laser line to sync
+  :param filters: the filters of the laserline
+  :param labels: the labels of the filters
 */
-void GraphicsScene::syncFilters(const std::vector<Data::Filter>& filters) {
-  this->item_filters->syncFilters(filters);
-  // Force redrawing of the filters
-  this->update(this->item_filters->boundingRect());
+void GraphicsScene::syncFilters(const std::vector<Data::Filter>& filters, const std::vector<State::FilterLabel>& labels) {
+  this->item_filters->syncFilters(filters, labels);
 }
 
 /*
@@ -499,6 +587,8 @@ void GraphicsScene::updatePainter(const Graph::Format::Style* style) {
   this->setBackgroundBrush(style->brushScene());
 
   this->item_background->updatePainter(style);
+  this->item_density->updatePainter(style);
+  this->rebinDensity();
 
   if (this->settings.enable_labels) {
     this->item_x_axis_label->updatePainter(style);
@@ -650,30 +740,24 @@ void GraphicsScene::wheelEvent(QGraphicsSceneWheelEvent* event) {
 }
 
 /*
-Finds the Spectrum items (contained in Spectra) that contains the point and selects the curve based on the index
+Finds the Spectrum items (contained in Spectra) that contains the point and selects the curve based on the index.
+Only a change of selection invalidates the spectra layer and is emitted.
   :param point: the point to contain in scene coordinates
-  :param index: if there are multiple items that fit the curve, the index specifies the one to be selected
+  :param index: if there are multiple items that fit the curve, the index specifies the one to be selected, 0 being the nearest curve
 */
 void GraphicsScene::selectSpectrum(const QPointF& point, std::size_t index) {
-  std::vector<Graph::Spectrum*> is_contained = this->item_spectra->containsItems(this->plot_rect, point);
+  std::vector<Graph::Spectrum*> is_contained = this->item_spectra->pickItems(point);
 
-  // Deselect all
-  this->item_spectra->setSelect(false);
+  Graph::Spectrum* contained_graph = nullptr;
+  if (!is_contained.empty()) {
+    // Calculate the index, while allowing 'rotating' through all the indexes
+    index %= is_contained.size();
+    contained_graph = is_contained[index];
+  }
 
-  if (is_contained.empty()) {
+  if (this->item_spectra->select(contained_graph)) {
     emit this->spectrumSelected();
-    return;
   }
-
-  // Calculate the index, while allowing 'rotating' through all the indexes
-  index %= is_contained.size();
-
-  Graph::Spectrum* contained_graph = is_contained[index];
-
-  contained_graph->setSelect(true);
-
-  emit this->spectrumSelected();
-  return;
 }
 
 }  // namespace Graph
@@ -8,17 +8,21 @@
 
 /**** DOC ******************************************************************
 ** Starts the viewer's QApplication and central Window
+** In tracing builds (DATA_TRACE) the trace is saved at exit to the path in
+** the FLUOR_TRACE environment variable
 ***************************************************************************/
 
 #include <QDebug>
 
 #include "application.h"
 #include "data_factory.h"
+#include "data_trace.h"
 #include "state_program.h"
 
 int main(int argc, char **argv) {
   // Load QApplication eventManager
   Application APP(argc, argv);
+  DATA_TRACE_THREAD("GUI");
 
   // Load SettingsFactory
   Data::Factory FACTORY;
@@ -38,5 +42,15 @@ int main(int argc, char **argv) {
 
   State::Program STATE(FACTORY);
 
-  return APP.exec();
+  int result = APP.exec();
+
+#ifdef DATA_TRACE
+  // Save the trace of the whole session if requested
+  QString trace_path = qEnvironmentVariable("FLUOR_TRACE");
+  if (!trace_path.isEmpty()) {
+    Data::Trace::save(trace_path);
+  }
+#endif
+
+  return result;
 }
@@ -76,6 +76,7 @@ Controller::Controller(QWidget* parent) : QMainWindow(parent), window_screen(nul
 
   QObject::connect(controller_widget, &Central::Controller::sendGraphSelect, this, &Main::Controller::receiveGraphSelect);
   QObject::connect(this, &Main::Controller::sendGraphState, controller_widget, &Central::Controller::receiveGraphState);
+  QObject::connect(this, &Main::Controller::sendEvents, controller_widget, &Central::Controller::receiveEvents);
 }
 
 /*
@@ -248,4 +249,11 @@ Slot: receives and forwards Graph Set signal
 */
 void Controller::receiveGraphState(std::vector<State::GraphState>& state) { emit this->sendGraphState(state); }
 
+/*
+Slot: receives and forwards the events of the density overlay
+  :param x: the x parameter of the events, nullptr to remove the overlay
+  :param y: the y parameter of the events, nullptr for a histogram of x
+*/
+void Controller::receiveEvents(std::shared_ptr<const std::vector<float>> x, std::shared_ptr<const std::vector<float>> y) { emit this->sendEvents(std::move(x), std::move(y)); }
+
 }  // namespace Main
@@ -129,7 +129,7 @@ void InstrumentMenu::selectInstrument(QString id) {
 }
 
 /*
-Fills the menu with the instrument names
+Fills the menu with the instrument names, the menu is disabled until the instruments are loaded
 */
 void InstrumentMenu::buildMenu(const Data::InstrumentReader& data) {
   // Clear the menu, removing also deletes owning QActions
@@ -148,6 +148,8 @@ void InstrumentMenu::buildMenu(const Data::InstrumentReader& data) {
     action_instrument->setCheckable(true);
   }
   this->addActions(instrument_actions->actions());
+
+  this->setEnabled(data.isValid());
 }
 
 /*
@@ -395,6 +397,129 @@ void OptionsMenu::receiveSortMode(State::SortMode mode) { this->selectSortMode(m
 
 // #################################################################################### //
 
+/*
+Constructor: constructs the tools menu
+  :param parent: the parent widget
+*/
+ToolsMenu::ToolsMenu(QWidget* parent) : QMenu(parent) {
+  this->setTitle("&Tools");
+  this->setIcon(QIcon());
+
+  this->setToolTipsVisible(false);
+  this->setTearOffEnabled(false);
+  this->setSeparatorsCollapsible(false);
+
+  QAction* action_spillover = new QAction("&Spillover Matrix...", this);
+  action_spillover->setCheckable(false);
+  QObject::connect(action_spillover, &QAction::triggered, this, &ToolsMenu::triggered_spillover);
+  this->addAction(action_spillover);
+
+  QAction* action_panel = new QAction("&Panel Optimizer...", this);
+  action_panel->setCheckable(false);
+  QObject::connect(action_panel, &QAction::triggered, this, &ToolsMenu::triggered_panel);
+  this->addAction(action_panel);
+
+  QAction* action_similarity = new QAction("Similar &Fluorophores...", this);
+  action_similarity->setCheckable(false);
+  QObject::connect(action_similarity, &QAction::triggered, this, &ToolsMenu::triggered_similarity);
+  this->addAction(action_similarity);
+
+  QAction* action_spreading = new QAction("Spillover Sp&reading...", this);
+  action_spreading->setCheckable(false);
+  QObject::connect(action_spreading, &QAction::triggered, this, &ToolsMenu::triggered_spreading);
+  this->addAction(action_spreading);
+
+  QAction* action_compensation = new QAction("Spillover from &Controls...", this);
+  action_compensation->setCheckable(false);
+  QObject::connect(action_compensation, &QAction::triggered, this, &ToolsMenu::triggered_compensation);
+  this->addAction(action_compensation);
+
+  QAction* action_catalogue = new QAction("FCS C&atalogue...", this);
+  action_catalogue->setCheckable(false);
+  QObject::connect(action_catalogue, &QAction::triggered, this, &ToolsMenu::triggered_catalogue);
+  this->addAction(action_catalogue);
+
+  QAction* action_events = new QAction("&Events Overlay...", this);
+  action_events->setCheckable(false);
+  QObject::connect(action_events, &QAction::triggered, this, &ToolsMenu::triggered_events);
+  this->addAction(action_events);
+
+#ifdef DATA_TRACE
+  this->addSeparator();
+
+  QAction* action_trace = new QAction("Save &Trace...", this);
+  action_trace->setCheckable(false);
+  QObject::connect(action_trace, &QAction::triggered, this, &ToolsMenu::triggered_trace);
+  this->addAction(action_trace);
+#endif
+}
+
+/*
+Slot: receives 'spillover matrix' signal
+*/
+void ToolsMenu::triggered_spillover(bool checked) {
+  Q_UNUSED(checked);
+  emit this->sendAction(Main::MenuBarAction::Spillover, QVariant());
+}
+
+/*
+Slot: receives 'panel optimizer' signal
+*/
+void ToolsMenu::triggered_panel(bool checked) {
+  Q_UNUSED(checked);
+  emit this->sendAction(Main::MenuBarAction::Panel, QVariant());
+}
+
+/*
+Slot: receives 'similar fluorophores' signal
+*/
+void ToolsMenu::triggered_similarity(bool checked) {
+  Q_UNUSED(checked);
+  emit this->sendAction(Main::MenuBarAction::Similarity, QVariant());
+}
+
+/*
+Slot: receives 'spillover spreading' signal
+*/
+void ToolsMenu::triggered_spreading(bool checked) {
+  Q_UNUSED(checked);
+  emit this->sendAction(Main::MenuBarAction::Spreading, QVariant());
+}
+
+/*
+Slot: receives 'spillover from controls' signal
+*/
+void ToolsMenu::triggered_compensation(bool checked) {
+  Q_UNUSED(checked);
+  emit this->sendAction(Main::MenuBarAction::Compensation, QVariant());
+}
+
+/*
+Slot: receives 'fcs catalogue' signal
+*/
+void ToolsMenu::triggered_catalogue(bool checked) {
+  Q_UNUSED(checked);
+  emit this->sendAction(Main::MenuBarAction::Catalogue, QVariant());
+}
+
+/*
+Slot: receives 'events overlay' signal
+*/
+void ToolsMenu::triggered_events(bool checked) {
+  Q_UNUSED(checked);
+  emit this->sendAction(Main::MenuBarAction::Events, QVariant());
+}
+
+/*
+Slot: receives 'save trace' signal, only available in tracing builds
+*/
+void ToolsMenu::triggered_trace(bool checked) {
+  Q_UNUSED(checked);
+  emit this->sendAction(Main::MenuBarAction::Trace, QVariant());
+}
+
+// #################################################################################### //
+
 /*
 Constructor: constructs the file menu
   :param parent: the parent widget
@@ -428,13 +553,14 @@ Constructor: construct a menubar
   :param parent: the parent widget (keep nullptr for program wide menubars on Mac!)
 */
 MenuBar::MenuBar(QWidget* parent)
-    : QMenuBar(parent), file_menu(nullptr), instrument_menu(nullptr), options_menu(nullptr), help_menu(nullptr) {
+    : QMenuBar(parent), file_menu(nullptr), instrument_menu(nullptr), options_menu(nullptr), tools_menu(nullptr), help_menu(nullptr) {
   this->setNativeMenuBar(true);
 
   // Instantiate the menus, and build connections
   file_menu = new FileMenu(this);
   instrument_menu = new InstrumentMenu(this);
   options_menu = new OptionsMenu(this);
+  tools_menu = new ToolsMenu(this);
   help_menu = new HelpMenu(this);
 
   QObject::connect(file_menu, &Main::FileMenu::sendAction, this, &Main::MenuBar::receiveMenuBarStateChange);
@@ -448,12 +574,15 @@ MenuBar::MenuBar(QWidget* parent)
   QObject::connect(this, &Main::MenuBar::sendSortMode, options_menu, &Main::OptionsMenu::receiveSortMode);
   QObject::connect(options_menu, &Main::OptionsMenu::sendAction, this, &Main::MenuBar::receiveMenuBarStateChange);
 
+  QObject::connect(tools_menu, &Main::ToolsMenu::sendAction, this, &Main::MenuBar::receiveMenuBarStateChange);
+
   QObject::connect(help_menu, &Main::HelpMenu::sendAction, this, &Main::MenuBar::receiveMenuBarStateChange);
 
   // Add menu's to the menubar
   this->addMenu(file_menu);
   this->addMenu(instrument_menu);
   this->addMenu(options_menu);
+  this->addMenu(tools_menu);
   this->addMenu(help_menu);
 }
 
@@ -478,6 +607,14 @@ void MenuBar::receiveMenuBarStateUpdate(Main::MenuBarAction action, const QVaria
     case Main::MenuBarAction::Open:
     case Main::MenuBarAction::Print:
     case Main::MenuBarAction::Exit:
+    case Main::MenuBarAction::Spillover:
+    case Main::MenuBarAction::Panel:
+    case Main::MenuBarAction::Similarity:
+    case Main::MenuBarAction::Spreading:
+    case Main::MenuBarAction::Compensation:
+    case Main::MenuBarAction::Catalogue:
+    case Main::MenuBarAction::Events:
+    case Main::MenuBarAction::Trace:
     case Main::MenuBarAction::About:
     default:
       break;
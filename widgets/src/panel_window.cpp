@@ -0,0 +1,291 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "panel_window.h"
+
+#include <QDebug>
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QTableWidgetItem>
+
+#include "data_jobs.h"
+
+namespace Panel {
+
+/*
+Constructor: constructs the panel optimizer window
+  :param parent: parent widget
+*/
+Window::Window(QWidget* parent)
+    : General::StyledWidget(parent),
+      instrument(),
+      fluorophores(nullptr),
+      optimizer(nullptr),
+      optimizer_generation(),
+      widget_objective(nullptr),
+      widget_weight(nullptr),
+      widget_minimum(nullptr),
+      widget_beam(nullptr),
+      widget_start(nullptr),
+      widget_cancel(nullptr),
+      widget_apply(nullptr),
+      widget_progress(nullptr),
+      widget_summary(nullptr),
+      widget_table(nullptr) {
+  this->setWindowTitle("Panel Optimizer");
+  this->setAttribute(Qt::WA_DeleteOnClose);
+
+  // Set base properties
+  this->setContentsMargins(8, 8, 8, 8);
+
+  // Build layout
+  QGridLayout* controller_layout = new QGridLayout(this);
+  controller_layout->setColumnStretch(0, 0);
+  controller_layout->setColumnStretch(1, 1);
+  controller_layout->setColumnStretch(2, 0);
+  controller_layout->setColumnStretch(3, 1);
+  controller_layout->setRowStretch(5, 1);
+  controller_layout->setContentsMargins(0, 0, 0, 0);
+  controller_layout->setSpacing(6);
+
+  Data::PanelOptimizer::Options options;
+
+  this->widget_objective = new QComboBox(this);
+  this->widget_objective->addItem("Total spillover", static_cast<int>(Data::PanelOptimizer::TotalSpillover));
+  this->widget_objective->addItem("Worst-case spillover", static_cast<int>(Data::PanelOptimizer::WorstSpillover));
+
+  this->widget_weight = new QDoubleSpinBox(this);
+  this->widget_weight->setRange(0.0, 100.0);
+  this->widget_weight->setSingleStep(0.1);
+  this->widget_weight->setValue(options.spillover_weight);
+
+  this->widget_minimum = new QDoubleSpinBox(this);
+  this->widget_minimum->setRange(0.0, 1.0);
+  this->widget_minimum->setDecimals(3);
+  this->widget_minimum->setSingleStep(0.01);
+  this->widget_minimum->setValue(options.signal_minimum);
+
+  this->widget_beam = new QSpinBox(this);
+  this->widget_beam->setRange(1, 4096);
+  this->widget_beam->setValue(static_cast<int>(options.beam_width));
+
+  this->widget_start = new QPushButton("Start", this);
+  QObject::connect(this->widget_start, &QPushButton::clicked, this, &Panel::Window::receiveStart);
+
+  this->widget_cancel = new QPushButton("Cancel", this);
+  QObject::connect(this->widget_cancel, &QPushButton::clicked, this, &Panel::Window::receiveCancel);
+
+  this->widget_apply = new QPushButton("Apply", this);
+  QObject::connect(this->widget_apply, &QPushButton::clicked, this, &Panel::Window::receiveApply);
+
+  this->widget_progress = new QProgressBar(this);
+  this->widget_progress->setRange(0, 1000);
+  this->widget_progress->setValue(0);
+  this->widget_progress->setTextVisible(false);
+
+  this->widget_summary = new QLabel(this);
+
+  this->widget_table = new QTableWidget(this);
+  this->widget_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  this->widget_table->setSelectionMode(QAbstractItemView::NoSelection);
+  this->widget_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+  this->widget_table->horizontalHeader()->setStretchLastSection(true);
+
+  controller_layout->addWidget(new QLabel("Objective", this), 0, 0, 1, 1);
+  controller_layout->addWidget(this->widget_objective, 0, 1, 1, 1);
+  controller_layout->addWidget(new QLabel("Spillover weight", this), 0, 2, 1, 1);
+  controller_layout->addWidget(this->widget_weight, 0, 3, 1, 1);
+  controller_layout->addWidget(new QLabel("Minimum signal", this), 1, 0, 1, 1);
+  controller_layout->addWidget(this->widget_minimum, 1, 1, 1, 1);
+  controller_layout->addWidget(new QLabel("Beam width", this), 1, 2, 1, 1);
+  controller_layout->addWidget(this->widget_beam, 1, 3, 1, 1);
+  controller_layout->addWidget(this->widget_start, 2, 0, 1, 1);
+  controller_layout->addWidget(this->widget_progress, 2, 1, 1, 2);
+  controller_layout->addWidget(this->widget_cancel, 2, 3, 1, 1);
+  controller_layout->addWidget(this->widget_summary, 3, 0, 1, 3);
+  controller_layout->addWidget(this->widget_apply, 3, 3, 1, 1);
+  controller_layout->addWidget(this->widget_table, 5, 0, 1, 4);
+
+  this->setRunning(false);
+  this->widget_apply->setEnabled(false);
+}
+
+/*
+Destructor: cancels a running search, the search job cleans up after itself
+*/
+Window::~Window() { this->optimizer_generation.cancel(); }
+
+/*
+Enables/disables the controls depending on the search state
+  :param running: whether a search is running
+*/
+void Window::setRunning(bool running) {
+  this->widget_objective->setEnabled(!running);
+  this->widget_weight->setEnabled(!running);
+  this->widget_minimum->setEnabled(!running);
+  this->widget_beam->setEnabled(!running);
+  this->widget_start->setEnabled(!running);
+  this->widget_cancel->setEnabled(running);
+  if (running) {
+    this->widget_apply->setEnabled(false);
+  }
+}
+
+/*
+(Re)builds the result table from the finished optimizer
+*/
+void Window::buildTable() {
+  this->widget_table->clear();
+  this->widget_table->setColumnCount(3);
+  this->widget_table->setHorizontalHeaderLabels({"Detector", "Fluorophore", "Signal"});
+
+  if (!this->optimizer || this->optimizer->isCancelled()) {
+    this->widget_table->setRowCount(0);
+    this->widget_summary->setText(this->optimizer ? "Cancelled" : QString());
+    return;
+  }
+
+  const Data::PanelOptimizer::Result& result = this->optimizer->result();
+  const Data::SpilloverMatrix& matrix = this->optimizer->matrix();
+
+  int rows = static_cast<int>(result.assignment.size());
+  this->widget_table->setRowCount(rows);
+
+  std::size_t count = 0;
+  for (std::size_t d = 0; d < result.assignment.size(); ++d) {
+    int row = static_cast<int>(d);
+    this->widget_table->setItem(row, 0, new QTableWidgetItem(matrix.detector(d).name));
+
+    std::size_t candidate = result.assignment[d];
+    if (candidate == Data::PanelOptimizer::none) {
+      this->widget_table->setItem(row, 1, new QTableWidgetItem("-"));
+      continue;
+    }
+    ++count;
+
+    this->widget_table->setItem(row, 1, new QTableWidgetItem(this->optimizer->candidateName(candidate)));
+    QTableWidgetItem* item_signal = new QTableWidgetItem(QString::number(matrix.signal(candidate, d), 'f', 3));
+    item_signal->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    this->widget_table->setItem(row, 2, item_signal);
+  }
+
+  this->widget_summary->setText(QString("%1 fluorophores - signal: %2 - total spillover: %3 - worst spillover: %4%")
+                                    .arg(count)
+                                    .arg(result.signal, 0, 'f', 2)
+                                    .arg(result.spillover_total, 0, 'f', 2)
+                                    .arg(result.spillover_worst * 100.0, 0, 'f', 1));
+  this->widget_apply->setEnabled(count > 0);
+}
+
+/*
+Slot: receives the start button click, collects the candidates and starts the search in the background
+*/
+void Window::receiveStart(bool checked) {
+  Q_UNUSED(checked);
+
+  if (!this->fluorophores || this->instrument.isEmpty()) {
+    this->widget_summary->setText("Select an instrument to design a panel for");
+    return;
+  }
+
+  // Every fluorophore of the library is a candidate, the copy shares the spectrum data and is decoded by the job
+  std::shared_ptr<const Data::FluorophoreReader> library = std::make_shared<const Data::FluorophoreReader>(*this->fluorophores);
+
+  Data::PanelOptimizer::Options options;
+  options.objective = static_cast<Data::PanelOptimizer::Objective>(this->widget_objective->currentData().toInt());
+  options.spillover_weight = this->widget_weight->value();
+  options.signal_minimum = this->widget_minimum->value();
+  options.beam_width = static_cast<std::size_t>(this->widget_beam->value());
+
+  std::shared_ptr<Data::PanelOptimizer> optimizer = std::make_shared<Data::PanelOptimizer>();
+  optimizer->setInstrument(this->instrument);
+  optimizer->setOptions(options);
+
+  // The window only holds finished searches
+  this->optimizer.reset();
+  this->buildTable();
+  this->widget_progress->setValue(0);
+  this->widget_summary->setText("Searching...");
+  this->setRunning(true);
+
+  Data::JobToken token = this->optimizer_generation.next();
+  Data::JobReceiver receiver(this);
+
+  Data::JobSystem::instance().submit(
+      [this, receiver, token, optimizer, library]() {
+        std::vector<Data::Spectrum> spectra;
+        QStringList names;
+        library->getLibrary(spectra, names, token);
+        if (token.isCancelled()) {
+          return;
+        }
+        optimizer->setCandidates(std::move(spectra), std::move(names));
+
+        optimizer->run(token, [this, receiver, token](double progress) {
+          receiver.post([this, progress]() { this->widget_progress->setValue(static_cast<int>(progress * 1000.0)); }, token);
+        });
+        receiver.post([this, optimizer]() { this->finishSearch(optimizer); }, token);
+      },
+      Data::JobSystem::Normal, token);
+}
+
+/*
+Receives the finished search on the GUI thread
+  :param optimizer: the finished optimizer
+*/
+void Window::finishSearch(std::shared_ptr<Data::PanelOptimizer> optimizer) {
+  this->optimizer = std::move(optimizer);
+  this->setRunning(false);
+  this->buildTable();
+}
+
+/*
+Slot: receives the cancel button click, the search job is dropped or stops at its next poll of the token
+*/
+void Window::receiveCancel(bool checked) {
+  Q_UNUSED(checked);
+  this->optimizer_generation.cancel();
+  this->setRunning(false);
+  this->widget_progress->setValue(0);
+  this->widget_summary->setText("Cancelled");
+}
+
+/*
+Slot: receives the apply button click, sends the panel to the cache
+*/
+void Window::receiveApply(bool checked) {
+  Q_UNUSED(checked);
+  if (!this->optimizer || this->optimizer->isCancelled()) {
+    return;
+  }
+
+  std::vector<Data::FluorophoreID> panel;
+  unsigned int order = 0;
+  for (std::size_t candidate : this->optimizer->result().assignment) {
+    if (candidate == Data::PanelOptimizer::none) {
+      continue;
+    }
+    panel.emplace_back(this->optimizer->candidate(candidate).id(), this->optimizer->candidateName(candidate), order++);
+  }
+
+  emit this->sendPanel(panel);
+}
+
+/*
+Slot: receives the instrument to design the panel for
+  :param instrument: the instrument
+*/
+void Window::receiveInstrument(const Data::Instrument& instrument) { this->instrument = instrument; }
+
+/*
+Slot: receives the fluorophore library
+  :param fluorophores: the fluorophore reader, has to outlive this window
+*/
+void Window::receiveFluorophores(const Data::FluorophoreReader& fluorophores) { this->fluorophores = &fluorophores; }
+
+}  // namespace Panel
@@ -0,0 +1,335 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "similarity_window.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QSignalBlocker>
+#include <QTableWidgetItem>
+#include <set>
+
+namespace Similarity {
+
+/*
+Constructor: constructs the similar fluorophores window
+  :param parent: parent widget
+*/
+Window::Window(QWidget* parent)
+    : General::StyledWidget(parent),
+      fluorophores(nullptr),
+      library(nullptr),
+      library_names(nullptr),
+      instrument(),
+      index_spectral(nullptr),
+      index_detector(nullptr),
+      matches_index(nullptr),
+      matches(),
+      search_generation(),
+      sources(),
+      widget_source(nullptr),
+      widget_mode(nullptr),
+      widget_count(nullptr),
+      widget_add(nullptr),
+      widget_summary(nullptr),
+      widget_table(nullptr) {
+  this->setWindowTitle("Similar Fluorophores");
+  this->setAttribute(Qt::WA_DeleteOnClose);
+
+  // Set base properties
+  this->setContentsMargins(8, 8, 8, 8);
+
+  // Build layout
+  QGridLayout* controller_layout = new QGridLayout(this);
+  controller_layout->setRowStretch(0, 0);
+  controller_layout->setRowStretch(1, 0);
+  controller_layout->setRowStretch(2, 1);
+  controller_layout->setColumnStretch(0, 1);
+  controller_layout->setColumnStretch(1, 0);
+  controller_layout->setColumnStretch(2, 0);
+  controller_layout->setContentsMargins(0, 0, 0, 0);
+  controller_layout->setSpacing(6);
+
+  this->widget_source = new QComboBox(this);
+  QObject::connect(this->widget_source, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &Similarity::Window::receiveSource);
+
+  this->widget_mode = new QComboBox(this);
+  this->widget_mode->addItem("Spectrum", static_cast<int>(Data::SimilarityIndex::Spectral));
+  this->widget_mode->addItem("Detectors", static_cast<int>(Data::SimilarityIndex::Detector));
+  QObject::connect(this->widget_mode, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &Similarity::Window::receiveMode);
+
+  this->widget_count = new QSpinBox(this);
+  this->widget_count->setRange(1, 100);
+  this->widget_count->setValue(10);
+  QObject::connect(this->widget_count, QOverload<int>::of(&QSpinBox::valueChanged), this, &Similarity::Window::receiveCount);
+
+  this->widget_add = new QPushButton("Add", this);
+  this->widget_add->setEnabled(false);
+  QObject::connect(this->widget_add, &QPushButton::clicked, this, &Similarity::Window::receiveAdd);
+
+  this->widget_summary = new QLabel(this);
+
+  this->widget_table = new QTableWidget(this);
+  this->widget_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  this->widget_table->setSelectionMode(QAbstractItemView::ExtendedSelection);
+  this->widget_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+  this->widget_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+  this->widget_table->horizontalHeader()->setStretchLastSection(true);
+
+  controller_layout->addWidget(this->widget_source, 0, 0, 1, 1);
+  controller_layout->addWidget(this->widget_mode, 0, 1, 1, 1);
+  controller_layout->addWidget(this->widget_count, 0, 2, 1, 1);
+  controller_layout->addWidget(this->widget_summary, 1, 0, 1, 2);
+  controller_layout->addWidget(this->widget_add, 1, 2, 1, 1);
+  controller_layout->addWidget(this->widget_table, 2, 0, 1, 3);
+}
+
+/*
+Getter for the (cached) index of a mode
+  :param mode: the index mode
+*/
+std::shared_ptr<const Data::SimilarityIndex>& Window::index(Data::SimilarityIndex::Mode mode) {
+  if (mode == Data::SimilarityIndex::Detector) {
+    return this->index_detector;
+  }
+  return this->index_spectral;
+}
+
+/*
+Searches the library for the fluorophores most similar to the source. The search runs as a job and supersedes the
+previous search, the library is decoded and the index is built by the job if necessary.
+*/
+void Window::search() {
+  int source = this->widget_source->currentIndex();
+  if (source < 0 || static_cast<std::size_t>(source) >= this->sources.size() || !this->sources[static_cast<std::size_t>(source)].data) {
+    this->search_generation.cancel();
+    this->matches.clear();
+    this->matches_index.reset();
+    this->widget_summary->clear();
+    this->buildTable();
+    return;
+  }
+  const Cache::ID& id = this->sources[static_cast<std::size_t>(source)];
+
+  // The library is decoded by the job upon first use, the copy of the reader shares the spectrum data
+  std::shared_ptr<const Data::FluorophoreReader> reader;
+  if (!this->library && this->fluorophores) {
+    reader = std::make_shared<const Data::FluorophoreReader>(*this->fluorophores);
+  }
+
+  Data::SimilarityIndex::Mode mode = static_cast<Data::SimilarityIndex::Mode>(this->widget_mode->currentData().toInt());
+  std::shared_ptr<const Data::SimilarityIndex> index = this->index(mode);
+  if (!index || index->isEmpty()) {
+    this->widget_summary->setText("Building the index...");
+  }
+
+  // Everything the job needs is copied, the window can change (or close) while it runs
+  std::shared_ptr<const std::vector<Data::Spectrum>> library = this->library;
+  std::shared_ptr<const QStringList> library_names = this->library_names;
+  Data::Instrument instrument = this->instrument;
+  QString source_id = id.id;
+  Data::Spectrum source_spectrum = id.data->spectrum();
+  std::size_t count = static_cast<std::size_t>(this->widget_count->value());
+
+  Data::JobToken token = this->search_generation.next();
+  Data::JobReceiver receiver(this);
+
+  Data::JobSystem::instance().submit(
+      [this, receiver, token, mode, index, library, library_names, reader, instrument, source_id, source_spectrum, count]() mutable {
+        QElapsedTimer timer;
+        timer.start();
+
+        if (reader) {
+          std::vector<Data::Spectrum> spectra;
+          QStringList names;
+          reader->getLibrary(spectra, names, token);
+          if (token.isCancelled()) {
+            return;
+          }
+          library = std::make_shared<const std::vector<Data::Spectrum>>(std::move(spectra));
+          library_names = std::make_shared<const QStringList>(std::move(names));
+        }
+
+        std::shared_ptr<const Data::SimilarityIndex> searched = index;
+        if (!searched || searched->isEmpty()) {
+          std::shared_ptr<Data::SimilarityIndex> built = std::make_shared<Data::SimilarityIndex>();
+          if (library) {
+            built->setInstrument(instrument);
+            built->build(mode, *library, *library_names);
+          }
+          searched = std::move(built);
+        }
+        if (token.isCancelled()) {
+          return;
+        }
+
+        std::vector<Data::SimilarityIndex::Match> matches;
+        std::size_t row = searched->find(source_id);
+        if (row != Data::SimilarityIndex::none) {
+          matches = searched->query(row, count);
+        } else {
+          matches = searched->query(source_spectrum, count);
+        }
+
+        double elapsed = static_cast<double>(timer.nsecsElapsed()) * 1e-6;
+        receiver.post(
+            [this, mode, searched, matches, elapsed, library, library_names]() {
+              this->library = library;
+              this->library_names = library_names;
+              this->finishSearch(mode, searched, matches, elapsed);
+            },
+            token);
+      },
+      Data::JobSystem::Normal, token);
+}
+
+/*
+Receives the result of the (latest) search job on the GUI thread
+  :param mode: the searched index mode
+  :param index: the searched index, is cached for the next search
+  :param matches: the matches
+  :param elapsed: the search duration in ms, including the building of the index
+*/
+void Window::finishSearch(Data::SimilarityIndex::Mode mode, std::shared_ptr<const Data::SimilarityIndex> index,
+                          std::vector<Data::SimilarityIndex::Match> matches, double elapsed) {
+  this->index(mode) = index;
+  this->matches_index = std::move(index);
+  this->matches = std::move(matches);
+
+  this->widget_summary->setText(QString("Searched %1 fluorophores in %2 ms").arg(this->matches_index->size()).arg(elapsed, 0, 'f', 2));
+  this->buildTable();
+}
+
+/*
+(Re)builds the table from the matches
+*/
+void Window::buildTable() {
+  this->widget_table->clear();
+  this->widget_table->setColumnCount(2);
+  this->widget_table->setHorizontalHeaderLabels({"Fluorophore", "Similarity (%)"});
+  this->widget_table->setRowCount(static_cast<int>(this->matches.size()));
+
+  for (std::size_t i = 0; i < this->matches.size(); ++i) {
+    int row = static_cast<int>(i);
+    this->widget_table->setItem(row, 0, new QTableWidgetItem(this->matches_index->name(this->matches[i].index)));
+
+    QTableWidgetItem* item_similarity = new QTableWidgetItem(QString::number(this->matches[i].similarity * 100.0, 'f', 1));
+    item_similarity->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    this->widget_table->setItem(row, 1, item_similarity);
+  }
+
+  this->widget_add->setEnabled(!this->matches.empty());
+}
+
+/*
+Slot: receives the source combobox changes
+  :param index: the combobox index
+*/
+void Window::receiveSource(int index) {
+  Q_UNUSED(index);
+  this->search();
+}
+
+/*
+Slot: receives the mode combobox changes
+  :param index: the combobox index
+*/
+void Window::receiveMode(int index) {
+  Q_UNUSED(index);
+  this->search();
+}
+
+/*
+Slot: receives the match count changes
+  :param count: the amount of matches
+*/
+void Window::receiveCount(int count) {
+  Q_UNUSED(count);
+  this->search();
+}
+
+/*
+Slot: receives the add button click, adds the selected matches to the cache
+*/
+void Window::receiveAdd(bool checked) {
+  Q_UNUSED(checked);
+
+  std::set<int> rows;
+  for (const QModelIndex& selected : this->widget_table->selectionModel()->selectedRows()) {
+    rows.insert(selected.row());
+  }
+  if (rows.empty() || !this->matches_index) {
+    return;
+  }
+
+  std::vector<Data::FluorophoreID> fluorophores;
+  unsigned int order = 0;
+  for (int row : rows) {
+    const Data::SimilarityIndex::Match& match = this->matches[static_cast<std::size_t>(row)];
+    fluorophores.emplace_back(this->matches_index->id(match.index), this->matches_index->name(match.index), order++);
+  }
+
+  emit this->sendCacheAdd(fluorophores);
+}
+
+/*
+Slot: receives the fluorophore library, invalidates the indexes
+  :param fluorophores: the fluorophore reader, has to outlive this window
+*/
+void Window::receiveFluorophores(const Data::FluorophoreReader& fluorophores) {
+  this->search_generation.cancel();
+  this->fluorophores = &fluorophores;
+  this->library.reset();
+  this->library_names.reset();
+  this->index_spectral.reset();
+  this->index_detector.reset();
+  if (this->isVisible()) {
+    this->search();
+  }
+}
+
+/*
+Slot: receives the instrument, invalidates the detector index
+  :param instrument: the instrument
+*/
+void Window::receiveInstrument(const Data::Instrument& instrument) {
+  this->search_generation.cancel();
+  this->instrument = instrument;
+  this->index_detector.reset();
+  if (this->isVisible()) {
+    this->search();
+  }
+}
+
+/*
+Slot: receives the cache state, the fluorophores that can be searched for
+  :param cache_state: the state of the cache
+*/
+void Window::receiveCacheState(const std::vector<Cache::ID>& cache_state) {
+  QString current = this->widget_source->currentData().toString();
+  this->sources = cache_state;
+
+  // Rebuilding the combobox should only search once
+  QSignalBlocker blocker(this->widget_source);
+  this->widget_source->clear();
+  int select = 0;
+  for (std::size_t i = 0; i < this->sources.size(); ++i) {
+    this->widget_source->addItem(this->sources[i].name, this->sources[i].id);
+    if (this->sources[i].id == current) {
+      select = static_cast<int>(i);
+    }
+  }
+  this->widget_source->setCurrentIndex(this->sources.empty() ? -1 : select);
+  blocker.unblock();
+
+  this->search();
+}
+
+}  // namespace Similarity
@@ -0,0 +1,250 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "spillover_window.h"
+
+#include <QDebug>
+#include <QFileDialog>
+#include <QFont>
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QSaveFile>
+#include <QTableWidgetItem>
+#include <cmath>
+
+namespace Spillover {
+
+/*
+Constructor: constructs the spillover window
+  :param parent: parent widget
+*/
+Window::Window(QWidget* parent)
+    : General::StyledWidget(parent),
+      matrix(),
+      signature(),
+      matrix_mode(Window::Spillover),
+      widget_mode(nullptr),
+      widget_complexity(nullptr),
+      widget_export(nullptr),
+      widget_table(nullptr) {
+  this->setWindowTitle("Spillover Matrix");
+  this->setAttribute(Qt::WA_DeleteOnClose);
+
+  // Set base properties
+  this->setContentsMargins(8, 8, 8, 8);
+
+  // Build layout
+  QGridLayout* controller_layout = new QGridLayout(this);
+  controller_layout->setRowStretch(0, 0);
+  controller_layout->setRowStretch(1, 1);
+  controller_layout->setColumnStretch(0, 0);
+  controller_layout->setColumnStretch(1, 1);
+  controller_layout->setColumnStretch(2, 0);
+  controller_layout->setContentsMargins(0, 0, 0, 0);
+  controller_layout->setSpacing(6);
+
+  this->widget_mode = new QComboBox(this);
+  this->widget_mode->addItem("Spillover (%)", static_cast<int>(Window::Spillover));
+  this->widget_mode->addItem("Signal", static_cast<int>(Window::Signal));
+  this->widget_mode->addItem("Similarity", static_cast<int>(Window::Similarity));
+  QObject::connect(this->widget_mode, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &Spillover::Window::receiveMode);
+
+  this->widget_complexity = new QLabel(this);
+
+  this->widget_export = new QPushButton("Export...", this);
+  QObject::connect(this->widget_export, &QPushButton::clicked, this, &Spillover::Window::receiveExport);
+
+  this->widget_table = new QTableWidget(this);
+  this->widget_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  this->widget_table->setSelectionMode(QAbstractItemView::NoSelection);
+  this->widget_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+  this->widget_table->verticalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+  controller_layout->addWidget(this->widget_mode, 0, 0, 1, 1);
+  controller_layout->addWidget(this->widget_complexity, 0, 1, 1, 1);
+  controller_layout->addWidget(this->widget_export, 0, 2, 1, 1);
+  controller_layout->addWidget(this->widget_table, 1, 0, 1, 3);
+}
+
+/*
+(Re)builds the table of the current mode
+*/
+void Window::buildTable() {
+  if (this->matrix_mode == Window::Similarity) {
+    this->buildSimilarity();
+  } else {
+    this->buildSpillover();
+  }
+}
+
+/*
+(Re)builds the table from the spillover matrix
+*/
+void Window::buildSpillover() {
+  int rows = static_cast<int>(this->matrix.fluorophoreCount());
+  int columns = static_cast<int>(this->matrix.detectorCount());
+
+  this->widget_table->clear();
+  this->widget_table->setRowCount(rows);
+  this->widget_table->setColumnCount(columns);
+
+  QStringList header_columns;
+  for (std::size_t j = 0; j < this->matrix.detectorCount(); ++j) {
+    header_columns.append(this->matrix.detector(j).name);
+  }
+  this->widget_table->setHorizontalHeaderLabels(header_columns);
+
+  QStringList header_rows;
+  for (std::size_t i = 0; i < this->matrix.fluorophoreCount(); ++i) {
+    header_rows.append(this->matrix.fluorophore(i));
+  }
+  this->widget_table->setVerticalHeaderLabels(header_rows);
+
+  if (this->matrix.isEmpty()) {
+    return;
+  }
+
+  QFont font_primary = this->widget_table->font();
+  font_primary.setBold(true);
+
+  Data::SpilloverMatrix::Mode mode = this->matrix_mode == Window::Signal ? Data::SpilloverMatrix::Signal : Data::SpilloverMatrix::Spillover;
+
+  for (std::size_t i = 0; i < this->matrix.fluorophoreCount(); ++i) {
+    std::size_t primary = this->matrix.primaryDetector(i);
+    for (std::size_t j = 0; j < this->matrix.detectorCount(); ++j) {
+      double value = this->matrix.value(mode, i, j);
+
+      QTableWidgetItem* item;
+      if (mode == Data::SpilloverMatrix::Spillover) {
+        item = new QTableWidgetItem(QString::number(value * 100.0, 'f', 1));
+      } else {
+        item = new QTableWidgetItem(QString::number(value, 'f', 3));
+      }
+      item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      if (j == primary) {
+        item->setFont(font_primary);
+      }
+
+      this->widget_table->setItem(static_cast<int>(i), static_cast<int>(j), item);
+    }
+  }
+}
+
+/*
+(Re)builds the table from the signature similarity matrix, highly similar pairs are shown in bold
+*/
+void Window::buildSimilarity() {
+  int size = static_cast<int>(this->signature.fluorophoreCount());
+
+  this->widget_table->clear();
+  this->widget_table->setRowCount(size);
+  this->widget_table->setColumnCount(size);
+
+  QStringList header;
+  for (std::size_t i = 0; i < this->signature.fluorophoreCount(); ++i) {
+    header.append(this->signature.fluorophore(i));
+  }
+  this->widget_table->setHorizontalHeaderLabels(header);
+  this->widget_table->setVerticalHeaderLabels(header);
+
+  if (this->signature.isEmpty()) {
+    return;
+  }
+
+  QFont font_similar = this->widget_table->font();
+  font_similar.setBold(true);
+
+  for (std::size_t i = 0; i < this->signature.fluorophoreCount(); ++i) {
+    for (std::size_t j = 0; j < this->signature.fluorophoreCount(); ++j) {
+      double value = this->signature.similarity(i, j);
+
+      QTableWidgetItem* item = new QTableWidgetItem(QString::number(value, 'f', 2));
+      item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      if (i != j && value >= 0.9) {
+        item->setFont(font_similar);
+      }
+
+      this->widget_table->setItem(static_cast<int>(i), static_cast<int>(j), item);
+    }
+  }
+}
+
+/*
+Updates the complexity index label
+*/
+void Window::buildComplexity() {
+  if (this->signature.isEmpty()) {
+    this->widget_complexity->setText(QString());
+    return;
+  }
+
+  double complexity = this->signature.complexity();
+  QString text = std::isinf(complexity) ? QString("not unmixable") : QString::number(complexity, 'f', 2);
+  this->widget_complexity->setText(QString("Complexity index: %1").arg(text));
+}
+
+/*
+Slot: receives the mode combobox changes
+  :param index: the combobox index
+*/
+void Window::receiveMode(int index) {
+  this->matrix_mode = static_cast<Window::Mode>(this->widget_mode->itemData(index).toInt());
+  this->buildTable();
+}
+
+/*
+Slot: receives the export button click, exports the current matrix as .csv
+*/
+void Window::receiveExport(bool checked) {
+  Q_UNUSED(checked);
+
+  QString path = QFileDialog::getSaveFileName(this, "Export Spillover Matrix", QString(), "Comma Separated Values (*.csv)");
+  if (path.isEmpty()) {
+    return;
+  }
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    qWarning() << "Spillover::Window::receiveExport: cannot open" << path;
+    return;
+  }
+  if (this->matrix_mode == Window::Similarity) {
+    file.write(this->signature.toCSV().toUtf8());
+  } else {
+    Data::SpilloverMatrix::Mode mode = this->matrix_mode == Window::Signal ? Data::SpilloverMatrix::Signal : Data::SpilloverMatrix::Spillover;
+    file.write(this->matrix.toCSV(mode).toUtf8());
+  }
+  if (!file.commit()) {
+    qWarning() << "Spillover::Window::receiveExport: cannot write" << path;
+  }
+}
+
+/*
+Slot: receives the (recalculated) spillover matrix
+  :param matrix: the spillover matrix
+*/
+void Window::receiveSpillover(const Data::SpilloverMatrix& matrix) {
+  this->matrix = matrix;
+  if (this->matrix_mode != Window::Similarity) {
+    this->buildTable();
+  }
+}
+
+/*
+Slot: receives the (recalculated) signature matrix
+  :param signature: the signature matrix
+*/
+void Window::receiveSignature(const Data::SignatureMatrix& signature) {
+  this->signature = signature;
+  this->buildComplexity();
+  if (this->matrix_mode == Window::Similarity) {
+    this->buildTable();
+  }
+}
+
+}  // namespace Spillover
@@ -0,0 +1,302 @@
+/**** General **************************************************************
+** Version:    v0.10.2
+** Date:       2026-10-15
+** Author:     AJ Zwijnenburg
+** Copyright:  Copyright (C) 2022 - AJ Zwijnenburg
+** License:    LGPLv3
+***************************************************************************/
+
+#include "spreading_window.h"
+
+#include <QDebug>
+#include <QFileDialog>
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QSaveFile>
+#include <QTableWidgetItem>
+#include <limits>
+
+#include "data_jobs.h"
+
+namespace Spreading {
+
+/*
+Constructor: constructs the spreading simulation window
+  :param parent: parent widget
+*/
+Window::Window(QWidget* parent)
+    : General::StyledWidget(parent),
+      matrix(),
+      simulation(nullptr),
+      simulation_generation(),
+      simulation_time(),
+      widget_events(nullptr),
+      widget_brightness(nullptr),
+      widget_background(nullptr),
+      widget_noise(nullptr),
+      widget_seed(nullptr),
+      widget_start(nullptr),
+      widget_cancel(nullptr),
+      widget_export(nullptr),
+      widget_progress(nullptr),
+      widget_summary(nullptr),
+      widget_table(nullptr) {
+  this->setWindowTitle("Spillover Spreading");
+  this->setAttribute(Qt::WA_DeleteOnClose);
+
+  // Set base properties
+  this->setContentsMargins(8, 8, 8, 8);
+
+  // Build layout
+  QGridLayout* controller_layout = new QGridLayout(this);
+  controller_layout->setColumnStretch(0, 0);
+  controller_layout->setColumnStretch(1, 1);
+  controller_layout->setColumnStretch(2, 0);
+  controller_layout->setColumnStretch(3, 1);
+  controller_layout->setRowStretch(6, 1);
+  controller_layout->setContentsMargins(0, 0, 0, 0);
+  controller_layout->setSpacing(6);
+
+  Data::SpreadingSimulation::Options options;
+
+  this->widget_events = new QSpinBox(this);
+  this->widget_events->setRange(1000, 100000000);
+  this->widget_events->setSingleStep(10000);
+  this->widget_events->setValue(static_cast<int>(options.events));
+
+  this->widget_brightness = new QDoubleSpinBox(this);
+  this->widget_brightness->setRange(1.0, 10000000.0);
+  this->widget_brightness->setDecimals(0);
+  this->widget_brightness->setSingleStep(1000.0);
+  this->widget_brightness->setValue(options.brightness);
+
+  this->widget_background = new QDoubleSpinBox(this);
+  this->widget_background->setRange(0.0, 100000.0);
+  this->widget_background->setDecimals(1);
+  this->widget_background->setSingleStep(10.0);
+  this->widget_background->setValue(options.background);
+
+  this->widget_noise = new QDoubleSpinBox(this);
+  this->widget_noise->setRange(0.0, 10000.0);
+  this->widget_noise->setDecimals(1);
+  this->widget_noise->setSingleStep(1.0);
+  this->widget_noise->setValue(options.noise);
+
+  this->widget_seed = new QSpinBox(this);
+  this->widget_seed->setRange(0, std::numeric_limits<int>::max());
+  this->widget_seed->setValue(static_cast<int>(options.seed));
+
+  this->widget_start = new QPushButton("Start", this);
+  QObject::connect(this->widget_start, &QPushButton::clicked, this, &Spreading::Window::receiveStart);
+
+  this->widget_cancel = new QPushButton("Cancel", this);
+  QObject::connect(this->widget_cancel, &QPushButton::clicked, this, &Spreading::Window::receiveCancel);
+
+  this->widget_export = new QPushButton("Export...", this);
+  QObject::connect(this->widget_export, &QPushButton::clicked, this, &Spreading::Window::receiveExport);
+
+  this->widget_progress = new QProgressBar(this);
+  this->widget_progress->setRange(0, 1000);
+  this->widget_progress->setValue(0);
+  this->widget_progress->setTextVisible(false);
+
+  this->widget_summary = new QLabel(this);
+
+  this->widget_table = new QTableWidget(this);
+  this->widget_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  this->widget_table->setSelectionMode(QAbstractItemView::NoSelection);
+  this->widget_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+  this->widget_table->verticalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+  controller_layout->addWidget(new QLabel("Events per control", this), 0, 0, 1, 1);
+  controller_layout->addWidget(this->widget_events, 0, 1, 1, 1);
+  controller_layout->addWidget(new QLabel("Brightness (photons)", this), 0, 2, 1, 1);
+  controller_layout->addWidget(this->widget_brightness, 0, 3, 1, 1);
+  controller_layout->addWidget(new QLabel("Background (photons)", this), 1, 0, 1, 1);
+  controller_layout->addWidget(this->widget_background, 1, 1, 1, 1);
+  controller_layout->addWidget(new QLabel("Detector noise (SD)", this), 1, 2, 1, 1);
+  controller_layout->addWidget(this->widget_noise, 1, 3, 1, 1);
+  controller_layout->addWidget(new QLabel("Seed", this), 2, 0, 1, 1);
+  controller_layout->addWidget(this->widget_seed, 2, 1, 1, 1);
+  controller_layout->addWidget(this->widget_start, 3, 0, 1, 1);
+  controller_layout->addWidget(this->widget_progress, 3, 1, 1, 2);
+  controller_layout->addWidget(this->widget_cancel, 3, 3, 1, 1);
+  controller_layout->addWidget(this->widget_summary, 4, 0, 1, 3);
+  controller_layout->addWidget(this->widget_export, 4, 3, 1, 1);
+  controller_layout->addWidget(this->widget_table, 6, 0, 1, 4);
+
+  this->setRunning(false);
+  this->widget_export->setEnabled(false);
+}
+
+/*
+Destructor: cancels a running simulation, the simulation job cleans up after itself
+*/
+Window::~Window() { this->simulation_generation.cancel(); }
+
+/*
+Enables/disables the controls depending on the simulation state
+  :param running: whether a simulation is running
+*/
+void Window::setRunning(bool running) {
+  this->widget_events->setEnabled(!running);
+  this->widget_brightness->setEnabled(!running);
+  this->widget_background->setEnabled(!running);
+  this->widget_noise->setEnabled(!running);
+  this->widget_seed->setEnabled(!running);
+  this->widget_start->setEnabled(!running);
+  this->widget_cancel->setEnabled(running);
+  if (running) {
+    this->widget_export->setEnabled(false);
+  }
+}
+
+/*
+(Re)builds the spillover spreading table from the finished simulation
+*/
+void Window::buildTable() {
+  this->widget_table->clear();
+
+  if (!this->simulation || this->simulation->isCancelled()) {
+    this->widget_table->setRowCount(0);
+    this->widget_table->setColumnCount(0);
+    this->widget_summary->setText(this->simulation ? "Cancelled" : QString());
+    return;
+  }
+
+  if (this->simulation->isEmpty()) {
+    this->widget_table->setRowCount(0);
+    this->widget_table->setColumnCount(0);
+    this->widget_summary->setText(this->simulation->fluorophoreCount() == 0 ? "No fluorophores to simulate" : "Not unmixable");
+    return;
+  }
+
+  int size = static_cast<int>(this->simulation->fluorophoreCount());
+  this->widget_table->setRowCount(size);
+  this->widget_table->setColumnCount(size);
+
+  QStringList header;
+  for (std::size_t i = 0; i < this->simulation->fluorophoreCount(); ++i) {
+    header.append(this->simulation->fluorophore(i));
+  }
+  this->widget_table->setHorizontalHeaderLabels(header);
+  this->widget_table->setVerticalHeaderLabels(header);
+
+  for (std::size_t i = 0; i < this->simulation->fluorophoreCount(); ++i) {
+    for (std::size_t j = 0; j < this->simulation->fluorophoreCount(); ++j) {
+      QTableWidgetItem* item;
+      if (i == j) {
+        item = new QTableWidgetItem("-");
+      } else {
+        item = new QTableWidgetItem(QString::number(this->simulation->spreading(i, j), 'f', 2));
+      }
+      item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      this->widget_table->setItem(static_cast<int>(i), static_cast<int>(j), item);
+    }
+  }
+
+  double seconds = static_cast<double>(this->simulation_time.elapsed()) * 0.001;
+  double events = static_cast<double>(this->simulation->eventCount());
+  this->widget_summary->setText(QString("%1 events in %2 s (%3 million events/s)")
+                                    .arg(this->simulation->eventCount())
+                                    .arg(seconds, 0, 'f', 2)
+                                    .arg(seconds > 0.0 ? events / seconds * 1e-6 : 0.0, 0, 'f', 1));
+  this->widget_export->setEnabled(true);
+}
+
+/*
+Slot: receives the start button click, starts the simulation of the current spillover matrix in the background
+*/
+void Window::receiveStart(bool checked) {
+  Q_UNUSED(checked);
+
+  if (this->matrix.isEmpty()) {
+    this->widget_summary->setText("Add fluorophores to simulate");
+    return;
+  }
+
+  Data::SpreadingSimulation::Options options;
+  options.events = static_cast<std::size_t>(this->widget_events->value());
+  options.brightness = this->widget_brightness->value();
+  options.background = this->widget_background->value();
+  options.noise = this->widget_noise->value();
+  options.seed = static_cast<std::uint64_t>(this->widget_seed->value());
+
+  std::shared_ptr<Data::SpreadingSimulation> simulation = std::make_shared<Data::SpreadingSimulation>();
+  simulation->setMatrix(this->matrix);
+  simulation->setOptions(options);
+
+  // The window only holds finished simulations
+  this->simulation.reset();
+  this->buildTable();
+  this->widget_progress->setValue(0);
+  this->widget_summary->setText("Simulating...");
+  this->setRunning(true);
+
+  Data::JobToken token = this->simulation_generation.next();
+  Data::JobReceiver receiver(this);
+
+  this->simulation_time.start();
+  Data::JobSystem::instance().submit(
+      [this, receiver, token, simulation]() {
+        simulation->run(token, [this, receiver, token](double progress) {
+          receiver.post([this, progress]() { this->widget_progress->setValue(static_cast<int>(progress * 1000.0)); }, token);
+        });
+        receiver.post([this, simulation]() { this->finishSimulation(simulation); }, token);
+      },
+      Data::JobSystem::Normal, token);
+}
+
+/*
+Receives the finished simulation on the GUI thread
+  :param simulation: the finished simulation
+*/
+void Window::finishSimulation(std::shared_ptr<Data::SpreadingSimulation> simulation) {
+  this->simulation = std::move(simulation);
+  this->setRunning(false);
+  this->buildTable();
+}
+
+/*
+Slot: receives the cancel button click, the simulation job is dropped or stops at its next poll of the token
+*/
+void Window::receiveCancel(bool checked) {
+  Q_UNUSED(checked);
+  this->simulation_generation.cancel();
+  this->setRunning(false);
+  this->widget_progress->setValue(0);
+  this->widget_summary->setText("Cancelled");
+}
+
+/*
+Slot: receives the export button click, exports the spillover spreading matrix as .csv
+*/
+void Window::receiveExport(bool checked) {
+  Q_UNUSED(checked);
+  if (!this->simulation || this->simulation->isEmpty()) {
+    return;
+  }
+
+  QString path = QFileDialog::getSaveFileName(this, "Export Spillover Spreading Matrix", QString(), "Comma Separated Values (*.csv)");
+  if (path.isEmpty()) {
+    return;
+  }
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    qWarning() << "Spreading::Window::receiveExport: cannot open" << path;
+    return;
+  }
+  file.write(this->simulation->toCSV().toUtf8());
+  if (!file.commit()) {
+    qWarning() << "Spreading::Window::receiveExport: cannot write" << path;
+  }
+}
+
+/*
+Slot: receives the spillover matrix of the cached fluorophores, used by the next simulation
+  :param matrix: the spillover matrix
+*/
+void Window::receiveSpillover(const Data::SpilloverMatrix& matrix) { this->matrix = matrix; }
+
+}  // namespace Spreading
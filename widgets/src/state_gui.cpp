@@ -15,20 +15,26 @@ namespace State {
 /*
 Constructor: construct default graph state, internal vector has size 0
 */
-GraphState::GraphState() : graph_lasers(), graph_laserline(nullptr), selected(false), visible_lasers(false), visible_filters(false) {}
+GraphState::GraphState()
+    : graph_lasers(), graph_laserline(nullptr), graph_filter_labels(), selected(false), visible_lasers(false), visible_filters(false) {}
 
 /*
 Constructor: construct graph state, internal vector has size 0, with the specified visibility states
 */
 GraphState::GraphState(bool visible_lasers, bool visible_filters)
-    : graph_lasers(), graph_laserline(nullptr), selected(false), visible_lasers(visible_lasers), visible_filters(visible_filters) {}
+    : graph_lasers(),
+      graph_laserline(nullptr),
+      graph_filter_labels(),
+      selected(false),
+      visible_lasers(visible_lasers),
+      visible_filters(visible_filters) {}
 
 /*
 Constructor: constructs graph state, internal vector has size of the given size
   :param size: the reserved size of the laser vector
 */
 GraphState::GraphState(std::size_t size)
-    : graph_lasers(), graph_laserline(nullptr), selected(false), visible_lasers(false), visible_filters(false) {
+    : graph_lasers(), graph_laserline(nullptr), graph_filter_labels(), selected(false), visible_lasers(false), visible_filters(false) {
   this->graph_lasers.reserve(size);
 }
 
@@ -85,6 +91,16 @@ Sets the LaserLine pointer (is allowed to be nullptr)
 */
 void GraphState::setLaserLine(const Data::LaserLine* laserline) { this->graph_laserline = laserline; }
 
+/*
+Returns the labels of the laserline's filters, can be smaller then the amount of filters
+*/
+const std::vector<FilterLabel>& GraphState::filterLabels() const { return this->graph_filter_labels; }
+
+/*
+Returns a non-const filter label vector, for modification
+*/
+std::vector<FilterLabel>& GraphState::setFilterLabels() { return this->graph_filter_labels; }
+
 /* ############################################################################## */
 
 /*
@@ -11,11 +11,18 @@
 #include <QApplication>
 #include <QDebug>
 #include <QDesktopWidget>
+#include <QFileDialog>
 #include <QFont>
 #include <QFontMetrics>
+#include <QInputDialog>
 #include <QScreen>
 #include <QWindow>
+#include <algorithm>
+#include <memory>
 
+#include "data_fcs.h"
+#include "data_jobs.h"
+#include "data_trace.h"
 #include "general_widgets.h"
 
 namespace State {
@@ -30,23 +37,47 @@ Program::Program(Data::Factory& factory)
       data_instruments(),
       style(),
       instrument(),
+      spillover(),
+      signature(),
+      assignment(),
       cache(this->factory, this->data_fluorophores),
       state_gui(),
-      gui() {
-  // Load fluorophore data
-  if (!this->factory.isValid(Data::Factory::Fluorophores)) {
-    qWarning() << "State::State: invalid Factory::Fluorophores";
-  } else {
-    this->data_fluorophores.load(this->factory);
-  }
+      gui(),
+      window_spillover(nullptr),
+      window_panel(nullptr),
+      window_similarity(nullptr),
+      window_spreading(nullptr),
+      window_compensation(nullptr),
+      window_catalogue(nullptr),
+      loaded_instruments(false),
+      events_x(nullptr),
+      events_y(nullptr),
+      events_generation(),
+      jobs() {
+  DATA_TRACE_SCOPE("Program::Program");
+
+  // Retreive the GUI State data, this selects the style
+  this->retreiveGUIState();
 
-  // Load instrument data
-  if (!this->factory.isValid(Data::Factory::Instruments)) {
-    qWarning() << "State::State: invalid Factory::Instruments";
+  // Parse the style concurrently with the data files, the style is applied before the GUI is shown
+  Data::StyleBuilder style;
+  Data::JobGroup style_job;
+  if (this->factory.isValid(Data::Factory::Styles)) {
+    style_job.submit(
+        [&style, factory = this->factory, style_id = this->state_gui.style]() {
+          DATA_TRACE_SCOPE("Program::readStyle");
+          style.readStyle(factory, style_id);
+        },
+        Data::JobSystem::High);
   } else {
-    this->data_instruments.load(this->factory);
+    qWarning() << "Program::Program: invalid Data::Factory::Styles - cannot load style" << this->state_gui.style;
   }
-  this->retreiveInstrument();
+
+  // Parse the fluorophore and instrument data in the background, the GUI is shown before the data is available
+  this->loadData();
+
+  // No instrument until the instruments are loaded
+  this->loadInstrument(QString());
 
   // Set global font size (for proper dpi scaling) (relevant if the primary screen is scaled)
   qreal dpi_scale = qApp->screens()[qApp->desktop()->primaryScreen()]->logicalDotsPerInch() / 96.0;
@@ -87,15 +118,14 @@ Program::Program(Data::Factory& factory)
   // Graphs
   QObject::connect(this, &State::Program::sendGraphState, &this->gui, &Main::Controller::receiveGraphState);
   QObject::connect(&this->gui, &Main::Controller::sendGraphSelect, this, &State::Program::receiveGraphSelect);
+  QObject::connect(this, &State::Program::sendEvents, &this->gui, &Main::Controller::receiveEvents);
 
   // Laser selection
   QObject::connect(&this->gui, &Main::Controller::sendLasers, this, &State::Program::receiveLasers);
 
-  // Retreive the GUI State data
-  this->retreiveGUIState();
-
-  // (Try to) load the default style
-  this->loadStyle(this->state_gui.style);
+  // Build the stylesheet with the (dpi scaled) font
+  style_job.wait();
+  this->finishStyle(style);
 
   // Start GUI
   this->gui.show();
@@ -103,9 +133,7 @@ Program::Program(Data::Factory& factory)
   // Retreive the GUI position data
   this->retreiveGUIPosition();
 
-  // Synchronize the program state to the GUI
-  this->syncFluorophores();
-  this->syncInstruments();
+  // Synchronize the program state to the GUI, the fluorophores and instruments are synchronized once loaded
   this->syncStyles();
   this->syncInstrument();
   this->syncStyle();
@@ -115,14 +143,114 @@ Program::Program(Data::Factory& factory)
   this->syncGraphs();
 }
 
+/*
+Destructor: cancels the loading of events, the member destructor of jobs waits for the running loads
+*/
+Program::~Program() { this->events_generation.cancel(); }
+
+/*
+Starts loading the fluorophore and instrument data files, each as its own job. The jobs work on a copy of the factory
+and their own reader, the results are handed to the program on the GUI thread. A stale spectrum database is compiled
+by a low priority job after the fluorophores are handed over. The jobs are joined upon destruction.
+*/
+void Program::loadData() {
+  Data::JobReceiver receiver(this);
+
+  if (!this->factory.isValid(Data::Factory::Fluorophores)) {
+    qWarning() << "State::State: invalid Factory::Fluorophores";
+  } else {
+    this->retreiveLoadMode();
+    std::shared_ptr<Data::FluorophoreReader> fluorophores = std::make_shared<Data::FluorophoreReader>(this->data_fluorophores);
+
+    this->jobs.submit([this, receiver, factory = this->factory, fluorophores]() mutable {
+      DATA_TRACE_SCOPE("Program::loadFluorophores");
+      fluorophores->load(factory);
+
+      // The copy shares the (lazy) spectrum data, so compiling does not conflict with the GUI taking over the reader
+      std::shared_ptr<const Data::FluorophoreReader> source;
+      if (fluorophores->isValid() && !fluorophores->isCompiled()) {
+        source = std::make_shared<const Data::FluorophoreReader>(*fluorophores);
+      }
+
+      receiver.post([this, fluorophores]() { this->finishFluorophores(*fluorophores); });
+
+      // (Re)compile the stale spectrum database afterwards, speeds up the next start without delaying this one
+      if (source) {
+        this->jobs.submit(
+            [factory, source]() {
+              DATA_TRACE_SCOPE("Program::compileFluorophores");
+              if (!source->compile(factory)) {
+                qWarning() << "State::State: could not compile the fluorophore spectrum database";
+              }
+            },
+            Data::JobSystem::Low);
+      }
+    });
+  }
+
+  if (!this->factory.isValid(Data::Factory::Instruments)) {
+    qWarning() << "State::State: invalid Factory::Instruments";
+  } else {
+    std::shared_ptr<Data::InstrumentReader> instruments = std::make_shared<Data::InstrumentReader>();
+
+    this->jobs.submit([this, receiver, factory = this->factory, instruments]() {
+      DATA_TRACE_SCOPE("Program::loadInstruments");
+      instruments->load(factory);
+
+      receiver.post([this, instruments]() { this->finishInstruments(*instruments); });
+    });
+  }
+}
+
+/*
+Takes over the loaded fluorophore data and synchronizes it to the GUI, enables the fluorophore input
+  :param fluorophores: the loaded fluorophore reader, is moved from
+*/
+void Program::finishFluorophores(Data::FluorophoreReader& fluorophores) {
+  DATA_TRACE_SCOPE("Program::finishFluorophores");
+  this->data_fluorophores = std::move(fluorophores);
+  this->syncFluorophores();
+}
+
+/*
+Takes over the loaded instrument data and synchronizes it to the GUI, enables the instrument menu and (re)selects the
+instrument of the previous session
+  :param instruments: the loaded instrument reader, is moved from
+*/
+void Program::finishInstruments(Data::InstrumentReader& instruments) {
+  DATA_TRACE_SCOPE("Program::finishInstruments");
+  this->data_instruments = std::move(instruments);
+  this->loaded_instruments = true;
+
+  this->syncInstruments();
+
+  this->retreiveInstrument();
+  this->syncInstrument();
+  this->syncToolbar();
+  this->syncGraphs();
+  emit this->sendCacheState(this->cache.state());
+  this->syncSpillover();
+}
+
+/*
+Takes over the parsed style, builds its stylesheet and applies it to the GUI
+  :param style: the parsed style, is moved from
+*/
+void Program::finishStyle(Data::StyleBuilder& style) {
+  DATA_TRACE_SCOPE("Program::finishStyle");
+  this->style = std::move(style);
+  if (!this->style.id().isEmpty()) {
+    this->style.buildStyleSheet();
+  }
+  this->gui.setStyleSheet(this->style.getStyleSheet());
+}
+
 /*
 Retreives the GUI state from the stored settings data. Load this data before setting a stylesheet.
 */
 void Program::retreiveGUIState() {
   if (!this->factory.isValid(Data::Factory::Settings)) {
     qWarning() << "Program::retreiveGUIState: invalid Data::Factory::Settings - cannot load GUI state";
-    // Load default style
-    this->loadStyle(this->state_gui.style);
     return;
   }
   std::unique_ptr<QSettings> data = this->factory.get(Data::Factory::Settings);
@@ -236,6 +364,27 @@ void Program::retreiveInstrument() {
   this->loadInstrument(instrument_id);
 }
 
+/*
+Retreive the fluorophore load mode from the settings, used if the compiled fluorophore database is stale
+*/
+void Program::retreiveLoadMode() {
+  if (!this->factory.isValid(Data::Factory::Settings)) {
+    return;
+  }
+  std::unique_ptr<QSettings> data = this->factory.get(Data::Factory::Settings);
+
+  QString load_mode = data->value("DEFAULT/load_mode", QString()).toString();
+  load_mode = data->value("USER/load_mode", load_mode).toString();
+  if (load_mode == "Document") {
+    this->data_fluorophores.setLoadMode(Data::FluorophoreReader::Document);
+  } else if (load_mode == "Lazy") {
+    this->data_fluorophores.setLoadMode(Data::FluorophoreReader::Lazy);
+  } else if (load_mode == "Eager") {
+    this->data_fluorophores.setLoadMode(Data::FluorophoreReader::Eager);
+  }
+  // If QString isNull() it keeps the hardcoded default
+}
+
 /*
 Stores the gui state to the settings.ini file.
 */
@@ -271,7 +420,10 @@ void Program::storeStateGUI() {
   data->setValue("window_maximized", this->gui.isMaximized());
 
   data->setValue("style", this->state_gui.style);
-  data->setValue("instrument", this->instrument.id());
+  // Keep the stored instrument if the instruments were never loaded
+  if (this->loaded_instruments) {
+    data->setValue("instrument", this->instrument.id());
+  }
 
   switch (this->state_gui.sort_fluorophores) {
     case SortMode::Additive: {
@@ -331,7 +483,16 @@ void Program::syncToolbar() {
 /*
 Synchronizes the graphs state to the GUI (needed by the graph controller)
 */
-void Program::syncGraphs() { emit this->sendGraphState(this->state_gui.graphs()); }
+void Program::syncGraphs() {
+  this->labelGraphs();
+  emit this->sendGraphState(this->state_gui.graphs());
+
+  // The shown lasers can have changed
+  this->syncLasers();
+
+  // New graphs need the events, the existing graphs ignore the unchanged events
+  this->syncEvents();
+}
 
 /*
 Synchronizes the cache state to the GUI state (needed by the fluor scrollarea)
@@ -341,8 +502,16 @@ void Program::syncCache() {
 
   // Need to synchronize as the sort order can be changed
   emit this->sendCacheState(this->cache.state());
+
+  this->syncSpillover();
+  this->syncAssignment();
 }
 
+/*
+Synchronizes the events of the density overlay to the graphs
+*/
+void Program::syncEvents() { emit this->sendEvents(this->events_x, this->events_y); }
+
 /*
 Synchronizes the fluorophore to the GUI (needed by the fluor lineedit)
 */
@@ -384,10 +553,174 @@ void Program::syncOptions() {
   emit this->sendMenuBarState(Main::MenuBarAction::SortOrder, static_cast<int>(this->state_gui.sort_fluorophores));
 }
 
+/*
+Updates the spillover and signature matrices to the cached fluorophores and synchronizes them to the spillover and spreading windows
+(if shown). Only the fluorophores that are new to the matrices are calculated.
+*/
+void Program::syncSpillover() {
+  // Only calculate while someone is looking at it
+  if (!this->window_spillover && !this->window_spreading) {
+    return;
+  }
+
+  std::vector<const Data::Spectrum*> spectra;
+  QStringList names;
+  for (const Cache::ID& id : this->cache.state()) {
+    if (id.data) {
+      spectra.push_back(&id.data->spectrum());
+      names.append(id.name);
+    }
+  }
+
+  this->spillover.sync(spectra, names);
+  this->signature.sync(this->spillover);
+  this->updateLasers(spectra);
+
+  emit this->sendSpillover(this->spillover);
+  emit this->sendSignature(this->signature);
+}
+
+/*
+Updates the spillover and signature matrices to the lasers shown in the graphs and synchronizes them to the spillover and
+spreading windows (if shown and changed)
+*/
+void Program::syncLasers() {
+  if (!this->window_spillover && !this->window_spreading) {
+    return;
+  }
+
+  std::vector<const Data::Spectrum*> spectra;
+  for (const Cache::ID& id : this->cache.state()) {
+    if (id.data) {
+      spectra.push_back(&id.data->spectrum());
+    }
+  }
+
+  // The matrices are not of the cached fluorophores (the instrument has changed), update them completely
+  if (spectra.size() != this->spillover.fluorophoreCount()) {
+    this->syncSpillover();
+    return;
+  }
+
+  if (this->updateLasers(spectra)) {
+    emit this->sendSpillover(this->spillover);
+    emit this->sendSignature(this->signature);
+  }
+}
+
+/*
+Sets the lasers of every laserline in the spillover matrix. A laserline shown in any graph uses the lasers shown in those graphs,
+otherwise all lasers of the laserline. Only the detectors of the changed laserlines are recalculated.
+  :param spectra: the spectra of the rows of the matrices
+  :returns: whether any laserline has changed
+*/
+bool Program::updateLasers(const std::vector<const Data::Spectrum*>& spectra) {
+  bool changed = false;
+
+  for (std::size_t i = 0; i < this->instrument.optics().size(); ++i) {
+    const Data::LaserLine& laserline = this->instrument.optics()[i];
+
+    std::vector<double> wavelengths;
+    bool shown = false;
+    for (const State::GraphState& graph : this->state_gui.graphs()) {
+      if (graph.laserLine() != &laserline) {
+        continue;
+      }
+      shown = true;
+      for (const Data::Laser& laser : graph.lasers()) {
+        if (std::find(wavelengths.begin(), wavelengths.end(), laser.wavelength()) == wavelengths.end()) {
+          wavelengths.push_back(laser.wavelength());
+        }
+      }
+    }
+    if (!shown) {
+      for (const Data::Laser& laser : laserline.lasers()) {
+        wavelengths.push_back(laser.wavelength());
+      }
+    }
+
+    if (this->spillover.setLasers(i, wavelengths, spectra)) {
+      std::pair<std::size_t, std::size_t> range = this->spillover.detectorRange(i);
+      this->signature.updateChannels(this->spillover, range.first, range.second);
+      changed = true;
+    }
+  }
+
+  return changed;
+}
+
+/*
+Assigns the cached fluorophores to the detectors of the instrument and synchronizes the assignment to the graphs (if changed)
+*/
+void Program::syncAssignment() {
+  std::vector<const Data::Spectrum*> spectra;
+  for (const Cache::ID& id : this->cache.state()) {
+    if (id.data) {
+      spectra.push_back(&id.data->spectrum());
+    }
+  }
+
+  // Added fluorophores are solved incrementally, removed fluorophores re-solve
+  this->assignment.sync(spectra);
+
+  if (this->labelGraphs()) {
+    emit this->sendGraphState(this->state_gui.graphs());
+  }
+}
+
+/*
+Labels the filters of the graphs with the assigned fluorophores
+  :returns: whether any label has changed
+*/
+bool Program::labelGraphs() {
+  // Per detector the assigned fluorophore
+  const std::vector<Cache::ID> cache_state = this->cache.state();
+  std::vector<const Cache::ID*> assigned(this->assignment.detectorCount(), nullptr);
+  for (const Cache::ID& id : cache_state) {
+    if (!id.data) {
+      continue;
+    }
+    std::size_t detector = this->assignment.assignment(id.id);
+    if (detector != Data::AssignmentSolver::none) {
+      assigned[detector] = &id;
+    }
+  }
+
+  bool changed = false;
+  for (State::GraphState& graph : this->state_gui.graphs()) {
+    std::vector<State::FilterLabel> labels;
+
+    if (graph.laserLine()) {
+      labels.resize(graph.laserLine()->filters().size());
+      for (std::size_t j = 0; j < this->assignment.detectorCount(); ++j) {
+        const Data::SpilloverMatrix::Detector& detector = this->assignment.detector(j);
+        if (!assigned[j] || &this->instrument.optics()[detector.laserline] != graph.laserLine()) {
+          continue;
+        }
+        labels[detector.filter].text = assigned[j]->name;
+        labels[detector.filter].color = assigned[j]->data->spectrum().emission().color();
+      }
+    }
+
+    std::vector<State::FilterLabel>& current = graph.setFilterLabels();
+    bool equal = current.size() == labels.size();
+    for (std::size_t i = 0; equal && i < labels.size(); ++i) {
+      equal = current[i].text == labels[i].text && current[i].color == labels[i].color;
+    }
+    if (!equal) {
+      current = std::move(labels);
+      changed = true;
+    }
+  }
+
+  return changed;
+}
+
 /*
 Loads the style of the specified id into the program (if possible)
 */
 void Program::loadStyle(const QString& style_id) {
+  DATA_TRACE_SCOPE("Program::loadStyle");
   this->state_gui.style = style_id;
 
   if (this->factory.isValid(Data::Factory::Styles)) {
@@ -409,6 +742,9 @@ void Program::loadInstrument(const QString& instrument_id) {
   } else {
     this->instrument = this->data_instruments.getInstrument(instrument_id);
   }
+  this->spillover.setInstrument(this->instrument);
+  this->signature.clear();
+  this->assignment.setInstrument(this->instrument);
 
   // Synchronize the toolbar buttons to the state of the instrument
   if (this->instrument.isEmpty()) {
@@ -437,6 +773,52 @@ void Program::loadInstrument(const QString& instrument_id) {
   this->refreshToolbar();
 }
 
+/*
+Loads the events of the density overlay from an FCS file in a job, superseding the loading of earlier events. The
+columns are read into their own vectors, which are shared with the graphs.
+  :param path: path to the FCS file
+  :param x: the index of the x parameter
+  :param y: the index of the y parameter, Data::FCSReader::none for a histogram of x
+*/
+void Program::loadEvents(const QString& path, std::size_t x, std::size_t y) {
+  Data::JobToken token = this->events_generation.next();
+  Data::JobReceiver receiver(this);
+
+  this->jobs.submit(
+      [this, receiver, token, path, x, y]() {
+        DATA_TRACE_SCOPE("Program::loadEvents");
+        Data::FCSReader reader;
+        if (!reader.open(path)) {
+          qWarning() << "Program::loadEvents: cannot open FCS file" << path;
+          return;
+        }
+
+        const std::size_t count = reader.eventCount();
+        std::shared_ptr<std::vector<float>> values_x = std::make_shared<std::vector<float>>(count);
+        std::shared_ptr<std::vector<float>> values_y = nullptr;
+        if (reader.readColumn(x, 0, count, values_x->data()) != count) {
+          qWarning() << "Program::loadEvents: cannot read x parameter" << x << "of" << path;
+          return;
+        }
+        if (y != Data::FCSReader::none) {
+          values_y = std::make_shared<std::vector<float>>(count);
+          if (reader.readColumn(y, 0, count, values_y->data()) != count) {
+            qWarning() << "Program::loadEvents: cannot read y parameter" << y << "of" << path;
+            return;
+          }
+        }
+
+        receiver.post(
+            [this, values_x, values_y]() {
+              this->events_x = values_x;
+              this->events_y = values_y;
+              this->syncEvents();
+            },
+            token);
+      },
+      Data::JobSystem::Normal, token);
+}
+
 /*
 Recalculates add/remove buttons of the the toolbar
 */
@@ -563,6 +945,8 @@ void Program::receiveMenuBarState(Main::MenuBarAction action, const QVariant& id
       this->syncGraphs();
       // Make sure to update the fluorophores in all (potentially new) graphs
       this->sendCacheState(this->cache.state());
+      // The detectors have changed
+      this->syncSpillover();
       break;
     }
     case Main::MenuBarAction::SortOrder: {
@@ -587,6 +971,155 @@ void Program::receiveMenuBarState(Main::MenuBarAction action, const QVariant& id
       this->syncStyle();
       break;
     }
+    case Main::MenuBarAction::Spillover: {
+      if (!this->window_spillover) {
+        this->window_spillover = new Spillover::Window();
+        this->window_spillover->setStyleSheet(this->style.getStyleSheet());
+        QObject::connect(this->window_spillover.data(), &Spillover::Window::screenChanged, this, &State::Program::reloadStyle);
+        QObject::connect(this->window_spillover.data(), &Spillover::Window::screenDPIChanged, this, &State::Program::reloadStyle);
+        QObject::connect(this, &State::Program::sendSpillover, this->window_spillover.data(), &Spillover::Window::receiveSpillover);
+        QObject::connect(this, &State::Program::sendSignature, this->window_spillover.data(), &Spillover::Window::receiveSignature);
+      }
+      this->syncSpillover();
+      this->window_spillover->show();
+      this->window_spillover->raise();
+      this->window_spillover->activateWindow();
+      break;
+    }
+    case Main::MenuBarAction::Panel: {
+      if (!this->window_panel) {
+        this->window_panel = new Panel::Window();
+        this->window_panel->setStyleSheet(this->style.getStyleSheet());
+        QObject::connect(this->window_panel.data(), &Panel::Window::screenChanged, this, &State::Program::reloadStyle);
+        QObject::connect(this->window_panel.data(), &Panel::Window::screenDPIChanged, this, &State::Program::reloadStyle);
+        QObject::connect(this, &State::Program::sendInstrument, this->window_panel.data(), &Panel::Window::receiveInstrument);
+        QObject::connect(this, &State::Program::sendFluorophores, this->window_panel.data(), &Panel::Window::receiveFluorophores);
+        QObject::connect(this->window_panel.data(), &Panel::Window::sendPanel, this, &State::Program::receivePanel);
+        this->window_panel->receiveFluorophores(this->data_fluorophores);
+        this->window_panel->receiveInstrument(this->instrument);
+      }
+      this->window_panel->show();
+      this->window_panel->raise();
+      this->window_panel->activateWindow();
+      break;
+    }
+    case Main::MenuBarAction::Similarity: {
+      if (!this->window_similarity) {
+        this->window_similarity = new Similarity::Window();
+        this->window_similarity->setStyleSheet(this->style.getStyleSheet());
+        QObject::connect(this->window_similarity.data(), &Similarity::Window::screenChanged, this, &State::Program::reloadStyle);
+        QObject::connect(this->window_similarity.data(), &Similarity::Window::screenDPIChanged, this, &State::Program::reloadStyle);
+        QObject::connect(this, &State::Program::sendFluorophores, this->window_similarity.data(), &Similarity::Window::receiveFluorophores);
+        QObject::connect(this, &State::Program::sendInstrument, this->window_similarity.data(), &Similarity::Window::receiveInstrument);
+        QObject::connect(this, &State::Program::sendCacheState, this->window_similarity.data(), &Similarity::Window::receiveCacheState);
+        QObject::connect(this->window_similarity.data(), &Similarity::Window::sendCacheAdd, this, &State::Program::receiveCacheAdd);
+        this->window_similarity->receiveFluorophores(this->data_fluorophores);
+        this->window_similarity->receiveInstrument(this->instrument);
+        this->window_similarity->receiveCacheState(this->cache.state());
+      }
+      this->window_similarity->show();
+      this->window_similarity->raise();
+      this->window_similarity->activateWindow();
+      break;
+    }
+    case Main::MenuBarAction::Spreading: {
+      if (!this->window_spreading) {
+        this->window_spreading = new Spreading::Window();
+        this->window_spreading->setStyleSheet(this->style.getStyleSheet());
+        QObject::connect(this->window_spreading.data(), &Spreading::Window::screenChanged, this, &State::Program::reloadStyle);
+        QObject::connect(this->window_spreading.data(), &Spreading::Window::screenDPIChanged, this, &State::Program::reloadStyle);
+        QObject::connect(this, &State::Program::sendSpillover, this->window_spreading.data(), &Spreading::Window::receiveSpillover);
+      }
+      this->syncSpillover();
+      this->window_spreading->show();
+      this->window_spreading->raise();
+      this->window_spreading->activateWindow();
+      break;
+    }
+    case Main::MenuBarAction::Compensation: {
+      if (!this->window_compensation) {
+        this->window_compensation = new Compensation::Window();
+        this->window_compensation->setStyleSheet(this->style.getStyleSheet());
+        QObject::connect(this->window_compensation.data(), &Compensation::Window::screenChanged, this, &State::Program::reloadStyle);
+        QObject::connect(this->window_compensation.data(), &Compensation::Window::screenDPIChanged, this, &State::Program::reloadStyle);
+        QObject::connect(this, &State::Program::sendInstrument, this->window_compensation.data(), &Compensation::Window::receiveInstrument);
+        QObject::connect(this, &State::Program::sendFluorophores, this->window_compensation.data(), &Compensation::Window::receiveFluorophores);
+        this->window_compensation->receiveFluorophores(this->data_fluorophores);
+        this->window_compensation->receiveInstrument(this->instrument);
+      }
+      this->window_compensation->show();
+      this->window_compensation->raise();
+      this->window_compensation->activateWindow();
+      break;
+    }
+    case Main::MenuBarAction::Catalogue: {
+      if (!this->window_catalogue) {
+        this->window_catalogue = new Catalogue::Window();
+        this->window_catalogue->setStyleSheet(this->style.getStyleSheet());
+        QObject::connect(this->window_catalogue.data(), &Catalogue::Window::screenChanged, this, &State::Program::reloadStyle);
+        QObject::connect(this->window_catalogue.data(), &Catalogue::Window::screenDPIChanged, this, &State::Program::reloadStyle);
+        QObject::connect(this, &State::Program::sendInstruments, this->window_catalogue.data(), &Catalogue::Window::receiveInstruments);
+        this->window_catalogue->receiveInstruments(this->data_instruments);
+      }
+      this->window_catalogue->show();
+      this->window_catalogue->raise();
+      this->window_catalogue->activateWindow();
+      break;
+    }
+    case Main::MenuBarAction::Events: {
+      QString path = QFileDialog::getOpenFileName(&this->gui, "Events Overlay", QString(), "Flow Cytometry Standard (*.fcs)");
+      if (path.isEmpty()) {
+        break;
+      }
+      Data::FCSReader header;
+      if (!header.readHeader(path)) {
+        qWarning() << "Program::receiveMenuBarState: cannot read FCS file" << path;
+        break;
+      }
+
+      QStringList parameters;
+      for (std::size_t i = 0; i < header.parameterCount(); ++i) {
+        const Data::FCSReader::Parameter& parameter = header.parameter(i);
+        parameters.append(parameter.label.isEmpty() ? parameter.name : QString("%1 (%2)").arg(parameter.name, parameter.label));
+      }
+
+      // The first X item removes the overlay, the first Y item plots a histogram of X
+      bool accepted = false;
+      QStringList items_x = parameters;
+      items_x.prepend("None (remove overlay)");
+      QString parameter_x =
+          QInputDialog::getItem(&this->gui, "Events Overlay", "X parameter:", items_x, parameters.isEmpty() ? 0 : 1, false, &accepted);
+      int index_x = items_x.indexOf(parameter_x);
+      if (!accepted) {
+        break;
+      }
+      if (index_x <= 0) {
+        this->events_generation.cancel();
+        this->events_x.reset();
+        this->events_y.reset();
+        this->syncEvents();
+        break;
+      }
+
+      QStringList items_y = parameters;
+      items_y.prepend("None (histogram)");
+      QString parameter_y = QInputDialog::getItem(&this->gui, "Events Overlay", "Y parameter:", items_y, 0, false, &accepted);
+      int index_y = items_y.indexOf(parameter_y);
+      if (!accepted) {
+        break;
+      }
+
+      this->loadEvents(path, static_cast<std::size_t>(index_x - 1),
+                       index_y <= 0 ? Data::FCSReader::none : static_cast<std::size_t>(index_y - 1));
+      break;
+    }
+    case Main::MenuBarAction::Trace: {
+      QString path = QFileDialog::getSaveFileName(&this->gui, "Save Trace", QString(), "Chrome Trace (*.json)");
+      if (!path.isEmpty()) {
+        Data::Trace::save(path);
+      }
+      break;
+    }
     case Main::MenuBarAction::About: {
       General::AboutWindow* about = new General::AboutWindow();
       about->setStyleSheet(this->style.getStyleSheet());
@@ -610,8 +1143,10 @@ Slot: receives a Laser signal and forwards it to the state_gui
 void Program::receiveLasers(std::vector<Data::LaserID>& lasers) {
   // Let the GUI add the lasers
   this->state_gui.addLasers(lasers, this->instrument);
+  this->labelGraphs();
 
   emit this->sendGraphState(this->state_gui.graphs());
+  this->syncLasers();
 }
 
 /*
@@ -622,6 +1157,8 @@ void Program::receiveCacheAdd(std::vector<Data::FluorophoreID>& fluorophores) {
 
   // Synchronize
   emit this->sendCacheState(this->cache.state());
+  this->syncSpillover();
+  this->syncAssignment();
 }
 
 /*
@@ -632,6 +1169,8 @@ void Program::receiveCacheRemove(std::vector<Data::FluorophoreID>& fluorophores)
 
   // Synchronize
   emit this->sendCacheState(this->cache.state());
+  this->syncSpillover();
+  this->syncAssignment();
 }
 
 /*
@@ -644,6 +1183,24 @@ Slot: receives a Cache request update signal, forces GUI update
 */
 void Program::receiveCacheRequestUpdate() { emit this->sendCacheUpdate(); }
 
+/*
+Slot: receives a panel, replaces the cached fluorophores with the panel fluorophores
+  :param fluorophores: the panel fluorophores
+*/
+void Program::receivePanel(std::vector<Data::FluorophoreID>& fluorophores) {
+  std::vector<Data::FluorophoreID> cached;
+  for (const Cache::ID& id : this->cache.state()) {
+    cached.emplace_back(id.id, id.name, 0);
+  }
+  this->cache.remove(cached);
+  this->cache.add(fluorophores);
+
+  // Synchronize
+  emit this->sendCacheState(this->cache.state());
+  this->syncSpillover();
+  this->syncAssignment();
+}
+
 /*
 Slot: receive Graph select signal and forwards to the state_gui
   :param index: the graph index that sends the signal